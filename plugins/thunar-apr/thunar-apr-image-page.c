@@ -22,6 +22,10 @@
 #include <config.h>
 #endif
 
+#ifdef HAVE_STRING_H
+#include <string.h>
+#endif
+
 #include <exo/exo.h>
 
 #include <thunar-apr/thunar-apr-image-page.h>
@@ -32,8 +36,18 @@
 
 
 
+typedef struct _ThunarAprImageInfo ThunarAprImageInfo;
+
+
+
+static void thunar_apr_image_page_dispose       (GObject                  *object);
+static void thunar_apr_image_page_finalize      (GObject                  *object);
 static void thunar_apr_image_page_file_changed  (ThunarAprAbstractPage    *abstract_page,
                                                  ThunarxFileInfo          *file);
+static void thunar_apr_image_page_probe_thread  (gpointer                  data,
+                                                 gpointer                  user_data);
+static gboolean thunar_apr_image_page_ready     (gpointer                  user_data);
+static void thunar_apr_image_info_free          (gpointer                  data);
 
 
 
@@ -77,6 +91,28 @@ struct _ThunarAprImagePage
 #ifdef HAVE_EXIF
   GtkWidget            *exif_labels[G_N_ELEMENTS (TAIP_EXIF)];
 #endif
+
+  /* the running probe and the file it is for */
+  GThreadPool          *pool;
+  GCancellable         *cancellable;
+  gchar                *probed_uri;
+  guint64               probed_mtime;
+};
+
+/* the result of a probe, filled in by the worker thread */
+struct _ThunarAprImageInfo
+{
+  /* keeps the page alive until the result is delivered */
+  ThunarAprImagePage *image_page;
+
+  gchar              *filename;
+  GCancellable       *cancellable;
+  GdkPixbufFormat    *format;
+  gint                width;
+  gint                height;
+#ifdef HAVE_EXIF
+  gchar              *exif[G_N_ELEMENTS (TAIP_EXIF)];
+#endif
 };
 
 
@@ -91,6 +127,11 @@ static void
 thunar_apr_image_page_class_init (ThunarAprImagePageClass *klass)
 {
   ThunarAprAbstractPageClass *thunarapr_abstract_page_class;
+  GObjectClass               *gobject_class;
+
+  gobject_class = G_OBJECT_CLASS (klass);
+  gobject_class->dispose = thunar_apr_image_page_dispose;
+  gobject_class->finalize = thunar_apr_image_page_finalize;
 
   thunarapr_abstract_page_class = THUNAR_APR_ABSTRACT_PAGE_CLASS (klass);
   thunarapr_abstract_page_class->file_changed = thunar_apr_image_page_file_changed;
@@ -205,101 +246,230 @@ thunar_apr_image_page_init (ThunarAprImagePage *image_page)
 
 
 
+static void
+thunar_apr_image_page_dispose (GObject *object)
+{
+  ThunarAprImagePage *image_page = THUNAR_APR_IMAGE_PAGE (object);
+
+  /* drop the result of a running probe */
+  if (image_page->cancellable != NULL)
+    {
+      g_cancellable_cancel (image_page->cancellable);
+      g_object_unref (image_page->cancellable);
+      image_page->cancellable = NULL;
+    }
+
+  (*G_OBJECT_CLASS (thunar_apr_image_page_parent_class)->dispose) (object);
+}
+
+
+
+static void
+thunar_apr_image_page_finalize (GObject *object)
+{
+  ThunarAprImagePage *image_page = THUNAR_APR_IMAGE_PAGE (object);
+
+  /* every probe holds a reference, so nothing is running */
+  if (image_page->pool != NULL)
+    g_thread_pool_free (image_page->pool, TRUE, FALSE);
+
+  g_free (image_page->probed_uri);
+
+  (*G_OBJECT_CLASS (thunar_apr_image_page_parent_class)->finalize) (object);
+}
+
+
+
 static void
 thunar_apr_image_page_file_changed (ThunarAprAbstractPage *abstract_page,
                                     ThunarxFileInfo       *file)
 {
   ThunarAprImagePage *image_page = THUNAR_APR_IMAGE_PAGE (abstract_page);
-  GdkPixbufFormat    *format;
+  ThunarAprImageInfo *info;
+  GFileInfo          *file_info;
+  guint64             mtime;
   gchar              *filename;
-  gchar              *text;
   gchar              *uri;
-  gint                height;
-  gint                width;
-#ifdef HAVE_EXIF
-  ExifEntry          *exif_entry;
-  ExifData           *exif_data;
-  gchar               exif_buffer[1024];
-  guint               n;
-#endif
 
   /* determine the URI for the file */
   uri = thunarx_file_info_get_uri (file);
   if (G_UNLIKELY (uri == NULL))
     return;
 
+  /* determine the modification time of the file */
+  file_info = thunarx_file_info_get_file_info (file);
+  mtime = g_file_info_get_attribute_uint64 (file_info, G_FILE_ATTRIBUTE_TIME_MODIFIED);
+  g_object_unref (G_OBJECT (file_info));
+
+  /* no need to probe the file again if its contents did not change */
+  if (image_page->probed_uri != NULL
+      && strcmp (image_page->probed_uri, uri) == 0
+      && image_page->probed_mtime == mtime)
+    {
+      g_free (uri);
+      return;
+    }
+
   /* determine the local path of the file */
   filename = g_filename_from_uri (uri, NULL, NULL);
   if (G_LIKELY (filename != NULL))
     {
-      /* determine the pixbuf format */
-      format = gdk_pixbuf_get_file_info (filename, &width, &height);
-      if (G_LIKELY (format != NULL))
+      /* drop the result of the previous probe */
+      if (image_page->cancellable != NULL)
         {
-          /* update the "Image Type" label */
-          text = g_strdup_printf ("%s (%s)", gdk_pixbuf_format_get_name (format), gdk_pixbuf_format_get_description (format));
-          gtk_label_set_text (GTK_LABEL (image_page->type_label), text);
-          g_free (text);
+          g_cancellable_cancel (image_page->cancellable);
+          g_object_unref (image_page->cancellable);
+        }
+
+      g_free (image_page->probed_uri);
+      image_page->probed_uri = g_strdup (uri);
+      image_page->probed_mtime = mtime;
+      image_page->cancellable = g_cancellable_new ();
+
+      /* probe the image in a worker thread, reading large images or
+       * images on a network share must not block the dialog */
+      info = g_slice_new0 (ThunarAprImageInfo);
+      info->image_page = g_object_ref (image_page);
+      info->filename = filename;
+      info->cancellable = g_object_ref (image_page->cancellable);
+
+      if (G_UNLIKELY (image_page->pool == NULL))
+        image_page->pool = g_thread_pool_new (thunar_apr_image_page_probe_thread, NULL, 1, FALSE, NULL);
+      g_thread_pool_push (image_page->pool, info, NULL);
+    }
+
+  /* cleanup */
+  g_free (uri);
+}
 
-          /* update the "Image Size" label */
-          text = g_strdup_printf (ngettext ("%dx%d pixel", "%dx%d pixels", width + height), width, height);
-          gtk_label_set_text (GTK_LABEL (image_page->dimensions_label), text);
-          g_free (text);
 
+
+static void
+thunar_apr_image_page_probe_thread (gpointer data,
+                                    gpointer user_data)
+{
+  ThunarAprImageInfo *info = data;
 #ifdef HAVE_EXIF
-          /* hide all Exif labels (will be shown again if data is available) */
-          for (n = 0; n < G_N_ELEMENTS (TAIP_EXIF); ++n)
-            gtk_widget_hide (image_page->exif_labels[n]);
+  ExifEntry          *exif_entry;
+  ExifData           *exif_data;
+  gchar               exif_buffer[1024];
+  guint               n;
+#endif
+
+  /* determine the pixbuf format */
+  info->format = gdk_pixbuf_get_file_info (info->filename, &info->width, &info->height);
 
-          /* try to load the Exif data for the file */
-          exif_data = exif_data_new_from_file (filename);
-          if (G_LIKELY (exif_data != NULL))
+#ifdef HAVE_EXIF
+  if (G_LIKELY (info->format != NULL && !g_cancellable_is_cancelled (info->cancellable)))
+    {
+      /* try to load the Exif data for the file */
+      exif_data = exif_data_new_from_file (info->filename);
+      if (G_LIKELY (exif_data != NULL))
+        {
+          for (n = 0; n < G_N_ELEMENTS (TAIP_EXIF); ++n)
             {
-              /* update all Exif labels */
-              for (n = 0; n < G_N_ELEMENTS (TAIP_EXIF); ++n)
+              /* lookup the entry for the tag */
+              exif_entry = exif_data_get_entry (exif_data, TAIP_EXIF[n].tag);
+              if (G_LIKELY (exif_entry != NULL))
                 {
-                  /* lookup the entry for the tag */
-                  exif_entry = exif_data_get_entry (exif_data, TAIP_EXIF[n].tag);
-                  if (G_LIKELY (exif_entry != NULL))
+                  /* determine the value */
+                  if (exif_entry_get_value (exif_entry, exif_buffer, sizeof (exif_buffer)) != NULL)
                     {
-                      /* determine the value */
-                      if (exif_entry_get_value (exif_entry, exif_buffer, sizeof (exif_buffer)) != NULL)
-                        {
-                          /* setup the label text */
-                          text = (g_utf8_validate (exif_buffer, -1, NULL)) ? g_strdup (exif_buffer) : g_filename_display_name (exif_buffer);
-                          gtk_label_set_text (GTK_LABEL (image_page->exif_labels[n]), text);
-                          g_free (text);
-
-                          /* show the label */
-                          gtk_widget_show (image_page->exif_labels[n]);
-                        }
+                      /* setup the label text */
+                      info->exif[n] = (g_utf8_validate (exif_buffer, -1, NULL)) ? g_strdup (exif_buffer) : g_filename_display_name (exif_buffer);
                     }
                 }
-
-              /* cleanup */
-              exif_data_free (exif_data);
             }
-#endif
+
+          /* cleanup */
+          exif_data_free (exif_data);
         }
-      else
-        {
-          /* tell the user that we're unable to determine the file info */
-          gtk_label_set_text (GTK_LABEL (image_page->type_label), _("Unknown"));
-          gtk_label_set_text (GTK_LABEL (image_page->dimensions_label), _("Unknown"));
+    }
+#endif
+
+  /* deliver the result in the main thread */
+  g_idle_add_full (G_PRIORITY_LOW, thunar_apr_image_page_ready, info, thunar_apr_image_info_free);
+}
 
+
+
+static gboolean
+thunar_apr_image_page_ready (gpointer user_data)
+{
+  ThunarAprImageInfo *info = user_data;
+  ThunarAprImagePage *image_page = info->image_page;
+  gchar              *text;
 #ifdef HAVE_EXIF
-          /* hide all Exif labels */
-          for (n = 0; n < G_N_ELEMENTS (TAIP_EXIF); ++n)
-            gtk_widget_hide (image_page->exif_labels[n]);
+  guint               n;
 #endif
+
+  /* the page was destroyed or shows another file by now */
+  if (g_cancellable_is_cancelled (info->cancellable))
+    return FALSE;
+
+  GDK_THREADS_ENTER ();
+
+  if (G_LIKELY (info->format != NULL))
+    {
+      /* update the "Image Type" label */
+      text = g_strdup_printf ("%s (%s)", gdk_pixbuf_format_get_name (info->format), gdk_pixbuf_format_get_description (info->format));
+      gtk_label_set_text (GTK_LABEL (image_page->type_label), text);
+      g_free (text);
+
+      /* update the "Image Size" label */
+      text = g_strdup_printf (ngettext ("%dx%d pixel", "%dx%d pixels", info->width + info->height), info->width, info->height);
+      gtk_label_set_text (GTK_LABEL (image_page->dimensions_label), text);
+      g_free (text);
+
+#ifdef HAVE_EXIF
+      /* update all Exif labels, hide the ones without data */
+      for (n = 0; n < G_N_ELEMENTS (TAIP_EXIF); ++n)
+        {
+          if (info->exif[n] != NULL)
+            {
+              gtk_label_set_text (GTK_LABEL (image_page->exif_labels[n]), info->exif[n]);
+              gtk_widget_show (image_page->exif_labels[n]);
+            }
+          else
+            {
+              gtk_widget_hide (image_page->exif_labels[n]);
+            }
         }
+#endif
     }
+  else
+    {
+      /* tell the user that we're unable to determine the file info */
+      gtk_label_set_text (GTK_LABEL (image_page->type_label), _("Unknown"));
+      gtk_label_set_text (GTK_LABEL (image_page->dimensions_label), _("Unknown"));
 
-  /* cleanup */
-  g_free (filename);
-  g_free (uri);
+#ifdef HAVE_EXIF
+      /* hide all Exif labels */
+      for (n = 0; n < G_N_ELEMENTS (TAIP_EXIF); ++n)
+        gtk_widget_hide (image_page->exif_labels[n]);
+#endif
+    }
+
+  GDK_THREADS_LEAVE ();
+
+  return FALSE;
 }
 
 
 
+static void
+thunar_apr_image_info_free (gpointer data)
+{
+  ThunarAprImageInfo *info = data;
+#ifdef HAVE_EXIF
+  guint               n;
+
+  for (n = 0; n < G_N_ELEMENTS (TAIP_EXIF); ++n)
+    g_free (info->exif[n]);
+#endif
 
+  g_object_unref (info->cancellable);
+  g_object_unref (info->image_page);
+  g_free (info->filename);
+  g_slice_free (ThunarAprImageInfo, info);
+}
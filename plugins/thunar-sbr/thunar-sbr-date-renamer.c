@@ -44,6 +44,12 @@
 
 
 
+#ifdef HAVE_EXIF
+/* maximum number of threads reading EXIF data in parallel */
+#define EXIF_MAX_THREADS (4)
+#endif
+
+
 /* Property identifiers */
 enum
 {
@@ -56,26 +62,44 @@ enum
 
 
 
-static void    thunar_sbr_date_renamer_finalize     (GObject                   *object);
-static void    thunar_sbr_date_renamer_get_property (GObject                   *object,
-                                                     guint                      prop_id,
-                                                     GValue                    *value,
-                                                     GParamSpec                *pspec);
-static void    thunar_sbr_date_renamer_set_property (GObject                   *object,
-                                                     guint                      prop_id,
-                                                     const GValue              *value,
-                                                     GParamSpec                *pspec);
-static gchar  *thunar_sbr_get_time_string           (guint64                    file_time,
-                                                     const gchar               *custom_format);
+static void    thunar_sbr_date_renamer_finalize      (GObject                   *object);
+static void    thunar_sbr_date_renamer_get_property  (GObject                   *object,
+                                                      guint                      prop_id,
+                                                      GValue                    *value,
+                                                      GParamSpec                *pspec);
+static void    thunar_sbr_date_renamer_set_property  (GObject                   *object,
+                                                      guint                      prop_id,
+                                                      const GValue              *value,
+                                                      GParamSpec                *pspec);
+static gchar  *thunar_sbr_get_time_string            (guint64                    file_time,
+                                                      const gchar               *locale_format);
 #ifdef HAVE_EXIF
-static guint64 thunar_sbr_get_time_from_string      (const gchar               *string);
+static guint64 thunar_sbr_get_time_from_string       (const gchar               *string);
+static guint64 thunar_sbr_get_exif_time              (const gchar               *filename);
+static void    thunar_sbr_date_renamer_exif_worker   (gpointer                   data,
+                                                      gpointer                   user_data);
+static gboolean thunar_sbr_date_renamer_exif_ready  (gpointer                   user_data);
+static void    thunar_sbr_exif_time_free             (gpointer                   data);
+static void    thunar_sbr_exif_job_free              (gpointer                   data);
+static gchar **thunar_sbr_date_renamer_exif_prefetch (ThunarSbrDateRenamer      *date_renamer,
+                                                      ThunarxFileInfo          **files,
+                                                      guint                      n_files,
+                                                      guint64                   *mtimes);
+static guint64 thunar_sbr_date_renamer_exif_lookup   (ThunarSbrDateRenamer      *date_renamer,
+                                                      const gchar               *filename,
+                                                      guint64                    mtime);
 #endif
-static guint64 thunar_sbr_get_time                  (ThunarxFileInfo           *file,
-                                                     ThunarSbrDateMode          mode);
-static gchar  *thunar_sbr_date_renamer_process      (ThunarxRenamer            *renamer,
-                                                     ThunarxFileInfo           *file,
-                                                     const gchar               *text,
-                                                     guint                      idx);
+static guint64 thunar_sbr_get_time                   (ThunarxFileInfo           *file,
+                                                      ThunarSbrDateMode          mode);
+static gchar  *thunar_sbr_date_renamer_process       (ThunarxRenamer            *renamer,
+                                                      ThunarxFileInfo           *file,
+                                                      const gchar               *text,
+                                                      guint                      idx);
+static gchar **thunar_sbr_date_renamer_process_batch (ThunarxRenamer            *renamer,
+                                                      ThunarxFileInfo          **files,
+                                                      const gchar              **texts,
+                                                      const guint               *indices,
+                                                      guint                      n_files);
 
 
 
@@ -91,8 +115,43 @@ struct _ThunarSbrDateRenamer
   guint               offset;
   ThunarSbrOffsetMode offset_mode;
   gchar              *format;
+
+#ifdef HAVE_EXIF
+  /* the picture taken times read so far, so format changes
+   * don't need to read the EXIF data of every file again. The
+   * renamer lives as long as the dialog, so this holds at most
+   * one time for every file that was shown in the dialog.
+   * filename -> TsdrExifTime
+   */
+  GHashTable         *exif_cache;
+
+  /* filename -> TsdrExifJob */
+  GHashTable         *exif_jobs;
+  GThreadPool        *exif_pool;
+#endif
 };
 
+#ifdef HAVE_EXIF
+typedef struct
+{
+  gchar  *filename;
+  guint64 mtime;
+  guint64 time;
+} TsdrExifTime;
+
+typedef struct
+{
+  /* keeps the renamer alive until the result is delivered */
+  ThunarSbrDateRenamer *date_renamer;
+  ThunarxFileInfo      *file;
+  gchar                *filename;
+  guint64               mtime;
+
+  /* set by the worker thread */
+  guint64               time;
+} TsdrExifJob;
+#endif
+
 
 
 THUNARX_DEFINE_TYPE (ThunarSbrDateRenamer, thunar_sbr_date_renamer, THUNARX_TYPE_RENAMER);
@@ -112,6 +171,7 @@ thunar_sbr_date_renamer_class_init (ThunarSbrDateRenamerClass *klass)
 
   thunarxrenamer_class = THUNARX_RENAMER_CLASS (klass);
   thunarxrenamer_class->process = thunar_sbr_date_renamer_process;
+  thunarxrenamer_class->process_batch = thunar_sbr_date_renamer_process_batch;
 
   /**
    * ThunarSbrDateRenamer:mode:
@@ -266,6 +326,13 @@ thunar_sbr_date_renamer_init (ThunarSbrDateRenamer *date_renamer)
   gtk_box_pack_start (GTK_BOX (hbox), combo, FALSE, FALSE, 0);
   g_type_class_unref (klass);
   gtk_widget_show (combo);
+
+#ifdef HAVE_EXIF
+  /* setup the picture taken time cache */
+  date_renamer->exif_cache = g_hash_table_new_full (g_str_hash, g_str_equal, NULL,
+                                                    thunar_sbr_exif_time_free);
+  date_renamer->exif_jobs = g_hash_table_new (g_str_hash, g_str_equal);
+#endif
 }
 
 
@@ -278,6 +345,16 @@ thunar_sbr_date_renamer_finalize (GObject *object)
   /* release the format */
   g_free (date_renamer->format);
 
+#ifdef HAVE_EXIF
+  /* every job holds a reference, so no worker is running */
+  if (date_renamer->exif_pool != NULL)
+    g_thread_pool_free (date_renamer->exif_pool, TRUE, FALSE);
+  g_hash_table_destroy (date_renamer->exif_jobs);
+
+  /* release the picture taken time cache */
+  g_hash_table_destroy (date_renamer->exif_cache);
+#endif
+
   (*G_OBJECT_CLASS (thunar_sbr_date_renamer_parent_class)->finalize) (object);
 }
 
@@ -353,11 +430,10 @@ thunar_sbr_date_renamer_set_property (GObject      *object,
 
 static gchar *
 thunar_sbr_get_time_string (guint64      file_time,
-                            const gchar *format)
+                            const gchar *locale_format)
 {
   struct tm *tm;
   time_t     _time;
-  gchar     *converted;
   gchar      buffer[1024];
   gint       length;
 
@@ -366,14 +442,8 @@ thunar_sbr_get_time_string (guint64      file_time,
   /* determine the local file time */
   tm = localtime (&_time);
 
-  /* conver the format to the current locale */
-  converted = g_locale_from_utf8 (format, -1, NULL, NULL, NULL);
-
   /* parse the format */
-  length = strftime (buffer, sizeof (buffer), converted, tm);
-
-  /* cleanup */
-  g_free (converted);
+  length = strftime (buffer, sizeof (buffer), locale_format, tm);
 
   /* check if strftime succeeded */
   if (G_UNLIKELY (length == 0))
@@ -428,6 +498,194 @@ thunar_sbr_get_time_from_string (const gchar *string)
 
 
 
+#ifdef HAVE_EXIF
+static guint64
+thunar_sbr_get_exif_time (const gchar *filename)
+{
+  ExifEntry *exif_entry;
+  ExifData  *exif_data;
+  guint64    file_time = 0;
+  gchar      exif_buffer[128];
+
+  /* try to load the exif data for the file */
+  exif_data = exif_data_new_from_file (filename);
+  if (G_LIKELY (exif_data != NULL))
+    {
+      /* lookup the entry for the tag, fallback on less common ones */
+      exif_entry = exif_data_get_entry (exif_data, EXIF_TAG_DATE_TIME);
+
+      if (exif_entry == NULL)
+        exif_entry = exif_data_get_entry (exif_data, EXIF_TAG_DATE_TIME_ORIGINAL);
+
+      if (exif_entry == NULL)
+        exif_entry = exif_data_get_entry (exif_data, EXIF_TAG_DATE_TIME_DIGITIZED);
+
+      if (G_LIKELY (exif_entry != NULL))
+        {
+          /* determine the value */
+          if (exif_entry_get_value (exif_entry, exif_buffer, sizeof (exif_buffer)) != NULL)
+            file_time = thunar_sbr_get_time_from_string (exif_buffer);
+        }
+
+      /* cleanup */
+      exif_data_free (exif_data);
+    }
+
+  return file_time;
+}
+
+
+
+static void
+thunar_sbr_date_renamer_exif_worker (gpointer data,
+                                     gpointer user_data)
+{
+  TsdrExifJob *job = data;
+
+  job->time = thunar_sbr_get_exif_time (job->filename);
+
+  /* deliver the result in the main thread */
+  g_idle_add_full (G_PRIORITY_LOW, thunar_sbr_date_renamer_exif_ready,
+                   job, thunar_sbr_exif_job_free);
+}
+
+
+
+static gboolean
+thunar_sbr_date_renamer_exif_ready (gpointer user_data)
+{
+  ThunarSbrDateRenamer *date_renamer;
+  TsdrExifTime         *exif_time;
+  TsdrExifJob          *job = user_data;
+
+  GDK_THREADS_ENTER ();
+
+  date_renamer = job->date_renamer;
+  g_hash_table_remove (date_renamer->exif_jobs, job->filename);
+
+  /* cache the new time, replacing an older time for the file */
+  exif_time = g_slice_new0 (TsdrExifTime);
+  exif_time->filename = g_strdup (job->filename);
+  exif_time->mtime = job->mtime;
+  exif_time->time = job->time;
+  g_hash_table_replace (date_renamer->exif_cache, exif_time->filename, exif_time);
+
+  /* only the row of this file needs a new name, files
+   * without a picture taken time keep their name */
+  if (G_LIKELY (job->time != 0))
+    thunarx_renamer_file_changed (THUNARX_RENAMER (date_renamer), job->file);
+
+  GDK_THREADS_LEAVE ();
+
+  return FALSE;
+}
+
+
+
+static void
+thunar_sbr_exif_time_free (gpointer data)
+{
+  TsdrExifTime *exif_time = data;
+
+  g_free (exif_time->filename);
+  g_slice_free (TsdrExifTime, exif_time);
+}
+
+
+
+static void
+thunar_sbr_exif_job_free (gpointer data)
+{
+  TsdrExifJob *job = data;
+
+  g_free (job->filename);
+  g_object_unref (job->file);
+  g_object_unref (job->date_renamer);
+  g_slice_free (TsdrExifJob, job);
+}
+
+
+
+static gchar**
+thunar_sbr_date_renamer_exif_prefetch (ThunarSbrDateRenamer *date_renamer,
+                                       ThunarxFileInfo     **files,
+                                       guint                 n_files,
+                                       guint64              *mtimes)
+{
+  TsdrExifTime *exif_time;
+  TsdrExifJob  *job;
+  GFileInfo    *file_info;
+  gchar       **filenames;
+  gchar        *uri;
+  guint         n;
+
+  /* start the workers on-demand */
+  if (G_UNLIKELY (date_renamer->exif_pool == NULL))
+    date_renamer->exif_pool = g_thread_pool_new (thunar_sbr_date_renamer_exif_worker, NULL, EXIF_MAX_THREADS, FALSE, NULL);
+
+  filenames = g_new0 (gchar *, n_files);
+
+  for (n = 0; n < n_files; ++n)
+    {
+      /* determine the local path of the file */
+      uri = thunarx_file_info_get_uri (files[n]);
+      filenames[n] = (uri != NULL) ? g_filename_from_uri (uri, NULL, NULL) : NULL;
+      g_free (uri);
+
+      if (G_UNLIKELY (filenames[n] == NULL))
+        continue;
+
+      /* the cached time is valid as long as the file was not modified */
+      file_info = thunarx_file_info_get_file_info (files[n]);
+      mtimes[n] = g_file_info_get_attribute_uint64 (file_info, G_FILE_ATTRIBUTE_TIME_MODIFIED);
+      g_object_unref (file_info);
+
+      exif_time = g_hash_table_lookup (date_renamer->exif_cache, filenames[n]);
+      if (exif_time != NULL && exif_time->mtime == mtimes[n])
+        continue;
+
+      /* check if the file is read already */
+      if (g_hash_table_lookup (date_renamer->exif_jobs, filenames[n]) != NULL)
+        continue;
+
+      /* read the EXIF data in one of the workers, the rows are
+       * updated once the time is known */
+      job = g_slice_new0 (TsdrExifJob);
+      job->date_renamer = g_object_ref (date_renamer);
+      job->file = g_object_ref (files[n]);
+      job->filename = g_strdup (filenames[n]);
+      job->mtime = mtimes[n];
+      g_hash_table_insert (date_renamer->exif_jobs, job->filename, job);
+      g_thread_pool_push (date_renamer->exif_pool, job, NULL);
+    }
+
+  return filenames;
+}
+
+
+
+static guint64
+thunar_sbr_date_renamer_exif_lookup (ThunarSbrDateRenamer *date_renamer,
+                                     const gchar          *filename,
+                                     guint64               mtime)
+{
+  TsdrExifTime *exif_time;
+
+  if (G_UNLIKELY (filename == NULL))
+    return 0;
+
+  /* files that are still being read keep their name for now,
+   * so do modified files until their time was read again */
+  exif_time = g_hash_table_lookup (date_renamer->exif_cache, filename);
+  if (G_LIKELY (exif_time != NULL && exif_time->mtime == mtime))
+    return exif_time->time;
+
+  return 0;
+}
+#endif
+
+
+
 static guint64
 thunar_sbr_get_time (ThunarxFileInfo   *file,
                      ThunarSbrDateMode  mode)
@@ -435,12 +693,6 @@ thunar_sbr_get_time (ThunarxFileInfo   *file,
 
   GFileInfo *file_info;
   guint64    file_time = 0;
-#ifdef HAVE_EXIF
-  gchar     *uri, *filename;
-  ExifEntry *exif_entry;
-  ExifData  *exif_data;
-  gchar     exif_buffer[128];
-#endif
 
   switch (mode)
     {
@@ -472,46 +724,7 @@ thunar_sbr_get_time (ThunarxFileInfo   *file,
 
 #ifdef HAVE_EXIF
     case THUNAR_SBR_DATE_MODE_TAKEN:
-      /* get the uri */
-      uri = thunarx_file_info_get_uri (file);
-      if (G_LIKELY (uri != NULL))
-        {
-          /* determine the local path of the file */
-          filename = g_filename_from_uri (uri, NULL, NULL);
-          if (G_LIKELY (filename != NULL))
-            {
-              /* try to load the exif data for the file */
-              exif_data = exif_data_new_from_file (filename);
-              if (G_LIKELY (exif_data != NULL))
-                {
-                  /* lookup the entry for the tag, fallback on less common ones */
-                  exif_entry = exif_data_get_entry (exif_data, EXIF_TAG_DATE_TIME);
-
-                  if (exif_entry == NULL)
-                    exif_entry = exif_data_get_entry (exif_data, EXIF_TAG_DATE_TIME_ORIGINAL);
-
-                  if (exif_entry == NULL)
-                    exif_entry = exif_data_get_entry (exif_data, EXIF_TAG_DATE_TIME_DIGITIZED);
-
-                  if (G_LIKELY (exif_entry != NULL))
-                    {
-                      /* determine the value */
-                      if (exif_entry_get_value (exif_entry, exif_buffer, sizeof (exif_buffer)) != NULL)
-                        file_time = thunar_sbr_get_time_from_string (exif_buffer);
-                    }
-
-                  /* cleanup */
-                  exif_data_free (exif_data);
-                }
-
-              /* cleanup */
-              g_free (filename);
-            }
-
-          /* cleanup */
-          g_free (uri);
-        }
-
+      /* handled by the EXIF cache of the renamer */
       break;
 #endif
     }
@@ -526,54 +739,141 @@ thunar_sbr_date_renamer_process (ThunarxRenamer  *renamer,
                                  ThunarxFileInfo *file,
                                  const gchar     *text,
                                  guint            idx)
+{
+  gchar **names;
+  gchar  *name;
+
+  /* a single file is just a batch of one */
+  names = thunar_sbr_date_renamer_process_batch (renamer, &file, &text, &idx, 1);
+  name = names[0];
+  g_free (names);
+
+  return name;
+}
+
+
+
+static gchar**
+thunar_sbr_date_renamer_process_batch (ThunarxRenamer   *renamer,
+                                       ThunarxFileInfo **files,
+                                       const gchar     **texts,
+                                       const guint      *indices,
+                                       guint             n_files)
 {
   ThunarSbrDateRenamer *date_renamer = THUNAR_SBR_DATE_RENAMER (renamer);
-  gchar                *string;
+  guint64               last_time = 0;
   guint64               file_time;
+  guint64               now = 0;
   const gchar          *s;
+  const gchar          *text;
   GString              *result;
+  gchar               **names;
+  gchar                *locale_format = NULL;
+  gchar                *string = NULL;
+  gchar               **filenames = NULL;
+  guint64              *mtimes = NULL;
   guint                 text_length;
   guint                 offset;
+  guint                 n;
 
-  /* return when there is no text in the custom format entry */
-  if (G_UNLIKELY (date_renamer->format == NULL || *date_renamer->format == '\0'))
-    return g_strdup (text);
+  names = g_new (gchar *, n_files + 1);
+  names[n_files] = NULL;
 
-  /* determine the input text length */
-  text_length = g_utf8_strlen (text, -1);
+  /* convert the format to the current locale once for all files */
+  if (G_LIKELY (date_renamer->format != NULL && *date_renamer->format != '\0'))
+    locale_format = g_locale_from_utf8 (date_renamer->format, -1, NULL, NULL, NULL);
 
-  /* determine the real offset and check if it's valid */
-  offset = (date_renamer->offset_mode == THUNAR_SBR_OFFSET_MODE_LEFT) ? date_renamer->offset : (text_length - date_renamer->offset);
-  if (G_UNLIKELY (offset > text_length))
-    return g_strdup (text);
+  /* all files get the same time in "now" mode */
+  if (date_renamer->mode == THUNAR_SBR_DATE_MODE_NOW)
+    now = time (NULL);
+
+#ifdef HAVE_EXIF
+  /* read the picture taken times of the batch in the background */
+  if (date_renamer->mode == THUNAR_SBR_DATE_MODE_TAKEN && locale_format != NULL)
+    {
+      mtimes = g_new0 (guint64, n_files);
+      filenames = thunar_sbr_date_renamer_exif_prefetch (date_renamer, files, n_files, mtimes);
+    }
+#endif
 
-  /* get the file time */
-  file_time = thunar_sbr_get_time (file, date_renamer->mode);
-  if (file_time == 0)
-    return g_strdup (text);
+  for (n = 0; n < n_files; ++n)
+    {
+      text = texts[n];
 
-  /* allocate space for the result */
-  result = g_string_sized_new (2 * text_length);
+      /* return the text when there is no text in the custom format entry */
+      if (G_UNLIKELY (locale_format == NULL))
+        {
+          names[n] = g_strdup (text);
+          continue;
+        }
 
-  /* determine the text pointer for the offset */
-  s = g_utf8_offset_to_pointer (text, offset);
+      /* determine the input text length */
+      text_length = g_utf8_strlen (text, -1);
 
-  /* add the text before the insert/overwrite offset */
-  g_string_append_len (result, text, s - text);
+      /* determine the real offset and check if it's valid */
+      offset = (date_renamer->offset_mode == THUNAR_SBR_OFFSET_MODE_LEFT) ? date_renamer->offset : (text_length - date_renamer->offset);
+      if (G_UNLIKELY (offset > text_length))
+        {
+          names[n] = g_strdup (text);
+          continue;
+        }
 
-  /* parse the time string */
-  string = thunar_sbr_get_time_string (file_time, date_renamer->format);
-  if (string)
-    {
-      g_string_append (result, string);
-      g_free (string);
+      /* get the file time */
+      if (now != 0)
+        file_time = now;
+#ifdef HAVE_EXIF
+      else if (filenames != NULL)
+        file_time = thunar_sbr_date_renamer_exif_lookup (date_renamer, filenames[n], mtimes[n]);
+#endif
+      else
+        file_time = thunar_sbr_get_time (files[n], date_renamer->mode);
+      if (file_time == 0)
+        {
+          names[n] = g_strdup (text);
+          continue;
+        }
+
+      /* parse the time string, unless the previous file had the same time */
+      if (file_time != last_time)
+        {
+          g_free (string);
+          string = thunar_sbr_get_time_string (file_time, locale_format);
+          last_time = file_time;
+        }
+
+      /* allocate space for the result */
+      result = g_string_sized_new (2 * text_length);
+
+      /* determine the text pointer for the offset */
+      s = g_utf8_offset_to_pointer (text, offset);
+
+      /* add the text before the insert/overwrite offset */
+      g_string_append_len (result, text, s - text);
+
+      /* add the time string */
+      if (string != NULL)
+        g_string_append (result, string);
+
+      /* append the remaining text */
+      g_string_append (result, s);
+
+      names[n] = g_string_free (result, FALSE);
     }
 
-  /* append the remaining text */
-  g_string_append (result, s);
+  /* cleanup */
+  g_free (locale_format);
+  g_free (string);
+
+  /* release the filenames (if any) */
+  if (filenames != NULL)
+    {
+      for (n = 0; n < n_files; ++n)
+        g_free (filenames[n]);
+      g_free (filenames);
+    }
+  g_free (mtimes);
 
-  /* return the result */
-  return g_string_free (result, FALSE);
+  return names;
 }
 
 
@@ -50,21 +50,26 @@ enum
 
 
 
-static void   thunar_sbr_number_renamer_finalize      (GObject                      *object);
-static void   thunar_sbr_number_renamer_get_property  (GObject                      *object,
-                                                       guint                         prop_id,
-                                                       GValue                       *value,
-                                                       GParamSpec                   *pspec);
-static void   thunar_sbr_number_renamer_set_property  (GObject                      *object,
-                                                       guint                         prop_id,
-                                                       const GValue                 *value,
-                                                       GParamSpec                   *pspec);
-static void   thunar_sbr_number_renamer_realize       (GtkWidget                    *widget);
-static gchar *thunar_sbr_number_renamer_process       (ThunarxRenamer               *renamer,
-                                                       ThunarxFileInfo              *file,
-                                                       const gchar                  *text,
-                                                       guint                         idx);
-static void   thunar_sbr_number_renamer_update        (ThunarSbrNumberRenamer       *number_renamer);
+static void    thunar_sbr_number_renamer_finalize       (GObject                      *object);
+static void    thunar_sbr_number_renamer_get_property   (GObject                      *object,
+                                                         guint                         prop_id,
+                                                         GValue                       *value,
+                                                         GParamSpec                   *pspec);
+static void    thunar_sbr_number_renamer_set_property   (GObject                      *object,
+                                                         guint                         prop_id,
+                                                         const GValue                 *value,
+                                                         GParamSpec                   *pspec);
+static void    thunar_sbr_number_renamer_realize        (GtkWidget                    *widget);
+static gchar  *thunar_sbr_number_renamer_process        (ThunarxRenamer               *renamer,
+                                                         ThunarxFileInfo              *file,
+                                                         const gchar                  *text,
+                                                         guint                         idx);
+static gchar **thunar_sbr_number_renamer_process_batch  (ThunarxRenamer               *renamer,
+                                                         ThunarxFileInfo             **files,
+                                                         const gchar                 **texts,
+                                                         const guint                  *indices,
+                                                         guint                         n_files);
+static void    thunar_sbr_number_renamer_update         (ThunarSbrNumberRenamer       *number_renamer);
 
 
 
@@ -108,6 +113,7 @@ thunar_sbr_number_renamer_class_init (ThunarSbrNumberRenamerClass *klass)
 
   thunarxrenamer_class = THUNARX_RENAMER_CLASS (klass);
   thunarxrenamer_class->process = thunar_sbr_number_renamer_process;
+  thunarxrenamer_class->process_batch = thunar_sbr_number_renamer_process_batch;
 
   /**
    * ThunarSbrNumberRenamer:mode:
@@ -370,13 +376,38 @@ thunar_sbr_number_renamer_process (ThunarxRenamer  *renamer,
                                    ThunarxFileInfo *file,
                                    const gchar     *text,
                                    guint            idx)
+{
+  gchar **names;
+  gchar  *name;
+
+  /* a single file is just a batch of one */
+  names = thunar_sbr_number_renamer_process_batch (renamer, &file, &text, &idx, 1);
+  name = names[0];
+  g_free (names);
+
+  return name;
+}
+
+
+
+static gchar**
+thunar_sbr_number_renamer_process_batch (ThunarxRenamer   *renamer,
+                                         ThunarxFileInfo **files,
+                                         const gchar     **texts,
+                                         const guint      *indices,
+                                         guint             n_files)
 {
   ThunarSbrNumberRenamer *number_renamer = THUNAR_SBR_NUMBER_RENAMER (renamer);
+  const gchar            *format = NULL;
   gboolean                invalid = TRUE;
+  gchar                 **names;
   gchar                  *endp;
-  gchar                  *name;
-  gchar                  *number = NULL;
+  gchar                   number[32];
   guint                   start = 0;
+  guint                   n;
+
+  names = g_new (gchar *, n_files + 1);
+  names[n_files] = NULL;
 
   /* check whether "start" is valid for the "mode" */
   if (number_renamer->mode < THUNAR_SBR_NUMBER_MODE_ABC)
@@ -396,34 +427,32 @@ thunar_sbr_number_renamer_process (ThunarxRenamer  *renamer,
 
   /* check if we have invalid settings */
   if (G_UNLIKELY (invalid))
-    return g_strdup (text);
+    {
+      for (n = 0; n < n_files; ++n)
+        names[n] = g_strdup (texts[n]);
+      return names;
+    }
 
-  /* format the number */
+  /* determine the number format once for all files */
   switch (number_renamer->mode)
     {
     case THUNAR_SBR_NUMBER_MODE_123:
-      number = g_strdup_printf ("%u", start + idx);
+      format = "%u";
       break;
 
     case THUNAR_SBR_NUMBER_MODE_010203:
-      number = g_strdup_printf ("%02u", start + idx);
+      format = "%02u";
       break;
 
     case THUNAR_SBR_NUMBER_MODE_001002003:
-      number = g_strdup_printf ("%03u", start + idx);
+      format = "%03u";
       break;
 
     case THUNAR_SBR_NUMBER_MODE_000100020003:
-      number = g_strdup_printf ("%04u", start + idx);
+      format = "%04u";
       break;
 
     case THUNAR_SBR_NUMBER_MODE_ABC:
-      if (start >= 'a' && start <= 'z')
-        number = g_strdup_printf ("%c", (gchar) (MIN (start + idx, 'z')));
-      else if (start >= 'A' && start <= 'Z')
-        number = g_strdup_printf ("%c", (gchar) (MIN (start + idx, 'Z')));
-      else
-        g_assert_not_reached ();
       break;
 
     default:
@@ -431,35 +460,50 @@ thunar_sbr_number_renamer_process (ThunarxRenamer  *renamer,
       break;
     }
 
-  /* format the text */
-  switch (number_renamer->text_mode)
+  for (n = 0; n < n_files; ++n)
     {
-    case THUNAR_SBR_TEXT_MODE_OTN:
-      name = g_strconcat (text, number_renamer->text, number, NULL);
-      break;
+      /* format the number */
+      if (G_LIKELY (format != NULL))
+        {
+          g_snprintf (number, sizeof (number), format, start + indices[n]);
+        }
+      else
+        {
+          if (start >= 'a' && start <= 'z')
+            number[0] = (gchar) (MIN (start + indices[n], 'z'));
+          else if (start >= 'A' && start <= 'Z')
+            number[0] = (gchar) (MIN (start + indices[n], 'Z'));
+          else
+            g_assert_not_reached ();
+          number[1] = '\0';
+        }
 
-    case THUNAR_SBR_TEXT_MODE_NTO:
-      name = g_strconcat (number, number_renamer->text, text, NULL);
-      break;
+      /* format the text */
+      switch (number_renamer->text_mode)
+        {
+        case THUNAR_SBR_TEXT_MODE_OTN:
+          names[n] = g_strconcat (texts[n], number_renamer->text, number, NULL);
+          break;
 
-    case THUNAR_SBR_TEXT_MODE_TN:
-      name = g_strconcat (number_renamer->text, number, NULL);
-      break;
+        case THUNAR_SBR_TEXT_MODE_NTO:
+          names[n] = g_strconcat (number, number_renamer->text, texts[n], NULL);
+          break;
 
-    case THUNAR_SBR_TEXT_MODE_NT:
-      name = g_strconcat (number, number_renamer->text, NULL);
-      break;
+        case THUNAR_SBR_TEXT_MODE_TN:
+          names[n] = g_strconcat (number_renamer->text, number, NULL);
+          break;
 
-    default:
-      g_assert_not_reached ();
-      break;
-    }
+        case THUNAR_SBR_TEXT_MODE_NT:
+          names[n] = g_strconcat (number, number_renamer->text, NULL);
+          break;
 
-  /* release the number */
-  g_free (number);
+        default:
+          g_assert_not_reached ();
+          break;
+        }
+    }
 
-  /* return the new name */
-  return name;
+  return names;
 }
 
 
@@ -39,6 +39,18 @@
 
 
 
+#ifdef HAVE_PCRE
+/* JIT compilation is available since PCRE 8.20 */
+#ifdef PCRE_STUDY_JIT_COMPILE
+#define TSRR_STUDY_OPTIONS      PCRE_STUDY_JIT_COMPILE
+#define tsrr_pcre_free_study(e) pcre_free_study (e)
+#else
+#define TSRR_STUDY_OPTIONS      0
+#define tsrr_pcre_free_study(e) pcre_free (e)
+#endif
+#endif
+
+
 /* Property identifiers */
 enum
 {
@@ -51,24 +63,30 @@ enum
 
 
 
-static void   thunar_sbr_replace_renamer_finalize     (GObject                      *object);
-static void   thunar_sbr_replace_renamer_get_property (GObject                      *object,
-                                                       guint                         prop_id,
-                                                       GValue                       *value,
-                                                       GParamSpec                   *pspec);
-static void   thunar_sbr_replace_renamer_set_property (GObject                      *object,
-                                                       guint                         prop_id,
-                                                       const GValue                 *value,
-                                                       GParamSpec                   *pspec);
-static void   thunar_sbr_replace_renamer_realize      (GtkWidget                    *widget);
-static gchar *thunar_sbr_replace_renamer_process      (ThunarxRenamer               *renamer,
-                                                       ThunarxFileInfo              *file,
-                                                       const gchar                  *text,
-                                                       guint                         idx);
+static void    thunar_sbr_replace_renamer_finalize      (GObject                      *object);
+static void    thunar_sbr_replace_renamer_get_property  (GObject                      *object,
+                                                         guint                         prop_id,
+                                                         GValue                       *value,
+                                                         GParamSpec                   *pspec);
+static void    thunar_sbr_replace_renamer_set_property  (GObject                      *object,
+                                                         guint                         prop_id,
+                                                         const GValue                 *value,
+                                                         GParamSpec                   *pspec);
+static void    thunar_sbr_replace_renamer_realize       (GtkWidget                    *widget);
+static gchar  *thunar_sbr_replace_renamer_process       (ThunarxRenamer               *renamer,
+                                                         ThunarxFileInfo              *file,
+                                                         const gchar                  *text,
+                                                         guint                         idx);
+static gchar **thunar_sbr_replace_renamer_process_batch (ThunarxRenamer               *renamer,
+                                                         ThunarxFileInfo             **files,
+                                                         const gchar                 **texts,
+                                                         const guint                  *indices,
+                                                         guint                         n_files);
 #ifdef HAVE_PCRE
-static gchar *thunar_sbr_replace_renamer_pcre_exec    (ThunarSbrReplaceRenamer      *replace_renamer,
-                                                       const gchar                  *text);
-static void   thunar_sbr_replace_renamer_pcre_update  (ThunarSbrReplaceRenamer      *replace_renamer);
+static gchar  *thunar_sbr_replace_renamer_pcre_exec     (ThunarSbrReplaceRenamer      *replace_renamer,
+                                                         const gchar                  *text);
+static void    thunar_sbr_replace_renamer_pcre_update   (ThunarSbrReplaceRenamer      *replace_renamer);
+static void    thunar_sbr_replace_renamer_pcre_release  (ThunarSbrReplaceRenamer      *replace_renamer);
 #endif
 
 
@@ -90,10 +108,15 @@ struct _ThunarSbrReplaceRenamer
   /* TRUE if PCRE is available and supports UTF-8 */
   gint           regexp_supported;
 
-  /* PCRE compiled pattern */
+  /* PCRE compiled pattern, its study data and the output
+   * vector, which is shared by all pcre_exec() calls.
+   */
 #ifdef HAVE_PCRE
   pcre          *pcre_pattern;
+  pcre_extra    *pcre_extra;
   gint           pcre_capture_count;
+  gint          *pcre_ovec;
+  gint           pcre_olen;
 #endif
 };
 
@@ -120,6 +143,7 @@ thunar_sbr_replace_renamer_class_init (ThunarSbrReplaceRenamerClass *klass)
 
   thunarxrenamer_class = THUNARX_RENAMER_CLASS (klass);
   thunarxrenamer_class->process = thunar_sbr_replace_renamer_process;
+  thunarxrenamer_class->process_batch = thunar_sbr_replace_renamer_process_batch;
 
   /**
    * ThunarSbrReplaceRenamer:case-sensitive:
@@ -265,8 +289,7 @@ thunar_sbr_replace_renamer_finalize (GObject *object)
 
   /* release the PCRE pattern (if any) */
 #ifdef HAVE_PCRE
-  if (G_UNLIKELY (replace_renamer->pcre_pattern != NULL))
-    pcre_free (replace_renamer->pcre_pattern);
+  thunar_sbr_replace_renamer_pcre_release (replace_renamer);
 #endif
 
   /* release the strings */
@@ -439,6 +462,52 @@ thunar_sbr_replace_renamer_process (ThunarxRenamer  *renamer,
 
 
 
+static gchar**
+thunar_sbr_replace_renamer_process_batch (ThunarxRenamer   *renamer,
+                                          ThunarxFileInfo **files,
+                                          const gchar     **texts,
+                                          const guint      *indices,
+                                          guint             n_files)
+{
+  ThunarSbrReplaceRenamer *replace_renamer = THUNAR_SBR_REPLACE_RENAMER (renamer);
+  gchar                  **names;
+  guint                    n;
+
+  names = g_new (gchar *, n_files + 1);
+  names[n_files] = NULL;
+
+  /* nothing to replace if we don't have a pattern */
+  if (G_UNLIKELY (replace_renamer->pattern == NULL || *replace_renamer->pattern == '\0'))
+    {
+      for (n = 0; n < n_files; ++n)
+        names[n] = g_strdup (texts[n]);
+      return names;
+    }
+
+#ifdef HAVE_PCRE
+  /* the compiled pattern and the output vector are shared by the whole batch */
+  if (G_UNLIKELY (replace_renamer->regexp))
+    {
+      for (n = 0; n < n_files; ++n)
+        {
+          if (G_UNLIKELY (replace_renamer->pcre_pattern == NULL))
+            names[n] = g_strdup (texts[n]);
+          else
+            names[n] = thunar_sbr_replace_renamer_pcre_exec (replace_renamer, texts[n]);
+        }
+      return names;
+    }
+#endif
+
+  /* perform the replace operations */
+  for (n = 0; n < n_files; ++n)
+    names[n] = tsrr_replace (texts[n], replace_renamer->pattern, replace_renamer->replacement, replace_renamer->case_sensitive);
+
+  return names;
+}
+
+
+
 #ifdef HAVE_PCRE
 static gchar*
 thunar_sbr_replace_renamer_pcre_exec (ThunarSbrReplaceRenamer *replace_renamer,
@@ -446,38 +515,36 @@ thunar_sbr_replace_renamer_pcre_exec (ThunarSbrReplaceRenamer *replace_renamer,
 {
   const gchar *r;
   GString     *result;
+  gsize        length;
   gint         second;
   gint         first;
   gint         idx;
   gint        *ovec;
-  gint         olen;
   gint         rc;
 
-  /* guess an initial ovec size */
-  olen = (replace_renamer->pcre_capture_count + 10) * 3;
-  ovec = g_new0 (gint, olen);
-
-  /* try to match the subject (increasing ovec on-demand) */
+  /* try to match the subject (increasing the shared ovec on-demand) */
+  length = strlen (subject);
   for (rc = 0; rc <= 0; )
     {
       /* try to exec, will return 0 if the ovec is too small */
-      rc = pcre_exec (replace_renamer->pcre_pattern, NULL, subject, strlen (subject), 0, PCRE_NOTEMPTY, ovec, olen);
+      rc = pcre_exec (replace_renamer->pcre_pattern, replace_renamer->pcre_extra, subject, length, 0,
+                      PCRE_NOTEMPTY, replace_renamer->pcre_ovec, replace_renamer->pcre_olen);
       if (G_UNLIKELY (rc < 0))
         {
           /* no match or error */
-          g_free (ovec);
           return g_strdup (subject);
         }
       else if (rc == 0)
         {
           /* ovec too small, try to increase */
-          olen += 18;
-          ovec = g_realloc (ovec, olen * sizeof (gint));
+          replace_renamer->pcre_olen += 18;
+          replace_renamer->pcre_ovec = g_renew (gint, replace_renamer->pcre_ovec, replace_renamer->pcre_olen);
         }
     }
 
   /* allocate a string for the result */
-  result = g_string_sized_new (32);
+  ovec = replace_renamer->pcre_ovec;
+  result = g_string_sized_new (length + strlen (replace_renamer->replacement) + 1);
 
   /* append the text before the match */
   g_string_append_len (result, subject, ovec[0]);
@@ -517,7 +584,7 @@ thunar_sbr_replace_renamer_pcre_exec (ThunarSbrReplaceRenamer *replace_renamer,
             {
               /* \' and $' is replaced with the text after the whole match */
               first = ovec[1];
-              second = strlen (subject) - 1;
+              second = length - 1;
             }
           else if (g_ascii_isdigit (r[0]))
             {
@@ -554,9 +621,6 @@ thunar_sbr_replace_renamer_pcre_exec (ThunarSbrReplaceRenamer *replace_renamer,
   /* append the text after the match */
   g_string_append (result, subject + ovec[1]);
 
-  /* release the output vector */
-  g_free (ovec);
-
   /* return the new name */
   return g_string_free (result, FALSE);
 }
@@ -567,6 +631,7 @@ static void
 thunar_sbr_replace_renamer_pcre_update (ThunarSbrReplaceRenamer *replace_renamer)
 {
   const gchar *error_message = NULL;
+  const gchar *study_error = NULL;
   GdkColor     back;
   GdkColor     text;
   gchar       *tooltip;
@@ -578,8 +643,7 @@ thunar_sbr_replace_renamer_pcre_update (ThunarSbrReplaceRenamer *replace_renamer
   if (G_UNLIKELY (replace_renamer->regexp))
     {
       /* release the previous pattern (if any) */
-      if (G_LIKELY (replace_renamer->pcre_pattern != NULL))
-        pcre_free (replace_renamer->pcre_pattern);
+      thunar_sbr_replace_renamer_pcre_release (replace_renamer);
 
       /* try to compile the new pattern */
       replace_renamer->pcre_pattern = pcre_compile (replace_renamer->pattern, (replace_renamer->case_sensitive ? 0 : PCRE_CASELESS) | PCRE_UTF8,
@@ -593,6 +657,18 @@ thunar_sbr_replace_renamer_pcre_update (ThunarSbrReplaceRenamer *replace_renamer
               pcre_free (replace_renamer->pcre_pattern);
               replace_renamer->pcre_pattern = NULL;
             }
+          else
+            {
+              /* study (and JIT compile if possible) the pattern once, as it is
+               * going to be executed for every file name; a failure is not
+               * fatal, the pattern is just slower then.
+               */
+              replace_renamer->pcre_extra = pcre_study (replace_renamer->pcre_pattern, TSRR_STUDY_OPTIONS, &study_error);
+
+              /* allocate an output vector large enough for all subpatterns */
+              replace_renamer->pcre_olen = (replace_renamer->pcre_capture_count + 1) * 3;
+              replace_renamer->pcre_ovec = g_new0 (gint, replace_renamer->pcre_olen);
+            }
         }
     }
 
@@ -642,6 +718,31 @@ thunar_sbr_replace_renamer_pcre_update (ThunarSbrReplaceRenamer *replace_renamer
       gtk_widget_set_tooltip_text (replace_renamer->pattern_entry, _("Enter the text to search for in the file names."));
     }
 }
+
+
+
+static void
+thunar_sbr_replace_renamer_pcre_release (ThunarSbrReplaceRenamer *replace_renamer)
+{
+  /* release the study data */
+  if (G_LIKELY (replace_renamer->pcre_extra != NULL))
+    {
+      tsrr_pcre_free_study (replace_renamer->pcre_extra);
+      replace_renamer->pcre_extra = NULL;
+    }
+
+  /* release the pattern */
+  if (G_LIKELY (replace_renamer->pcre_pattern != NULL))
+    {
+      pcre_free (replace_renamer->pcre_pattern);
+      replace_renamer->pcre_pattern = NULL;
+    }
+
+  /* release the output vector */
+  g_free (replace_renamer->pcre_ovec);
+  replace_renamer->pcre_ovec = NULL;
+  replace_renamer->pcre_olen = 0;
+}
 #endif
 
 
@@ -125,6 +125,10 @@ static gboolean           thunar_uca_model_load_from_file   (ThunarUcaModel
                                                              const gchar          *filename,
                                                              GError              **error);
 static void               thunar_uca_model_item_reset       (ThunarUcaModelItem   *item);
+static void               thunar_uca_model_item_compile     (ThunarUcaModelItem   *item);
+static gboolean           thunar_uca_model_item_match       (ThunarUcaModelItem   *item,
+                                                             const gchar          *name,
+                                                             const gchar          *extension);
 static void               thunar_uca_model_item_free        (gpointer              data);
 static void               start_element_handler             (GMarkupParseContext  *context,
                                                              const gchar          *element_name,
@@ -171,6 +175,14 @@ struct _ThunarUcaModelItem
 
   /* derived attributes */
   guint          multiple_selection : 1;
+
+  /* the patterns compiled for matching: "*" sets match_all,
+   * "*.ext" patterns end up in the extensions set and all
+   * other patterns are turned into pattern specs.
+   */
+  guint          match_all : 1;
+  GHashTable    *extensions;
+  GPatternSpec **pattern_specs;
 };
 
 typedef XFCE_GENERIC_STACK(ParserState) ParserStack;
@@ -608,8 +620,20 @@ thunar_uca_model_load_from_file (ThunarUcaModel *uca_model,
 static void
 thunar_uca_model_item_reset (ThunarUcaModelItem *item)
 {
+  guint n;
+
   /* release the previous values... */
   g_strfreev (item->patterns);
+
+  if (item->extensions != NULL)
+    g_hash_table_destroy (item->extensions);
+
+  if (item->pattern_specs != NULL)
+    {
+      for (n = 0; item->pattern_specs[n] != NULL; ++n)
+        g_pattern_spec_free (item->pattern_specs[n]);
+      g_free (item->pattern_specs);
+    }
   g_free (item->description);
   g_free (item->command);
   g_free (item->name);
@@ -625,6 +649,67 @@ thunar_uca_model_item_reset (ThunarUcaModelItem *item)
 
 
 
+static void
+thunar_uca_model_item_compile (ThunarUcaModelItem *item)
+{
+  const gchar *pattern;
+  guint        n_specs = 0;
+  guint        n;
+
+  item->pattern_specs = g_new0 (GPatternSpec *, g_strv_length (item->patterns) + 1);
+
+  for (n = 0; item->patterns[n] != NULL; ++n)
+    {
+      pattern = item->patterns[n];
+
+      if (strcmp (pattern, "*") == 0)
+        {
+          /* matches every file name */
+          item->match_all = TRUE;
+        }
+      else if (pattern[0] == '*' && pattern[1] == '.' && pattern[2] != '\0'
+               && strpbrk (pattern + 2, "*?.") == NULL)
+        {
+          /* "*.ext" matches exactly the names whose last extension is ".ext" */
+          if (item->extensions == NULL)
+            item->extensions = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+          g_hash_table_insert (item->extensions, g_strdup (pattern + 1), GUINT_TO_POINTER (TRUE));
+        }
+      else
+        {
+          /* everything else needs the glob matcher */
+          item->pattern_specs[n_specs++] = g_pattern_spec_new (pattern);
+        }
+    }
+}
+
+
+
+static gboolean
+thunar_uca_model_item_match (ThunarUcaModelItem *item,
+                             const gchar        *name,
+                             const gchar        *extension)
+{
+  guint n;
+
+  if (item->match_all)
+    return TRUE;
+
+  if (extension != NULL && item->extensions != NULL
+      && g_hash_table_lookup (item->extensions, extension) != NULL)
+    return TRUE;
+
+  /* the pattern specs need the full file name */
+  if (name != NULL && item->pattern_specs != NULL)
+    for (n = 0; item->pattern_specs[n] != NULL; ++n)
+      if (g_pattern_match_string (item->pattern_specs[n], name))
+        return TRUE;
+
+  return FALSE;
+}
+
+
+
 static void
 thunar_uca_model_item_free (gpointer data)
 {
@@ -1075,18 +1160,22 @@ thunar_uca_model_match (ThunarUcaModel *uca_model,
   typedef struct
   {
     gchar          *name;
+    const gchar    *extension;
     ThunarUcaTypes  types;
   } ThunarUcaFile;
 
   ThunarUcaModelItem *item;
+  ThunarUcaFile      *classes;
   ThunarUcaFile      *files;
+  GHashTable         *class_table;
   GFile              *location;
   gchar              *mime_type;
-  gboolean            matches;
+  gchar              *key;
   GList              *paths = NULL;
   GList              *lp;
+  gint                n_classes = 0;
   gint                n_files;
-  gint                i, m, n;
+  gint                i, n;
 
   g_return_val_if_fail (THUNAR_UCA_IS_MODEL (uca_model), NULL);
   g_return_val_if_fail (file_infos != NULL, NULL);
@@ -1095,9 +1184,15 @@ thunar_uca_model_match (ThunarUcaModel *uca_model,
   if (G_UNLIKELY (uca_model->items == NULL))
     return NULL;
 
-  /* determine the ThunarUcaFile's for the given file_infos */
+  /* determine the ThunarUcaFile's for the given file_infos, and
+   * group them into classes of files with the same types and
+   * extension, which is all that "*" and "*.ext" patterns
+   * need to know about a file.
+   */
   n_files = g_list_length (file_infos);
   files = g_new (ThunarUcaFile, n_files);
+  classes = g_new (ThunarUcaFile, n_files);
+  class_table = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
   for (lp = file_infos, n = 0; lp != NULL; lp = lp->next, ++n)
     {
       location = thunarx_file_info_get_location (lp->data);
@@ -1106,6 +1201,10 @@ thunar_uca_model_match (ThunarUcaModel *uca_model,
         {
           /* cannot handle non-local files */
           g_object_unref (location);
+          while (n-- > 0)
+            g_free (files[n].name);
+          g_hash_table_destroy (class_table);
+          g_free (classes);
           g_free (files);
           return NULL;
         }
@@ -1115,13 +1214,29 @@ thunar_uca_model_match (ThunarUcaModel *uca_model,
       mime_type = thunarx_file_info_get_mime_type (lp->data);
 
       files[n].name = thunarx_file_info_get_name (lp->data);
+      files[n].extension = strrchr (files[n].name, '.');
       files[n].types = types_from_mime_type (mime_type);
 
       if (G_UNLIKELY (files[n].types == 0))
         files[n].types = THUNAR_UCA_TYPE_OTHER_FILES;
 
       g_free (mime_type);
+
+      /* add a new class if this is the first file of its kind */
+      key = g_strdup_printf ("%u:%s", files[n].types, (files[n].extension != NULL) ? files[n].extension : "");
+      if (g_hash_table_lookup (class_table, key) == NULL)
+        {
+          classes[n_classes].name = NULL;
+          classes[n_classes].extension = files[n].extension;
+          classes[n_classes].types = files[n].types;
+          g_hash_table_insert (class_table, key, GINT_TO_POINTER (++n_classes));
+        }
+      else
+        {
+          g_free (key);
+        }
     }
+  g_hash_table_destroy (class_table);
 
   /* lookup the matching items */
   for (i = 0, lp = uca_model->items; lp != NULL; ++i, lp = lp->next)
@@ -1131,30 +1246,36 @@ thunar_uca_model_match (ThunarUcaModel *uca_model,
       if (!item->multiple_selection && n_files > 1)
         continue;
 
-      /* match the specified files */
-      for (n = 0; n < n_files; ++n)
+      if (item->pattern_specs == NULL || item->pattern_specs[0] == NULL)
         {
-          /* verify that we support this type of file */
-          if ((files[n].types & item->types) == 0)
-            break;
-
-          /* atleast on pattern must match the file name */
-          for (m = 0, matches = FALSE; item->patterns[m] != NULL && !matches; ++m)
-            matches = g_pattern_match_simple (item->patterns[m], files[n].name);
+          /* only the types and extensions matter, so match every class once */
+          for (n = 0; n < n_classes; ++n)
+            if ((classes[n].types & item->types) == 0
+                || !thunar_uca_model_item_match (item, NULL, classes[n].extension))
+              break;
 
-          /* no need to continue if none of the patterns match */
-          if (!matches)
-            break;
+          /* add the path if all classes match */
+          if (G_UNLIKELY (n == n_classes))
+            paths = g_list_append (paths, gtk_tree_path_new_from_indices (i, -1));
         }
+      else
+        {
+          /* match the specified files */
+          for (n = 0; n < n_files; ++n)
+            if ((files[n].types & item->types) == 0
+                || !thunar_uca_model_item_match (item, files[n].name, files[n].extension))
+              break;
 
-      /* add the path if all files match one of the patterns */
-      if (G_UNLIKELY (n == n_files))
-        paths = g_list_append (paths, gtk_tree_path_new_from_indices (i, -1));
+          /* add the path if all files match one of the patterns */
+          if (G_UNLIKELY (n == n_files))
+            paths = g_list_append (paths, gtk_tree_path_new_from_indices (i, -1));
+        }
     }
 
   /* cleanup */
   for (n = 0; n < n_files; ++n)
     g_free (files[n].name);
+  g_free (classes);
   g_free (files);
 
   return paths;
@@ -1349,6 +1470,9 @@ thunar_uca_model_update (ThunarUcaModel *uca_model,
     }
   item->patterns[n] = NULL;
 
+  /* compile the patterns once for matching */
+  thunar_uca_model_item_compile (item);
+
   /* check if this item will work for multiple files */
   item->multiple_selection = (command != NULL && (strstr (command, "%F") != NULL
                                                || strstr (command, "%D") != NULL
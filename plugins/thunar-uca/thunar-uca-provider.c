@@ -47,6 +47,8 @@ static GList *thunar_uca_provider_get_file_actions          (ThunarxMenuProvider
 static GList *thunar_uca_provider_get_folder_actions        (ThunarxMenuProvider              *menu_provider,
                                                              GtkWidget                        *window,
                                                              ThunarxFileInfo                  *folder);
+static guint  thunar_uca_provider_get_cache_stamp           (ThunarxMenuProvider              *menu_provider);
+static void   thunar_uca_provider_model_changed             (ThunarUcaProvider                *uca_provider);
 static void   thunar_uca_provider_activated                 (ThunarUcaProvider                *uca_provider,
                                                              GtkAction                        *action);
 static void   thunar_uca_provider_child_watch               (ThunarUcaProvider                *uca_provider,
@@ -68,6 +70,11 @@ struct _ThunarUcaProvider
   ThunarUcaModel *model;
   gint            last_action_id; /* used to generate unique action names */
 
+  /* bumped whenever the model changes, so the file
+   * manager knows when to drop its cached actions.
+   */
+  guint           cache_stamp;
+
   /* child watch support for the last spawned child process
    * to be able to refresh the folder contents after the
    * child process has terminated.
@@ -115,6 +122,7 @@ thunar_uca_provider_menu_provider_init (ThunarxMenuProviderIface *iface)
 {
   iface->get_file_actions = thunar_uca_provider_get_file_actions;
   iface->get_folder_actions = thunar_uca_provider_get_folder_actions;
+  iface->get_cache_stamp = thunar_uca_provider_get_cache_stamp;
 }
 
 
@@ -135,6 +143,17 @@ thunar_uca_provider_init (ThunarUcaProvider *uca_provider)
 
   /* grab a reference on the default model */
   uca_provider->model = thunar_uca_model_get_default ();
+
+  /* invalidate the cached actions whenever the model changes */
+  uca_provider->cache_stamp = 1;
+  g_signal_connect_swapped (G_OBJECT (uca_provider->model), "row-changed",
+                            G_CALLBACK (thunar_uca_provider_model_changed), uca_provider);
+  g_signal_connect_swapped (G_OBJECT (uca_provider->model), "row-inserted",
+                            G_CALLBACK (thunar_uca_provider_model_changed), uca_provider);
+  g_signal_connect_swapped (G_OBJECT (uca_provider->model), "row-deleted",
+                            G_CALLBACK (thunar_uca_provider_model_changed), uca_provider);
+  g_signal_connect_swapped (G_OBJECT (uca_provider->model), "rows-reordered",
+                            G_CALLBACK (thunar_uca_provider_model_changed), uca_provider);
 }
 
 
@@ -148,6 +167,7 @@ thunar_uca_provider_finalize (GObject *object)
   thunar_uca_provider_child_watch_destroy (uca_provider, NULL);
 
   /* drop our reference on the model */
+  g_signal_handlers_disconnect_by_func (G_OBJECT (uca_provider->model), thunar_uca_provider_model_changed, uca_provider);
   g_object_unref (G_OBJECT (uca_provider->model));
 
   (*G_OBJECT_CLASS (thunar_uca_provider_parent_class)->finalize) (object);
@@ -294,6 +314,24 @@ thunar_uca_provider_get_folder_actions (ThunarxMenuProvider *menu_provider,
 
 
 
+static guint
+thunar_uca_provider_get_cache_stamp (ThunarxMenuProvider *menu_provider)
+{
+  return THUNAR_UCA_PROVIDER (menu_provider)->cache_stamp;
+}
+
+
+
+static void
+thunar_uca_provider_model_changed (ThunarUcaProvider *uca_provider)
+{
+  /* zero means "not cacheable", so skip it on wrap around */
+  if (G_UNLIKELY (++uca_provider->cache_stamp == 0))
+    uca_provider->cache_stamp = 1;
+}
+
+
+
 static void
 thunar_uca_provider_activated (ThunarUcaProvider *uca_provider,
                                GtkAction         *action)
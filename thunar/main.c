@@ -41,6 +41,7 @@
 #include <thunar/thunar-notify.h>
 #include <thunar/thunar-session-client.h>
 #include <thunar/thunar-stock.h>
+#include <thunar/thunar-util.h>
 #include <thunar/thunar-preferences.h>
 
 
@@ -51,6 +52,9 @@ main (int argc, char **argv)
   ThunarApplication   *application;
   GError              *error = NULL;
 
+  /* start the startup profile (if enabled) */
+  thunar_util_profile_mark ("main");
+
   /* setup translation domain */
   xfce_textdomain (GETTEXT_PACKAGE, PACKAGE_LOCALE_DIR, "UTF-8");
 
@@ -74,6 +78,8 @@ main (int argc, char **argv)
       thunar_preferences_xfconf_init_failed ();
     }
 
+  thunar_util_profile_mark ("xfconf");
+
 #ifdef HAVE_GIO_UNIX
 #if !GLIB_CHECK_VERSION (2, 42, 0)
   /* set desktop environment for app infos */
@@ -87,6 +93,8 @@ main (int argc, char **argv)
   /* initialize the thunar stock items/icons */
   thunar_stock_init ();
 
+  thunar_util_profile_mark ("stock icons");
+
   /* acquire a reference on the global application */
   application = thunar_application_get ();
 
@@ -0,0 +1,354 @@
+/* vi:set et ai sw=2 sts=2 ts=2: */
+/*-
+ * Copyright (c) 2015 Xfce Development Team <xfce4-dev@xfce.org>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the Free
+ * Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#ifdef HAVE_SYS_TYPES_H
+#include <sys/types.h>
+#endif
+#ifdef HAVE_SYS_STAT_H
+#include <sys/stat.h>
+#endif
+
+#ifdef HAVE_ERRNO_H
+#include <errno.h>
+#endif
+#ifdef HAVE_FCNTL_H
+#include <fcntl.h>
+#endif
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+
+#include <glib/gstdio.h>
+
+#include <thunar/thunar-gio-extensions.h>
+#include <thunar/thunar-io-walk.h>
+
+
+
+/* more top-level directories than the walk queues before it
+ * starts to descend inline, each with a chain of subdirectories */
+#define TREE_WIDTH (200)
+#define TREE_DEPTH (6)
+#define TREE_FILES (3)
+
+
+
+typedef struct
+{
+  gchar *path;
+  gint   parent;
+} TestEntry;
+
+typedef struct
+{
+  GFile            *root;
+  ThunarIoWalkFlags flags;
+  ThunarIoWalkFunc  func;
+  GList            *remaining;
+  GList            *directories;
+} TestWalk;
+
+typedef struct
+{
+  GMutex      lock;
+  GHashTable *visits;
+  guint       n_visits;
+  guint       n_duplicates;
+} TestVisits;
+
+
+
+/* minimal job type, thunar_io_walk() only needs the ExoJob behind it */
+typedef struct _ThunarJobClass TestJobClass;
+typedef struct _ThunarJob      TestJob;
+
+G_DEFINE_TYPE (TestJob, thunar_job, EXO_TYPE_JOB)
+
+
+
+static TestWalk   test_walk;
+static TestVisits test_visits;
+
+
+
+static gboolean
+test_job_run (ExoJob  *job,
+              GError **error)
+{
+  GList file_list = { test_walk.root, NULL, NULL };
+
+  test_walk.remaining = thunar_io_walk (THUNAR_JOB (job), &file_list, test_walk.flags,
+                                        test_walk.func, &test_visits,
+                                        &test_walk.directories);
+
+  return TRUE;
+}
+
+
+
+static void
+thunar_job_class_init (TestJobClass *klass)
+{
+  EXO_JOB_CLASS (klass)->run = test_job_run;
+}
+
+
+
+static void
+thunar_job_init (TestJob *job)
+{
+}
+
+
+
+gboolean
+thunar_g_file_is_root (GFile *file)
+{
+  GFile *parent;
+
+  parent = g_file_get_parent (file);
+  if (parent == NULL)
+    return TRUE;
+
+  g_object_unref (parent);
+  return FALSE;
+}
+
+
+
+static gint
+test_walk_count (gint               dir_fd,
+                 const gchar       *name,
+                 const struct stat *statbuf,
+                 gboolean           is_directory,
+                 gpointer           user_data)
+{
+  TestVisits *visits = user_data;
+  gpointer    key;
+
+  g_assert (statbuf != NULL);
+  g_assert (is_directory == S_ISDIR (statbuf->st_mode));
+
+  key = GSIZE_TO_POINTER ((gsize) statbuf->st_ino);
+
+  g_mutex_lock (&visits->lock);
+  if (g_hash_table_lookup_extended (visits->visits, key, NULL, NULL))
+    visits->n_duplicates += 1;
+  else
+    g_hash_table_insert (visits->visits, key, GUINT_TO_POINTER (visits->n_visits));
+  visits->n_visits += 1;
+  g_mutex_unlock (&visits->lock);
+
+  return 0;
+}
+
+
+
+static gint
+test_walk_unlink (gint               dir_fd,
+                  const gchar       *name,
+                  const struct stat *statbuf,
+                  gboolean           is_directory,
+                  gpointer           user_data)
+{
+  if (unlinkat (dir_fd, name, is_directory ? AT_REMOVEDIR : 0) < 0)
+    return errno;
+
+  return 0;
+}
+
+
+
+static void
+test_walk_run (ThunarIoWalkFlags flags,
+               ThunarIoWalkFunc  func)
+{
+  GMainLoop *loop;
+  ExoJob    *job;
+
+  test_walk.flags = flags;
+  test_walk.func = func;
+  test_walk.remaining = NULL;
+  test_walk.directories = NULL;
+
+  loop = g_main_loop_new (NULL, FALSE);
+  job = g_object_new (THUNAR_TYPE_JOB, NULL);
+  g_signal_connect_swapped (job, "finished", G_CALLBACK (g_main_loop_quit), loop);
+  exo_job_launch (job);
+  g_main_loop_run (loop);
+
+  g_object_unref (job);
+  g_main_loop_unref (loop);
+}
+
+
+
+static void
+test_tree_add (GArray      *entries,
+               gint         parent,
+               const gchar *path,
+               gboolean     is_directory)
+{
+  TestEntry entry;
+
+  if (is_directory)
+    g_assert_cmpint (g_mkdir (path, 0755), ==, 0);
+  else
+    g_assert (g_file_set_contents (path, "", 0, NULL));
+
+  entry.path = g_strdup (path);
+  entry.parent = parent;
+  g_array_append_val (entries, entry);
+}
+
+
+
+static GArray *
+test_tree_create (const gchar *root_path)
+{
+  TestEntry root;
+  GArray   *entries;
+  gchar    *path;
+  gchar    *name;
+  gint      parent;
+  gint      i, j, k;
+
+  entries = g_array_new (FALSE, FALSE, sizeof (TestEntry));
+
+  /* the root directory is created by the caller */
+  root.path = g_strdup (root_path);
+  root.parent = -1;
+  g_array_append_val (entries, root);
+
+  for (i = 0; i < TREE_WIDTH; ++i)
+    {
+      parent = 0;
+      for (j = 0; j < TREE_DEPTH; ++j)
+        {
+          name = g_strdup_printf ("d%d", j == 0 ? i : j);
+          path = g_build_filename (g_array_index (entries, TestEntry, parent).path, name, NULL);
+          test_tree_add (entries, parent, path, TRUE);
+          parent = entries->len - 1;
+          g_free (path);
+          g_free (name);
+
+          for (k = 0; k < TREE_FILES; ++k)
+            {
+              name = g_strdup_printf ("f%d", k);
+              path = g_build_filename (g_array_index (entries, TestEntry, parent).path, name, NULL);
+              test_tree_add (entries, parent, path, FALSE);
+              g_free (path);
+              g_free (name);
+            }
+        }
+    }
+
+  return entries;
+}
+
+
+
+static void
+test_io_walk_visits_once (void)
+{
+  struct stat statbuf;
+  TestEntry  *entry;
+  GArray     *entries;
+  gpointer    order;
+  gpointer    parent_order;
+  gchar      *root_path;
+  guint       n;
+
+  root_path = g_dir_make_tmp ("thunar-io-walk-XXXXXX", NULL);
+  g_assert (root_path != NULL);
+  entries = test_tree_create (root_path);
+
+  test_walk.root = g_file_new_for_path (root_path);
+
+  /* count the visits of every inode */
+  g_mutex_init (&test_visits.lock);
+  test_visits.visits = g_hash_table_new (g_direct_hash, g_direct_equal);
+  test_visits.n_visits = 0;
+  test_visits.n_duplicates = 0;
+
+  test_walk_run (THUNAR_IO_WALK_STAT, test_walk_count);
+
+  g_assert (test_walk.remaining == NULL);
+  g_assert (test_walk.directories != NULL && test_walk.directories->data == test_walk.root);
+  thunar_g_file_list_free (test_walk.directories);
+
+  /* every entry exactly once, and every directory after its contents */
+  g_assert_cmpuint (test_visits.n_duplicates, ==, 0);
+  g_assert_cmpuint (test_visits.n_visits, ==, entries->len);
+  for (n = 0; n < entries->len; ++n)
+    {
+      entry = &g_array_index (entries, TestEntry, n);
+      g_assert_cmpint (lstat (entry->path, &statbuf), ==, 0);
+      g_assert (g_hash_table_lookup_extended (test_visits.visits,
+                                              GSIZE_TO_POINTER ((gsize) statbuf.st_ino),
+                                              NULL, &order));
+
+      if (entry->parent < 0)
+        continue;
+
+      g_assert_cmpint (lstat (g_array_index (entries, TestEntry, entry->parent).path, &statbuf), ==, 0);
+      g_assert (g_hash_table_lookup_extended (test_visits.visits,
+                                              GSIZE_TO_POINTER ((gsize) statbuf.st_ino),
+                                              NULL, &parent_order));
+      g_assert_cmpuint (GPOINTER_TO_UINT (order), <, GPOINTER_TO_UINT (parent_order));
+    }
+
+  g_hash_table_destroy (test_visits.visits);
+  g_mutex_clear (&test_visits.lock);
+
+  /* removing the tree only works in post-order as well */
+  test_walk_run (THUNAR_IO_WALK_NONE, test_walk_unlink);
+
+  g_assert (test_walk.remaining == NULL);
+  thunar_g_file_list_free (test_walk.directories);
+  g_assert (!g_file_test (root_path, G_FILE_TEST_EXISTS));
+
+  for (n = 0; n < entries->len; ++n)
+    g_free (g_array_index (entries, TestEntry, n).path);
+  g_array_free (entries, TRUE);
+  g_object_unref (test_walk.root);
+  g_free (root_path);
+}
+
+
+
+int
+main (int    argc,
+      char **argv)
+{
+#if !GLIB_CHECK_VERSION (2, 36, 0)
+  g_type_init ();
+#endif
+
+  g_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/thunar/io-walk/visits-once", test_io_walk_visits_once);
+
+  return g_test_run ();
+}
@@ -0,0 +1,428 @@
+/* vi:set et ai sw=2 sts=2 ts=2: */
+/*-
+ * Copyright (c) 2015 Xfce Development Team <xfce4-dev@xfce.org>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the Free
+ * Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* The application info cache remembers which applications handle a
+ * content type, so the "Open With" menus and the chooser dialogs do
+ * not make GIO re-read the mimeapps.list and desktop file state every
+ * time they are shown. Everything is dropped when the application
+ * database changes, which GIO tells us through the GAppInfoMonitor.
+ * Older versions of GIO have no monitor, in that case the entries
+ * simply expire after a few seconds. */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <gio/gio.h>
+
+#include <thunar/thunar-app-info-cache.h>
+#include <thunar/thunar-private.h>
+
+
+
+/* lifetime of the cached entries if GIO cannot tell us about changes */
+#define EXPIRE_TIME (5 * G_USEC_PER_SEC)
+
+
+
+/* Signal identifiers */
+enum
+{
+  CHANGED,
+  LAST_SIGNAL,
+};
+
+
+
+typedef struct _ThunarAppInfoCacheEntry ThunarAppInfoCacheEntry;
+
+
+
+static void                     thunar_app_info_cache_finalize      (GObject            *object);
+static void                     thunar_app_info_cache_changed       (ThunarAppInfoCache *cache);
+static ThunarAppInfoCacheEntry *thunar_app_info_cache_lookup        (ThunarAppInfoCache *cache,
+                                                                     const gchar        *content_type);
+static GList                   *thunar_app_info_cache_copy_list     (GList              *list);
+static void                     thunar_app_info_cache_entry_free    (gpointer            data);
+
+
+
+struct _ThunarAppInfoCacheClass
+{
+  GObjectClass __parent__;
+};
+
+struct _ThunarAppInfoCache
+{
+  GObject          __parent__;
+
+#if GLIB_CHECK_VERSION (2, 40, 0)
+  GAppInfoMonitor *monitor;
+#else
+  /* when the entries were filled */
+  gint64           timestamp;
+#endif
+
+  /* content type -> ThunarAppInfoCacheEntry */
+  GHashTable      *entries;
+
+  /* all installed applications */
+  GList           *all;
+  gboolean         has_all;
+};
+
+struct _ThunarAppInfoCacheEntry
+{
+  GList    *all;
+  GAppInfo *defaults[2]; /* indexed by must_support_uris */
+
+  guint     has_all : 1;
+  guint     has_defaults : 2; /* bit mask of the valid defaults */
+};
+
+
+
+static guint app_info_cache_signals[LAST_SIGNAL];
+
+
+
+/* the cache is used from the job threads as well */
+G_LOCK_DEFINE_STATIC (app_info_cache_mutex);
+
+
+
+G_DEFINE_TYPE (ThunarAppInfoCache, thunar_app_info_cache, G_TYPE_OBJECT)
+
+
+
+static void
+thunar_app_info_cache_class_init (ThunarAppInfoCacheClass *klass)
+{
+  GObjectClass *gobject_class;
+
+  gobject_class = G_OBJECT_CLASS (klass);
+  gobject_class->finalize = thunar_app_info_cache_finalize;
+
+  /**
+   * ThunarAppInfoCache::changed:
+   * @cache : a #ThunarAppInfoCache.
+   *
+   * Emitted whenever the installed applications or their
+   * associations with content types changed.
+   **/
+  app_info_cache_signals[CHANGED] =
+    g_signal_new (I_("changed"),
+                  G_TYPE_FROM_CLASS (klass),
+                  G_SIGNAL_NO_HOOKS,
+                  0, NULL, NULL,
+                  g_cclosure_marshal_VOID__VOID,
+                  G_TYPE_NONE, 0);
+}
+
+
+
+static void
+thunar_app_info_cache_init (ThunarAppInfoCache *cache)
+{
+  cache->entries = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+                                          thunar_app_info_cache_entry_free);
+
+#if GLIB_CHECK_VERSION (2, 40, 0)
+  /* drop everything when the application database changes */
+  cache->monitor = g_app_info_monitor_get ();
+  g_signal_connect_swapped (cache->monitor, "changed", G_CALLBACK (thunar_app_info_cache_changed), cache);
+#endif
+}
+
+
+
+static void
+thunar_app_info_cache_finalize (GObject *object)
+{
+  ThunarAppInfoCache *cache = THUNAR_APP_INFO_CACHE (object);
+
+#if GLIB_CHECK_VERSION (2, 40, 0)
+  /* disconnect from the monitor */
+  g_signal_handlers_disconnect_by_func (cache->monitor, thunar_app_info_cache_changed, cache);
+  g_object_unref (cache->monitor);
+#endif
+
+  /* release the entries */
+  g_hash_table_destroy (cache->entries);
+  g_list_free_full (cache->all, g_object_unref);
+
+  (*G_OBJECT_CLASS (thunar_app_info_cache_parent_class)->finalize) (object);
+}
+
+
+
+static void
+thunar_app_info_cache_changed (ThunarAppInfoCache *cache)
+{
+  _thunar_return_if_fail (THUNAR_IS_APP_INFO_CACHE (cache));
+
+  G_LOCK (app_info_cache_mutex);
+
+  /* forget everything, the lists are reloaded on demand */
+  g_hash_table_remove_all (cache->entries);
+  g_list_free_full (cache->all, g_object_unref);
+  cache->all = NULL;
+  cache->has_all = FALSE;
+
+  G_UNLOCK (app_info_cache_mutex);
+
+  /* tell everybody that the applications changed */
+  g_signal_emit (G_OBJECT (cache), app_info_cache_signals[CHANGED], 0);
+}
+
+
+
+/* must be called with the cache lock held */
+static ThunarAppInfoCacheEntry *
+thunar_app_info_cache_lookup (ThunarAppInfoCache *cache,
+                              const gchar        *content_type)
+{
+  ThunarAppInfoCacheEntry *entry;
+#if !GLIB_CHECK_VERSION (2, 40, 0)
+  gint64                   now;
+
+  /* expire the entries every now and then */
+  now = g_get_monotonic_time ();
+  if (now - cache->timestamp > EXPIRE_TIME)
+    {
+      g_hash_table_remove_all (cache->entries);
+      g_list_free_full (cache->all, g_object_unref);
+      cache->all = NULL;
+      cache->has_all = FALSE;
+      cache->timestamp = now;
+    }
+#endif
+
+  if (content_type == NULL)
+    return NULL;
+
+  entry = g_hash_table_lookup (cache->entries, content_type);
+  if (G_UNLIKELY (entry == NULL))
+    {
+      entry = g_slice_new0 (ThunarAppInfoCacheEntry);
+      g_hash_table_insert (cache->entries, g_strdup (content_type), entry);
+    }
+
+  return entry;
+}
+
+
+
+static GList *
+thunar_app_info_cache_copy_list (GList *list)
+{
+  GList *copy;
+  GList *lp;
+
+  copy = g_list_copy (list);
+  for (lp = copy; lp != NULL; lp = lp->next)
+    g_object_ref (lp->data);
+
+  return copy;
+}
+
+
+
+static void
+thunar_app_info_cache_entry_free (gpointer data)
+{
+  ThunarAppInfoCacheEntry *entry = data;
+
+  g_list_free_full (entry->all, g_object_unref);
+  if (entry->defaults[0] != NULL)
+    g_object_unref (entry->defaults[0]);
+  if (entry->defaults[1] != NULL)
+    g_object_unref (entry->defaults[1]);
+
+  g_slice_free (ThunarAppInfoCacheEntry, entry);
+}
+
+
+
+/**
+ * thunar_app_info_cache_get:
+ *
+ * Returns a reference to the shared #ThunarAppInfoCache. The
+ * caller is responsible to free the returned object using
+ * g_object_unref() when no longer needed.
+ *
+ * Return value: the shared #ThunarAppInfoCache.
+ **/
+ThunarAppInfoCache *
+thunar_app_info_cache_get (void)
+{
+  static ThunarAppInfoCache *cache = NULL;
+
+  if (G_UNLIKELY (cache == NULL))
+    {
+      cache = g_object_new (THUNAR_TYPE_APP_INFO_CACHE, NULL);
+      g_object_add_weak_pointer (G_OBJECT (cache), (gpointer) &cache);
+    }
+  else
+    {
+      g_object_ref (G_OBJECT (cache));
+    }
+
+  return cache;
+}
+
+
+
+/**
+ * thunar_app_info_cache_get_all:
+ * @cache : a #ThunarAppInfoCache.
+ *
+ * Cached version of g_app_info_get_all().
+ *
+ * The caller is responsible to free the returned list using
+ * g_list_free_full (list, g_object_unref).
+ *
+ * Return value: the list of all installed #GAppInfo<!---->s.
+ **/
+GList *
+thunar_app_info_cache_get_all (ThunarAppInfoCache *cache)
+{
+  GList *list;
+
+  _thunar_return_val_if_fail (THUNAR_IS_APP_INFO_CACHE (cache), NULL);
+
+  G_LOCK (app_info_cache_mutex);
+
+  /* check for expired entries */
+  thunar_app_info_cache_lookup (cache, NULL);
+
+  if (!cache->has_all)
+    {
+      cache->all = g_app_info_get_all ();
+      cache->has_all = TRUE;
+    }
+  list = thunar_app_info_cache_copy_list (cache->all);
+
+  G_UNLOCK (app_info_cache_mutex);
+
+  return list;
+}
+
+
+
+/**
+ * thunar_app_info_cache_get_all_for_type:
+ * @cache        : a #ThunarAppInfoCache.
+ * @content_type : a content type.
+ *
+ * Cached version of g_app_info_get_all_for_type().
+ *
+ * The caller is responsible to free the returned list using
+ * g_list_free_full (list, g_object_unref).
+ *
+ * Return value: the list of #GAppInfo<!---->s for @content_type.
+ **/
+GList *
+thunar_app_info_cache_get_all_for_type (ThunarAppInfoCache *cache,
+                                        const gchar        *content_type)
+{
+  ThunarAppInfoCacheEntry *entry;
+  GList                   *list;
+
+  _thunar_return_val_if_fail (THUNAR_IS_APP_INFO_CACHE (cache), NULL);
+  _thunar_return_val_if_fail (content_type != NULL, NULL);
+
+  G_LOCK (app_info_cache_mutex);
+
+  entry = thunar_app_info_cache_lookup (cache, content_type);
+  if (!entry->has_all)
+    {
+      entry->all = g_app_info_get_all_for_type (content_type);
+      entry->has_all = TRUE;
+    }
+  list = thunar_app_info_cache_copy_list (entry->all);
+
+  G_UNLOCK (app_info_cache_mutex);
+
+  return list;
+}
+
+
+
+/**
+ * thunar_app_info_cache_get_default_for_type:
+ * @cache             : a #ThunarAppInfoCache.
+ * @content_type      : a content type.
+ * @must_support_uris : whether the application must support URIs.
+ *
+ * Cached version of g_app_info_get_default_for_type().
+ *
+ * The caller is responsible to free the returned object using
+ * g_object_unref() when no longer needed.
+ *
+ * Return value: the default #GAppInfo for @content_type or %NULL.
+ **/
+GAppInfo *
+thunar_app_info_cache_get_default_for_type (ThunarAppInfoCache *cache,
+                                            const gchar        *content_type,
+                                            gboolean            must_support_uris)
+{
+  ThunarAppInfoCacheEntry *entry;
+  GAppInfo                *app_info;
+  guint                    n = must_support_uris ? 1 : 0;
+
+  _thunar_return_val_if_fail (THUNAR_IS_APP_INFO_CACHE (cache), NULL);
+  _thunar_return_val_if_fail (content_type != NULL, NULL);
+
+  G_LOCK (app_info_cache_mutex);
+
+  entry = thunar_app_info_cache_lookup (cache, content_type);
+  if ((entry->has_defaults & (1 << n)) == 0)
+    {
+      entry->defaults[n] = g_app_info_get_default_for_type (content_type, must_support_uris);
+      entry->has_defaults |= (1 << n);
+    }
+
+  app_info = entry->defaults[n];
+  if (app_info != NULL)
+    g_object_ref (app_info);
+
+  G_UNLOCK (app_info_cache_mutex);
+
+  return app_info;
+}
+
+
+
+/**
+ * thunar_app_info_cache_invalidate:
+ * @cache : a #ThunarAppInfoCache.
+ *
+ * Drops all cached entries of @cache and emits ::changed. This
+ * should be called after changing the associations of a content
+ * type, as the #GAppInfoMonitor only notices that later.
+ **/
+void
+thunar_app_info_cache_invalidate (ThunarAppInfoCache *cache)
+{
+  _thunar_return_if_fail (THUNAR_IS_APP_INFO_CACHE (cache));
+
+  thunar_app_info_cache_changed (cache);
+}
@@ -0,0 +1,53 @@
+/* vi:set et ai sw=2 sts=2 ts=2: */
+/*-
+ * Copyright (c) 2015 Xfce Development Team <xfce4-dev@xfce.org>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the Free
+ * Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __THUNAR_APP_INFO_CACHE_H__
+#define __THUNAR_APP_INFO_CACHE_H__
+
+#include <gio/gio.h>
+
+G_BEGIN_DECLS;
+
+typedef struct _ThunarAppInfoCacheClass ThunarAppInfoCacheClass;
+typedef struct _ThunarAppInfoCache      ThunarAppInfoCache;
+
+#define THUNAR_TYPE_APP_INFO_CACHE            (thunar_app_info_cache_get_type ())
+#define THUNAR_APP_INFO_CACHE(obj)            (G_TYPE_CHECK_INSTANCE_CAST ((obj), THUNAR_TYPE_APP_INFO_CACHE, ThunarAppInfoCache))
+#define THUNAR_APP_INFO_CACHE_CLASS(klass)    (G_TYPE_CHECK_CLASS_CAST ((klass), THUNAR_TYPE_APP_INFO_CACHE, ThunarAppInfoCacheClass))
+#define THUNAR_IS_APP_INFO_CACHE(obj)         (G_TYPE_CHECK_INSTANCE_TYPE ((obj), THUNAR_TYPE_APP_INFO_CACHE))
+#define THUNAR_IS_APP_INFO_CACHE_CLASS(klass) (G_TYPE_CHECK_CLASS_TYPE ((klass), THUNAR_TYPE_APP_INFO_CACHE))
+#define THUNAR_APP_INFO_CACHE_GET_CLASS(obj)  (G_TYPE_INSTANCE_GET_CLASS ((obj), THUNAR_TYPE_APP_INFO_CACHE, ThunarAppInfoCacheClass))
+
+GType               thunar_app_info_cache_get_type             (void) G_GNUC_CONST;
+
+ThunarAppInfoCache *thunar_app_info_cache_get                  (void);
+
+GList              *thunar_app_info_cache_get_all              (ThunarAppInfoCache *cache) G_GNUC_MALLOC;
+GList              *thunar_app_info_cache_get_all_for_type     (ThunarAppInfoCache *cache,
+                                                                const gchar        *content_type) G_GNUC_MALLOC;
+GAppInfo           *thunar_app_info_cache_get_default_for_type (ThunarAppInfoCache *cache,
+                                                                const gchar        *content_type,
+                                                                gboolean            must_support_uris);
+
+void                thunar_app_info_cache_invalidate           (ThunarAppInfoCache *cache);
+
+G_END_DECLS;
+
+#endif /* !__THUNAR_APP_INFO_CACHE_H__ */
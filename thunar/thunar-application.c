@@ -50,15 +50,21 @@
 #include <thunar/thunar-browser.h>
 #include <thunar/thunar-create-dialog.h>
 #include <thunar/thunar-dialogs.h>
+#include <thunar/thunar-folder.h>
 #include <thunar/thunar-gdk-extensions.h>
+#include <thunar/thunar-gio-extensions.h>
 #include <thunar/thunar-gobject-extensions.h>
+#include <thunar/thunar-icon-factory.h>
 #include <thunar/thunar-io-jobs.h>
 #include <thunar/thunar-preferences.h>
 #include <thunar/thunar-private.h>
 #include <thunar/thunar-progress-dialog.h>
 #include <thunar/thunar-renamer-dialog.h>
+#include <thunar/thunar-shortcuts-model.h>
 #include <thunar/thunar-thumbnail-cache.h>
 #include <thunar/thunar-thumbnailer.h>
+#include <thunar/thunar-transfer-job.h>
+#include <thunar/thunar-transfer-journal.h>
 #include <thunar/thunar-util.h>
 #include <thunar/thunar-view.h>
 #include <thunar/thunar-session-client.h>
@@ -147,6 +153,12 @@ static void           thunar_application_collect_and_launch     (ThunarApplicati
                                                                  GClosure               *new_files_closure);
 static void           thunar_application_launch_finished        (ThunarJob              *job,
                                                                  ThunarView             *view);
+static void           thunar_application_launch_job             (ThunarApplication      *application,
+                                                                 gpointer                parent,
+                                                                 const gchar            *icon_name,
+                                                                 const gchar            *title,
+                                                                 ThunarJob              *job,
+                                                                 GClosure               *new_files_closure);
 static void           thunar_application_launch                 (ThunarApplication      *application,
                                                                  gpointer                parent,
                                                                  const gchar            *icon_name,
@@ -169,10 +181,18 @@ static void           thunar_application_volman_watch           (GPid
                                                                  gpointer                user_data);
 static void           thunar_application_volman_watch_destroy   (gpointer                user_data);
 #endif
+static gboolean       thunar_application_resume_transfers_idle  (gpointer                user_data);
 static gboolean       thunar_application_show_dialogs           (gpointer                user_data);
 static void           thunar_application_show_dialogs_destroy   (gpointer                user_data);
 static GtkWidget     *thunar_application_get_progress_dialog    (ThunarApplication      *application);
 static void           thunar_application_process_files          (ThunarApplication      *application);
+static gboolean       thunar_application_window_drawn           (GtkWidget              *window,
+                                                                 cairo_t                *cr,
+                                                                 gpointer                user_data);
+static void           thunar_application_prewarm_icons          (ThunarApplication      *application);
+static void           thunar_application_prewarm_folder_loaded  (ThunarApplication      *application);
+static gboolean       thunar_application_prewarm_idle           (gpointer                user_data);
+static void           thunar_application_prewarm_idle_destroy   (gpointer                user_data);
 
 
 
@@ -202,6 +222,8 @@ struct _ThunarApplication
 
   guint                  show_dialogs_timer_id;
 
+  guint                  resume_transfers_idle_id;
+
 #ifdef HAVE_GUDEV
   GUdevClient           *udev_client;
 
@@ -213,6 +235,24 @@ struct _ThunarApplication
   GList                 *files_to_launch;
 
   guint                  dbus_owner_id;
+
+  /* caches loaded ahead of the first window in daemon mode */
+  guint                  prewarm_idle_id;
+  guint                  prewarm_step;
+  GSList                *prewarm_icons;
+  ThunarShortcutsModel  *prewarm_shortcuts;
+  ThunarFolder          *prewarm_folder;
+};
+
+
+
+/* icons looked up by a new window for the shortcuts and common files */
+static const gchar *prewarm_icon_names[] =
+{
+  "folder", "folder-open", "user-home", "user-desktop", "user-trash",
+  "user-trash-full", "drive-harddisk", "inode-directory", "text-x-generic",
+  "image-x-generic", "audio-x-generic", "video-x-generic", "package-x-generic",
+  "application-x-executable", "x-office-document",
 };
 
 
@@ -354,6 +394,8 @@ thunar_application_startup (GApplication *gapp)
   /* initialize the application */
   application->preferences = thunar_preferences_get ();
 
+  thunar_util_profile_mark ("preferences");
+
   /* TODO: how do accel maps integrate with GAction/GMenu? */
   /* check if we have a saved accel map */
   path = xfce_resource_lookup (XFCE_RESOURCE_CONFIG, ACCEL_MAP_PATH);
@@ -369,6 +411,8 @@ thunar_application_startup (GApplication *gapp)
   g_signal_connect_swapped (G_OBJECT (application->accel_map), "changed",
       G_CALLBACK (thunar_application_accel_map_changed), application);
 
+  thunar_util_profile_mark ("accel map");
+
 #ifdef HAVE_GUDEV
   /* establish connection with udev */
   application->udev_client = g_udev_client_new (subsystems);
@@ -377,13 +421,24 @@ thunar_application_startup (GApplication *gapp)
    * or disconnected from the computer */
   g_signal_connect (application->udev_client, "uevent",
                     G_CALLBACK (thunar_application_uevent), application);
+
+  thunar_util_profile_mark ("device monitor");
 #endif
 
   /* connect to the session manager */
   application->session_client = thunar_session_client_new (opt_sm_client_id);
 
+  thunar_util_profile_mark ("session client");
+
   thunar_application_dbus_init (application);
 
+  thunar_util_profile_mark ("dbus name");
+
+  /* offer to resume copies that were interrupted by a crash, once the
+   * primary instance is up and running */
+  application->resume_transfers_idle_id =
+    g_idle_add (thunar_application_resume_transfers_idle, application);
+
   G_APPLICATION_CLASS (thunar_application_parent_class)->startup (gapp);
 }
 
@@ -398,6 +453,18 @@ thunar_application_shutdown (GApplication *gapp)
   /* unqueue all files waiting to be processed */
   thunar_g_file_list_free (application->files_to_launch);
 
+  /* stop prewarming and release the prewarmed caches */
+  if (G_UNLIKELY (application->prewarm_idle_id != 0))
+    g_source_remove (application->prewarm_idle_id);
+  g_slist_free_full (application->prewarm_icons, g_object_unref);
+  application->prewarm_icons = NULL;
+  g_clear_object (&application->prewarm_shortcuts);
+  if (application->prewarm_folder != NULL)
+    {
+      g_signal_handlers_disconnect_by_func (application->prewarm_folder, thunar_application_prewarm_folder_loaded, application);
+      g_clear_object (&application->prewarm_folder);
+    }
+
   /* save the current accel map */
   if (G_UNLIKELY (application->accel_map_save_id != 0))
     {
@@ -428,6 +495,10 @@ thunar_application_shutdown (GApplication *gapp)
   if (G_UNLIKELY (application->show_dialogs_timer_id != 0))
     g_source_remove (application->show_dialogs_timer_id);
 
+  /* drop the pending check for interrupted transfers */
+  if (G_UNLIKELY (application->resume_transfers_idle_id != 0))
+    g_source_remove (application->resume_transfers_idle_id);
+
   /* drop ref on the thumbnailer */
   if (application->thumbnailer != NULL)
     g_object_unref (application->thumbnailer);
@@ -584,7 +655,12 @@ thunar_application_dbus_register (GApplication           *gapp,
 
     application->dbus_service = g_object_new (THUNAR_TYPE_DBUS_SERVICE, NULL);
 
-    return thunar_dbus_service_export_on_connection (application->dbus_service, connection, error);
+    if (!thunar_dbus_service_export_on_connection (application->dbus_service, connection, error))
+      return FALSE;
+
+    thunar_util_profile_mark ("dbus service");
+
+    return TRUE;
 }
 
 
@@ -786,27 +862,22 @@ thunar_application_launch_finished (ThunarJob  *job,
 
 
 static void
-thunar_application_launch (ThunarApplication *application,
-                           gpointer           parent,
-                           const gchar       *icon_name,
-                           const gchar       *title,
-                           Launcher           launcher,
-                           GList             *source_file_list,
-                           GList             *target_file_list,
-                           GClosure          *new_files_closure)
+thunar_application_launch_job (ThunarApplication *application,
+                               gpointer           parent,
+                               const gchar       *icon_name,
+                               const gchar       *title,
+                               ThunarJob         *job,
+                               GClosure          *new_files_closure)
 {
   GtkWidget *dialog;
   GdkScreen *screen;
-  ThunarJob *job;
 
   _thunar_return_if_fail (parent == NULL || GDK_IS_SCREEN (parent) || GTK_IS_WIDGET (parent));
+  _thunar_return_if_fail (THUNAR_IS_JOB (job));
 
   /* parse the parent pointer */
   screen = thunar_util_parse_parent (parent, NULL);
 
-  /* try to allocate a new job for the operation */
-  job = (*launcher) (source_file_list, target_file_list);
-
   if (THUNAR_IS_VIEW (parent))
     {
       /* connect a callback to instantly refresh the thunar view */
@@ -864,6 +935,109 @@ thunar_application_launch (ThunarApplication *application,
 
 
 
+static void
+thunar_application_launch (ThunarApplication *application,
+                           gpointer           parent,
+                           const gchar       *icon_name,
+                           const gchar       *title,
+                           Launcher           launcher,
+                           GList             *source_file_list,
+                           GList             *target_file_list,
+                           GClosure          *new_files_closure)
+{
+  ThunarJob *job;
+
+  _thunar_return_if_fail (parent == NULL || GDK_IS_SCREEN (parent) || GTK_IS_WIDGET (parent));
+
+  /* try to allocate a new job for the operation */
+  job = (*launcher) (source_file_list, target_file_list);
+
+  /* hand the job over to the progress dialog */
+  thunar_application_launch_job (application, parent, icon_name, title,
+                                 job, new_files_closure);
+}
+
+
+
+static gboolean
+thunar_application_resume_transfers_idle (gpointer user_data)
+{
+  ThunarTransferJournal *journal;
+  ThunarApplication     *application = THUNAR_APPLICATION (user_data);
+  GtkWidget             *dialog;
+  ThunarJob             *job;
+  GError                *error = NULL;
+  gchar                **paths;
+  guint                  n_paths;
+  guint                  n;
+  gint                   response;
+
+  application->resume_transfers_idle_id = 0;
+
+  /* check if the last session left unfinished copies behind */
+  paths = thunar_transfer_journal_find_interrupted ();
+  if (G_LIKELY (paths == NULL))
+    return FALSE;
+
+  n_paths = g_strv_length (paths);
+
+  /* ask the user once for all interrupted copies */
+  dialog = gtk_message_dialog_new (NULL, 0,
+                                   GTK_MESSAGE_QUESTION,
+                                   GTK_BUTTONS_NONE,
+                                   ngettext ("A copy operation was interrupted. Do you want to resume it?",
+                                             "%u copy operations were interrupted. Do you want to resume them?",
+                                             n_paths),
+                                   n_paths);
+  gtk_dialog_add_buttons (GTK_DIALOG (dialog),
+                          _("_Discard"), GTK_RESPONSE_NO,
+                          _("_Resume"), GTK_RESPONSE_YES,
+                          NULL);
+  gtk_dialog_set_default_response (GTK_DIALOG (dialog), GTK_RESPONSE_YES);
+  gtk_message_dialog_format_secondary_text (GTK_MESSAGE_DIALOG (dialog),
+                                            _("Files that were copied completely are skipped and "
+                                              "partially copied files are continued where the "
+                                              "copy stopped."));
+  response = gtk_dialog_run (GTK_DIALOG (dialog));
+  gtk_widget_destroy (dialog);
+
+  /* if the dialog was just closed, ask again next time */
+  if (response == GTK_RESPONSE_YES || response == GTK_RESPONSE_NO)
+    {
+      for (n = 0; n < n_paths; ++n)
+        {
+          journal = thunar_transfer_journal_load (paths[n], &error);
+          if (G_UNLIKELY (journal == NULL))
+            {
+              g_warning ("Failed to load transfer journal: %s", error->message);
+              g_clear_error (&error);
+              continue;
+            }
+
+          if (response == GTK_RESPONSE_YES)
+            {
+              /* continue the copy, the job takes over the journal */
+              job = thunar_transfer_job_new_resume (journal);
+              thunar_application_launch_job (application, NULL, "stock_folder-copy",
+                                             _("Resuming copy..."),
+                                             THUNAR_JOB (exo_job_launch (EXO_JOB (job))),
+                                             NULL);
+            }
+          else
+            {
+              thunar_transfer_journal_remove (journal);
+              thunar_transfer_journal_free (journal);
+            }
+        }
+    }
+
+  g_strfreev (paths);
+
+  return FALSE;
+}
+
+
+
 #ifdef HAVE_GUDEV
 static void
 thunar_application_uevent (GUdevClient       *client,
@@ -1060,6 +1234,127 @@ thunar_application_show_dialogs_destroy (gpointer user_data)
 
 
 
+static gboolean
+thunar_application_window_drawn (GtkWidget *window,
+                                 cairo_t   *cr,
+                                 gpointer   user_data)
+{
+  /* only the first frame is of interest */
+  g_signal_handlers_disconnect_by_func (window, thunar_application_window_drawn, user_data);
+
+  thunar_util_profile_mark ("window drawn");
+  thunar_util_profile_dump ();
+
+  return FALSE;
+}
+
+
+
+static void
+thunar_application_prewarm_icons (ThunarApplication *application)
+{
+  ThunarIconFactory *icon_factory;
+  ThunarIconSize     shortcuts_icon_size;
+  GdkPixbuf         *icon;
+  GValue             zoom_level = G_VALUE_INIT;
+  GValue             icon_size = G_VALUE_INIT;
+  gint               sizes[2];
+  guint              n, i;
+
+  /* determine the icon sizes of the shortcuts pane and the icon view */
+  g_object_get (G_OBJECT (application->preferences), "shortcuts-icon-size", &shortcuts_icon_size, NULL);
+  g_value_init (&zoom_level, THUNAR_TYPE_ZOOM_LEVEL);
+  g_value_init (&icon_size, THUNAR_TYPE_ICON_SIZE);
+  g_object_get_property (G_OBJECT (application->preferences), "last-icon-view-zoom-level", &zoom_level);
+  g_value_transform (&zoom_level, &icon_size);
+  sizes[0] = shortcuts_icon_size;
+  sizes[1] = g_value_get_enum (&icon_size);
+  g_value_unset (&zoom_level);
+  g_value_unset (&icon_size);
+
+  /* keep references on the icons, so the icon factory doesn't sweep them */
+  icon_factory = thunar_icon_factory_get_default ();
+  for (i = 0; i < G_N_ELEMENTS (sizes); ++i)
+    for (n = 0; n < G_N_ELEMENTS (prewarm_icon_names); ++n)
+      {
+        icon = thunar_icon_factory_load_icon (icon_factory, prewarm_icon_names[n], sizes[i], FALSE);
+        if (G_LIKELY (icon != NULL))
+          application->prewarm_icons = g_slist_prepend (application->prewarm_icons, icon);
+      }
+  g_object_unref (G_OBJECT (icon_factory));
+}
+
+
+
+static void
+thunar_application_prewarm_folder_loaded (ThunarApplication *application)
+{
+  _thunar_return_if_fail (THUNAR_IS_FOLDER (application->prewarm_folder));
+
+  if (thunar_folder_get_loading (application->prewarm_folder))
+    return;
+
+  g_signal_handlers_disconnect_by_func (application->prewarm_folder, thunar_application_prewarm_folder_loaded, application);
+
+  thunar_util_profile_mark ("prewarm home folder");
+  thunar_util_profile_dump ();
+}
+
+
+
+static gboolean
+thunar_application_prewarm_idle (gpointer user_data)
+{
+  ThunarApplication *application = THUNAR_APPLICATION (user_data);
+  ThunarFile        *home_file;
+  GFile             *home;
+
+  /* load one cache per iteration to keep the main loop responsive */
+  switch (application->prewarm_step++)
+    {
+    case 0:
+      thunar_application_prewarm_icons (application);
+      thunar_util_profile_mark ("prewarm icons");
+      return TRUE;
+
+    case 1:
+      application->prewarm_shortcuts = thunar_shortcuts_model_get_default ();
+      thunar_util_profile_mark ("prewarm shortcuts");
+      return TRUE;
+
+    default:
+      /* start listing the home folder, the window will reuse the folder */
+      home = thunar_g_file_new_for_home ();
+      home_file = thunar_file_get (home, NULL);
+      g_object_unref (home);
+
+      if (G_LIKELY (home_file != NULL))
+        {
+          application->prewarm_folder = thunar_folder_get_for_file (home_file);
+          g_object_unref (home_file);
+        }
+
+      if (G_LIKELY (application->prewarm_folder != NULL))
+        {
+          g_signal_connect_swapped (application->prewarm_folder, "notify::loading",
+                                    G_CALLBACK (thunar_application_prewarm_folder_loaded), application);
+          thunar_application_prewarm_folder_loaded (application);
+        }
+
+      return FALSE;
+    }
+}
+
+
+
+static void
+thunar_application_prewarm_idle_destroy (gpointer user_data)
+{
+  THUNAR_APPLICATION (user_data)->prewarm_idle_id = 0;
+}
+
+
+
 /**
  * thunar_application_get:
  *
@@ -1119,9 +1414,20 @@ thunar_application_set_daemon (ThunarApplication *application,
       g_object_notify (G_OBJECT (application), "daemon");
 
       if (daemonize)
-        g_application_hold (G_APPLICATION (application));
+        {
+          g_application_hold (G_APPLICATION (application));
+
+          /* load the caches for the first window in the background */
+          if (application->prewarm_idle_id == 0 && application->prewarm_step == 0)
+            {
+              application->prewarm_idle_id = g_idle_add_full (G_PRIORITY_LOW, thunar_application_prewarm_idle,
+                                                              application, thunar_application_prewarm_idle_destroy);
+            }
+        }
       else
-        g_application_release (G_APPLICATION (application));
+        {
+          g_application_release (G_APPLICATION (application));
+        }
     }
 }
 
@@ -1265,6 +1571,14 @@ thunar_application_open_window (ThunarApplication *application,
   if (directory != NULL)
     thunar_window_set_current_directory (THUNAR_WINDOW (window), directory);
 
+  /* report the startup profile once the window drew its first frame */
+  if (G_UNLIKELY (thunar_util_profile_enabled ()))
+    {
+      thunar_util_profile_mark ("window shown");
+      g_signal_connect_after (G_OBJECT (window), "draw",
+                              G_CALLBACK (thunar_application_window_drawn), NULL);
+    }
+
   return window;
 }
 
@@ -24,6 +24,7 @@
 #include <config.h>
 #endif
 
+#include <thunar/thunar-app-info-cache.h>
 #include <thunar/thunar-chooser-button.h>
 #include <thunar/thunar-chooser-dialog.h>
 #include <thunar/thunar-dialogs.h>
@@ -275,6 +276,7 @@ static void
 thunar_chooser_button_changed (GtkComboBox *combo_box)
 {
   ThunarChooserButton *chooser_button = THUNAR_CHOOSER_BUTTON (combo_box);
+  ThunarAppInfoCache  *app_info_cache;
   GtkTreeIter          iter;
   const gchar         *content_type;
   GAppInfo            *app_info;
@@ -312,6 +314,11 @@ thunar_chooser_button_changed (GtkComboBox *combo_box)
         }
       else
         {
+          /* don't wait for GIO to notice the new default */
+          app_info_cache = thunar_app_info_cache_get ();
+          thunar_app_info_cache_invalidate (app_info_cache);
+          g_object_unref (app_info_cache);
+
           /* emit "changed" on the file, so everybody updates its state */
           thunar_file_changed (chooser_button->file);
         }
@@ -407,13 +414,14 @@ static void
 thunar_chooser_button_file_changed (ThunarChooserButton *chooser_button,
                                     ThunarFile          *file)
 {
-  const gchar *content_type;
-  GtkTreeIter  iter;
-  GAppInfo    *app_info;
-  GList       *app_infos;
-  GList       *lp;
-  gchar       *description;
-  guint        i = 0;
+  ThunarAppInfoCache *app_info_cache;
+  const gchar        *content_type;
+  GtkTreeIter         iter;
+  GAppInfo           *app_info;
+  GList              *app_infos;
+  GList              *lp;
+  gchar              *description;
+  guint               i = 0;
 
   _thunar_return_if_fail (THUNAR_IS_CHOOSER_BUTTON (chooser_button));
   _thunar_return_if_fail (chooser_button->file == file);
@@ -443,11 +451,12 @@ thunar_chooser_button_file_changed (ThunarChooserButton *chooser_button,
       g_free (description);
 
       /* determine the default application for that content type */
-      app_info = g_app_info_get_default_for_type (content_type, FALSE);
+      app_info_cache = thunar_app_info_cache_get ();
+      app_info = thunar_app_info_cache_get_default_for_type (app_info_cache, content_type, FALSE);
       if (G_LIKELY (app_info != NULL))
         {
           /* determine all applications that claim to be able to handle the file */
-          app_infos = g_app_info_get_all_for_type (content_type);
+          app_infos = thunar_app_info_cache_get_all_for_type (app_info_cache, content_type);
           app_infos = g_list_sort (app_infos, thunar_chooser_button_sort_applications);
           
           /* add all possible applications */
@@ -485,6 +494,7 @@ thunar_chooser_button_file_changed (ThunarChooserButton *chooser_button,
           /* assume we have some applications in the list */
           chooser_button->has_default_application = TRUE;
         }
+      g_object_unref (app_info_cache);
     }
   
   if (content_type == NULL || !chooser_button->has_default_application)
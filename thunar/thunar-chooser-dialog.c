@@ -30,6 +30,7 @@
 #endif
 
 #include <thunar/thunar-abstract-dialog.h>
+#include <thunar/thunar-app-info-cache.h>
 #include <thunar/thunar-application.h>
 #include <thunar/thunar-chooser-dialog.h>
 #include <thunar/thunar-chooser-model.h>
@@ -387,6 +388,7 @@ thunar_chooser_dialog_response (GtkDialog *widget,
 {
   GdkAppLaunchContext *context;
   ThunarChooserDialog *dialog = THUNAR_CHOOSER_DIALOG (widget);
+  ThunarAppInfoCache  *app_info_cache;
   GtkTreeSelection    *selection;
   GtkTreeModel        *model;
   GtkTreeIter          iter;
@@ -471,13 +473,25 @@ thunar_chooser_dialog_response (GtkDialog *widget,
 
       /* emit "changed" on the file if we successfully changed the default application */
       if (G_LIKELY (succeed))
-        thunar_file_changed (dialog->file);
+        {
+          /* don't wait for GIO to notice the new default */
+          app_info_cache = thunar_app_info_cache_get ();
+          thunar_app_info_cache_invalidate (app_info_cache);
+          g_object_unref (app_info_cache);
+
+          thunar_file_changed (dialog->file);
+        }
     }
   else
     {
       /* simply try to set the app as last used for this type (we do not show any errors here) */
       if (g_app_info_set_as_last_used_for_type (app_info, content_type, NULL))
         {
+          /* the order of the applications changed */
+          app_info_cache = thunar_app_info_cache_get ();
+          thunar_app_info_cache_invalidate (app_info_cache);
+          g_object_unref (app_info_cache);
+
           /* emit "changed" on the file if we successfully changed the default application */
           thunar_file_changed (dialog->file);
         }
@@ -29,6 +29,7 @@
 #include <string.h>
 #endif
 
+#include <thunar/thunar-app-info-cache.h>
 #include <thunar/thunar-chooser-model.h>
 #include <thunar/thunar-gobject-extensions.h>
 #include <thunar/thunar-icon-factory.h>
@@ -279,10 +280,13 @@ sort_app_infos (gconstpointer a,
 static void
 thunar_chooser_model_reload (ThunarChooserModel *model)
 {
-  GList *all;
-  GList *lp;
-  GList *other = NULL;
-  GList *recommended;
+  ThunarAppInfoCache *app_info_cache;
+  GHashTable         *recommended_ids;
+  const gchar        *app_id;
+  GList              *all;
+  GList              *lp;
+  GList              *other = NULL;
+  GList              *recommended;
 
   _thunar_return_if_fail (THUNAR_IS_CHOOSER_MODEL (model));
   _thunar_return_if_fail (model->content_type != NULL);
@@ -290,7 +294,8 @@ thunar_chooser_model_reload (ThunarChooserModel *model)
   gtk_tree_store_clear (GTK_TREE_STORE (model));
 
   /* check if we have any applications for this type */
-  recommended = g_app_info_get_all_for_type (model->content_type);
+  app_info_cache = thunar_app_info_cache_get ();
+  recommended = thunar_app_info_cache_get_all_for_type (app_info_cache, model->content_type);
 
   /* append them as recommended */
   recommended = g_list_sort (recommended, sort_app_infos);
@@ -299,16 +304,28 @@ thunar_chooser_model_reload (ThunarChooserModel *model)
                                "preferences-desktop-default-applications", 
                                recommended);
 
-  all = g_app_info_get_all ();
+  /* remember the recommended applications by id */
+  recommended_ids = g_hash_table_new (g_str_hash, g_str_equal);
+  for (lp = recommended; lp != NULL; lp = lp->next)
+    {
+      app_id = g_app_info_get_id (lp->data);
+      if (G_LIKELY (app_id != NULL))
+        g_hash_table_insert (recommended_ids, (gpointer) app_id, lp->data);
+    }
+
+  all = thunar_app_info_cache_get_all (app_info_cache);
   for (lp = all; lp != NULL; lp = lp->next)
     {
-      if (g_list_find_custom (recommended,
-                              lp->data,
-                              compare_app_infos) == NULL)
+      app_id = g_app_info_get_id (lp->data);
+      if (app_id != NULL
+          ? g_hash_table_lookup (recommended_ids, app_id) == NULL
+          : g_list_find_custom (recommended, lp->data, compare_app_infos) == NULL)
         {
           other = g_list_prepend (other, lp->data);
         }
     }
+  g_hash_table_destroy (recommended_ids);
+  g_object_unref (app_info_cache);
 
   /* append the other applications */
   other = g_list_sort (other, sort_app_infos);
@@ -377,8 +394,9 @@ thunar_chooser_model_remove (ThunarChooserModel *model,
                              GtkTreeIter        *iter,
                              GError            **error)
 {
-  GAppInfo *app_info;
-  gboolean  succeed;
+  ThunarAppInfoCache *app_info_cache;
+  GAppInfo           *app_info;
+  gboolean            succeed;
 
   _thunar_return_val_if_fail (THUNAR_IS_CHOOSER_MODEL (model), FALSE);
   _thunar_return_val_if_fail (error == NULL || *error == NULL, FALSE);
@@ -407,6 +425,11 @@ thunar_chooser_model_remove (ThunarChooserModel *model,
                    g_app_info_get_id (app_info));
     }
 
+  /* the associations of the content type changed */
+  app_info_cache = thunar_app_info_cache_get ();
+  thunar_app_info_cache_invalidate (app_info_cache);
+  g_object_unref (app_info_cache);
+
   /* clean up */
   g_object_unref (app_info);
 
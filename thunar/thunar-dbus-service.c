@@ -39,9 +39,11 @@
 #include <thunar/thunar-dbus-service.h>
 #include <thunar/thunar-file.h>
 #include <thunar/thunar-gdk-extensions.h>
+#include <thunar/thunar-io-jobs.h>
 #include <thunar/thunar-preferences-dialog.h>
 #include <thunar/thunar-private.h>
 #include <thunar/thunar-properties-dialog.h>
+#include <thunar/thunar-transfer-job.h>
 #include <thunar/thunar-util.h>
 
 
@@ -51,6 +53,14 @@
 
 
 
+/* delay before "trash-changed" is emitted, in milliseconds */
+#define TRASH_CHANGED_TIMEOUT (250)
+
+/* interval between "BatchProgress" signals, in milliseconds */
+#define BATCH_PROGRESS_INTERVAL (500)
+
+
+
 typedef enum
 {
   THUNAR_DBUS_TRANSFER_MODE_COPY_TO,
@@ -59,6 +69,18 @@ typedef enum
   THUNAR_DBUS_TRANSFER_MODE_LINK_INTO,
 } ThunarDBusTransferMode;
 
+typedef enum
+{
+  THUNAR_DBUS_BATCH_COPY,
+  THUNAR_DBUS_BATCH_MOVE,
+  THUNAR_DBUS_BATCH_LINK,
+  THUNAR_DBUS_BATCH_TRASH,
+  THUNAR_DBUS_BATCH_UNLINK,
+} ThunarDBusBatchType;
+
+typedef struct _ThunarDBusBatchOperation ThunarDBusBatchOperation;
+typedef struct _ThunarDBusBatch          ThunarDBusBatch;
+
 
 static void     thunar_dbus_service_finalize                    (GObject                *object);
 static gboolean thunar_dbus_service_connect_trash_bin           (ThunarDBusService      *dbus_service,
@@ -219,6 +241,18 @@ static gboolean thunar_dbus_service_unlink_files                (ThunarDBusFileM
 static gboolean thunar_dbus_service_terminate                   (ThunarDBusThunar       *object,
                                                                  GDBusMethodInvocation  *invocation,
                                                                  ThunarDBusService      *dbus_service);
+static gboolean thunar_dbus_service_batch_operations            (ThunarDBusThunar       *object,
+                                                                 GDBusMethodInvocation  *invocation,
+                                                                 const gchar            *working_directory,
+                                                                 GVariant               *operations,
+                                                                 ThunarDBusService      *dbus_service);
+static gboolean thunar_dbus_service_cancel_batch                (ThunarDBusThunar       *object,
+                                                                 GDBusMethodInvocation  *invocation,
+                                                                 guint                   handle,
+                                                                 ThunarDBusService      *dbus_service);
+static void     thunar_dbus_service_batch_free                  (gpointer                data);
+static void     thunar_dbus_service_batch_next                  (ThunarDBusBatch        *batch);
+static gboolean thunar_dbus_service_batch_progress              (gpointer                user_data);
 
 
 
@@ -236,6 +270,46 @@ struct _ThunarDBusService
   ThunarDBusThunar      *thunar;
 
   ThunarFile      *trash_bin;
+
+  /* "trash-changed" is emitted once the trash bin settled */
+  guint            trash_changed_timeout_id;
+
+  /* running batches, indexed by their handle */
+  GHashTable      *batches;
+  guint            last_batch_handle;
+};
+
+struct _ThunarDBusBatchOperation
+{
+  ThunarDBusBatchType type;
+  GList              *source_files;
+  GList              *target_files;
+};
+
+struct _ThunarDBusBatch
+{
+  ThunarDBusService *dbus_service;
+  guint              handle;
+
+  /* pending operations and the job of the running one */
+  GList             *operations;
+  ThunarJob         *job;
+  guint              job_n_files;
+  gdouble            job_percent;
+
+  /* progress of the finished operations */
+  guint              n_files;
+  guint              n_files_done;
+  guint64            n_bytes_done;
+  guint64            n_bytes_total;
+
+  gint64             start_time;
+  guint              progress_timer_id;
+  guint              last_files_done;
+  guint64            last_bytes_done;
+
+  /* the first error of the batch */
+  GError            *error;
 };
 
 
@@ -314,7 +388,11 @@ thunar_dbus_service_init (ThunarDBusService *dbus_service)
   connect_signals_multiple (dbus_service->thunar, dbus_service,
                             "handle-bulk-rename", thunar_dbus_service_bulk_rename,
                             "handle-terminate", thunar_dbus_service_terminate,
+                            "handle-batch-operations", thunar_dbus_service_batch_operations,
+                            "handle-cancel-batch", thunar_dbus_service_cancel_batch,
                             NULL);
+
+  dbus_service->batches = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL, thunar_dbus_service_batch_free);
 }
 
 
@@ -328,9 +406,15 @@ thunar_dbus_service_finalize (GObject *object)
   g_object_unref (dbus_service->trash);
   g_object_unref (dbus_service->thunar);
 
+  if (dbus_service->trash_changed_timeout_id != 0)
+    g_source_remove (dbus_service->trash_changed_timeout_id);
+
   if (dbus_service->trash_bin)
     g_object_unref (dbus_service->trash_bin);
 
+  /* cancel and release all running batches */
+  g_hash_table_destroy (dbus_service->batches);
+
   (*G_OBJECT_CLASS (thunar_dbus_service_parent_class)->finalize) (object);
 }
 
@@ -393,6 +477,21 @@ thunar_dbus_service_parse_uri_and_display (ThunarDBusService *dbus_service,
 
 
 
+static gboolean
+thunar_dbus_service_trash_changed_timeout (gpointer user_data)
+{
+  ThunarDBusService *dbus_service = THUNAR_DBUS_SERVICE (user_data);
+
+  dbus_service->trash_changed_timeout_id = 0;
+
+  /* emit the "trash-changed" signal with the new state */
+  thunar_dbus_trash_emit_trash_changed (dbus_service->trash);
+
+  return FALSE;
+}
+
+
+
 static void
 thunar_dbus_service_trash_bin_changed (ThunarDBusService *dbus_service,
                                        ThunarFile        *trash_bin)
@@ -401,8 +500,13 @@ thunar_dbus_service_trash_bin_changed (ThunarDBusService *dbus_service,
   _thunar_return_if_fail (dbus_service->trash_bin == trash_bin);
   _thunar_return_if_fail (THUNAR_IS_FILE (trash_bin));
 
-  /* emit the "trash-changed" signal with the new state */
-  thunar_dbus_trash_emit_trash_changed (dbus_service->trash);
+  /* trashing a batch of files changes the trash bin for every file,
+   * so wait until it settled before telling the trash applet */
+  if (dbus_service->trash_changed_timeout_id != 0)
+    g_source_remove (dbus_service->trash_changed_timeout_id);
+
+  dbus_service->trash_changed_timeout_id =
+    g_timeout_add (TRASH_CHANGED_TIMEOUT, thunar_dbus_service_trash_changed_timeout, dbus_service);
 }
 
 
@@ -1480,6 +1584,512 @@ thunar_dbus_service_terminate (ThunarDBusThunar       *object,
 
 
 
+static GList*
+thunar_dbus_service_batch_file_list (const gchar **filenames,
+                                     GError      **error)
+{
+  GError *err = NULL;
+  GFile  *file;
+  GList  *file_list = NULL;
+  gchar  *filename;
+  guint   n;
+
+  for (n = 0; err == NULL && filenames[n] != NULL; ++n)
+    {
+      /* decode the filename (D-BUS uses UTF-8) */
+      filename = g_filename_from_utf8 (filenames[n], -1, NULL, NULL, &err);
+      if (filename != NULL)
+        {
+          file = g_file_new_for_commandline_arg (filename);
+          file_list = thunar_g_file_list_append (file_list, file);
+          g_object_unref (file);
+          g_free (filename);
+        }
+    }
+
+  if (G_UNLIKELY (err != NULL))
+    {
+      g_propagate_error (error, err);
+      thunar_g_file_list_free (file_list);
+      return NULL;
+    }
+
+  return file_list;
+}
+
+
+
+static ThunarDBusBatchOperation*
+thunar_dbus_service_batch_operation_new (const gchar  *name,
+                                         const gchar **source_filenames,
+                                         const gchar **target_filenames,
+                                         GError      **error)
+{
+  ThunarDBusBatchOperation *operation;
+  GList                    *target_list;
+  GList                    *lp;
+  GFile                    *file;
+  gchar                    *base_name;
+  guint                     n_targets;
+
+  n_targets = g_strv_length ((gchar **) target_filenames);
+
+  operation = g_slice_new0 (ThunarDBusBatchOperation);
+
+  /* determine the type and verify the number of target filenames */
+  if (strcmp (name, "copy-to") == 0)
+    {
+      operation->type = THUNAR_DBUS_BATCH_COPY;
+      if (g_strv_length ((gchar **) source_filenames) != n_targets)
+        {
+          g_set_error (error, G_FILE_ERROR, G_FILE_ERROR_INVAL,
+                       _("The number of source and target filenames must be the same"));
+          goto failed;
+        }
+    }
+  else if (strcmp (name, "copy-into") == 0
+           || strcmp (name, "move-into") == 0
+           || strcmp (name, "link-into") == 0)
+    {
+      if (*name == 'c')
+        operation->type = THUNAR_DBUS_BATCH_COPY;
+      else if (*name == 'm')
+        operation->type = THUNAR_DBUS_BATCH_MOVE;
+      else
+        operation->type = THUNAR_DBUS_BATCH_LINK;
+
+      if (n_targets != 1)
+        {
+          g_set_error (error, G_FILE_ERROR, G_FILE_ERROR_INVAL,
+                       _("A destination directory must be specified"));
+          goto failed;
+        }
+    }
+  else if (strcmp (name, "trash") == 0 || strcmp (name, "unlink") == 0)
+    {
+      operation->type = (*name == 't') ? THUNAR_DBUS_BATCH_TRASH : THUNAR_DBUS_BATCH_UNLINK;
+      n_targets = 0;
+    }
+  else
+    {
+      g_set_error (error, G_FILE_ERROR, G_FILE_ERROR_INVAL,
+                   _("Unknown operation \"%s\""), name);
+      goto failed;
+    }
+
+  /* verify that at least one file to process is given */
+  if (*source_filenames == NULL)
+    {
+      g_set_error (error, G_FILE_ERROR, G_FILE_ERROR_INVAL,
+                   _("At least one source filename must be specified"));
+      goto failed;
+    }
+
+  operation->source_files = thunar_dbus_service_batch_file_list (source_filenames, error);
+  if (G_UNLIKELY (operation->source_files == NULL))
+    goto failed;
+
+  if (n_targets > 0)
+    {
+      target_list = thunar_dbus_service_batch_file_list (target_filenames, error);
+      if (G_UNLIKELY (target_list == NULL))
+        goto failed;
+
+      if (strcmp (name, "copy-to") == 0)
+        {
+          operation->target_files = target_list;
+        }
+      else
+        {
+          /* generate the target path list for the directory */
+          for (lp = operation->source_files; lp != NULL; lp = lp->next)
+            {
+              base_name = g_file_get_basename (lp->data);
+              file = g_file_resolve_relative_path (target_list->data, base_name);
+              operation->target_files = thunar_g_file_list_append (operation->target_files, file);
+              g_object_unref (file);
+              g_free (base_name);
+            }
+          thunar_g_file_list_free (target_list);
+        }
+    }
+
+  return operation;
+
+failed:
+  thunar_g_file_list_free (operation->source_files);
+  g_slice_free (ThunarDBusBatchOperation, operation);
+  return NULL;
+}
+
+
+
+static void
+thunar_dbus_service_batch_operation_free (gpointer data)
+{
+  ThunarDBusBatchOperation *operation = data;
+
+  thunar_g_file_list_free (operation->source_files);
+  thunar_g_file_list_free (operation->target_files);
+  g_slice_free (ThunarDBusBatchOperation, operation);
+}
+
+
+
+static ThunarJobResponse
+thunar_dbus_service_batch_ask (ThunarJob         *job,
+                               const gchar       *message,
+                               ThunarJobResponse  choices,
+                               ThunarDBusBatch   *batch)
+{
+  /* nobody can be asked, so never overwrite or delete anything */
+  if ((choices & THUNAR_JOB_RESPONSE_NO_ALL) != 0)
+    return THUNAR_JOB_RESPONSE_NO_ALL;
+  else if ((choices & THUNAR_JOB_RESPONSE_NO) != 0)
+    return THUNAR_JOB_RESPONSE_NO;
+  else
+    return THUNAR_JOB_RESPONSE_CANCEL;
+}
+
+
+
+static ThunarJobResponse
+thunar_dbus_service_batch_ask_replace (ThunarJob       *job,
+                                       ThunarFile      *source_file,
+                                       ThunarFile      *target_file,
+                                       ThunarDBusBatch *batch)
+{
+  /* skip existing files */
+  return THUNAR_JOB_RESPONSE_NO_ALL;
+}
+
+
+
+static void
+thunar_dbus_service_batch_error (ThunarJob       *job,
+                                 GError          *error,
+                                 ThunarDBusBatch *batch)
+{
+  _thunar_return_if_fail (batch->job == job);
+
+  /* remember the first error, the remaining operations still run */
+  if (batch->error == NULL)
+    batch->error = g_error_copy (error);
+}
+
+
+
+static void
+thunar_dbus_service_batch_percent (ThunarJob       *job,
+                                   gdouble          percent,
+                                   ThunarDBusBatch *batch)
+{
+  _thunar_return_if_fail (batch->job == job);
+
+  batch->job_percent = percent;
+}
+
+
+
+static void
+thunar_dbus_service_batch_job_progress (ThunarDBusBatch *batch,
+                                        guint64         *n_bytes_done,
+                                        guint64         *n_bytes_total)
+{
+  *n_bytes_done = *n_bytes_total = 0;
+
+  if (batch->job != NULL && THUNAR_IS_TRANSFER_JOB (batch->job))
+    thunar_transfer_job_get_progress (THUNAR_TRANSFER_JOB (batch->job), n_bytes_done, n_bytes_total);
+}
+
+
+
+static void
+thunar_dbus_service_batch_finished (ThunarJob       *job,
+                                    ThunarDBusBatch *batch)
+{
+  guint64 n_bytes_done;
+  guint64 n_bytes_total;
+
+  _thunar_return_if_fail (batch->job == job);
+
+  /* account the progress of the finished operation */
+  thunar_dbus_service_batch_job_progress (batch, &n_bytes_done, &n_bytes_total);
+  batch->n_bytes_done += n_bytes_done;
+  batch->n_bytes_total += n_bytes_total;
+  batch->n_files_done += batch->job_n_files;
+
+  /* release the job */
+  g_signal_handlers_disconnect_matched (job, G_SIGNAL_MATCH_DATA, 0, 0, NULL, NULL, batch);
+  g_object_unref (job);
+  batch->job = NULL;
+
+  thunar_dbus_service_batch_next (batch);
+}
+
+
+
+static void
+thunar_dbus_service_batch_next (ThunarDBusBatch *batch)
+{
+  ThunarDBusBatchOperation *operation;
+  ThunarDBusService        *dbus_service = batch->dbus_service;
+
+  _thunar_return_if_fail (batch->job == NULL);
+
+  /* check if the batch is done */
+  if (batch->operations == NULL)
+    {
+      /* send the final progress, then tell the caller */
+      thunar_dbus_service_batch_progress (batch);
+      thunar_dbus_thunar_emit_batch_finished (dbus_service->thunar, batch->handle, batch->error == NULL,
+                                              (batch->error != NULL) ? batch->error->message : "");
+      g_hash_table_remove (dbus_service->batches, GUINT_TO_POINTER (batch->handle));
+      return;
+    }
+
+  /* pop the next operation */
+  operation = batch->operations->data;
+  batch->operations = g_list_delete_link (batch->operations, batch->operations);
+
+  /* launch the job for the operation */
+  switch (operation->type)
+    {
+    case THUNAR_DBUS_BATCH_COPY:
+      batch->job = thunar_io_jobs_copy_files (operation->source_files, operation->target_files);
+      break;
+
+    case THUNAR_DBUS_BATCH_MOVE:
+      batch->job = thunar_io_jobs_move_files (operation->source_files, operation->target_files);
+      break;
+
+    case THUNAR_DBUS_BATCH_LINK:
+      batch->job = thunar_io_jobs_link_files (operation->source_files, operation->target_files);
+      break;
+
+    case THUNAR_DBUS_BATCH_TRASH:
+      batch->job = thunar_io_jobs_trash_files (operation->source_files);
+      break;
+
+    case THUNAR_DBUS_BATCH_UNLINK:
+      batch->job = thunar_io_jobs_unlink_files (operation->source_files);
+      break;
+    }
+
+  batch->job_n_files = g_list_length (operation->source_files);
+  batch->job_percent = 0.0;
+  thunar_dbus_service_batch_operation_free (operation);
+
+  g_signal_connect (batch->job, "ask", G_CALLBACK (thunar_dbus_service_batch_ask), batch);
+  g_signal_connect (batch->job, "ask-replace", G_CALLBACK (thunar_dbus_service_batch_ask_replace), batch);
+  g_signal_connect (batch->job, "error", G_CALLBACK (thunar_dbus_service_batch_error), batch);
+  g_signal_connect (batch->job, "percent", G_CALLBACK (thunar_dbus_service_batch_percent), batch);
+  g_signal_connect (batch->job, "finished", G_CALLBACK (thunar_dbus_service_batch_finished), batch);
+}
+
+
+
+static gboolean
+thunar_dbus_service_batch_progress (gpointer user_data)
+{
+  ThunarDBusBatch *batch = user_data;
+  guint64          n_bytes_done;
+  guint64          n_bytes_total;
+  guint64          rate = 0;
+  gdouble          fraction;
+  gint64           elapsed;
+  guint            n_files_done;
+  guint            eta = 0;
+
+  /* add the progress of the running operation */
+  thunar_dbus_service_batch_job_progress (batch, &n_bytes_done, &n_bytes_total);
+  n_bytes_done += batch->n_bytes_done;
+  n_bytes_total += batch->n_bytes_total;
+  n_files_done = batch->n_files_done + (guint) (batch->job_n_files * batch->job_percent / 100.0);
+
+  /* don't flood the bus if nothing happened */
+  if (n_files_done == batch->last_files_done
+      && n_bytes_done == batch->last_bytes_done
+      && batch->operations != NULL)
+    return TRUE;
+
+  batch->last_files_done = n_files_done;
+  batch->last_bytes_done = n_bytes_done;
+
+  /* estimate the rate and remaining time from the progress so far */
+  elapsed = g_get_monotonic_time () - batch->start_time;
+  if (elapsed > 0)
+    rate = (n_bytes_done * G_USEC_PER_SEC) / elapsed;
+
+  fraction = (batch->n_files_done + batch->job_n_files * batch->job_percent / 100.0) / MAX (batch->n_files, 1);
+  if (fraction > 0.0 && fraction < 1.0)
+    eta = (elapsed / (gdouble) G_USEC_PER_SEC) * (1.0 - fraction) / fraction;
+
+  thunar_dbus_thunar_emit_batch_progress (batch->dbus_service->thunar, batch->handle,
+                                          n_bytes_done, n_bytes_total,
+                                          n_files_done, batch->n_files,
+                                          rate, eta);
+
+  return TRUE;
+}
+
+
+
+static void
+thunar_dbus_service_batch_free (gpointer data)
+{
+  ThunarDBusBatch   *batch = data;
+  ThunarApplication *application;
+
+  /* stop the running job */
+  if (G_UNLIKELY (batch->job != NULL))
+    {
+      g_signal_handlers_disconnect_matched (batch->job, G_SIGNAL_MATCH_DATA, 0, 0, NULL, NULL, batch);
+      exo_job_cancel (EXO_JOB (batch->job));
+      g_object_unref (batch->job);
+    }
+
+  if (batch->progress_timer_id != 0)
+    g_source_remove (batch->progress_timer_id);
+
+  g_list_free_full (batch->operations, thunar_dbus_service_batch_operation_free);
+
+  if (batch->error != NULL)
+    g_error_free (batch->error);
+
+  g_slice_free (ThunarDBusBatch, batch);
+
+  /* the application may exit now */
+  application = thunar_application_get ();
+  g_application_release (G_APPLICATION (application));
+  g_object_unref (application);
+}
+
+
+
+static gboolean
+thunar_dbus_service_batch_operations (ThunarDBusThunar       *object,
+                                      GDBusMethodInvocation  *invocation,
+                                      const gchar            *working_directory,
+                                      GVariant               *operations,
+                                      ThunarDBusService      *dbus_service)
+{
+  ThunarDBusBatchOperation *operation;
+  ThunarApplication        *application;
+  ThunarDBusBatch          *batch;
+  GVariantIter              iter;
+  GError                   *err = NULL;
+  GList                    *operation_list = NULL;
+  GList                    *lp;
+  const gchar              *name;
+  const gchar             **source_filenames;
+  const gchar             **target_filenames;
+  gchar                    *new_working_dir = NULL;
+  gchar                    *old_working_dir = NULL;
+  guint                     n_files = 0;
+
+  /* change the working directory if necessary */
+  if (!exo_str_is_empty (working_directory))
+    old_working_dir = thunar_util_change_working_directory (working_directory);
+
+  /* parse all operations before starting the first one */
+  g_variant_iter_init (&iter, operations);
+  while (err == NULL && g_variant_iter_next (&iter, "(&s^a&s^a&s)", &name, &source_filenames, &target_filenames))
+    {
+      operation = thunar_dbus_service_batch_operation_new (name, source_filenames, target_filenames, &err);
+      if (G_LIKELY (operation != NULL))
+        operation_list = g_list_prepend (operation_list, operation);
+      g_free (source_filenames);
+      g_free (target_filenames);
+    }
+
+  /* switch back to the previous working directory */
+  if (!exo_str_is_empty (working_directory))
+    {
+      new_working_dir = thunar_util_change_working_directory (old_working_dir);
+      g_free (old_working_dir);
+      g_free (new_working_dir);
+    }
+
+  if (err == NULL && operation_list == NULL)
+    g_set_error (&err, G_FILE_ERROR, G_FILE_ERROR_INVAL, _("At least one operation must be specified"));
+
+  if (G_UNLIKELY (err != NULL))
+    {
+      g_list_free_full (operation_list, thunar_dbus_service_batch_operation_free);
+      g_dbus_method_invocation_take_error (invocation, err);
+      return TRUE;
+    }
+
+  /* allocate the batch with a new handle */
+  batch = g_slice_new0 (ThunarDBusBatch);
+  batch->dbus_service = dbus_service;
+  batch->operations = g_list_reverse (operation_list);
+  batch->start_time = g_get_monotonic_time ();
+  do
+    batch->handle = ++dbus_service->last_batch_handle;
+  while (batch->handle == 0 || g_hash_table_lookup (dbus_service->batches, GUINT_TO_POINTER (batch->handle)) != NULL);
+  g_hash_table_insert (dbus_service->batches, GUINT_TO_POINTER (batch->handle), batch);
+
+  for (lp = batch->operations; lp != NULL; lp = lp->next)
+    {
+      operation = lp->data;
+      n_files += g_list_length (operation->source_files);
+    }
+  batch->n_files = n_files;
+
+  /* keep the application alive until the batch is done */
+  application = thunar_application_get ();
+  g_application_hold (G_APPLICATION (application));
+  g_object_unref (application);
+
+  thunar_dbus_thunar_complete_batch_operations (object, invocation, batch->handle);
+
+  /* report the progress periodically and start the first operation */
+  batch->progress_timer_id = g_timeout_add (BATCH_PROGRESS_INTERVAL, thunar_dbus_service_batch_progress, batch);
+  thunar_dbus_service_batch_next (batch);
+
+  return TRUE;
+}
+
+
+
+static gboolean
+thunar_dbus_service_cancel_batch (ThunarDBusThunar       *object,
+                                  GDBusMethodInvocation  *invocation,
+                                  guint                   handle,
+                                  ThunarDBusService      *dbus_service)
+{
+  ThunarDBusBatch *batch;
+
+  batch = g_hash_table_lookup (dbus_service->batches, GUINT_TO_POINTER (handle));
+  if (G_UNLIKELY (batch == NULL))
+    {
+      g_dbus_method_invocation_return_error (invocation, G_FILE_ERROR, G_FILE_ERROR_INVAL,
+                                             _("Unknown batch %u"), handle);
+      return TRUE;
+    }
+
+  /* drop the remaining operations */
+  g_list_free_full (batch->operations, thunar_dbus_service_batch_operation_free);
+  batch->operations = NULL;
+
+  if (batch->error == NULL)
+    g_set_error_literal (&batch->error, G_IO_ERROR, G_IO_ERROR_CANCELLED, _("Operation was cancelled"));
+
+  /* the batch finishes once the running job stopped */
+  if (batch->job != NULL)
+    exo_job_cancel (EXO_JOB (batch->job));
+  else
+    thunar_dbus_service_batch_next (batch);
+
+  thunar_dbus_thunar_complete_cancel_batch (object, invocation);
+
+  return TRUE;
+}
+
+
+
 gboolean thunar_dbus_service_export_on_connection (ThunarDBusService *service,
                                                    GDBusConnection   *connection,
                                                    GError           **error)
@@ -55,6 +55,7 @@
 
 #include <thunarx/thunarx.h>
 
+#include <thunar/thunar-app-info-cache.h>
 #include <thunar/thunar-application.h>
 #include <thunar/thunar-chooser-dialog.h>
 #include <thunar/thunar-exec.h>
@@ -719,7 +720,9 @@ static void
 thunar_file_monitor_moved (ThunarFile *file,
                            GFile      *renamed_file)
 {
-  GFile *previous_file;
+  ThunarFile *cached_file;
+  GWeakRef   *ref;
+  GFile      *previous_file;
 
   /* ref the old location */
   previous_file = g_object_ref (G_OBJECT (file->gfile));
@@ -738,8 +741,12 @@ thunar_file_monitor_moved (ThunarFile *file,
 
   G_LOCK (file_cache_mutex);
 
-  /* drop the previous entry from the cache */
-  g_hash_table_remove (file_cache, previous_file);
+  /* drop the previous entry from the cache, unless another file took
+   * over that location already (i.e. two files swapped their names) */
+  ref = g_hash_table_lookup (file_cache, previous_file);
+  cached_file = (ref != NULL) ? g_weak_ref_get (ref) : NULL;
+  if (cached_file == NULL || cached_file == file)
+    g_hash_table_remove (file_cache, previous_file);
 
   /* drop the reference on the previous file */
   g_object_unref (previous_file);
@@ -750,6 +757,10 @@ thunar_file_monitor_moved (ThunarFile *file,
                        weak_ref_new (G_OBJECT (file)));
 
   G_UNLOCK (file_cache_mutex);
+
+  /* release the cached file outside the lock, its finalize takes it */
+  if (cached_file != NULL)
+    g_object_unref (cached_file);
 }
 
 
@@ -1985,6 +1996,30 @@ thunar_file_rename (ThunarFile   *file,
 
 
 
+/**
+ * thunar_file_moved:
+ * @file         : a #ThunarFile instance.
+ * @renamed_file : the new location of @file.
+ *
+ * Tells @file that it was renamed to @renamed_file behind its back,
+ * e.g. by a job that renamed a batch of files directly. This updates
+ * the location of @file and the file cache, but does not emit any
+ * signals; the caller has to do that from the main loop.
+ **/
+void
+thunar_file_moved (ThunarFile *file,
+                   GFile      *renamed_file)
+{
+  _thunar_return_if_fail (THUNAR_IS_FILE (file));
+  _thunar_return_if_fail (G_IS_FILE (renamed_file));
+
+  G_LOCK (file_rename_mutex);
+  thunar_file_monitor_moved (file, renamed_file);
+  G_UNLOCK (file_rename_mutex);
+}
+
+
+
 /**
  * thunar_file_accepts_drop:
  * @file                    : a #ThunarFile instance.
@@ -2587,10 +2622,11 @@ thunar_file_get_size (const ThunarFile *file)
 GAppInfo *
 thunar_file_get_default_handler (const ThunarFile *file) 
 {
-  const gchar *content_type;
-  GAppInfo    *app_info = NULL;
-  gboolean     must_support_uris = FALSE;
-  gchar       *path;
+  ThunarAppInfoCache *app_info_cache;
+  const gchar        *content_type;
+  GAppInfo           *app_info = NULL;
+  gboolean            must_support_uris = FALSE;
+  gchar              *path;
 
   _thunar_return_val_if_fail (THUNAR_IS_FILE (file), NULL);
 
@@ -2601,7 +2637,9 @@ thunar_file_get_default_handler (const ThunarFile *file)
       must_support_uris = (path == NULL);
       g_free (path);
 
-      app_info = g_app_info_get_default_for_type (content_type, must_support_uris);
+      app_info_cache = thunar_app_info_cache_get ();
+      app_info = thunar_app_info_cache_get_default_for_type (app_info_cache, content_type, must_support_uris);
+      g_object_unref (app_info_cache);
     }
 
   if (app_info == NULL)
@@ -4220,35 +4258,53 @@ compare_app_infos (gconstpointer a,
 GList*
 thunar_file_list_get_applications (GList *file_list)
 {
-  GList       *applications = NULL;
-  GList       *list;
-  GList       *next;
-  GList       *ap;
-  GList       *lp;
-  GAppInfo    *default_application;
-  const gchar *previous_type = NULL;
-  const gchar *current_type;
-
-  /* determine the set of applications that can open all files */
+  ThunarAppInfoCache *app_info_cache;
+  GHashTable         *types;
+  GHashTable         *app_ids;
+  GPtrArray          *type_list;
+  GList              *applications = NULL;
+  GList              *list;
+  GList              *next;
+  GList              *ap;
+  GList              *lp;
+  GAppInfo           *default_application;
+  const gchar        *current_type;
+  const gchar        *app_id;
+  guint               n;
+
+  /* collect the distinct content types of the files, in the order
+   * they appear, so large selections with only a few types are cheap */
+  types = g_hash_table_new (g_str_hash, g_str_equal);
+  type_list = g_ptr_array_new ();
   for (lp = file_list; lp != NULL; lp = lp->next)
     {
       current_type = thunar_file_get_content_type (lp->data);
 
-      /* no need to check anything if this file has the same mimetype as the previous file */
-      if (current_type != NULL && previous_type != NULL)
-        if (G_LIKELY (g_content_type_equals (previous_type, current_type)))
-          continue;
-
-      /* store the previous type */
-      previous_type = current_type;
+      /* no application can open a file without a type */
+      if (G_UNLIKELY (current_type == NULL))
+        {
+          g_ptr_array_set_size (type_list, 0);
+          break;
+        }
 
-      /* determine the list of applications that can open this file */
-      if (G_UNLIKELY (current_type != NULL))
+      if (g_hash_table_lookup (types, current_type) == NULL)
         {
-          list = g_app_info_get_all_for_type (current_type);
+          g_hash_table_insert (types, (gpointer) current_type, (gpointer) current_type);
+          g_ptr_array_add (type_list, (gpointer) current_type);
+        }
+    }
+
+  /* determine the set of applications that can open all types */
+  app_info_cache = thunar_app_info_cache_get ();
+  for (n = 0; n < type_list->len; ++n)
+    {
+      current_type = g_ptr_array_index (type_list, n);
+      list = thunar_app_info_cache_get_all_for_type (app_info_cache, current_type);
 
+      if (G_UNLIKELY (n == 0))
+        {
           /* move any default application in front of the list */
-          default_application = g_app_info_get_default_for_type (current_type, FALSE);
+          default_application = thunar_app_info_cache_get_default_for_type (app_info_cache, current_type, FALSE);
           if (G_LIKELY (default_application != NULL))
             {
               for (ap = list; ap != NULL; ap = ap->next)
@@ -4262,17 +4318,21 @@ thunar_file_list_get_applications (GList *file_list)
                 }
               list = g_list_prepend (list, default_application);
             }
-        }
-      else
-        list = NULL;
 
-      if (G_UNLIKELY (applications == NULL))
-        {
-          /* first file, so just use the applications list */
+          /* first type, so just use the applications list */
           applications = list;
         }
       else
         {
+          /* collect the ids of the applications for this type */
+          app_ids = g_hash_table_new (g_str_hash, g_str_equal);
+          for (ap = list; ap != NULL; ap = ap->next)
+            {
+              app_id = g_app_info_get_id (ap->data);
+              if (G_LIKELY (app_id != NULL))
+                g_hash_table_insert (app_ids, (gpointer) app_id, ap->data);
+            }
+
           /* keep only the applications that are also present in list */
           for (ap = applications; ap != NULL; ap = next)
             {
@@ -4280,7 +4340,10 @@ thunar_file_list_get_applications (GList *file_list)
               next = ap->next;
 
               /* check if the application is present in list */
-              if (g_list_find_custom (list, ap->data, compare_app_infos) == NULL)
+              app_id = g_app_info_get_id (ap->data);
+              if (app_id != NULL
+                  ? g_hash_table_lookup (app_ids, app_id) == NULL
+                  : g_list_find_custom (list, ap->data, compare_app_infos) == NULL)
                 {
                   /* drop our reference on the application */
                   g_object_unref (G_OBJECT (ap->data));
@@ -4290,7 +4353,8 @@ thunar_file_list_get_applications (GList *file_list)
                 }
             }
 
-          /* release the list of applications for this file */
+          /* release the list of applications for this type */
+          g_hash_table_destroy (app_ids);
           g_list_free_full (list, g_object_unref);
         }
 
@@ -4299,6 +4363,10 @@ thunar_file_list_get_applications (GList *file_list)
         break;
     }
 
+  g_object_unref (app_info_cache);
+  g_ptr_array_free (type_list, TRUE);
+  g_hash_table_destroy (types);
+
   /* remove hidden applications */
   for (ap = applications; ap != NULL; ap = next)
     {
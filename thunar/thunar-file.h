@@ -154,6 +154,8 @@ gboolean          thunar_file_rename                     (ThunarFile
                                                           GCancellable           *cancellable,
                                                           gboolean                called_from_job,
                                                           GError                **error);
+void              thunar_file_moved                      (ThunarFile             *file,
+                                                          GFile                  *renamed_file);
 
 GdkDragAction     thunar_file_accepts_drop               (ThunarFile             *file,
                                                           GList                  *path_list,
@@ -0,0 +1,559 @@
+/* vi:set et ai sw=2 sts=2 ts=2: */
+/*-
+ * Copyright (c) 2015 Xfce Development Team <xfce4-dev@xfce.org>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the Free
+ * Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* The filesystem cache answers free space queries from memory, so the
+ * statusbar, the side pane and the properties dialog never wait for a
+ * (possibly stale) mount on the main thread. Entries are keyed by the
+ * mount point of the file when it is known and by the file itself
+ * otherwise. Unknown entries are queried asynchronously, the known ones
+ * are refreshed on a timer and when devices change, and ::changed is
+ * emitted whenever new values arrive. */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#ifdef HAVE_STRING_H
+#include <string.h>
+#endif
+
+#include <gio/gio.h>
+#ifdef HAVE_GIO_UNIX
+#include <gio/gunixmounts.h>
+#endif
+
+#include <libxfce4util/libxfce4util.h>
+
+#include <thunarx/thunarx.h>
+
+#include <thunar/thunar-device-monitor.h>
+#include <thunar/thunar-filesystem-cache.h>
+#include <thunar/thunar-private.h>
+
+
+
+/* seconds between refreshes of the cached values */
+#define REFRESH_INTERVAL (30)
+
+/* entries nobody asked for this long are dropped */
+#define EXPIRE_TIME (5 * 60 * G_USEC_PER_SEC)
+
+
+
+/* Signal identifiers */
+enum
+{
+  CHANGED,
+  LAST_SIGNAL,
+};
+
+
+
+typedef struct _ThunarFilesystemCacheEntry ThunarFilesystemCacheEntry;
+
+
+
+static void     thunar_filesystem_cache_finalize       (GObject                    *object);
+static GFile   *thunar_filesystem_cache_get_root       (ThunarFilesystemCache      *cache,
+                                                        GFile                      *file);
+static void     thunar_filesystem_cache_refresh_all    (ThunarFilesystemCache      *cache);
+static gboolean thunar_filesystem_cache_refresh_timer  (gpointer                    user_data);
+static void     thunar_filesystem_cache_device_changed (ThunarDeviceMonitor        *device_monitor,
+                                                        ThunarDevice               *device,
+                                                        ThunarFilesystemCache      *cache);
+static void     thunar_filesystem_cache_entry_query    (ThunarFilesystemCacheEntry *entry);
+static void     thunar_filesystem_cache_entry_ready    (GObject                    *object,
+                                                        GAsyncResult               *result,
+                                                        gpointer                    user_data);
+static void     thunar_filesystem_cache_entry_free     (gpointer                    data);
+
+
+
+struct _ThunarFilesystemCacheClass
+{
+  GObjectClass __parent__;
+};
+
+struct _ThunarFilesystemCache
+{
+  GObject              __parent__;
+
+  ThunarDeviceMonitor *device_monitor;
+
+  /* GFile of the root -> ThunarFilesystemCacheEntry */
+  GHashTable          *entries;
+
+  guint                refresh_timer_id;
+
+#ifdef HAVE_GIO_UNIX
+  /* paths of the mounted filesystems, longest first */
+  GList               *mount_paths;
+  guint64              mount_paths_time;
+#endif
+};
+
+struct _ThunarFilesystemCacheEntry
+{
+  /* NULL once the entry was dropped from the cache while
+   * a query was still running, the query frees it then */
+  ThunarFilesystemCache *cache;
+
+  GFile                 *root;
+
+  /* the running query, if any */
+  GCancellable          *cancellable;
+
+  gint64                 last_used;
+
+  guint64                fs_free;
+  guint64                fs_size;
+  guint                  has_free : 1;
+  guint                  has_size : 1;
+};
+
+
+
+static guint filesystem_cache_signals[LAST_SIGNAL];
+
+
+
+G_DEFINE_TYPE (ThunarFilesystemCache, thunar_filesystem_cache, G_TYPE_OBJECT)
+
+
+
+static void
+thunar_filesystem_cache_class_init (ThunarFilesystemCacheClass *klass)
+{
+  GObjectClass *gobject_class;
+
+  gobject_class = G_OBJECT_CLASS (klass);
+  gobject_class->finalize = thunar_filesystem_cache_finalize;
+
+  /**
+   * ThunarFilesystemCache::changed:
+   * @cache : a #ThunarFilesystemCache.
+   * @root  : the mount point or folder whose values changed.
+   *
+   * Emitted whenever the cached free space of @root changed,
+   * including when it is known for the first time.
+   **/
+  filesystem_cache_signals[CHANGED] =
+    g_signal_new (I_("changed"),
+                  G_TYPE_FROM_CLASS (klass),
+                  G_SIGNAL_NO_HOOKS,
+                  0, NULL, NULL,
+                  g_cclosure_marshal_VOID__OBJECT,
+                  G_TYPE_NONE, 1, G_TYPE_FILE);
+}
+
+
+
+static void
+thunar_filesystem_cache_init (ThunarFilesystemCache *cache)
+{
+  cache->entries = g_hash_table_new_full (g_file_hash, (GEqualFunc) g_file_equal,
+                                          NULL, thunar_filesystem_cache_entry_free);
+
+  /* refresh the values when devices are (un)mounted */
+  cache->device_monitor = thunar_device_monitor_get ();
+  g_signal_connect (cache->device_monitor, "device-added", G_CALLBACK (thunar_filesystem_cache_device_changed), cache);
+  g_signal_connect (cache->device_monitor, "device-removed", G_CALLBACK (thunar_filesystem_cache_device_changed), cache);
+  g_signal_connect (cache->device_monitor, "device-changed", G_CALLBACK (thunar_filesystem_cache_device_changed), cache);
+}
+
+
+
+static void
+thunar_filesystem_cache_finalize (GObject *object)
+{
+  ThunarFilesystemCache *cache = THUNAR_FILESYSTEM_CACHE (object);
+
+  /* stop refreshing */
+  if (cache->refresh_timer_id != 0)
+    g_source_remove (cache->refresh_timer_id);
+
+  /* disconnect from the device monitor */
+  g_signal_handlers_disconnect_matched (cache->device_monitor, G_SIGNAL_MATCH_DATA, 0, 0, NULL, NULL, cache);
+  g_object_unref (cache->device_monitor);
+
+  /* release the entries, running queries are cancelled */
+  g_hash_table_destroy (cache->entries);
+
+#ifdef HAVE_GIO_UNIX
+  g_list_free_full (cache->mount_paths, g_free);
+#endif
+
+  (*G_OBJECT_CLASS (thunar_filesystem_cache_parent_class)->finalize) (object);
+}
+
+
+
+#ifdef HAVE_GIO_UNIX
+static gint
+thunar_filesystem_cache_compare_paths (gconstpointer a,
+                                       gconstpointer b)
+{
+  /* longest path first */
+  return (gint) strlen (b) - (gint) strlen (a);
+}
+#endif
+
+
+
+static GFile *
+thunar_filesystem_cache_get_root (ThunarFilesystemCache *cache,
+                                  GFile                 *file)
+{
+#ifdef HAVE_GIO_UNIX
+  GUnixMountEntry *mount;
+  GList           *mounts;
+  GList           *lp;
+  GFile           *root = NULL;
+  gchar           *path;
+  gsize            len;
+
+  path = g_file_is_native (file) ? g_file_get_path (file) : NULL;
+  if (G_LIKELY (path != NULL))
+    {
+      /* reload the mount paths if the mount table changed, this only
+       * reads the table of the kernel and never touches a mount */
+      if (cache->mount_paths == NULL || g_unix_mounts_changed_since (cache->mount_paths_time))
+        {
+          g_list_free_full (cache->mount_paths, g_free);
+          cache->mount_paths = NULL;
+
+          mounts = g_unix_mounts_get (&cache->mount_paths_time);
+          for (lp = mounts; lp != NULL; lp = lp->next)
+            {
+              mount = lp->data;
+              cache->mount_paths = g_list_prepend (cache->mount_paths, g_strdup (g_unix_mount_get_mount_path (mount)));
+              g_unix_mount_free (mount);
+            }
+          g_list_free (mounts);
+
+          cache->mount_paths = g_list_sort (cache->mount_paths, thunar_filesystem_cache_compare_paths);
+        }
+
+      /* the longest mount path containing the file is its mount point */
+      for (lp = cache->mount_paths; root == NULL && lp != NULL; lp = lp->next)
+        {
+          len = strlen (lp->data);
+          if (strncmp (path, lp->data, len) == 0
+              && (path[len] == '\0' || path[len] == G_DIR_SEPARATOR || len == 1))
+            root = g_file_new_for_path (lp->data);
+        }
+
+      g_free (path);
+
+      if (G_LIKELY (root != NULL))
+        return root;
+    }
+#endif
+
+  /* cache the folder itself */
+  return g_object_ref (file);
+}
+
+
+
+static void
+thunar_filesystem_cache_refresh_all (ThunarFilesystemCache *cache)
+{
+  GHashTableIter iter;
+  gpointer       value;
+
+  g_hash_table_iter_init (&iter, cache->entries);
+  while (g_hash_table_iter_next (&iter, NULL, &value))
+    thunar_filesystem_cache_entry_query (value);
+}
+
+
+
+static gboolean
+thunar_filesystem_cache_refresh_timer (gpointer user_data)
+{
+  ThunarFilesystemCache      *cache = THUNAR_FILESYSTEM_CACHE (user_data);
+  ThunarFilesystemCacheEntry *entry;
+  GHashTableIter              iter;
+  gpointer                    value;
+  gint64                      now;
+
+  now = g_get_monotonic_time ();
+
+  g_hash_table_iter_init (&iter, cache->entries);
+  while (g_hash_table_iter_next (&iter, NULL, &value))
+    {
+      entry = value;
+
+      /* drop entries nobody is interested in anymore */
+      if (now - entry->last_used > EXPIRE_TIME)
+        g_hash_table_iter_remove (&iter);
+      else
+        thunar_filesystem_cache_entry_query (entry);
+    }
+
+  /* keep refreshing while there are entries */
+  if (g_hash_table_size (cache->entries) > 0)
+    return TRUE;
+
+  cache->refresh_timer_id = 0;
+  return FALSE;
+}
+
+
+
+static void
+thunar_filesystem_cache_device_changed (ThunarDeviceMonitor   *device_monitor,
+                                        ThunarDevice          *device,
+                                        ThunarFilesystemCache *cache)
+{
+  _thunar_return_if_fail (THUNAR_IS_FILESYSTEM_CACHE (cache));
+
+  /* the free space of any mount could be different now */
+  thunar_filesystem_cache_refresh_all (cache);
+}
+
+
+
+static void
+thunar_filesystem_cache_entry_query (ThunarFilesystemCacheEntry *entry)
+{
+  /* don't stack queries, e.g. for a mount that stopped responding */
+  if (entry->cancellable != NULL)
+    return;
+
+  entry->cancellable = g_cancellable_new ();
+  g_file_query_filesystem_info_async (entry->root, THUNARX_FILESYSTEM_INFO_NAMESPACE,
+                                      G_PRIORITY_LOW, entry->cancellable,
+                                      thunar_filesystem_cache_entry_ready, entry);
+}
+
+
+
+static void
+thunar_filesystem_cache_entry_ready (GObject      *object,
+                                     GAsyncResult *result,
+                                     gpointer      user_data)
+{
+  ThunarFilesystemCacheEntry *entry = user_data;
+  GFileInfo                  *info;
+  gboolean                    has_free = FALSE;
+  gboolean                    has_size = FALSE;
+  guint64                     fs_free = 0;
+  guint64                     fs_size = 0;
+
+  info = g_file_query_filesystem_info_finish (G_FILE (object), result, NULL);
+
+  /* the query is done */
+  g_object_unref (entry->cancellable);
+  entry->cancellable = NULL;
+
+  /* release the entry if it was dropped from the cache meanwhile */
+  if (G_UNLIKELY (entry->cache == NULL))
+    {
+      if (info != NULL)
+        g_object_unref (info);
+      thunar_filesystem_cache_entry_free (entry);
+      return;
+    }
+
+  if (G_LIKELY (info != NULL))
+    {
+      has_free = g_file_info_has_attribute (info, G_FILE_ATTRIBUTE_FILESYSTEM_FREE);
+      fs_free = g_file_info_get_attribute_uint64 (info, G_FILE_ATTRIBUTE_FILESYSTEM_FREE);
+      has_size = g_file_info_has_attribute (info, G_FILE_ATTRIBUTE_FILESYSTEM_SIZE);
+      fs_size = g_file_info_get_attribute_uint64 (info, G_FILE_ATTRIBUTE_FILESYSTEM_SIZE);
+      g_object_unref (info);
+    }
+
+  /* nothing to tell if the values are the same */
+  if (entry->has_free == has_free && entry->fs_free == fs_free
+      && entry->has_size == has_size && entry->fs_size == fs_size)
+    return;
+
+  entry->has_free = has_free;
+  entry->fs_free = fs_free;
+  entry->has_size = has_size;
+  entry->fs_size = fs_size;
+
+  g_signal_emit (entry->cache, filesystem_cache_signals[CHANGED], 0, entry->root);
+}
+
+
+
+static void
+thunar_filesystem_cache_entry_free (gpointer data)
+{
+  ThunarFilesystemCacheEntry *entry = data;
+
+  /* let the running query release the entry */
+  if (entry->cancellable != NULL)
+    {
+      entry->cache = NULL;
+      g_cancellable_cancel (entry->cancellable);
+      return;
+    }
+
+  g_object_unref (entry->root);
+  g_slice_free (ThunarFilesystemCacheEntry, entry);
+}
+
+
+
+/**
+ * thunar_filesystem_cache_get:
+ *
+ * Returns a reference to the shared #ThunarFilesystemCache. The
+ * caller is responsible to free the returned object using
+ * g_object_unref() when no longer needed.
+ *
+ * Return value: the shared #ThunarFilesystemCache.
+ **/
+ThunarFilesystemCache *
+thunar_filesystem_cache_get (void)
+{
+  static ThunarFilesystemCache *cache = NULL;
+
+  if (G_UNLIKELY (cache == NULL))
+    {
+      cache = g_object_new (THUNAR_TYPE_FILESYSTEM_CACHE, NULL);
+      g_object_add_weak_pointer (G_OBJECT (cache), (gpointer) &cache);
+    }
+  else
+    {
+      g_object_ref (G_OBJECT (cache));
+    }
+
+  return cache;
+}
+
+
+
+/**
+ * thunar_filesystem_cache_get_free_space:
+ * @cache             : a #ThunarFilesystemCache.
+ * @file              : a #GFile.
+ * @fs_free_return    : return location for the amount of free space or %NULL.
+ * @fs_size_return    : return location for the total volume size or %NULL.
+ *
+ * Determines the free space of the volume containing @file from the
+ * cache, without blocking. If the volume is not in the cache yet, it
+ * is queried in the background, ::changed is emitted once the values
+ * are known, and %FALSE is returned.
+ *
+ * Return value: %TRUE if the values are known, else %FALSE.
+ **/
+gboolean
+thunar_filesystem_cache_get_free_space (ThunarFilesystemCache *cache,
+                                        GFile                 *file,
+                                        guint64               *fs_free_return,
+                                        guint64               *fs_size_return)
+{
+  ThunarFilesystemCacheEntry *entry;
+  gboolean                    success;
+  GFile                      *root;
+
+  _thunar_return_val_if_fail (THUNAR_IS_FILESYSTEM_CACHE (cache), FALSE);
+  _thunar_return_val_if_fail (G_IS_FILE (file), FALSE);
+
+  root = thunar_filesystem_cache_get_root (cache, file);
+
+  entry = g_hash_table_lookup (cache->entries, root);
+  if (G_UNLIKELY (entry == NULL))
+    {
+      entry = g_slice_new0 (ThunarFilesystemCacheEntry);
+      entry->cache = cache;
+      entry->root = root;
+      g_hash_table_insert (cache->entries, entry->root, entry);
+
+      /* query the values in the background */
+      thunar_filesystem_cache_entry_query (entry);
+
+      /* start refreshing the cache */
+      if (cache->refresh_timer_id == 0)
+        cache->refresh_timer_id = g_timeout_add_seconds (REFRESH_INTERVAL, thunar_filesystem_cache_refresh_timer, cache);
+    }
+  else
+    {
+      g_object_unref (root);
+    }
+
+  entry->last_used = g_get_monotonic_time ();
+
+  /* only succeed if all the requested values are known */
+  success = entry->has_free || entry->has_size;
+
+  if (fs_free_return != NULL)
+    {
+      *fs_free_return = entry->fs_free;
+      success = success && entry->has_free;
+    }
+
+  if (fs_size_return != NULL)
+    {
+      *fs_size_return = entry->fs_size;
+      success = success && entry->has_size;
+    }
+
+  return success;
+}
+
+
+
+/**
+ * thunar_filesystem_cache_get_free_space_string:
+ * @cache            : a #ThunarFilesystemCache.
+ * @file             : a #GFile.
+ * @file_size_binary : whether to use binary units.
+ *
+ * Like thunar_filesystem_cache_get_free_space(), but returns a
+ * human readable description of the free and total space.
+ *
+ * Return value: the description or %NULL if not known (yet).
+ **/
+gchar *
+thunar_filesystem_cache_get_free_space_string (ThunarFilesystemCache *cache,
+                                               GFile                 *file,
+                                               gboolean               file_size_binary)
+{
+  gchar   *fs_free_str;
+  gchar   *fs_size_str;
+  guint64  fs_free;
+  guint64  fs_size;
+  gchar   *fs_string = NULL;
+
+  _thunar_return_val_if_fail (THUNAR_IS_FILESYSTEM_CACHE (cache), NULL);
+  _thunar_return_val_if_fail (G_IS_FILE (file), NULL);
+
+  if (thunar_filesystem_cache_get_free_space (cache, file, &fs_free, &fs_size)
+      && fs_size > 0)
+    {
+      fs_free_str = g_format_size_full (fs_free, file_size_binary ? G_FORMAT_SIZE_IEC_UNITS : G_FORMAT_SIZE_DEFAULT);
+      fs_size_str = g_format_size_full (fs_size, file_size_binary ? G_FORMAT_SIZE_IEC_UNITS : G_FORMAT_SIZE_DEFAULT);
+      /* free disk space string */
+      fs_string = g_strdup_printf (_("%s of %s free (%d%% used)"),
+                                   fs_free_str, fs_size_str,
+                                   (gint) ((fs_size - fs_free) * 100 / fs_size));
+      g_free (fs_free_str);
+      g_free (fs_size_str);
+    }
+
+  return fs_string;
+}
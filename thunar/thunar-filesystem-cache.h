@@ -0,0 +1,52 @@
+/* vi:set et ai sw=2 sts=2 ts=2: */
+/*-
+ * Copyright (c) 2015 Xfce Development Team <xfce4-dev@xfce.org>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the Free
+ * Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __THUNAR_FILESYSTEM_CACHE_H__
+#define __THUNAR_FILESYSTEM_CACHE_H__
+
+#include <gio/gio.h>
+
+G_BEGIN_DECLS;
+
+typedef struct _ThunarFilesystemCacheClass ThunarFilesystemCacheClass;
+typedef struct _ThunarFilesystemCache      ThunarFilesystemCache;
+
+#define THUNAR_TYPE_FILESYSTEM_CACHE            (thunar_filesystem_cache_get_type ())
+#define THUNAR_FILESYSTEM_CACHE(obj)            (G_TYPE_CHECK_INSTANCE_CAST ((obj), THUNAR_TYPE_FILESYSTEM_CACHE, ThunarFilesystemCache))
+#define THUNAR_FILESYSTEM_CACHE_CLASS(klass)    (G_TYPE_CHECK_CLASS_CAST ((klass), THUNAR_TYPE_FILESYSTEM_CACHE, ThunarFilesystemCacheClass))
+#define THUNAR_IS_FILESYSTEM_CACHE(obj)         (G_TYPE_CHECK_INSTANCE_TYPE ((obj), THUNAR_TYPE_FILESYSTEM_CACHE))
+#define THUNAR_IS_FILESYSTEM_CACHE_CLASS(klass) (G_TYPE_CHECK_CLASS_TYPE ((klass), THUNAR_TYPE_FILESYSTEM_CACHE))
+#define THUNAR_FILESYSTEM_CACHE_GET_CLASS(obj)  (G_TYPE_INSTANCE_GET_CLASS ((obj), THUNAR_TYPE_FILESYSTEM_CACHE, ThunarFilesystemCacheClass))
+
+GType                  thunar_filesystem_cache_get_type              (void) G_GNUC_CONST;
+
+ThunarFilesystemCache *thunar_filesystem_cache_get                   (void);
+
+gboolean               thunar_filesystem_cache_get_free_space        (ThunarFilesystemCache *cache,
+                                                                      GFile                 *file,
+                                                                      guint64               *fs_free_return,
+                                                                      guint64               *fs_size_return);
+gchar                 *thunar_filesystem_cache_get_free_space_string (ThunarFilesystemCache *cache,
+                                                                      GFile                 *file,
+                                                                      gboolean               file_size_binary) G_GNUC_MALLOC;
+
+G_END_DECLS;
+
+#endif /* !__THUNAR_FILESYSTEM_CACHE_H__ */
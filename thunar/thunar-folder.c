@@ -83,6 +83,9 @@ static void     thunar_folder_monitor                     (GFileMonitor
                                                            GFile                  *other_file,
                                                            GFileMonitorEvent       event_type,
                                                            gpointer                user_data);
+static void     thunar_folder_monitor_directory           (GObject                *object,
+                                                           GAsyncResult           *result,
+                                                           gpointer                user_data);
 
 
 
@@ -115,6 +118,7 @@ struct _ThunarFolder
   guint              content_type_idle_id;
 
   guint              in_destruction : 1;
+  guint              directories_only : 1;
 
   ThunarFileMonitor *file_monitor;
 
@@ -125,6 +129,7 @@ struct _ThunarFolder
 
 static guint  folder_signals[LAST_SIGNAL];
 static GQuark thunar_folder_quark;
+static GQuark thunar_folder_directories_quark;
 
 
 
@@ -303,7 +308,9 @@ thunar_folder_finalize (GObject *object)
   if (G_LIKELY (folder->corresponding_file != NULL))
     {
       /* drop the reference */
-      g_object_set_qdata (G_OBJECT (folder->corresponding_file), thunar_folder_quark, NULL);
+      g_object_set_qdata (G_OBJECT (folder->corresponding_file),
+                          folder->directories_only ? thunar_folder_directories_quark : thunar_folder_quark,
+                          NULL);
       g_object_unref (G_OBJECT (folder->corresponding_file));
     }
 
@@ -746,16 +753,32 @@ thunar_folder_monitor (GFileMonitor     *monitor,
       /* if we don't have it, add it if the event is not an "deleted" event */
       if (G_UNLIKELY (lp == NULL && event_type != G_FILE_MONITOR_EVENT_DELETED))
         {
-          /* allocate a file for the path */
-          file = thunar_file_get (event_file, NULL);
-          if (G_UNLIKELY (file != NULL))
+          /* folders that only list directories only care about new
+           * files and need to know their type first, so query just
+           * the type without blocking */
+          if (folder->directories_only)
+            {
+              if (event_type == G_FILE_MONITOR_EVENT_CREATED)
+                {
+                  g_file_query_info_async (event_file, G_FILE_ATTRIBUTE_STANDARD_TYPE,
+                                           G_FILE_QUERY_INFO_NONE, G_PRIORITY_DEFAULT, NULL,
+                                           thunar_folder_monitor_directory,
+                                           g_object_ref (folder));
+                }
+            }
+          else
             {
-              /* prepend it to our internal list */
-              folder->files = g_list_prepend (folder->files, file);
+              /* allocate a file for the path */
+              file = thunar_file_get (event_file, NULL);
+              if (G_UNLIKELY (file != NULL))
+                {
+                  /* prepend it to our internal list */
+                  folder->files = g_list_prepend (folder->files, file);
 
-              /* tell others about the new file */
-              list.data = file; list.next = list.prev = NULL;
-              g_signal_emit (G_OBJECT (folder), folder_signals[FILES_ADDED], 0, &list);
+                  /* tell others about the new file */
+                  list.data = file; list.next = list.prev = NULL;
+                  g_signal_emit (G_OBJECT (folder), folder_signals[FILES_ADDED], 0, &list);
+                }
             }
         }
       else if (lp != NULL)
@@ -839,24 +862,62 @@ thunar_folder_monitor (GFileMonitor     *monitor,
 
 
 
-/**
- * thunar_folder_get_for_file:
- * @file : a #ThunarFile.
- *
- * Opens the specified @file as #ThunarFolder and
- * returns a reference to the folder.
- *
- * The caller is responsible to free the returned
- * object using g_object_unref() when no longer
- * needed.
- *
- * Return value: the #ThunarFolder which corresponds
- *               to @file.
- **/
-ThunarFolder*
-thunar_folder_get_for_file (ThunarFile *file)
+static void
+thunar_folder_monitor_directory (GObject      *object,
+                                 GAsyncResult *result,
+                                 gpointer      user_data)
+{
+  ThunarFolder *folder = THUNAR_FOLDER (user_data);
+  ThunarFile   *file;
+  GFileInfo    *info;
+  GList         list;
+
+  _thunar_return_if_fail (G_IS_FILE (object));
+  _thunar_return_if_fail (THUNAR_IS_FOLDER (folder));
+
+  info = g_file_query_info_finish (G_FILE (object), result, NULL);
+  if (G_LIKELY (info != NULL))
+    {
+      /* only directories get a file, if the folder is being
+       * reloaded, the new listing will contain it anyway */
+      if (g_file_info_get_file_type (info) == G_FILE_TYPE_DIRECTORY
+          && folder->job == NULL)
+        {
+          file = thunar_file_get (G_FILE (object), NULL);
+          if (G_LIKELY (file != NULL))
+            {
+              if (g_list_find (folder->files, file) == NULL)
+                {
+                  /* prepend it to our internal list */
+                  folder->files = g_list_prepend (folder->files, file);
+
+                  /* tell others about the new file */
+                  list.data = file; list.next = list.prev = NULL;
+                  g_signal_emit (G_OBJECT (folder), folder_signals[FILES_ADDED], 0, &list);
+                }
+              else
+                {
+                  /* the folder knows about it already */
+                  g_object_unref (G_OBJECT (file));
+                }
+            }
+        }
+
+      g_object_unref (info);
+    }
+
+  /* release the reference taken in thunar_folder_monitor() */
+  g_object_unref (G_OBJECT (folder));
+}
+
+
+
+static ThunarFolder*
+thunar_folder_get_internal (ThunarFile *file,
+                            gboolean    directories_only)
 {
   ThunarFolder *folder;
+  GQuark        quark;
 
   _thunar_return_val_if_fail (THUNAR_IS_FILE (file), NULL);
 
@@ -870,12 +931,18 @@ thunar_folder_get_for_file (ThunarFile *file)
   if (!thunar_file_is_directory (file))
     return NULL;
 
-  /* determine the "thunar-folder" quark on-demand */
+  /* determine the quarks on-demand */
   if (G_UNLIKELY (thunar_folder_quark == 0))
-    thunar_folder_quark = g_quark_from_static_string ("thunar-folder");
+    {
+      thunar_folder_quark = g_quark_from_static_string ("thunar-folder");
+      thunar_folder_directories_quark = g_quark_from_static_string ("thunar-folder-directories");
+    }
+
+  /* directory listings are shared separately from the complete ones */
+  quark = directories_only ? thunar_folder_directories_quark : thunar_folder_quark;
 
   /* check if we already know that folder */
-  folder = g_object_get_qdata (G_OBJECT (file), thunar_folder_quark);
+  folder = g_object_get_qdata (G_OBJECT (file), quark);
   if (G_UNLIKELY (folder != NULL))
     {
       g_object_ref (G_OBJECT (folder));
@@ -884,9 +951,10 @@ thunar_folder_get_for_file (ThunarFile *file)
     {
       /* allocate the new instance */
       folder = g_object_new (THUNAR_TYPE_FOLDER, "corresponding-file", file, NULL);
+      folder->directories_only = directories_only;
 
       /* connect the folder to the file */
-      g_object_set_qdata (G_OBJECT (file), thunar_folder_quark, folder);
+      g_object_set_qdata (G_OBJECT (file), quark, folder);
 
       /* schedule the loading of the folder */
       thunar_folder_reload (folder, FALSE);
@@ -897,6 +965,53 @@ thunar_folder_get_for_file (ThunarFile *file)
 
 
 
+/**
+ * thunar_folder_get_for_file:
+ * @file : a #ThunarFile.
+ *
+ * Opens the specified @file as #ThunarFolder and
+ * returns a reference to the folder.
+ *
+ * The caller is responsible to free the returned
+ * object using g_object_unref() when no longer
+ * needed.
+ *
+ * Return value: the #ThunarFolder which corresponds
+ *               to @file.
+ **/
+ThunarFolder*
+thunar_folder_get_for_file (ThunarFile *file)
+{
+  return thunar_folder_get_internal (file, FALSE);
+}
+
+
+
+/**
+ * thunar_folder_get_directories_for_file:
+ * @file : a #ThunarFile.
+ *
+ * Like thunar_folder_get_for_file(), but the returned
+ * #ThunarFolder only contains the subdirectories of
+ * @file. No #ThunarFile<!---->s are created for any
+ * other children, which makes this a lot cheaper
+ * for directories with many files.
+ *
+ * The caller is responsible to free the returned
+ * object using g_object_unref() when no longer
+ * needed.
+ *
+ * Return value: the directories-only #ThunarFolder
+ *               which corresponds to @file.
+ **/
+ThunarFolder*
+thunar_folder_get_directories_for_file (ThunarFile *file)
+{
+  return thunar_folder_get_internal (file, TRUE);
+}
+
+
+
 /**
  * thunar_folder_get_corresponding_file:
  * @folder : a #ThunarFolder instance.
@@ -998,7 +1113,10 @@ thunar_folder_reload (ThunarFolder *folder,
   folder->new_files = NULL;
 
   /* start a new job */
-  folder->job = thunar_io_jobs_list_directory (thunar_file_get_file (folder->corresponding_file));
+  if (folder->directories_only)
+    folder->job = thunar_io_jobs_list_directories (thunar_file_get_file (folder->corresponding_file));
+  else
+    folder->job = thunar_io_jobs_list_directory (thunar_file_get_file (folder->corresponding_file));
   g_signal_connect (folder->job, "error", G_CALLBACK (thunar_folder_error), folder);
   g_signal_connect (folder->job, "finished", G_CALLBACK (thunar_folder_finished), folder);
   g_signal_connect (folder->job, "files-ready", G_CALLBACK (thunar_folder_files_ready), folder);
@@ -32,6 +32,7 @@
 #include <exo/exo.h>
 #include <libxfce4util/libxfce4util.h>
 
+#include <thunar/thunar-app-info-cache.h>
 #include <thunar/thunar-file.h>
 #include <thunar/thunar-gio-extensions.h>
 #include <thunar/thunar-preferences.h>
@@ -363,85 +364,6 @@ thunar_g_vfs_is_uri_scheme_supported (const gchar *scheme)
 
 
 
-/**
- * thunar_g_file_get_free_space:
- * @file           : a #GFile instance.
- * @fs_free_return : return location for the amount of
- *                   free space or %NULL.
- * @fs_size_return : return location for the total volume size.
- *
- * Determines the amount of free space of the volume on
- * which @file resides. Returns %TRUE if the amount of
- * free space was determined successfully and placed into
- * @free_space_return, else %FALSE will be returned.
- *
- * Return value: %TRUE if successfull, else %FALSE.
- **/
-gboolean
-thunar_g_file_get_free_space (GFile   *file,
-                              guint64 *fs_free_return,
-                              guint64 *fs_size_return)
-{
-  GFileInfo *filesystem_info;
-  gboolean   success = FALSE;
-
-  _thunar_return_val_if_fail (G_IS_FILE (file), FALSE);
-
-  filesystem_info = g_file_query_filesystem_info (file,
-                                                  THUNARX_FILESYSTEM_INFO_NAMESPACE,
-                                                  NULL, NULL);
-
-  if (filesystem_info != NULL)
-    {
-      if (fs_free_return != NULL)
-        {
-          *fs_free_return = g_file_info_get_attribute_uint64 (filesystem_info, G_FILE_ATTRIBUTE_FILESYSTEM_FREE);
-          success = g_file_info_has_attribute (filesystem_info, G_FILE_ATTRIBUTE_FILESYSTEM_FREE);
-        }
-
-      if (fs_size_return != NULL)
-        {
-          *fs_size_return = g_file_info_get_attribute_uint64 (filesystem_info, G_FILE_ATTRIBUTE_FILESYSTEM_SIZE);
-          success = g_file_info_has_attribute (filesystem_info, G_FILE_ATTRIBUTE_FILESYSTEM_SIZE);
-        }
-
-      g_object_unref (filesystem_info);
-    }
-
-  return success;
-}
-
-
-
-gchar *
-thunar_g_file_get_free_space_string (GFile *file, gboolean file_size_binary)
-{
-  gchar             *fs_free_str;
-  gchar             *fs_size_str;
-  guint64            fs_free;
-  guint64            fs_size;
-  gchar             *fs_string = NULL;
-
-  _thunar_return_val_if_fail (G_IS_FILE (file), NULL);
-
-  if (thunar_g_file_get_free_space (file, &fs_free, &fs_size)
-      && fs_size > 0)
-    {
-      fs_free_str = g_format_size_full (fs_free, file_size_binary ? G_FORMAT_SIZE_IEC_UNITS : G_FORMAT_SIZE_DEFAULT);
-      fs_size_str = g_format_size_full (fs_size, file_size_binary ? G_FORMAT_SIZE_IEC_UNITS : G_FORMAT_SIZE_DEFAULT);
-      /* free disk space string */
-      fs_string = g_strdup_printf (_("%s of %s free (%d%% used)"),
-                                   fs_free_str, fs_size_str,
-                                   (gint) ((fs_size - fs_free) * 100 / fs_size));
-      g_free (fs_free_str);
-      g_free (fs_size_str);
-    }
-
-  return fs_string;
-}
-
-
-
 GType
 thunar_g_file_list_get_type (void)
 {
@@ -526,12 +448,14 @@ thunar_g_app_info_launch (GAppInfo          *info,
                           GAppLaunchContext *context,
                           GError           **error)
 {
-  ThunarFile   *file;
-  GList        *lp;
-  const gchar  *content_type;
-  gboolean      result = FALSE;
-  gchar        *new_path = NULL;
-  gchar        *old_path = NULL;
+  ThunarAppInfoCache *app_info_cache;
+  ThunarFile         *file;
+  GList              *lp;
+  const gchar        *content_type;
+  gboolean            result = FALSE;
+  gboolean            last_used_changed = FALSE;
+  gchar              *new_path = NULL;
+  gchar              *old_path = NULL;
 
   _thunar_return_val_if_fail (G_IS_APP_INFO (info), FALSE);
   _thunar_return_val_if_fail (working_directory == NULL || G_IS_FILE (working_directory), FALSE);
@@ -569,11 +493,22 @@ thunar_g_app_info_launch (GAppInfo          *info,
 
               /* emit "changed" on the file if we successfully changed the last used application */
               if (g_app_info_set_as_last_used_for_type (info, content_type, NULL))
-                thunar_file_changed (file);
+                {
+                  thunar_file_changed (file);
+                  last_used_changed = TRUE;
+                }
 
               g_object_unref (file);
             }
         }
+
+      /* the order of the applications changed */
+      if (last_used_changed)
+        {
+          app_info_cache = thunar_app_info_cache_get ();
+          thunar_app_info_cache_invalidate (app_info_cache);
+          g_object_unref (app_info_cache);
+        }
     }
 
   /* check if we need to reset the working directory to the one Thunar was
@@ -0,0 +1,366 @@
+/* vi:set et ai sw=2 sts=2 ts=2: */
+/*-
+ * Copyright (c) 2015 Xfce Development Team <xfce4-dev@xfce.org>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the Free
+ * Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* The image probe determines the dimensions of image files in a
+ * worker thread, using the header parsers of the gdk-pixbuf loaders,
+ * so large images or images on slow shares never stall the main
+ * loop. The results of the most recently used files are cached and
+ * invalidated by the modification time of the file, and ::ready is
+ * emitted whenever a new result is available. */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <gdk/gdk.h>
+#include <gdk-pixbuf/gdk-pixbuf.h>
+
+#include <thunar/thunar-image-probe.h>
+#include <thunar/thunar-private.h>
+
+
+
+/* number of results to keep in the cache */
+#define MAX_ENTRIES (64)
+
+/* number of files probed at the same time */
+#define MAX_THREADS (2)
+
+
+
+/* Signal identifiers */
+enum
+{
+  READY,
+  LAST_SIGNAL,
+};
+
+
+
+typedef struct _ThunarImageProbeEntry   ThunarImageProbeEntry;
+typedef struct _ThunarImageProbeRequest ThunarImageProbeRequest;
+
+
+
+static void     thunar_image_probe_finalize     (GObject          *object);
+static void     thunar_image_probe_worker       (gpointer          data,
+                                                 gpointer          user_data);
+static gboolean thunar_image_probe_ready_idle   (gpointer          user_data);
+static void     thunar_image_probe_entry_free   (gpointer          data);
+static void     thunar_image_probe_request_free (gpointer          data);
+
+
+
+struct _ThunarImageProbeClass
+{
+  GObjectClass __parent__;
+};
+
+struct _ThunarImageProbe
+{
+  GObject      __parent__;
+
+  /* GFile -> ThunarImageProbeEntry, most recently used first in lru */
+  GHashTable  *entries;
+  GQueue       lru;
+
+  /* GFile -> ThunarImageProbeRequest */
+  GHashTable  *requests;
+  GThreadPool *pool;
+};
+
+struct _ThunarImageProbeEntry
+{
+  GFile   *file;
+  guint64  mtime;
+  gint     width;
+  gint     height;
+  gboolean valid;
+  GList    lru_link;
+};
+
+struct _ThunarImageProbeRequest
+{
+  /* keeps the probe alive until the result is delivered */
+  ThunarImageProbe *probe;
+
+  GFile            *file;
+  gchar            *path;
+  guint64           mtime;
+
+  /* set by the worker thread */
+  gint              width;
+  gint              height;
+  gboolean          valid;
+};
+
+
+
+static guint image_probe_signals[LAST_SIGNAL];
+
+
+
+G_DEFINE_TYPE (ThunarImageProbe, thunar_image_probe, G_TYPE_OBJECT)
+
+
+
+static void
+thunar_image_probe_class_init (ThunarImageProbeClass *klass)
+{
+  GObjectClass *gobject_class;
+
+  gobject_class = G_OBJECT_CLASS (klass);
+  gobject_class->finalize = thunar_image_probe_finalize;
+
+  /**
+   * ThunarImageProbe::ready:
+   * @probe : a #ThunarImageProbe.
+   * @file  : the #GFile that was probed.
+   *
+   * Emitted when the probe of @file finished and
+   * thunar_image_probe_get_size() returns the result.
+   **/
+  image_probe_signals[READY] =
+    g_signal_new (I_("ready"),
+                  G_TYPE_FROM_CLASS (klass),
+                  G_SIGNAL_NO_HOOKS,
+                  0, NULL, NULL,
+                  g_cclosure_marshal_VOID__OBJECT,
+                  G_TYPE_NONE, 1, G_TYPE_FILE);
+}
+
+
+
+static void
+thunar_image_probe_init (ThunarImageProbe *probe)
+{
+  probe->entries = g_hash_table_new_full (g_file_hash, (GEqualFunc) g_file_equal,
+                                          NULL, thunar_image_probe_entry_free);
+  g_queue_init (&probe->lru);
+
+  probe->requests = g_hash_table_new (g_file_hash, (GEqualFunc) g_file_equal);
+  probe->pool = g_thread_pool_new (thunar_image_probe_worker, NULL, MAX_THREADS, FALSE, NULL);
+}
+
+
+
+static void
+thunar_image_probe_finalize (GObject *object)
+{
+  ThunarImageProbe *probe = THUNAR_IMAGE_PROBE (object);
+
+  /* every request holds a reference, so nothing is running */
+  _thunar_assert (g_hash_table_size (probe->requests) == 0);
+
+  g_thread_pool_free (probe->pool, TRUE, FALSE);
+  g_hash_table_destroy (probe->requests);
+
+  /* the links are part of the entries */
+  g_hash_table_destroy (probe->entries);
+
+  (*G_OBJECT_CLASS (thunar_image_probe_parent_class)->finalize) (object);
+}
+
+
+
+static void
+thunar_image_probe_worker (gpointer data,
+                           gpointer user_data)
+{
+  ThunarImageProbeRequest *request = data;
+
+  /* this only parses the header of the image */
+  request->valid = (gdk_pixbuf_get_file_info (request->path, &request->width, &request->height) != NULL);
+
+  /* deliver the result in the main thread */
+  g_idle_add_full (G_PRIORITY_LOW, thunar_image_probe_ready_idle, request, thunar_image_probe_request_free);
+}
+
+
+
+static gboolean
+thunar_image_probe_ready_idle (gpointer user_data)
+{
+  ThunarImageProbeRequest *request = user_data;
+  ThunarImageProbeEntry   *entry;
+  ThunarImageProbe        *probe = request->probe;
+
+  GDK_THREADS_ENTER ();
+
+  g_hash_table_remove (probe->requests, request->file);
+
+  /* drop an older result for the file */
+  entry = g_hash_table_lookup (probe->entries, request->file);
+  if (entry != NULL)
+    {
+      g_queue_unlink (&probe->lru, &entry->lru_link);
+      g_hash_table_remove (probe->entries, request->file);
+    }
+
+  /* cache the new result */
+  entry = g_slice_new0 (ThunarImageProbeEntry);
+  entry->file = g_object_ref (request->file);
+  entry->mtime = request->mtime;
+  entry->width = request->width;
+  entry->height = request->height;
+  entry->valid = request->valid;
+  entry->lru_link.data = entry;
+  g_hash_table_insert (probe->entries, entry->file, entry);
+  g_queue_push_head_link (&probe->lru, &entry->lru_link);
+
+  /* forget the least recently used result */
+  if (probe->lru.length > MAX_ENTRIES)
+    {
+      entry = probe->lru.tail->data;
+      g_queue_unlink (&probe->lru, &entry->lru_link);
+      g_hash_table_remove (probe->entries, entry->file);
+    }
+
+  g_signal_emit (probe, image_probe_signals[READY], 0, request->file);
+
+  GDK_THREADS_LEAVE ();
+
+  return FALSE;
+}
+
+
+
+static void
+thunar_image_probe_entry_free (gpointer data)
+{
+  ThunarImageProbeEntry *entry = data;
+
+  g_object_unref (entry->file);
+  g_slice_free (ThunarImageProbeEntry, entry);
+}
+
+
+
+static void
+thunar_image_probe_request_free (gpointer data)
+{
+  ThunarImageProbeRequest *request = data;
+
+  g_object_unref (request->file);
+  g_free (request->path);
+  g_object_unref (request->probe);
+  g_slice_free (ThunarImageProbeRequest, request);
+}
+
+
+
+/**
+ * thunar_image_probe_get:
+ *
+ * Returns a reference to the shared #ThunarImageProbe. The
+ * caller is responsible to free the returned object using
+ * g_object_unref() when no longer needed.
+ *
+ * Return value: the shared #ThunarImageProbe.
+ **/
+ThunarImageProbe *
+thunar_image_probe_get (void)
+{
+  static ThunarImageProbe *probe = NULL;
+
+  if (G_UNLIKELY (probe == NULL))
+    {
+      probe = g_object_new (THUNAR_TYPE_IMAGE_PROBE, NULL);
+      g_object_add_weak_pointer (G_OBJECT (probe), (gpointer) &probe);
+    }
+  else
+    {
+      g_object_ref (G_OBJECT (probe));
+    }
+
+  return probe;
+}
+
+
+
+/**
+ * thunar_image_probe_get_size:
+ * @probe         : a #ThunarImageProbe.
+ * @file          : a local #ThunarFile.
+ * @width_return  : return location for the width of the image.
+ * @height_return : return location for the height of the image.
+ *
+ * Determines the dimensions of the image @file from the cache,
+ * without blocking. If @file was not probed yet, or changed since
+ * then, it is probed in the background, ::ready is emitted once
+ * the result is available, and %FALSE is returned.
+ *
+ * Return value: %TRUE if @file is a known image, else %FALSE.
+ **/
+gboolean
+thunar_image_probe_get_size (ThunarImageProbe *probe,
+                             ThunarFile       *file,
+                             gint             *width_return,
+                             gint             *height_return)
+{
+  ThunarImageProbeRequest *request;
+  ThunarImageProbeEntry   *entry;
+  GFile                   *gfile;
+  guint64                  mtime;
+  gchar                   *path;
+
+  _thunar_return_val_if_fail (THUNAR_IS_IMAGE_PROBE (probe), FALSE);
+  _thunar_return_val_if_fail (THUNAR_IS_FILE (file), FALSE);
+
+  gfile = thunar_file_get_file (file);
+  mtime = thunar_file_get_date (file, THUNAR_FILE_DATE_MODIFIED);
+
+  entry = g_hash_table_lookup (probe->entries, gfile);
+  if (entry != NULL && entry->mtime == mtime)
+    {
+      /* mark the entry as most recently used */
+      g_queue_unlink (&probe->lru, &entry->lru_link);
+      g_queue_push_head_link (&probe->lru, &entry->lru_link);
+
+      if (entry->valid)
+        {
+          if (width_return != NULL)
+            *width_return = entry->width;
+          if (height_return != NULL)
+            *height_return = entry->height;
+        }
+
+      return entry->valid;
+    }
+
+  /* check if the file is probed already */
+  if (g_hash_table_lookup (probe->requests, gfile) != NULL)
+    return FALSE;
+
+  path = g_file_get_path (gfile);
+  if (G_UNLIKELY (path == NULL))
+    return FALSE;
+
+  request = g_slice_new0 (ThunarImageProbeRequest);
+  request->probe = g_object_ref (probe);
+  request->file = g_object_ref (gfile);
+  request->path = path;
+  request->mtime = mtime;
+  g_hash_table_insert (probe->requests, request->file, request);
+
+  g_thread_pool_push (probe->pool, request, NULL);
+
+  return FALSE;
+}
@@ -22,6 +22,17 @@
 #include <config.h>
 #endif
 
+#ifdef HAVE_ERRNO_H
+#include <errno.h>
+#endif
+#ifdef HAVE_FCNTL_H
+#include <fcntl.h>
+#endif
+#include <stdio.h>
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+
 #include <gio/gio.h>
 
 #include <thunar/thunar-application.h>
@@ -30,6 +41,7 @@
 #include <thunar/thunar-io-scan-directory.h>
 #include <thunar/thunar-io-jobs.h>
 #include <thunar/thunar-io-jobs-util.h>
+#include <thunar/thunar-io-walk.h>
 #include <thunar/thunar-job.h>
 #include <thunar/thunar-private.h>
 #include <thunar/thunar-simple-job.h>
@@ -38,6 +50,44 @@
 
 
 
+/* minimum interval between two progress updates of the batch rename */
+#define RENAME_PROGRESS_INTERVAL (100 * 1000) /* 100 ms */
+
+
+
+typedef struct _TijRenameStep TijRenameStep;
+typedef struct _TijRenameOp   TijRenameOp;
+
+struct _TijRenameStep
+{
+  ThunarFile    *file;
+  GFile         *parent;
+  gint           dir_fd;
+  gchar         *old_display_name;
+  const gchar   *new_display_name;
+  gchar         *source;
+  gchar         *target;
+  gchar         *temp;
+  gboolean       is_desktop_file;
+  guint          state;
+};
+
+struct _TijRenameOp
+{
+  TijRenameStep *step;
+  const gchar   *from;
+  const gchar   *to;
+};
+
+enum
+{
+  TIJ_RENAME_STEP_UNVISITED,
+  TIJ_RENAME_STEP_VISITING,
+  TIJ_RENAME_STEP_DONE,
+};
+
+
+
 static GList *
 _tij_collect_nofollow (ThunarJob *job,
                        GList     *base_file_list,
@@ -396,34 +446,110 @@ thunar_io_jobs_make_directories (GList *file_list)
 
 
 
+#ifdef HAVE_UNLINKAT
+static gint
+_tij_unlink_native (gint               dir_fd,
+                    const gchar       *name,
+                    const struct stat *statbuf,
+                    gboolean           is_directory,
+                    gpointer           user_data)
+{
+  if (unlinkat (dir_fd, name, is_directory ? AT_REMOVEDIR : 0) < 0)
+    return errno;
+
+  return 0;
+}
+
+
+
+static GList *
+_tij_unlink_native_files (ThunarJob            *job,
+                          GList                *file_list,
+                          ThunarThumbnailCache *thumbnail_cache)
+{
+  GHashTable *kept;
+  GList      *directory_list;
+  GList      *deleted_list = NULL;
+  GList      *remaining_list;
+  GList      *lp;
+
+  exo_job_info_message (EXO_JOB (job), _("Deleting files..."));
+
+  /* delete the local trees while walking them, in parallel */
+  remaining_list = thunar_io_walk (job, file_list, THUNAR_IO_WALK_NONE,
+                                   _tij_unlink_native, NULL, &directory_list);
+
+  /* the walk returns the same GFile instances, so a pointer set is enough */
+  kept = g_hash_table_new (g_direct_hash, g_direct_equal);
+  for (lp = remaining_list; lp != NULL; lp = lp->next)
+    g_hash_table_insert (kept, lp->data, lp->data);
+  for (lp = directory_list; lp != NULL; lp = lp->next)
+    g_hash_table_insert (kept, lp->data, lp->data);
+
+  /* collect the plain files that are gone now */
+  for (lp = file_list; lp != NULL; lp = lp->next)
+    if (g_hash_table_lookup (kept, lp->data) == NULL)
+      deleted_list = g_list_prepend (deleted_list, lp->data);
+
+  g_hash_table_destroy (kept);
+
+  /* let the thumbnail cache drop their thumbnails in one go, and clean up
+   * the deleted directories instead of telling it about every file in them */
+  thunar_thumbnail_cache_delete_files (thumbnail_cache, deleted_list);
+  for (lp = directory_list; lp != NULL; lp = lp->next)
+    thunar_thumbnail_cache_cleanup_file (thumbnail_cache, lp->data);
+
+  g_list_free (deleted_list);
+  thunar_g_file_list_free (directory_list);
+
+  return remaining_list;
+}
+#endif
+
+
+
 static gboolean
-_thunar_io_jobs_unlink (ThunarJob  *job,
-                        GArray     *param_values,
-                        GError    **error)
+_tij_unlink_files (ThunarJob  *job,
+                   GList      *file_list,
+                   GError    **error)
 {
   ThunarThumbnailCache *thumbnail_cache;
   ThunarApplication    *application;
   ThunarJobResponse     response;
   GFileInfo            *info;
   GError               *err = NULL;
-  GList                *file_list;
+  GList                *remaining_list;
   GList                *lp;
   gchar                *base_name;
   gchar                *display_name;
 
-  _thunar_return_val_if_fail (THUNAR_IS_JOB (job), FALSE);
-  _thunar_return_val_if_fail (param_values != NULL, FALSE);
-  _thunar_return_val_if_fail (param_values->len == 1, FALSE);
-  _thunar_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+  /* take a reference on the thumbnail cache */
+  application = thunar_application_get ();
+  thumbnail_cache = thunar_application_get_thumbnail_cache (application);
+  g_object_unref (application);
 
-  /* get the file list */
-  file_list = g_value_get_boxed (&g_array_index (param_values, GValue, 0));
+#ifdef HAVE_UNLINKAT
+  /* delete local files directly, everything else and whatever failed
+   * is left for the code below which can ask the user */
+  remaining_list = _tij_unlink_native_files (job, file_list, thumbnail_cache);
+#else
+  remaining_list = thunar_g_file_list_copy (file_list);
+#endif
+
+  /* check if we are done already */
+  if (remaining_list == NULL || exo_job_is_cancelled (EXO_JOB (job)))
+    {
+      thunar_g_file_list_free (remaining_list);
+      g_object_unref (thumbnail_cache);
+      return !exo_job_set_error_if_cancelled (EXO_JOB (job), error);
+    }
 
   /* tell the user that we're preparing to unlink the files */
   exo_job_info_message (EXO_JOB (job), _("Preparing..."));
 
   /* recursively collect files for removal, not following any symlinks */
-  file_list = _tij_collect_nofollow (job, file_list, TRUE, &err);
+  file_list = _tij_collect_nofollow (job, remaining_list, TRUE, &err);
+  thunar_g_file_list_free (remaining_list);
 
   /* free the file list and fail if there was an error or the job was cancelled */
   if (err != NULL || exo_job_is_cancelled (EXO_JOB (job)))
@@ -434,17 +560,13 @@ _thunar_io_jobs_unlink (ThunarJob  *job,
         g_propagate_error (error, err);
 
       thunar_g_file_list_free (file_list);
+      g_object_unref (thumbnail_cache);
       return FALSE;
     }
 
   /* we know the total list of files to process */
   thunar_job_set_total_files (THUNAR_JOB (job), file_list);
 
-  /* take a reference on the thumbnail cache */
-  application = thunar_application_get ();
-  thumbnail_cache = thunar_application_get_thumbnail_cache (application);
-  g_object_unref (application);
-
   /* remove all the files */
   for (lp = file_list; lp != NULL && !exo_job_is_cancelled (EXO_JOB (job)); lp = lp->next)
     {
@@ -520,6 +642,21 @@ again:
 
 
 
+static gboolean
+_thunar_io_jobs_unlink (ThunarJob  *job,
+                        GArray     *param_values,
+                        GError    **error)
+{
+  _thunar_return_val_if_fail (THUNAR_IS_JOB (job), FALSE);
+  _thunar_return_val_if_fail (param_values != NULL, FALSE);
+  _thunar_return_val_if_fail (param_values->len == 1, FALSE);
+  _thunar_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+  return _tij_unlink_files (job, g_value_get_boxed (&g_array_index (param_values, GValue, 0)), error);
+}
+
+
+
 ThunarJob *
 thunar_io_jobs_unlink_files (GList *file_list)
 {
@@ -789,16 +926,232 @@ thunar_io_jobs_link_files (GList *source_file_list,
 
 
 
+typedef struct
+{
+  GCancellable *cancellable;
+  GMutex        lock;
+  GCond         cond;
+  guint         n_done;
+  GList        *trashed_list;
+  GError       *error;
+} TijTrashBatch;
+
+
+
 static gboolean
-_thunar_io_jobs_trash (ThunarJob  *job,
-                       GArray     *param_values,
-                       GError    **error)
+_tij_trash_can_trash (ThunarJob *job,
+                      GFile     *file)
+{
+  GFileInfo *info;
+  gboolean   can_trash = TRUE;
+
+  info = g_file_query_info (file, G_FILE_ATTRIBUTE_ACCESS_CAN_TRASH,
+                            G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS,
+                            exo_job_get_cancellable (EXO_JOB (job)), NULL);
+  if (G_LIKELY (info != NULL))
+    {
+      /* if the backend does not know, let g_file_trash() find out */
+      if (g_file_info_has_attribute (info, G_FILE_ATTRIBUTE_ACCESS_CAN_TRASH))
+        can_trash = g_file_info_get_attribute_boolean (info, G_FILE_ATTRIBUTE_ACCESS_CAN_TRASH);
+      g_object_unref (info);
+    }
+
+  return can_trash;
+}
+
+
+
+static GList *
+_tij_trash_split (ThunarJob *job,
+                  GList     *file_list,
+                  GList    **untrashable_list_return)
+{
+  GHashTable *results;
+  GFileInfo  *info;
+  gboolean    can_trash;
+  gpointer    value;
+  GFile      *parent;
+  GList      *trash_list = NULL;
+  GList      *lp;
+  gchar      *parent_uri;
+  gchar      *key;
+
+  *untrashable_list_return = NULL;
+
+  /* whether a local file can be trashed depends on the trash directory
+   * of its filesystem and on whether it may be renamed in its parent,
+   * which for sticky directories also depends on the owner. Files that
+   * share all of these share the result */
+  results = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+
+  for (lp = file_list; lp != NULL && !exo_job_is_cancelled (EXO_JOB (job)); lp = lp->next)
+    {
+      info = g_file_query_info (lp->data,
+                                G_FILE_ATTRIBUTE_UNIX_DEVICE ","
+                                G_FILE_ATTRIBUTE_UNIX_UID,
+                                G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS,
+                                exo_job_get_cancellable (EXO_JOB (job)), NULL);
+      parent = g_file_get_parent (lp->data);
+
+      if (info != NULL
+          && parent != NULL
+          && g_file_info_has_attribute (info, G_FILE_ATTRIBUTE_UNIX_DEVICE)
+          && g_file_info_has_attribute (info, G_FILE_ATTRIBUTE_UNIX_UID))
+        {
+          parent_uri = g_file_get_uri (parent);
+          key = g_strdup_printf ("%u:%u:%s",
+                                 g_file_info_get_attribute_uint32 (info, G_FILE_ATTRIBUTE_UNIX_DEVICE),
+                                 g_file_info_get_attribute_uint32 (info, G_FILE_ATTRIBUTE_UNIX_UID),
+                                 parent_uri);
+          g_free (parent_uri);
+
+          if (g_hash_table_lookup_extended (results, key, NULL, &value))
+            {
+              can_trash = GPOINTER_TO_INT (value);
+              g_free (key);
+            }
+          else
+            {
+              can_trash = _tij_trash_can_trash (job, lp->data);
+              g_hash_table_insert (results, key, GINT_TO_POINTER (can_trash));
+            }
+        }
+      else
+        {
+          can_trash = _tij_trash_can_trash (job, lp->data);
+        }
+
+      if (parent != NULL)
+        g_object_unref (parent);
+      if (info != NULL)
+        g_object_unref (info);
+
+      if (can_trash)
+        trash_list = thunar_g_file_list_prepend (trash_list, lp->data);
+      else
+        *untrashable_list_return = thunar_g_file_list_prepend (*untrashable_list_return, lp->data);
+    }
+
+  g_hash_table_destroy (results);
+
+  *untrashable_list_return = g_list_reverse (*untrashable_list_return);
+  return g_list_reverse (trash_list);
+}
+
+
+
+static void
+_tij_trash_worker (gpointer data,
+                   gpointer user_data)
+{
+  TijTrashBatch *batch = user_data;
+  GFile         *file = data;
+  GError        *err = NULL;
+  gboolean       failed;
+
+  /* don't start on anything once a file failed */
+  g_mutex_lock (&batch->lock);
+  failed = (batch->error != NULL);
+  g_mutex_unlock (&batch->lock);
+
+  if (!failed)
+    g_file_trash (file, batch->cancellable, &err);
+
+  g_mutex_lock (&batch->lock);
+  if (err != NULL)
+    {
+      if (batch->error == NULL)
+        batch->error = err;
+      else
+        g_error_free (err);
+    }
+  else if (!failed)
+    {
+      batch->trashed_list = thunar_g_file_list_prepend (batch->trashed_list, file);
+    }
+  batch->n_done += 1;
+  g_cond_signal (&batch->cond);
+  g_mutex_unlock (&batch->lock);
+}
+
+
+
+static gboolean
+_tij_trash_files (ThunarJob *job,
+                  GList     *file_list,
+                  GError   **error)
 {
   ThunarThumbnailCache *thumbnail_cache;
   ThunarApplication    *application;
-  GError               *err = NULL;
-  GList                *file_list;
+  TijTrashBatch         batch;
+  GThreadPool          *pool;
   GList                *lp;
+  guint                 n_files;
+
+  n_files = g_list_length (file_list);
+  if (n_files == 0)
+    return TRUE;
+
+  batch.cancellable = exo_job_get_cancellable (EXO_JOB (job));
+  batch.n_done = 0;
+  batch.trashed_list = NULL;
+  batch.error = NULL;
+  g_mutex_init (&batch.lock);
+  g_cond_init (&batch.cond);
+
+  /* trashing is mostly renaming files, which the kernel can do for
+   * several files at once, even on the same filesystem */
+  pool = g_thread_pool_new (_tij_trash_worker, &batch, MIN (n_files, 4), FALSE, NULL);
+  for (lp = file_list; lp != NULL; lp = lp->next)
+    g_thread_pool_push (pool, lp->data, NULL);
+
+  /* wait for the workers and update the progress */
+  g_mutex_lock (&batch.lock);
+  while (batch.n_done < n_files)
+    {
+      g_cond_wait (&batch.cond, &batch.lock);
+      exo_job_percent (EXO_JOB (job), (batch.n_done * 100.0) / n_files);
+    }
+  g_mutex_unlock (&batch.lock);
+
+  g_thread_pool_free (pool, FALSE, TRUE);
+  g_mutex_clear (&batch.lock);
+  g_cond_clear (&batch.cond);
+
+  /* update the thumbnail cache */
+  application = thunar_application_get ();
+  thumbnail_cache = thunar_application_get_thumbnail_cache (application);
+  g_object_unref (application);
+
+  for (lp = batch.trashed_list; lp != NULL; lp = lp->next)
+    thunar_thumbnail_cache_cleanup_file (thumbnail_cache, lp->data);
+
+  g_object_unref (thumbnail_cache);
+  thunar_g_file_list_free (batch.trashed_list);
+
+  if (batch.error != NULL)
+    {
+      g_propagate_error (error, batch.error);
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+
+
+static gboolean
+_thunar_io_jobs_trash (ThunarJob  *job,
+                       GArray     *param_values,
+                       GError    **error)
+{
+  ThunarJobResponse response = THUNAR_JOB_RESPONSE_NO;
+  GError           *err = NULL;
+  GList            *file_list;
+  GList            *trash_list;
+  GList            *untrashable_list;
+  gchar            *display_name;
+  guint             n_untrashable;
 
   _thunar_return_val_if_fail (THUNAR_IS_JOB (job), FALSE);
   _thunar_return_val_if_fail (param_values != NULL, FALSE);
@@ -810,24 +1163,43 @@ _thunar_io_jobs_trash (ThunarJob  *job,
   if (exo_job_set_error_if_cancelled (EXO_JOB (job), error))
     return FALSE;
 
-  /* take a reference on the thumbnail cache */
-  application = thunar_application_get ();
-  thumbnail_cache = thunar_application_get_thumbnail_cache (application);
-  g_object_unref (application);
+  /* find out up front which files cannot be trashed */
+  trash_list = _tij_trash_split (job, file_list, &untrashable_list);
 
-  for (lp = file_list; err == NULL && lp != NULL; lp = lp->next)
+  /* ask once what to do with all of them */
+  if (untrashable_list != NULL)
     {
-      _thunar_assert (G_IS_FILE (lp->data));
-
-      /* trash the file or folder */
-      g_file_trash (lp->data, exo_job_get_cancellable (EXO_JOB (job)), &err);
+      n_untrashable = g_list_length (untrashable_list);
+      if (n_untrashable == 1)
+        {
+          display_name = thunar_g_file_get_display_name (untrashable_list->data);
+          response = thunar_job_ask_delete (job, 1, _("The file \"%s\" cannot be moved to the trash"),
+                                            display_name);
+          g_free (display_name);
+        }
+      else
+        {
+          response = thunar_job_ask_delete (job, n_untrashable,
+                                            ngettext ("%u file cannot be moved to the trash",
+                                                      "%u files cannot be moved to the trash",
+                                                      n_untrashable),
+                                            n_untrashable);
+        }
+    }
 
-      /* update the thumbnail cache */
-      thunar_thumbnail_cache_cleanup_file (thumbnail_cache, lp->data);
+  if (!exo_job_set_error_if_cancelled (EXO_JOB (job), &err))
+    {
+      /* move everything else to the trash */
+      if (_tij_trash_files (job, trash_list, &err)
+          && response == THUNAR_JOB_RESPONSE_YES)
+        {
+          /* and delete the files the user gave up on */
+          _tij_unlink_files (job, untrashable_list, &err);
+        }
     }
 
-  /* release the thumbnail cache */
-  g_object_unref (thumbnail_cache);
+  thunar_g_file_list_free (trash_list);
+  thunar_g_file_list_free (untrashable_list);
 
   if (err != NULL)
     {
@@ -871,6 +1243,38 @@ thunar_io_jobs_restore_files (GList *source_file_list,
 
 
 
+#ifdef HAVE_FCHOWNAT
+typedef struct
+{
+  gint uid;
+  gint gid;
+} TijChownData;
+
+
+
+static gint
+_tij_chown_native (gint               dir_fd,
+                   const gchar       *name,
+                   const struct stat *statbuf,
+                   gboolean           is_directory,
+                   gpointer           user_data)
+{
+  const TijChownData *data = user_data;
+
+  /* nothing to do if the file has the right owner and group already */
+  if ((data->uid < 0 || statbuf->st_uid == (uid_t) data->uid)
+      && (data->gid < 0 || statbuf->st_gid == (gid_t) data->gid))
+    return 0;
+
+  if (fchownat (dir_fd, name, data->uid, data->gid, AT_SYMLINK_NOFOLLOW) < 0)
+    return errno;
+
+  return 0;
+}
+#endif
+
+
+
 static gboolean
 _thunar_io_jobs_chown (ThunarJob  *job,
                        GArray     *param_values,
@@ -882,9 +1286,13 @@ _thunar_io_jobs_chown (ThunarJob  *job,
   gboolean          recursive;
   GError           *err = NULL;
   GList            *file_list;
+  GList            *remaining_list;
   GList            *lp;
   gint              uid;
   gint              gid;
+#ifdef HAVE_FCHOWNAT
+  TijChownData      data;
+#endif
 
   _thunar_return_val_if_fail (THUNAR_IS_JOB (job), FALSE);
   _thunar_return_val_if_fail (param_values != NULL, FALSE);
@@ -900,9 +1308,25 @@ _thunar_io_jobs_chown (ThunarJob  *job,
 
   /* collect the files for the chown operation */
   if (recursive)
-    file_list = _tij_collect_nofollow (job, file_list, FALSE, &err);
+    {
+#ifdef HAVE_FCHOWNAT
+      /* change local trees directly, everything else and whatever
+       * failed is left for the code below which can ask the user */
+      data.uid = uid;
+      data.gid = gid;
+      remaining_list = thunar_io_walk (job, file_list, THUNAR_IO_WALK_STAT,
+                                       _tij_chown_native, &data, NULL);
+#else
+      remaining_list = thunar_g_file_list_copy (file_list);
+#endif
+
+      file_list = _tij_collect_nofollow (job, remaining_list, FALSE, &err);
+      thunar_g_file_list_free (remaining_list);
+    }
   else
-    file_list = thunar_g_file_list_copy (file_list);
+    {
+      file_list = thunar_g_file_list_copy (file_list);
+    }
 
   if (err != NULL)
     {
@@ -1008,6 +1432,49 @@ thunar_io_jobs_change_group (GList    *files,
 
 
 
+#ifdef HAVE_FCHMODAT
+typedef struct
+{
+  ThunarFileMode dir_mask;
+  ThunarFileMode dir_mode;
+  ThunarFileMode file_mask;
+  ThunarFileMode file_mode;
+} TijChmodData;
+
+
+
+static gint
+_tij_chmod_native (gint               dir_fd,
+                   const gchar       *name,
+                   const struct stat *statbuf,
+                   gboolean           is_directory,
+                   gpointer           user_data)
+{
+  const TijChmodData *data = user_data;
+  mode_t              new_mode;
+
+  /* symlinks have no permissions of their own */
+  if (S_ISLNK (statbuf->st_mode))
+    return 0;
+
+  if (is_directory)
+    new_mode = ((statbuf->st_mode & ~data->dir_mask) | data->dir_mode) & 07777;
+  else
+    new_mode = ((statbuf->st_mode & ~data->file_mask) | data->file_mode) & 07777;
+
+  /* nothing to do if the mode matches already */
+  if ((statbuf->st_mode & 07777) == new_mode)
+    return 0;
+
+  if (fchmodat (dir_fd, name, new_mode, 0) < 0)
+    return errno;
+
+  return 0;
+}
+#endif
+
+
+
 static gboolean
 _thunar_io_jobs_chmod (ThunarJob  *job,
                        GArray     *param_values,
@@ -1027,6 +1494,10 @@ _thunar_io_jobs_chmod (ThunarJob  *job,
   ThunarFileMode    mode;
   ThunarFileMode    old_mode;
   ThunarFileMode    new_mode;
+  GList            *remaining_list;
+#ifdef HAVE_FCHMODAT
+  TijChmodData      data;
+#endif
 
   _thunar_return_val_if_fail (THUNAR_IS_JOB (job), FALSE);
   _thunar_return_val_if_fail (param_values != NULL, FALSE);
@@ -1042,9 +1513,27 @@ _thunar_io_jobs_chmod (ThunarJob  *job,
 
   /* collect the files for the chown operation */
   if (recursive)
-    file_list = _tij_collect_nofollow (job, file_list, FALSE, &err);
+    {
+#ifdef HAVE_FCHMODAT
+      /* change local trees directly, everything else and whatever
+       * failed is left for the code below which can ask the user */
+      data.dir_mask = dir_mask;
+      data.dir_mode = dir_mode;
+      data.file_mask = file_mask;
+      data.file_mode = file_mode;
+      remaining_list = thunar_io_walk (job, file_list, THUNAR_IO_WALK_STAT,
+                                       _tij_chmod_native, &data, NULL);
+#else
+      remaining_list = thunar_g_file_list_copy (file_list);
+#endif
+
+      file_list = _tij_collect_nofollow (job, remaining_list, FALSE, &err);
+      thunar_g_file_list_free (remaining_list);
+    }
   else
-    file_list = thunar_g_file_list_copy (file_list);
+    {
+      file_list = thunar_g_file_list_copy (file_list);
+    }
 
   if (err != NULL)
     {
@@ -1093,7 +1582,7 @@ retry_chown:
        * information) into account */
       new_mode = ((old_mode & ~mask) | mode) & 07777;
 
-      if (old_mode != new_mode)
+      if ((old_mode & 07777) != new_mode)
         {
           /* try to change the file mode */
           g_file_set_attribute_uint32 (lp->data,
@@ -1170,13 +1659,14 @@ _thunar_io_jobs_ls (ThunarJob  *job,
                     GArray     *param_values,
                     GError    **error)
 {
-  GError *err = NULL;
-  GFile  *directory;
-  GList  *file_list = NULL;
+  GError   *err = NULL;
+  GFile    *directory;
+  GList    *file_list = NULL;
+  gboolean  directories_only;
 
   _thunar_return_val_if_fail (THUNAR_IS_JOB (job), FALSE);
   _thunar_return_val_if_fail (param_values != NULL, FALSE);
-  _thunar_return_val_if_fail (param_values->len == 1, FALSE);
+  _thunar_return_val_if_fail (param_values->len == 2, FALSE);
   _thunar_return_val_if_fail (error == NULL || *error == NULL, FALSE);
 
   if (exo_job_set_error_if_cancelled (EXO_JOB (job), error))
@@ -1184,14 +1674,18 @@ _thunar_io_jobs_ls (ThunarJob  *job,
 
   /* determine the directory to list */
   directory = g_value_get_object (&g_array_index (param_values, GValue, 0));
+  directories_only = g_value_get_boolean (&g_array_index (param_values, GValue, 1));
 
   /* make sure the object is valid */
   _thunar_assert (G_IS_FILE (directory));
 
   /* collect directory contents (non-recursively) */
-  file_list = thunar_io_scan_directory (job, directory,
-                                        G_FILE_QUERY_INFO_NONE, 
-                                        FALSE, FALSE, TRUE, &err);
+  if (directories_only)
+    file_list = thunar_io_scan_directories (job, directory, &err);
+  else
+    file_list = thunar_io_scan_directory (job, directory,
+                                          G_FILE_QUERY_INFO_NONE, 
+                                          FALSE, FALSE, TRUE, &err);
 
   /* abort on errors or cancellation */
   if (err != NULL)
@@ -1237,7 +1731,21 @@ thunar_io_jobs_list_directory (GFile *directory)
 {
   _thunar_return_val_if_fail (G_IS_FILE (directory), NULL);
   
-  return thunar_simple_job_launch (_thunar_io_jobs_ls, 1, G_TYPE_FILE, directory);
+  return thunar_simple_job_launch (_thunar_io_jobs_ls, 2,
+                                   G_TYPE_FILE, directory,
+                                   G_TYPE_BOOLEAN, FALSE);
+}
+
+
+
+ThunarJob *
+thunar_io_jobs_list_directories (GFile *directory)
+{
+  _thunar_return_val_if_fail (G_IS_FILE (directory), NULL);
+
+  return thunar_simple_job_launch (_thunar_io_jobs_ls, 2,
+                                   G_TYPE_FILE, directory,
+                                   G_TYPE_BOOLEAN, TRUE);
 }
 
 
@@ -1312,3 +1820,492 @@ thunar_io_jobs_rename_file (ThunarFile  *file,
                                    THUNAR_TYPE_FILE, file, 
                                    G_TYPE_STRING, display_name);
 }
+
+
+
+static void
+_tij_rename_step_free (gpointer data)
+{
+  TijRenameStep *step = data;
+
+  g_object_unref (step->file);
+  g_object_unref (step->parent);
+  g_free (step->old_display_name);
+  g_free (step->source);
+  g_free (step->target);
+  g_free (step->temp);
+  g_slice_free (TijRenameStep, step);
+}
+
+
+
+static void
+_tij_rename_close_fd (gpointer data)
+{
+  gint fd = GPOINTER_TO_INT (data);
+
+  if (fd >= 0)
+    close (fd);
+}
+
+
+
+static gint
+_tij_rename_lookup_fd (GHashTable *dir_fds,
+                       GFile      *directory)
+{
+  gpointer fd_ptr;
+  gint     fd = -1;
+#ifdef HAVE_RENAMEAT2
+  gchar   *path;
+#endif
+
+  /* check if we already opened this directory */
+  if (g_hash_table_lookup_extended (dir_fds, directory, NULL, &fd_ptr))
+    return GPOINTER_TO_INT (fd_ptr);
+
+#ifdef HAVE_RENAMEAT2
+  path = g_file_get_path (directory);
+  if (G_LIKELY (path != NULL))
+    fd = open (path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  g_free (path);
+#endif
+
+  /* failures are cached as well, those use the GIO fallback */
+  g_hash_table_insert (dir_fds, g_object_ref (directory), GINT_TO_POINTER (fd));
+
+  return fd;
+}
+
+
+
+static GFile *
+_tij_rename_step_child (TijRenameStep *step,
+                        const gchar   *name)
+{
+  return g_file_get_child (step->parent, name);
+}
+
+
+
+static GList *
+_tij_rename_collect (GList      *file_list,
+                     gchar     **names,
+                     GHashTable *dir_fds,
+                     GError    **error)
+{
+  TijRenameStep *step;
+  gboolean       is_secure;
+  GFile         *target_file;
+  GList         *steps = NULL;
+  GList         *lp;
+  guint          n;
+
+  for (lp = file_list, n = 0; lp != NULL && names[n] != NULL; lp = lp->next, ++n)
+    {
+      step = g_slice_new0 (TijRenameStep);
+      step->file = thunar_file_get (lp->data, error);
+      if (G_UNLIKELY (step->file == NULL))
+        {
+          g_slice_free (TijRenameStep, step);
+          break;
+        }
+
+      step->parent = g_file_get_parent (lp->data);
+      if (G_UNLIKELY (step->parent == NULL))
+        {
+          /* the root folder can never be renamed */
+          g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_FILENAME,
+                       _("Failed to rename \"%s\""), thunar_file_get_display_name (step->file));
+          g_object_unref (step->file);
+          g_slice_free (TijRenameStep, step);
+          break;
+        }
+
+      step->old_display_name = g_strdup (thunar_file_get_display_name (step->file));
+      step->new_display_name = names[n];
+      step->dir_fd = -1;
+
+      /* secure desktop files are "renamed" by changing their Name key */
+      if (thunar_file_is_desktop_file (step->file, &is_secure) && is_secure)
+        {
+          step->is_desktop_file = TRUE;
+          steps = g_list_prepend (steps, step);
+          continue;
+        }
+
+      /* determine the on-disk name for the new display name */
+      target_file = g_file_get_child_for_display_name (step->parent, names[n], error);
+      if (G_UNLIKELY (target_file == NULL))
+        {
+          _tij_rename_step_free (step);
+          break;
+        }
+
+      step->source = g_file_get_basename (lp->data);
+      step->target = g_file_get_basename (target_file);
+      g_object_unref (target_file);
+
+      /* nothing to do if the name does not change */
+      if (g_str_equal (step->source, step->target))
+        {
+          _tij_rename_step_free (step);
+          continue;
+        }
+
+      step->dir_fd = _tij_rename_lookup_fd (dir_fds, step->parent);
+      steps = g_list_prepend (steps, step);
+    }
+
+  if (G_UNLIKELY (lp != NULL && names[n] != NULL))
+    {
+      /* something went wrong above */
+      g_list_free_full (steps, _tij_rename_step_free);
+      return NULL;
+    }
+
+  return g_list_reverse (steps);
+}
+
+
+
+static GArray *
+_tij_rename_order (GList *steps)
+{
+  TijRenameStep *step;
+  TijRenameStep *blocker;
+  TijRenameOp    op;
+  GHashTable    *sources;
+  GPtrArray     *chain;
+  GArray        *ops;
+  GFile         *file;
+  GList         *lp;
+  gint           i;
+
+  ops = g_array_new (FALSE, FALSE, sizeof (TijRenameOp));
+  chain = g_ptr_array_new ();
+
+  /* map the current location of every file to its step */
+  sources = g_hash_table_new_full (g_file_hash, (GEqualFunc) g_file_equal, g_object_unref, NULL);
+  for (lp = steps; lp != NULL; lp = lp->next)
+    {
+      step = lp->data;
+      if (!step->is_desktop_file)
+        g_hash_table_insert (sources, _tij_rename_step_child (step, step->source), step);
+    }
+
+  for (lp = steps; lp != NULL; lp = lp->next)
+    {
+      step = lp->data;
+
+      /* desktop files keep their location */
+      if (step->is_desktop_file)
+        {
+          op.step = step;
+          op.from = step->old_display_name;
+          op.to = step->new_display_name;
+          g_array_append_val (ops, op);
+          continue;
+        }
+
+      /* follow the chain of files whose target is occupied by
+       * another file of the batch, e.g. a -> b, b -> c, c -> d */
+      for (blocker = step; blocker != NULL && blocker->state == TIJ_RENAME_STEP_UNVISITED; )
+        {
+          blocker->state = TIJ_RENAME_STEP_VISITING;
+          g_ptr_array_add (chain, blocker);
+
+          file = _tij_rename_step_child (blocker, blocker->target);
+          blocker = g_hash_table_lookup (sources, file);
+          g_object_unref (file);
+        }
+
+      /* a cycle (e.g. a swap), move the first file of it out of the way */
+      if (blocker != NULL && blocker->state == TIJ_RENAME_STEP_VISITING)
+        {
+          blocker->temp = g_strdup_printf (".thunar-rename-%08x", g_random_int ());
+
+          op.step = blocker;
+          op.from = blocker->source;
+          op.to = blocker->temp;
+          g_array_append_val (ops, op);
+        }
+
+      /* rename the chain back to front, each one frees the target
+       * of the one before it */
+      for (i = chain->len - 1; i >= 0; --i)
+        {
+          blocker = g_ptr_array_index (chain, i);
+          blocker->state = TIJ_RENAME_STEP_DONE;
+
+          op.step = blocker;
+          op.from = (blocker->temp != NULL) ? blocker->temp : blocker->source;
+          op.to = blocker->target;
+          g_array_append_val (ops, op);
+        }
+
+      g_ptr_array_set_size (chain, 0);
+    }
+
+  g_hash_table_destroy (sources);
+  g_ptr_array_free (chain, TRUE);
+
+  return ops;
+}
+
+
+
+static gboolean
+_tij_rename_op_run (TijRenameStep *step,
+                    const gchar   *from,
+                    const gchar   *to,
+                    GError       **error)
+{
+  gboolean succeed;
+  GFile   *source_file;
+  GFile   *target_file;
+#ifdef HAVE_RENAMEAT2
+  gint     saved_errno;
+#endif
+
+  if (step->is_desktop_file)
+    return thunar_file_rename (step->file, to, NULL, TRUE, error);
+
+#ifdef HAVE_RENAMEAT2
+  if (G_LIKELY (step->dir_fd >= 0))
+    {
+      /* never replace anything that is not part of the batch */
+      if (renameat2 (step->dir_fd, from, step->dir_fd, to, RENAME_NOREPLACE) == 0)
+        return TRUE;
+
+      /* fall back to GIO if the kernel or file system does not support it */
+      saved_errno = errno;
+      if (saved_errno != ENOSYS && saved_errno != EINVAL)
+        {
+          g_set_error_literal (error, G_IO_ERROR, g_io_error_from_errno (saved_errno),
+                               g_strerror (saved_errno));
+          return FALSE;
+        }
+    }
+#endif
+
+  /* the operation is not cancellable, rolling back must not be interrupted */
+  source_file = _tij_rename_step_child (step, from);
+  target_file = _tij_rename_step_child (step, to);
+  succeed = g_file_move (source_file, target_file,
+                         G_FILE_COPY_NOFOLLOW_SYMLINKS | G_FILE_COPY_NO_FALLBACK_FOR_MOVE,
+                         NULL, NULL, NULL, error);
+  g_object_unref (source_file);
+  g_object_unref (target_file);
+
+  return succeed;
+}
+
+
+
+static gboolean
+_tij_rename_notify (gpointer user_data)
+{
+  GList *file_list = user_data;
+  GList *lp;
+
+  for (lp = file_list; lp != NULL; lp = lp->next)
+    _thunar_io_jobs_rename_notify (lp->data);
+
+  return FALSE;
+}
+
+
+
+static void
+_tij_rename_notify_destroy (gpointer user_data)
+{
+  g_list_free_full (user_data, g_object_unref);
+}
+
+
+
+static gboolean
+_thunar_io_jobs_rename_batch (ThunarJob  *job,
+                              GArray     *param_values,
+                              GError    **error)
+{
+  TijRenameStep *step;
+  TijRenameOp   *op;
+  GHashTable    *dir_fds;
+  GError        *err = NULL;
+  GError        *rollback_err = NULL;
+  GArray        *ops;
+  GFile         *renamed_file;
+  GList         *renamed_list = NULL;
+  GList         *steps;
+  GList         *lp;
+  gchar         *message;
+  gchar         *note = NULL;
+  gint64         last_update = 0;
+  gint64         now;
+  guint          n_rollback_failed = 0;
+  guint          n_done;
+  gint           i;
+
+  _thunar_return_val_if_fail (THUNAR_IS_JOB (job), FALSE);
+  _thunar_return_val_if_fail (param_values != NULL, FALSE);
+  _thunar_return_val_if_fail (param_values->len == 2, FALSE);
+  _thunar_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+  if (exo_job_set_error_if_cancelled (EXO_JOB (job), error))
+    return FALSE;
+
+  exo_job_info_message (EXO_JOB (job), _("Preparing..."));
+
+  /* directory descriptors, shared by all files with the same parent */
+  dir_fds = g_hash_table_new_full (g_file_hash, (GEqualFunc) g_file_equal,
+                                   g_object_unref, _tij_rename_close_fd);
+
+  /* collect the files and determine an order in which every
+   * rename finds its target free */
+  steps = _tij_rename_collect (g_value_get_boxed (&g_array_index (param_values, GValue, 0)),
+                               g_value_get_boxed (&g_array_index (param_values, GValue, 1)),
+                               dir_fds, &err);
+  if (G_UNLIKELY (err != NULL))
+    {
+      g_hash_table_destroy (dir_fds);
+      g_propagate_error (error, err);
+      return FALSE;
+    }
+  ops = _tij_rename_order (steps);
+
+  exo_job_info_message (EXO_JOB (job), _("Renaming files..."));
+
+  /* execute the renames until something fails */
+  for (n_done = 0; n_done < ops->len; ++n_done)
+    {
+      if (exo_job_set_error_if_cancelled (EXO_JOB (job), &err))
+        break;
+
+      op = &g_array_index (ops, TijRenameOp, n_done);
+      if (!_tij_rename_op_run (op->step, op->from, op->to, &err))
+        {
+          g_prefix_error (&err, _("Failed to rename \"%s\" to \"%s\": "),
+                          op->step->old_display_name, op->step->new_display_name);
+          break;
+        }
+
+      /* update the progress every now and then */
+      now = g_get_monotonic_time ();
+      if (now - last_update >= RENAME_PROGRESS_INTERVAL)
+        {
+          exo_job_percent (EXO_JOB (job), ((n_done + 1) * 100.0) / ops->len);
+          last_update = now;
+        }
+    }
+
+  if (G_UNLIKELY (err != NULL))
+    {
+      exo_job_info_message (EXO_JOB (job), _("Reverting changes..."));
+
+      /* undo everything that was done so far, in reverse order */
+      for (i = (gint) n_done - 1; i >= 0; --i)
+        {
+          op = &g_array_index (ops, TijRenameOp, i);
+          if (!_tij_rename_op_run (op->step, op->to, op->from, &rollback_err))
+            {
+              g_clear_error (&rollback_err);
+              n_rollback_failed++;
+            }
+        }
+
+      /* tell the user in which state the files were left */
+      if (G_UNLIKELY (n_rollback_failed > 0))
+        {
+          note = g_strdup_printf (ngettext ("%u file could not be reverted to its previous name",
+                                            "%u files could not be reverted to their previous names",
+                                            n_rollback_failed), n_rollback_failed);
+        }
+      else if (n_done > 0)
+        {
+          note = g_strdup (_("All renamed files were reverted to their previous names"));
+        }
+
+      if (note != NULL)
+        {
+          message = g_strdup_printf ("%s. %s", err->message, note);
+          g_free (err->message);
+          err->message = message;
+          g_free (note);
+        }
+
+      /* reload files whose desktop entry was changed back */
+      for (lp = steps; lp != NULL; lp = lp->next)
+        {
+          step = lp->data;
+          if (step->is_desktop_file)
+            renamed_list = g_list_prepend (renamed_list, g_object_ref (step->file));
+        }
+    }
+  else
+    {
+      exo_job_percent (EXO_JOB (job), 100.0);
+
+      /* move the file objects to their new locations */
+      for (lp = steps; lp != NULL; lp = lp->next)
+        {
+          step = lp->data;
+          if (!step->is_desktop_file)
+            {
+              renamed_file = _tij_rename_step_child (step, step->target);
+              thunar_file_moved (step->file, renamed_file);
+              g_object_unref (renamed_file);
+            }
+
+          renamed_list = g_list_prepend (renamed_list, g_object_ref (step->file));
+        }
+    }
+
+  /* tell the folders and views about the changes in one go */
+  if (renamed_list != NULL)
+    {
+      exo_job_send_to_mainloop (EXO_JOB (job), _tij_rename_notify,
+                                renamed_list, _tij_rename_notify_destroy);
+    }
+
+  g_array_free (ops, TRUE);
+  g_list_free_full (steps, _tij_rename_step_free);
+  g_hash_table_destroy (dir_fds);
+
+  if (G_UNLIKELY (err != NULL))
+    {
+      g_propagate_error (error, err);
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+
+
+/**
+ * thunar_io_jobs_rename_files:
+ * @file_list : a #GList of #GFile<!---->s to rename.
+ * @names     : the new display names, one for every file in @file_list.
+ *
+ * Renames all files in @file_list in one transaction. The order of the
+ * renames is chosen so that chains and cycles within the batch (e.g.
+ * swapping the names of two files) work, existing files outside of the
+ * batch are never replaced. Local files are renamed directly relative
+ * to their folder's descriptor. If a rename fails or the job is
+ * cancelled, all previous renames are reverted.
+ *
+ * Return value: the newly allocated #ThunarJob.
+ **/
+ThunarJob *
+thunar_io_jobs_rename_files (GList  *file_list,
+                             gchar **names)
+{
+  _thunar_return_val_if_fail (names != NULL, NULL);
+  _thunar_return_val_if_fail (g_list_length (file_list) == g_strv_length (names), NULL);
+
+  return thunar_simple_job_launch (_thunar_io_jobs_rename_batch, 2,
+                                   THUNAR_TYPE_G_FILE_LIST, file_list,
+                                   G_TYPE_STRV, names);
+}
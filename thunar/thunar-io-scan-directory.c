@@ -180,3 +180,136 @@ thunar_io_scan_directory (ThunarJob          *job,
   
   return files;
 }
+
+
+
+/**
+ * thunar_io_scan_directories:
+ * @job   : a #ThunarJob.
+ * @file  : the directory to scan.
+ * @error : return location for errors or %NULL.
+ *
+ * Like thunar_io_scan_directory(), but only returns #ThunarFile<!---->s for
+ * the subdirectories of @file. The entries are enumerated with just their
+ * name and type, which local backends take from readdir() without a stat,
+ * and the full file information is only queried for the directories.
+ *
+ * Return value: the list of #ThunarFile<!---->s for the subdirectories.
+ **/
+GList *
+thunar_io_scan_directories (ThunarJob *job,
+                            GFile     *file,
+                            GError   **error)
+{
+  GFileEnumerator *enumerator;
+  GFileInfo       *child_info;
+  GFileInfo       *info;
+  GError          *err = NULL;
+  GFile           *child_file;
+  GList           *files = NULL;
+  ThunarFile      *thunar_file;
+  gboolean         is_mounted;
+
+  _thunar_return_val_if_fail (THUNAR_IS_JOB (job), NULL);
+  _thunar_return_val_if_fail (G_IS_FILE (file), NULL);
+  _thunar_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+  /* abort if the job was cancelled */
+  if (exo_job_set_error_if_cancelled (EXO_JOB (job), error))
+    return NULL;
+
+  /* only ask for what we need to filter the directories */
+  enumerator = g_file_enumerate_children (file,
+                                          G_FILE_ATTRIBUTE_STANDARD_TYPE ","
+                                          G_FILE_ATTRIBUTE_STANDARD_NAME,
+                                          G_FILE_QUERY_INFO_NONE,
+                                          exo_job_get_cancellable (EXO_JOB (job)),
+                                          &err);
+  if (err != NULL)
+    {
+      g_propagate_error (error, err);
+      return NULL;
+    }
+
+  while (!exo_job_is_cancelled (EXO_JOB (job)))
+    {
+      info = g_file_enumerator_next_file (enumerator,
+                                          exo_job_get_cancellable (EXO_JOB (job)),
+                                          &err);
+      if (G_UNLIKELY (info == NULL))
+        break;
+
+      is_mounted = TRUE;
+      if (err != NULL)
+        {
+          if (g_error_matches (err, G_IO_ERROR, G_IO_ERROR_NOT_MOUNTED))
+            {
+              is_mounted = FALSE;
+              g_clear_error (&err);
+            }
+          else
+            {
+              /* break on errors */
+              g_object_unref (info);
+              break;
+            }
+        }
+
+      /* skip everything that is not a directory */
+      if (g_file_info_get_file_type (info) == G_FILE_TYPE_DIRECTORY)
+        {
+          child_file = g_file_get_child (file, g_file_info_get_name (info));
+
+          /* load the complete information for the directory */
+          child_info = NULL;
+          if (G_LIKELY (is_mounted))
+            {
+              child_info = g_file_query_info (child_file, THUNARX_FILE_INFO_NAMESPACE,
+                                              G_FILE_QUERY_INFO_NONE,
+                                              exo_job_get_cancellable (EXO_JOB (job)),
+                                              &err);
+              if (err != NULL)
+                {
+                  if (g_error_matches (err, G_IO_ERROR, G_IO_ERROR_NOT_MOUNTED))
+                    is_mounted = FALSE;
+                  g_clear_error (&err);
+                }
+            }
+
+          if (G_LIKELY (child_info != NULL))
+            {
+              thunar_file = thunar_file_get_with_info (child_file, child_info, FALSE);
+              files = g_list_prepend (files, thunar_file);
+              g_object_unref (child_info);
+            }
+          else if (!is_mounted)
+            {
+              /* still show unmounted directories, like thunar_io_scan_directory() */
+              thunar_file = thunar_file_get_with_info (child_file, info, TRUE);
+              files = g_list_prepend (files, thunar_file);
+            }
+
+          g_object_unref (child_file);
+        }
+
+      g_object_unref (info);
+    }
+
+  /* release the enumerator */
+  g_object_unref (enumerator);
+
+  if (G_UNLIKELY (err != NULL))
+    {
+      g_propagate_error (error, err);
+      thunar_g_file_list_free (files);
+      return NULL;
+    }
+  else if (exo_job_set_error_if_cancelled (EXO_JOB (job), &err))
+    {
+      g_propagate_error (error, err);
+      thunar_g_file_list_free (files);
+      return NULL;
+    }
+
+  return files;
+}
@@ -28,13 +28,16 @@
 
 G_BEGIN_DECLS
 
-GList *thunar_io_scan_directory (ThunarJob          *job,
-                                 GFile              *file,
-                                 GFileQueryInfoFlags flags,
-                                 gboolean            recursively,
-                                 gboolean            unlinking,
-                                 gboolean            return_thunar_files,
-                                 GError            **error);
+GList *thunar_io_scan_directory   (ThunarJob          *job,
+                                   GFile              *file,
+                                   GFileQueryInfoFlags flags,
+                                   gboolean            recursively,
+                                   gboolean            unlinking,
+                                   gboolean            return_thunar_files,
+                                   GError            **error);
+GList *thunar_io_scan_directories (ThunarJob          *job,
+                                   GFile              *file,
+                                   GError            **error);
 
 G_END_DECLS
 
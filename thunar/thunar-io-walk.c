@@ -0,0 +1,506 @@
+/* vi:set et ai sw=2 sts=2 ts=2: */
+/*-
+ * Copyright (c) 2015 Xfce Development Team <xfce4-dev@xfce.org>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the Free
+ * Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#ifdef HAVE_SYS_TYPES_H
+#include <sys/types.h>
+#endif
+#ifdef HAVE_SYS_STAT_H
+#include <sys/stat.h>
+#endif
+
+#ifdef HAVE_DIRENT_H
+#include <dirent.h>
+#endif
+#ifdef HAVE_ERRNO_H
+#include <errno.h>
+#endif
+#ifdef HAVE_FCNTL_H
+#include <fcntl.h>
+#endif
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+
+#include <gio/gio.h>
+
+#include <thunar/thunar-gio-extensions.h>
+#include <thunar/thunar-io-walk.h>
+#include <thunar/thunar-private.h>
+
+#if defined(HAVE_OPENAT) && defined(HAVE_FDOPENDIR) && defined(HAVE_FSTATAT)
+#define THUNAR_IO_WALK_NATIVE 1
+#endif
+
+#ifndef O_CLOEXEC
+#define O_CLOEXEC 0
+#endif
+
+/* maximum number of worker threads */
+#define WALK_MAX_THREADS (8)
+
+/* subdirectories are handed to other workers as long as fewer
+ * than this many are waiting in the pool */
+#define WALK_SPLIT_QUEUE (64)
+
+/* interval between two throughput updates, in microseconds */
+#define WALK_PROGRESS_INTERVAL (500 * 1000)
+
+
+
+#ifdef THUNAR_IO_WALK_NATIVE
+typedef struct _ThunarIoWalk     ThunarIoWalk;
+typedef struct _ThunarIoWalkRoot ThunarIoWalkRoot;
+typedef struct _ThunarIoWalkNode ThunarIoWalkNode;
+
+struct _ThunarIoWalk
+{
+  ThunarIoWalkFlags flags;
+  ThunarIoWalkFunc  func;
+  gpointer          user_data;
+  GCancellable     *cancellable;
+  GThreadPool      *pool;
+
+  /* atomic counters */
+  gint              n_queued;
+  gint              n_processed;
+
+  /* number of root directories not yet done, protected by lock */
+  GMutex            lock;
+  GCond             cond;
+  guint             n_active_roots;
+};
+
+struct _ThunarIoWalkRoot
+{
+  GFile            *file;
+  gint              failed;
+};
+
+struct _ThunarIoWalkNode
+{
+  ThunarIoWalkNode *parent;
+  ThunarIoWalkRoot *root;
+  gchar            *path;
+  struct stat       statbuf;
+
+  /* the scan of the node itself plus its outstanding child nodes */
+  gint              pending;
+};
+
+
+
+static void thunar_io_walk_directory (ThunarIoWalk     *walk,
+                                      ThunarIoWalkNode *node,
+                                      gint              dir_fd);
+
+
+
+static ThunarIoWalkNode *
+thunar_io_walk_node_new (ThunarIoWalkNode  *parent,
+                         ThunarIoWalkRoot  *root,
+                         gchar             *path,
+                         const struct stat *statbuf)
+{
+  ThunarIoWalkNode *node;
+
+  node = g_slice_new0 (ThunarIoWalkNode);
+  node->parent = parent;
+  node->root = root;
+  node->path = path;
+  node->pending = 1;
+
+  if (statbuf != NULL)
+    node->statbuf = *statbuf;
+
+  return node;
+}
+
+
+
+static void
+thunar_io_walk_fail (ThunarIoWalkRoot *root)
+{
+  g_atomic_int_set (&root->failed, TRUE);
+}
+
+
+
+static void
+thunar_io_walk_process (ThunarIoWalk      *walk,
+                        ThunarIoWalkRoot  *root,
+                        gint               dir_fd,
+                        const gchar       *name,
+                        const struct stat *statbuf,
+                        gboolean           is_directory)
+{
+  if ((walk->flags & THUNAR_IO_WALK_STAT) == 0)
+    statbuf = NULL;
+
+  if ((*walk->func) (dir_fd, name, statbuf, is_directory, walk->user_data) != 0)
+    thunar_io_walk_fail (root);
+  else
+    g_atomic_int_inc (&walk->n_processed);
+}
+
+
+
+static void
+thunar_io_walk_node_release (ThunarIoWalk     *walk,
+                             ThunarIoWalkNode *node)
+{
+  ThunarIoWalkNode *parent;
+
+  /* walk up as long as we were the last one to finish below a node */
+  while (node != NULL && g_atomic_int_dec_and_test (&node->pending))
+    {
+      /* everything below the directory is done, process the directory itself */
+      if (!g_cancellable_is_cancelled (walk->cancellable))
+        thunar_io_walk_process (walk, node->root, AT_FDCWD, node->path, &node->statbuf, TRUE);
+      else
+        thunar_io_walk_fail (node->root);
+
+      parent = node->parent;
+      if (parent == NULL)
+        {
+          /* the whole tree of this root is done */
+          g_mutex_lock (&walk->lock);
+          walk->n_active_roots -= 1;
+          g_cond_signal (&walk->cond);
+          g_mutex_unlock (&walk->lock);
+        }
+
+      g_free (node->path);
+      g_slice_free (ThunarIoWalkNode, node);
+
+      node = parent;
+    }
+}
+
+
+
+static void
+thunar_io_walk_push (ThunarIoWalk     *walk,
+                     ThunarIoWalkNode *node)
+{
+  g_atomic_int_inc (&walk->n_queued);
+  g_thread_pool_push (walk->pool, node, NULL);
+}
+
+
+
+static void
+thunar_io_walk_worker (gpointer data,
+                       gpointer user_data)
+{
+  ThunarIoWalkNode *node = data;
+  ThunarIoWalk     *walk = user_data;
+  gint              fd;
+
+  g_atomic_int_add (&walk->n_queued, -1);
+
+  if (!g_cancellable_is_cancelled (walk->cancellable))
+    {
+      fd = open (node->path, O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+      if (G_LIKELY (fd >= 0))
+        thunar_io_walk_directory (walk, node, fd);
+      else
+        thunar_io_walk_fail (node->root);
+    }
+
+  thunar_io_walk_node_release (walk, node);
+}
+
+
+
+static void
+thunar_io_walk_directory (ThunarIoWalk     *walk,
+                          ThunarIoWalkNode *node,
+                          gint              dir_fd)
+{
+  ThunarIoWalkNode *child;
+  struct dirent    *dp;
+  struct stat       statbuf;
+  gboolean          is_directory;
+  DIR              *dir;
+  gint              fd;
+
+  dir = fdopendir (dir_fd);
+  if (G_UNLIKELY (dir == NULL))
+    {
+      close (dir_fd);
+      thunar_io_walk_fail (node->root);
+      return;
+    }
+
+  while (!g_cancellable_is_cancelled (walk->cancellable))
+    {
+      errno = 0;
+      dp = readdir (dir);
+      if (dp == NULL)
+        {
+          if (G_UNLIKELY (errno != 0))
+            thunar_io_walk_fail (node->root);
+          break;
+        }
+
+      /* skip "." and ".." */
+      if (dp->d_name[0] == '.'
+          && (dp->d_name[1] == '\0' || (dp->d_name[1] == '.' && dp->d_name[2] == '\0')))
+        continue;
+
+      /* only stat if the caller wants the data or readdir() did not tell the type */
+      if ((walk->flags & THUNAR_IO_WALK_STAT) != 0 || dp->d_type == DT_UNKNOWN)
+        {
+          if (fstatat (dirfd (dir), dp->d_name, &statbuf, AT_SYMLINK_NOFOLLOW) < 0)
+            {
+              thunar_io_walk_fail (node->root);
+              continue;
+            }
+
+          is_directory = S_ISDIR (statbuf.st_mode);
+        }
+      else
+        {
+          is_directory = (dp->d_type == DT_DIR);
+        }
+
+      if (is_directory)
+        {
+          /* every subdirectory gets its own node, so it is processed
+           * only after everything below it, wherever that was walked */
+          child = thunar_io_walk_node_new (node, node->root,
+                                           g_build_filename (node->path, dp->d_name, NULL),
+                                           (walk->flags & THUNAR_IO_WALK_STAT) != 0 ? &statbuf : NULL);
+          g_atomic_int_inc (&node->pending);
+
+          /* hand the subtree to another worker if the pool is running dry */
+          if (g_atomic_int_get (&walk->n_queued) < WALK_SPLIT_QUEUE)
+            {
+              thunar_io_walk_push (walk, child);
+              continue;
+            }
+
+          /* otherwise walk the subtree in this thread */
+          fd = openat (dirfd (dir), dp->d_name, O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+          if (G_LIKELY (fd >= 0))
+            thunar_io_walk_directory (walk, child, fd);
+          else
+            thunar_io_walk_fail (node->root);
+
+          /* processes the subdirectory once its queued children are done */
+          thunar_io_walk_node_release (walk, child);
+
+          if (g_cancellable_is_cancelled (walk->cancellable))
+            break;
+
+          continue;
+        }
+
+      thunar_io_walk_process (walk, node->root, dirfd (dir), dp->d_name, &statbuf, FALSE);
+    }
+
+  closedir (dir);
+}
+#endif /* !THUNAR_IO_WALK_NATIVE */
+
+
+
+/**
+ * thunar_io_walk:
+ * @job                : a #ThunarJob.
+ * @file_list          : a #GList of #GFile<!---->s.
+ * @flags              : #ThunarIoWalkFlags for the walk.
+ * @func               : the function to call for every entry.
+ * @user_data          : user data for @func.
+ * @directories_return : return location for the walked roots that were
+ *                       directories, or %NULL.
+ *
+ * Walks the local files in @file_list and everything below them without
+ * following symlinks, and calls @func for every entry in post-order, so
+ * the contents of a directory are processed before the directory itself.
+ * The directories are read with openat() and readdir() as they are
+ * walked, rather than collected up-front, and the subtrees are spread
+ * over a pool of worker threads. The throughput is reported as info
+ * message on @job.
+ *
+ * Files which are not local, and trees where @func failed for at least
+ * one entry, are returned so that the caller can handle them the slow
+ * way and report errors to the user. If the job is cancelled, the files
+ * that were not walked are returned as well.
+ *
+ * Return value: the #GFile<!---->s from @file_list that were not
+ *               processed completely. Free with thunar_g_file_list_free().
+ **/
+GList *
+thunar_io_walk (ThunarJob        *job,
+                GList            *file_list,
+                ThunarIoWalkFlags flags,
+                ThunarIoWalkFunc  func,
+                gpointer          user_data,
+                GList           **directories_return)
+{
+#ifdef THUNAR_IO_WALK_NATIVE
+  ThunarIoWalkRoot *root;
+  ThunarIoWalkNode *node;
+  ThunarIoWalk      walk;
+  struct stat       statbuf;
+  GList            *remaining = NULL;
+  GList            *roots = NULL;
+  GList            *lp;
+  gchar            *path;
+  gint64            last_time;
+  gint64            now;
+  guint             last_processed = 0;
+  guint             n_processed;
+  guint             n_threads;
+
+  _thunar_return_val_if_fail (THUNAR_IS_JOB (job), NULL);
+  _thunar_return_val_if_fail (func != NULL, NULL);
+
+  if (directories_return != NULL)
+    *directories_return = NULL;
+
+#if GLIB_CHECK_VERSION (2, 36, 0)
+  n_threads = CLAMP (g_get_num_processors (), 2, WALK_MAX_THREADS);
+#else
+  n_threads = 4;
+#endif
+
+  walk.flags = flags;
+  walk.func = func;
+  walk.user_data = user_data;
+  walk.cancellable = exo_job_get_cancellable (EXO_JOB (job));
+  walk.n_queued = 0;
+  walk.n_processed = 0;
+  walk.n_active_roots = 0;
+  walk.pool = g_thread_pool_new (thunar_io_walk_worker, &walk, n_threads, FALSE, NULL);
+  g_mutex_init (&walk.lock);
+  g_cond_init (&walk.cond);
+
+  for (lp = file_list; lp != NULL; lp = lp->next)
+    {
+      /* leave everything we did not start on to the caller */
+      if (exo_job_is_cancelled (EXO_JOB (job)))
+        {
+          remaining = thunar_g_file_list_prepend (remaining, lp->data);
+          continue;
+        }
+
+      /* only local files can be walked, and root folders are left to the caller */
+      path = g_file_get_path (lp->data);
+      if (path == NULL
+          || thunar_g_file_is_root (lp->data)
+          || lstat (path, &statbuf) < 0)
+        {
+          remaining = thunar_g_file_list_prepend (remaining, lp->data);
+          g_free (path);
+          continue;
+        }
+
+      if (!S_ISDIR (statbuf.st_mode))
+        {
+          /* plain files are handled right here */
+          if ((*func) (AT_FDCWD, path, (flags & THUNAR_IO_WALK_STAT) != 0 ? &statbuf : NULL,
+                       FALSE, user_data) != 0)
+            remaining = thunar_g_file_list_prepend (remaining, lp->data);
+          else
+            g_atomic_int_inc (&walk.n_processed);
+
+          g_free (path);
+          continue;
+        }
+
+      /* hand the tree over to the workers, the node takes the path */
+      root = g_slice_new0 (ThunarIoWalkRoot);
+      root->file = g_object_ref (lp->data);
+      roots = g_list_prepend (roots, root);
+
+      g_mutex_lock (&walk.lock);
+      walk.n_active_roots += 1;
+      g_mutex_unlock (&walk.lock);
+
+      node = thunar_io_walk_node_new (NULL, root, path, &statbuf);
+      thunar_io_walk_push (&walk, node);
+    }
+
+  /* wait for the workers, telling the user how fast we are */
+  last_time = g_get_monotonic_time ();
+  g_mutex_lock (&walk.lock);
+  while (walk.n_active_roots > 0)
+    {
+      if (g_cond_wait_until (&walk.cond, &walk.lock, last_time + WALK_PROGRESS_INTERVAL))
+        continue;
+
+      g_mutex_unlock (&walk.lock);
+
+      now = g_get_monotonic_time ();
+      n_processed = g_atomic_int_get (&walk.n_processed);
+      exo_job_info_message (EXO_JOB (job),
+                            ngettext ("%u file processed (%u files/s)",
+                                      "%u files processed (%u files/s)",
+                                      n_processed),
+                            n_processed,
+                            (guint) ((n_processed - last_processed) * G_USEC_PER_SEC / MAX (now - last_time, 1)));
+      last_processed = n_processed;
+      last_time = now;
+
+      g_mutex_lock (&walk.lock);
+    }
+  g_mutex_unlock (&walk.lock);
+
+  /* all nodes are released at this point, so the pool is idle */
+  g_thread_pool_free (walk.pool, FALSE, TRUE);
+  g_mutex_clear (&walk.lock);
+  g_cond_clear (&walk.cond);
+
+  /* sort out the trees that need another look */
+  for (lp = g_list_last (roots); lp != NULL; lp = lp->prev)
+    {
+      root = lp->data;
+
+      if (g_atomic_int_get (&root->failed))
+        remaining = g_list_prepend (remaining, root->file);
+      else if (directories_return != NULL)
+        *directories_return = g_list_prepend (*directories_return, root->file);
+      else
+        g_object_unref (root->file);
+
+      g_slice_free (ThunarIoWalkRoot, root);
+    }
+  g_list_free (roots);
+
+  if (directories_return != NULL)
+    *directories_return = g_list_reverse (*directories_return);
+
+  return g_list_reverse (remaining);
+#else
+  _thunar_return_val_if_fail (THUNAR_IS_JOB (job), NULL);
+
+  if (directories_return != NULL)
+    *directories_return = NULL;
+
+  /* nothing we can do without the *at() functions */
+  return thunar_g_file_list_copy (file_list);
+#endif
+}
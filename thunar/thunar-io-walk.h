@@ -0,0 +1,78 @@
+/* vi:set et ai sw=2 sts=2 ts=2: */
+/*-
+ * Copyright (c) 2015 Xfce Development Team <xfce4-dev@xfce.org>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the Free
+ * Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __THUNAR_IO_WALK_H__
+#define __THUNAR_IO_WALK_H__
+
+#ifdef HAVE_SYS_TYPES_H
+#include <sys/types.h>
+#endif
+#ifdef HAVE_SYS_STAT_H
+#include <sys/stat.h>
+#endif
+
+#include <thunar/thunar-job.h>
+
+G_BEGIN_DECLS
+
+/**
+ * ThunarIoWalkFlags:
+ * @THUNAR_IO_WALK_NONE : no special behaviour.
+ * @THUNAR_IO_WALK_STAT : lstat() every entry and pass the data to the
+ *                        #ThunarIoWalkFunc.
+ **/
+typedef enum
+{
+  THUNAR_IO_WALK_NONE = 0,
+  THUNAR_IO_WALK_STAT = 1 << 0,
+} ThunarIoWalkFlags;
+
+/**
+ * ThunarIoWalkFunc:
+ * @dir_fd       : descriptor of the directory containing @name, or
+ *                 %AT_FDCWD if @name is an absolute path.
+ * @name         : the entry to process.
+ * @statbuf      : the lstat() data of the entry if %THUNAR_IO_WALK_STAT
+ *                 was passed, %NULL otherwise.
+ * @is_directory : %TRUE if the entry is a directory. Directories are
+ *                 processed after everything below them.
+ * @user_data    : the user data passed to thunar_io_walk().
+ *
+ * Called for every entry of the walked trees, possibly from several
+ * threads at the same time.
+ *
+ * Return value: 0 on success, an errno value otherwise.
+ **/
+typedef gint (*ThunarIoWalkFunc) (gint               dir_fd,
+                                  const gchar       *name,
+                                  const struct stat *statbuf,
+                                  gboolean           is_directory,
+                                  gpointer           user_data);
+
+GList *thunar_io_walk (ThunarJob        *job,
+                       GList            *file_list,
+                       ThunarIoWalkFlags flags,
+                       ThunarIoWalkFunc  func,
+                       gpointer          user_data,
+                       GList           **directories_return) G_GNUC_WARN_UNUSED_RESULT;
+
+G_END_DECLS
+
+#endif /* !__THUNAR_IO_WALK_H__ */
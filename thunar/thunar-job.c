@@ -518,6 +518,38 @@ thunar_job_ask_skip (ThunarJob   *job,
 
 
 
+ThunarJobResponse
+thunar_job_ask_delete (ThunarJob   *job,
+                       guint        n_files,
+                       const gchar *format,
+                       ...)
+{
+  ThunarJobResponse response;
+  va_list           var_args;
+
+  _thunar_return_val_if_fail (THUNAR_IS_JOB (job), THUNAR_JOB_RESPONSE_CANCEL);
+  _thunar_return_val_if_fail (format != NULL, THUNAR_JOB_RESPONSE_CANCEL);
+
+  /* check if the user already cancelled the job */
+  if (G_UNLIKELY (exo_job_is_cancelled (EXO_JOB (job))))
+    return THUNAR_JOB_RESPONSE_CANCEL;
+
+  /* ask the user what he wants to do */
+  va_start (var_args, format);
+  response = _thunar_job_ask_valist (job, format, var_args,
+                                     ngettext ("Do you want to permanently delete it instead?",
+                                               "Do you want to permanently delete them instead?",
+                                               n_files),
+                                     THUNAR_JOB_RESPONSE_YES
+                                     | THUNAR_JOB_RESPONSE_NO
+                                     | THUNAR_JOB_RESPONSE_CANCEL);
+  va_end (var_args);
+
+  return response;
+}
+
+
+
 gboolean
 thunar_job_ask_no_size (ThunarJob   *job,
                         const gchar *format,
@@ -84,6 +84,10 @@ ThunarJobResponse thunar_job_ask_replace            (ThunarJob       *job,
 ThunarJobResponse thunar_job_ask_skip               (ThunarJob       *job,
                                                      const gchar     *format,
                                                      ...);
+ThunarJobResponse thunar_job_ask_delete             (ThunarJob       *job,
+                                                     guint            n_files,
+                                                     const gchar     *format,
+                                                     ...);
 gboolean          thunar_job_ask_no_size            (ThunarJob       *job,
                                                      const gchar     *format,
                                                      ...);
@@ -29,6 +29,7 @@
 #include <string.h>
 #endif
 
+#include <thunar/thunar-app-info-cache.h>
 #include <thunar/thunar-application.h>
 #include <thunar/thunar-browser.h>
 #include <thunar/thunar-chooser-dialog.h>
@@ -95,6 +96,12 @@ static void                    thunar_launcher_open_paths                 (GAppI
 static void                    thunar_launcher_open_windows               (ThunarLauncher           *launcher,
                                                                            GList                    *directories);
 static void                    thunar_launcher_update                     (ThunarLauncher           *launcher);
+static void                    thunar_launcher_connect_proxy              (GtkActionGroup           *action_group,
+                                                                           GtkAction                *action,
+                                                                           GtkWidget                *proxy,
+                                                                           ThunarLauncher           *launcher);
+static gboolean                thunar_launcher_watch_idle                 (gpointer                  user_data);
+static void                    thunar_launcher_watch_idle_destroy         (gpointer                  user_data);
 static void                    thunar_launcher_action_open                (GtkAction                *action,
                                                                            ThunarLauncher           *launcher);
 static void                    thunar_launcher_action_open_with_other     (GtkAction                *action,
@@ -136,7 +143,10 @@ struct _ThunarLauncher
   ThunarFile             *current_directory;
   GList                  *selected_files;
 
+  /* the actions are only updated when a menu needs them */
+  gboolean                dirty;
   guint                   launcher_idle_id;
+  guint                   watch_idle_id;
 
   GtkIconFactory         *icon_factory;
   GtkActionGroup         *action_group;
@@ -153,6 +163,7 @@ struct _ThunarLauncher
   GtkWidget              *widget;
 
   ThunarDeviceMonitor    *device_monitor;
+  ThunarAppInfoCache     *app_info_cache;
   ThunarSendtoModel      *sendto_model;
   guint                   sendto_idle_id;
 };
@@ -274,6 +285,7 @@ thunar_launcher_init (ThunarLauncher *launcher)
   launcher->action_group = gtk_action_group_new ("ThunarLauncher");
   gtk_action_group_set_translation_domain (launcher->action_group, GETTEXT_PACKAGE);
   gtk_action_group_add_actions (launcher->action_group, action_entries, G_N_ELEMENTS (action_entries), launcher);
+  g_signal_connect (launcher->action_group, "connect-proxy", G_CALLBACK (thunar_launcher_connect_proxy), launcher);
 
   /* determine references to our actions */
   launcher->action_open = gtk_action_group_get_action (launcher->action_group, "open");
@@ -293,6 +305,10 @@ thunar_launcher_init (ThunarLauncher *launcher)
   launcher->device_monitor = thunar_device_monitor_get ();
   g_signal_connect_swapped (launcher->device_monitor, "device-added", G_CALLBACK (thunar_launcher_update), launcher);
   g_signal_connect_swapped (launcher->device_monitor, "device-removed", G_CALLBACK (thunar_launcher_update), launcher);
+
+  /* the "Open With" actions change with the installed applications */
+  launcher->app_info_cache = thunar_app_info_cache_get ();
+  g_signal_connect_swapped (launcher->app_info_cache, "changed", G_CALLBACK (thunar_launcher_update), launcher);
 }
 
 
@@ -329,6 +345,10 @@ thunar_launcher_finalize (GObject *object)
   if (G_UNLIKELY (launcher->launcher_idle_id != 0))
     g_source_remove (launcher->launcher_idle_id);
 
+  /* be sure to cancel the menu watch idle source */
+  if (G_UNLIKELY (launcher->watch_idle_id != 0))
+    g_source_remove (launcher->watch_idle_id);
+
   /* drop our custom icon factory for the application/action icons */
   gtk_icon_factory_remove_default (launcher->icon_factory);
   g_object_unref (launcher->icon_factory);
@@ -340,6 +360,10 @@ thunar_launcher_finalize (GObject *object)
   g_signal_handlers_disconnect_by_func (launcher->device_monitor, thunar_launcher_update, launcher);
   g_object_unref (launcher->device_monitor);
 
+  /* disconnect from the application info cache */
+  g_signal_handlers_disconnect_by_func (launcher->app_info_cache, thunar_launcher_update, launcher);
+  g_object_unref (launcher->app_info_cache);
+
   /* release the reference on the sendto model */
   g_object_unref (launcher->sendto_model);
 
@@ -767,8 +791,8 @@ thunar_launcher_update_idle (gpointer data)
   gchar          *tooltip;
   gchar          *label;
   gchar          *name;
+  gboolean        all_executable = TRUE;
   gint            n_directories = 0;
-  gint            n_executables = 0;
   gint            n_regulars = 0;
   gint            n_selected_files = 0;
   gint            n;
@@ -779,6 +803,9 @@ thunar_launcher_update_idle (gpointer data)
 
   GDK_THREADS_ENTER ();
 
+  /* the actions are up to date now */
+  launcher->dirty = FALSE;
+
   /* drop the previous addons ui controls from the UI manager */
   if (G_LIKELY (launcher->ui_addons_merge_id != 0))
     {
@@ -801,8 +828,9 @@ thunar_launcher_update_idle (gpointer data)
         }
       else
         {
-          if (thunar_file_is_executable (lp->data))
-            ++n_executables;
+          /* no need to check the remaining files once one of them is not executable */
+          if (all_executable && !thunar_file_is_executable (lp->data))
+            all_executable = FALSE;
           ++n_regulars;
         }
     }
@@ -924,7 +952,7 @@ thunar_launcher_update_idle (gpointer data)
       actions = NULL;
 
       /* check if we have only executable files in the selection */
-      if (G_UNLIKELY (n_executables == n_selected_files))
+      if (G_UNLIKELY (all_executable))
         {
           /* turn the "Open" action into "Execute" */
           g_object_set (G_OBJECT (launcher->action_open),
@@ -982,7 +1010,7 @@ thunar_launcher_update_idle (gpointer data)
       /* place the other applications in the "Open With" submenu if we have more than 2 other applications, or the
        * default action for the file is "Execute", in which case the "Open With" actions aren't that relevant either
        */
-      if (G_UNLIKELY (g_list_length (applications) > 2 || n_executables == n_selected_files))
+      if (G_UNLIKELY (g_list_length (applications) > 2 || all_executable))
         {
           /* determine the base paths for the actions */
           file_menu_path = "/main-menu/file-menu/placeholder-launcher/open-with-menu/placeholder-applications";
@@ -1089,10 +1117,11 @@ thunar_launcher_update_check (ThunarLauncher *launcher,
   _thunar_return_if_fail (menu == NULL || GTK_IS_MENU (menu));
 
   /* check if the menu is in a dirty state */
-  if (launcher->launcher_idle_id != 0)
+  if (launcher->dirty && launcher->ui_manager != NULL)
     {
-      /* stop the timeout */
-      g_source_remove (launcher->launcher_idle_id);
+      /* stop the pending update */
+      if (launcher->launcher_idle_id != 0)
+        g_source_remove (launcher->launcher_idle_id);
 
       /* force an update */
       thunar_launcher_update_idle (launcher);
@@ -1109,25 +1138,21 @@ thunar_launcher_update_check (ThunarLauncher *launcher,
 
 
 
-static void
-thunar_launcher_update (ThunarLauncher *launcher)
+static GtkWidget*
+thunar_launcher_watch_menus (ThunarLauncher *launcher)
 {
-  GSList    *proxies, *lp;
+  GtkWidget *visible_menu = NULL;
   GtkWidget *menu;
-  gboolean   instant_update;
-
-  _thunar_return_if_fail (THUNAR_IS_LAUNCHER (launcher));
+  GSList    *lp;
 
-  proxies = gtk_action_get_proxies (launcher->action_open);
-  instant_update = (proxies == NULL);
-  for (lp = proxies; lp != NULL; lp = lp->next)
+  for (lp = gtk_action_get_proxies (launcher->action_open); lp != NULL; lp = lp->next)
     {
       menu = gtk_widget_get_ancestor (lp->data, GTK_TYPE_MENU);
       if (G_LIKELY (menu != NULL))
         {
-          /* instant update if a menu is visible */
+          /* remember if a menu is visible */
           if (gtk_widget_get_visible (menu))
-            instant_update = TRUE;
+            visible_menu = menu;
 
           /* watch menu changes */
           g_signal_handlers_disconnect_by_func (G_OBJECT (menu), G_CALLBACK (thunar_launcher_update_check), launcher);
@@ -1135,32 +1160,94 @@ thunar_launcher_update (ThunarLauncher *launcher)
         }
     }
 
-  /* stop pending timeouts */
-  if (launcher->launcher_idle_id != 0)
-    g_source_remove (launcher->launcher_idle_id);
+  return visible_menu;
+}
+
+
 
-  if (instant_update)
+static void
+thunar_launcher_update (ThunarLauncher *launcher)
+{
+  _thunar_return_if_fail (THUNAR_IS_LAUNCHER (launcher));
+
+  /* the actions need to be recomputed before they are used the next time */
+  launcher->dirty = TRUE;
+
+  if (thunar_launcher_watch_menus (launcher) != NULL)
     {
-      /* directly update without interruption */
-      thunar_launcher_update_idle (launcher);
+      /* a menu is visible, update once the selection settled down */
+      if (launcher->launcher_idle_id == 0)
+        {
+          launcher->launcher_idle_id = g_idle_add_full (G_PRIORITY_LOW, thunar_launcher_update_idle,
+                                                        launcher, thunar_launcher_update_idle_destroy);
+        }
     }
   else
     {
-      /* assume all actions are working */
+      /* nobody looks at the actions, drop any pending update */
+      if (launcher->launcher_idle_id != 0)
+        g_source_remove (launcher->launcher_idle_id);
+
+      /* assume all actions are working, they are updated when one
+       * of the menus is shown or an action is activated */
       gtk_action_set_sensitive (launcher->action_open, TRUE);
       gtk_action_set_visible (launcher->action_open_with_other, TRUE);
       gtk_action_set_visible (launcher->action_open_in_new_window, TRUE);
       gtk_action_set_visible (launcher->action_open_in_new_tab, TRUE);
       gtk_action_set_visible (launcher->action_open_with_other_in_menu, TRUE);
+    }
+}
+
 
-      /* delayed update */
-      launcher->launcher_idle_id = g_timeout_add_seconds_full (G_PRIORITY_LOW, 5, thunar_launcher_update_idle,
-                                                               launcher, thunar_launcher_update_idle_destroy);
+
+static void
+thunar_launcher_connect_proxy (GtkActionGroup *action_group,
+                               GtkAction      *action,
+                               GtkWidget      *proxy,
+                               ThunarLauncher *launcher)
+{
+  _thunar_return_if_fail (THUNAR_IS_LAUNCHER (launcher));
+
+  /* a new menu was built for the "Open" action, the proxy is not
+   * inside the menu yet, so start watching it once the ui manager
+   * is done */
+  if (action == launcher->action_open && launcher->watch_idle_id == 0)
+    {
+      launcher->watch_idle_id = g_idle_add_full (G_PRIORITY_HIGH_IDLE, thunar_launcher_watch_idle,
+                                                 launcher, thunar_launcher_watch_idle_destroy);
     }
 }
 
 
 
+static gboolean
+thunar_launcher_watch_idle (gpointer user_data)
+{
+  ThunarLauncher *launcher = THUNAR_LAUNCHER (user_data);
+  GtkWidget      *menu;
+
+  GDK_THREADS_ENTER ();
+
+  /* catch up if the new menu is already visible */
+  menu = thunar_launcher_watch_menus (launcher);
+  if (menu != NULL)
+    thunar_launcher_update_check (launcher, menu);
+
+  GDK_THREADS_LEAVE ();
+
+  return FALSE;
+}
+
+
+
+static void
+thunar_launcher_watch_idle_destroy (gpointer user_data)
+{
+  THUNAR_LAUNCHER (user_data)->watch_idle_id = 0;
+}
+
+
+
 static void
 thunar_launcher_open_file (ThunarLauncher *launcher,
                            ThunarFile     *file)
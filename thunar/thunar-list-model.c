@@ -32,7 +32,9 @@
 
 #include <thunar/thunar-application.h>
 #include <thunar/thunar-file-monitor.h>
+#include <thunar/thunar-filesystem-cache.h>
 #include <thunar/thunar-gobject-extensions.h>
+#include <thunar/thunar-image-probe.h>
 #include <thunar/thunar-list-model.h>
 #include <thunar/thunar-preferences.h>
 #include <thunar/thunar-private.h>
@@ -67,6 +69,9 @@ typedef gint (*ThunarSortFunc) (const ThunarFile *a,
                                 const ThunarFile *b,
                                 gboolean          case_sensitive);
 
+typedef struct _ThunarListModelAccount ThunarListModelAccount;
+typedef struct _ThunarListModelSummary ThunarListModelSummary;
+
 
 
 static void               thunar_list_model_tree_model_init       (GtkTreeModelIface      *iface);
@@ -151,6 +156,17 @@ static void               thunar_list_model_files_added           (ThunarFolder
 static void               thunar_list_model_files_removed         (ThunarFolder           *folder,
                                                                    GList                  *files,
                                                                    ThunarListModel        *store);
+static void               thunar_list_model_account_add           (ThunarListModel        *store,
+                                                                   ThunarFile             *file);
+static void               thunar_list_model_account_remove        (ThunarListModel        *store,
+                                                                   ThunarFile             *file);
+static void               thunar_list_model_account_update        (ThunarListModel        *store,
+                                                                   ThunarFile             *file);
+static void               thunar_list_model_account_clear         (ThunarListModel        *store);
+static void               thunar_list_model_account_free          (gpointer                data);
+static void               thunar_list_model_summary_apply         (ThunarListModelSummary *summary,
+                                                                   ThunarListModelAccount *account,
+                                                                   gboolean                add);
 static gint               sort_by_date_accessed                   (const ThunarFile       *a,
                                                                    const ThunarFile       *b,
                                                                    gboolean                case_sensitive);
@@ -196,6 +212,20 @@ struct _ThunarListModelClass
                  const GError    *error);
 };
 
+/* what a row contributes to the statusbar totals */
+struct _ThunarListModelAccount
+{
+  guint64 size;
+  guint   is_folder : 1;
+};
+
+struct _ThunarListModelSummary
+{
+  gint    folder_count;
+  gint    non_folder_count;
+  guint64 size_summary;
+};
+
 struct _ThunarListModel
 {
   GObject __parent__;
@@ -221,6 +251,20 @@ struct _ThunarListModel
    */
   ThunarFileMonitor *file_monitor;
 
+  /* free space of the folder's filesystem for the statusbar */
+  ThunarFilesystemCache *filesystem_cache;
+
+  /* dimensions of the selected image for the statusbar */
+  ThunarImageProbe      *image_probe;
+
+  /* running totals for the statusbar, so it never has to walk
+   * all the rows: ThunarFile -> ThunarListModelAccount for every
+   * row, and the selected rows with their own totals */
+  GHashTable            *accounts;
+  ThunarListModelSummary summary;
+  GHashTable            *selection;
+  ThunarListModelSummary selection_summary;
+
   /* ids for the "row-inserted" and "row-deleted" signals
    * of GtkTreeModel to speed up folder changing.
    */
@@ -429,6 +473,12 @@ thunar_list_model_init (ThunarListModel *store)
   store->file_monitor = thunar_file_monitor_get_default ();
   g_signal_connect (G_OBJECT (store->file_monitor), "file-changed",
                     G_CALLBACK (thunar_list_model_file_changed), store);
+
+  store->filesystem_cache = thunar_filesystem_cache_get ();
+  store->image_probe = thunar_image_probe_get ();
+
+  store->accounts = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL, thunar_list_model_account_free);
+  store->selection = g_hash_table_new (g_direct_hash, g_direct_equal);
 }
 
 
@@ -455,6 +505,12 @@ thunar_list_model_finalize (GObject *object)
   g_signal_handlers_disconnect_by_func (G_OBJECT (store->file_monitor), thunar_list_model_file_changed, store);
   g_object_unref (G_OBJECT (store->file_monitor));
 
+  g_object_unref (G_OBJECT (store->filesystem_cache));
+  g_object_unref (G_OBJECT (store->image_probe));
+
+  g_hash_table_destroy (store->selection);
+  g_hash_table_destroy (store->accounts);
+
   (*G_OBJECT_CLASS (thunar_list_model_parent_class)->finalize) (object);
 }
 
@@ -1124,6 +1180,13 @@ thunar_list_model_file_changed (ThunarFileMonitor *file_monitor,
   _thunar_return_if_fail (THUNAR_IS_LIST_MODEL (store));
   _thunar_return_if_fail (THUNAR_IS_FILE (file));
 
+  /* files not in the model have no account */
+  if (!g_hash_table_lookup_extended (store->accounts, file, NULL, NULL))
+    return;
+
+  /* the size of the file might have changed */
+  thunar_list_model_account_update (store, file);
+
   row = g_sequence_get_begin_iter (store->rows);
   end = g_sequence_get_end_iter (store->rows);
 
@@ -1260,6 +1323,7 @@ thunar_list_model_files_added (ThunarFolder    *folder,
           /* insert the file */
           row = g_sequence_insert_sorted (store->rows, file,
                                           thunar_list_model_cmp_func, store);
+          thunar_list_model_account_add (store, file);
 
           if (has_handler)
             {
@@ -1311,6 +1375,7 @@ thunar_list_model_files_removed (ThunarFolder    *folder,
               path = gtk_tree_path_new_from_indices (g_sequence_iter_get_position (row), -1);
 
               /* remove file from the model */
+              thunar_list_model_account_remove (store, lp->data);
               g_sequence_remove (row);
 
               /* notify the view(s) */
@@ -1342,6 +1407,121 @@ thunar_list_model_files_removed (ThunarFolder    *folder,
 
 
 
+static void
+thunar_list_model_summary_apply (ThunarListModelSummary *summary,
+                                 ThunarListModelAccount *account,
+                                 gboolean                add)
+{
+  gint delta = add ? 1 : -1;
+
+  if (account->is_folder)
+    summary->folder_count += delta;
+  else
+    summary->non_folder_count += delta;
+
+  if (add)
+    summary->size_summary += account->size;
+  else
+    summary->size_summary -= account->size;
+}
+
+
+
+static void
+thunar_list_model_account_add (ThunarListModel *store,
+                               ThunarFile      *file)
+{
+  ThunarListModelAccount *account;
+
+  _thunar_return_if_fail (THUNAR_IS_LIST_MODEL (store));
+  _thunar_return_if_fail (THUNAR_IS_FILE (file));
+
+  account = g_slice_new (ThunarListModelAccount);
+  account->is_folder = thunar_file_is_directory (file);
+  account->size = thunar_file_is_regular (file) ? thunar_file_get_size (file) : 0;
+  g_hash_table_insert (store->accounts, file, account);
+
+  thunar_list_model_summary_apply (&store->summary, account, TRUE);
+}
+
+
+
+static void
+thunar_list_model_account_remove (ThunarListModel *store,
+                                  ThunarFile      *file)
+{
+  ThunarListModelAccount *account;
+
+  _thunar_return_if_fail (THUNAR_IS_LIST_MODEL (store));
+  _thunar_return_if_fail (THUNAR_IS_FILE (file));
+
+  account = g_hash_table_lookup (store->accounts, file);
+  if (G_UNLIKELY (account == NULL))
+    return;
+
+  /* a removed row cannot be selected anymore */
+  if (g_hash_table_remove (store->selection, file))
+    thunar_list_model_summary_apply (&store->selection_summary, account, FALSE);
+
+  thunar_list_model_summary_apply (&store->summary, account, FALSE);
+  g_hash_table_remove (store->accounts, file);
+}
+
+
+
+static void
+thunar_list_model_account_update (ThunarListModel *store,
+                                  ThunarFile      *file)
+{
+  ThunarListModelAccount *account;
+  gboolean                selected;
+
+  _thunar_return_if_fail (THUNAR_IS_LIST_MODEL (store));
+  _thunar_return_if_fail (THUNAR_IS_FILE (file));
+
+  account = g_hash_table_lookup (store->accounts, file);
+  if (G_UNLIKELY (account == NULL))
+    return;
+
+  selected = g_hash_table_lookup (store->selection, file) != NULL;
+
+  /* replace the old contribution of the file with the new one */
+  thunar_list_model_summary_apply (&store->summary, account, FALSE);
+  if (selected)
+    thunar_list_model_summary_apply (&store->selection_summary, account, FALSE);
+
+  account->is_folder = thunar_file_is_directory (file);
+  account->size = thunar_file_is_regular (file) ? thunar_file_get_size (file) : 0;
+
+  thunar_list_model_summary_apply (&store->summary, account, TRUE);
+  if (selected)
+    thunar_list_model_summary_apply (&store->selection_summary, account, TRUE);
+}
+
+
+
+static void
+thunar_list_model_account_clear (ThunarListModel *store)
+{
+  _thunar_return_if_fail (THUNAR_IS_LIST_MODEL (store));
+
+  g_hash_table_remove_all (store->selection);
+  g_hash_table_remove_all (store->accounts);
+
+  memset (&store->summary, 0, sizeof (store->summary));
+  memset (&store->selection_summary, 0, sizeof (store->selection_summary));
+}
+
+
+
+static void
+thunar_list_model_account_free (gpointer data)
+{
+  g_slice_free (ThunarListModelAccount, data);
+}
+
+
+
 static gint
 sort_by_date_accessed (const ThunarFile *a,
                        const ThunarFile *b,
@@ -1783,6 +1963,9 @@ thunar_list_model_set_folder (ThunarListModel *store,
       row = g_sequence_get_begin_iter (store->rows);
       end = g_sequence_get_end_iter (store->rows);
 
+      /* reset the statusbar totals */
+      thunar_list_model_account_clear (store);
+
       /* remove existing entries */
       path = gtk_tree_path_new_first ();
       while (row != end)
@@ -1946,6 +2129,7 @@ thunar_list_model_set_show_hidden (ThunarListModel *store,
           /* insert file in the sorted position */
           row = g_sequence_insert_sorted (store->rows, file,
                                           thunar_list_model_cmp_func, store);
+          thunar_list_model_account_add (store, file);
 
           GTK_TREE_ITER_INIT (iter, store->stamp, row);
 
@@ -1979,6 +2163,7 @@ thunar_list_model_set_show_hidden (ThunarListModel *store,
               path = gtk_tree_path_new_from_indices (g_sequence_iter_get_position (row), -1);
 
               /* remove file from the model */
+              thunar_list_model_account_remove (store, file);
               g_sequence_remove (row);
 
               /* notify the view(s) */
@@ -2206,12 +2391,60 @@ thunar_list_model_get_paths_for_pattern (ThunarListModel *store,
 
 
 /**
- * thunar_list_model_get_statusbar_text:
+ * thunar_list_model_set_selected_files:
  * @store          : a #ThunarListModel instance.
- * @selected_items : the list of selected items (as GtkTreePath's).
+ * @selected_files : the list of selected #ThunarFile<!---->s.
  *
- * Generates the statusbar text for @store with the given
- * @selected_items.
+ * Tells @store which of its files are selected in the view, so
+ * thunar_list_model_get_statusbar_text() can describe the selection
+ * from the running totals. Only the files that were selected or
+ * unselected since the last call change the totals.
+ **/
+void
+thunar_list_model_set_selected_files (ThunarListModel *store,
+                                      GList           *selected_files)
+{
+  ThunarListModelAccount *account;
+  GHashTableIter          iter;
+  GHashTable             *selection;
+  gpointer                value;
+  GList                  *lp;
+
+  _thunar_return_if_fail (THUNAR_IS_LIST_MODEL (store));
+
+  selection = g_hash_table_new (g_direct_hash, g_direct_equal);
+
+  for (lp = selected_files; lp != NULL; lp = lp->next)
+    {
+      /* skip files that are not (or no longer) rows of the model */
+      account = g_hash_table_lookup (store->accounts, lp->data);
+      if (G_UNLIKELY (account == NULL || g_hash_table_lookup (selection, lp->data) != NULL))
+        continue;
+
+      /* count the newly selected files, keep the others */
+      if (!g_hash_table_remove (store->selection, lp->data))
+        thunar_list_model_summary_apply (&store->selection_summary, account, TRUE);
+
+      g_hash_table_insert (selection, lp->data, account);
+    }
+
+  /* what is left of the old selection was unselected */
+  g_hash_table_iter_init (&iter, store->selection);
+  while (g_hash_table_iter_next (&iter, NULL, &value))
+    thunar_list_model_summary_apply (&store->selection_summary, value, FALSE);
+
+  g_hash_table_destroy (store->selection);
+  store->selection = selection;
+}
+
+
+
+/**
+ * thunar_list_model_get_statusbar_text:
+ * @store : a #ThunarListModel instance.
+ *
+ * Generates the statusbar text for @store with the files
+ * selected by thunar_list_model_set_selected_files().
  *
  * This function is used by the #ThunarStandardView (and thereby
  * implicitly by #ThunarIconView and #ThunarDetailsView) to
@@ -2221,23 +2454,21 @@ thunar_list_model_get_paths_for_pattern (ThunarListModel *store,
  * The caller is reponsible to free the returned text using
  * g_free() when it's no longer needed.
  *
- * Return value: the statusbar text for @store with the given
- *               @selected_items.
+ * Return value: the statusbar text for @store with the
+ *               selected files.
  **/
 gchar*
-thunar_list_model_get_statusbar_text (ThunarListModel *store,
-                                      GList           *selected_items)
+thunar_list_model_get_statusbar_text (ThunarListModel *store)
 {
   const gchar       *content_type;
   const gchar       *original_path;
-  GtkTreeIter        iter;
+  GHashTableIter     iter;
+  gpointer           key;
   ThunarFile        *file;
   guint64            size;
   guint64            size_summary;
   gint               folder_count;
   gint               non_folder_count;
-  GList             *lp;
-  gchar             *absolute_path;
   gchar             *fspace_string;
   gchar             *display_name;
   gchar             *size_string;
@@ -2248,8 +2479,6 @@ thunar_list_model_get_statusbar_text (ThunarListModel *store,
   gint               height;
   gint               width;
   gchar             *description;
-  GSequenceIter     *row;
-  GSequenceIter     *end;
   gint               nrows;
   ThunarPreferences *preferences;
   gboolean           show_image_size;
@@ -2259,7 +2488,7 @@ thunar_list_model_get_statusbar_text (ThunarListModel *store,
 
   file_size_binary = thunar_list_model_get_file_size_binary(store);
 
-  if (selected_items == NULL)
+  if (g_hash_table_size (store->selection) == 0)
     {
       /* try to determine a file for the current folder */
       file = (store->folder != NULL) ? thunar_folder_get_corresponding_file (store->folder) : NULL;
@@ -2268,23 +2497,13 @@ thunar_list_model_get_statusbar_text (ThunarListModel *store,
 
       /* check if we can determine the amount of free space for the volume */
       if (G_LIKELY (file != NULL
-          && thunar_g_file_get_free_space (thunar_file_get_file (file), &size, NULL)))
+          && thunar_filesystem_cache_get_free_space (store->filesystem_cache, thunar_file_get_file (file), &size, NULL)))
         {
           /* humanize the free space */
           fspace_string = g_format_size_full (size, file_size_binary ? G_FORMAT_SIZE_IEC_UNITS : G_FORMAT_SIZE_DEFAULT);
-          size_summary = 0;
 
-          row = g_sequence_get_begin_iter (store->rows);
-          end = g_sequence_get_end_iter (store->rows);
-
-          /* calculate the size of all file items */
-          while (row != end)
-            {
-              file = g_sequence_get (row);
-              if (thunar_file_is_regular (file))
-                size_summary += thunar_file_get_size (file);
-              row = g_sequence_iter_next (row);
-            }
+          /* the size of all file items */
+          size_summary = store->summary.size_summary;
 
           if (size_summary > 0)
             {
@@ -2309,13 +2528,12 @@ thunar_list_model_get_statusbar_text (ThunarListModel *store,
           text = g_strdup_printf (ngettext ("%d item", "%d items", nrows), nrows);
         }
     }
-  else if (selected_items->next == NULL)
+  else if (g_hash_table_size (store->selection) == 1)
     {
-      /* resolve the iter for the single path */
-      gtk_tree_model_get_iter (GTK_TREE_MODEL (store), &iter, selected_items->data);
-
-      /* get the file for the given iter */
-      file = g_sequence_get (iter.user_data);
+      /* get the single selected file */
+      g_hash_table_iter_init (&iter, store->selection);
+      g_hash_table_iter_next (&iter, &key, NULL);
+      file = THUNAR_FILE (key);
 
       /* determine the content type of the file */
       content_type = thunar_file_get_content_type (file);
@@ -2378,45 +2596,24 @@ thunar_list_model_get_statusbar_text (ThunarListModel *store,
           g_object_get (preferences, "misc-image-size-in-statusbar", &show_image_size, NULL);
           g_object_unref (preferences);
 
-          if (show_image_size)
+          /* check if we know the dimension of this file already, else it is
+           * probed in the background and the view updates the text later */
+          if (show_image_size
+              && thunar_image_probe_get_size (store->image_probe, file, &width, &height))
             {
-              /* check if we can determine the dimension of this file (only for image files) */
-              absolute_path = g_file_get_path (thunar_file_get_file (file));
-              if (absolute_path != NULL
-                  && gdk_pixbuf_get_file_info (absolute_path, &width, &height) != NULL)
-                {
-                  /* append the image dimensions to the statusbar text */
-                  s = g_strdup_printf ("%s, %s %dx%d", text, _("Image Size:"), width, height);
-                  g_free (text);
-                  text = s;
-                }
-              g_free (absolute_path);
+              /* append the image dimensions to the statusbar text */
+              s = g_strdup_printf ("%s, %s %dx%d", text, _("Image Size:"), width, height);
+              g_free (text);
+              text = s;
             }
         }
     }
   else
     {
-      /* reset */
-      size_summary = 0;
-      folder_count = 0;
-      non_folder_count = 0;
-
-      /* analyze selection */
-      for (lp = selected_items; lp != NULL; lp = lp->next)
-        {
-          gtk_tree_model_get_iter (GTK_TREE_MODEL (store), &iter, lp->data);
-          file = g_sequence_get (iter.user_data);
-          if (thunar_file_is_directory (file))
-            {
-              folder_count++;
-            }
-          else
-            {
-              non_folder_count++;
-              if (thunar_file_is_regular (file))
-                size_summary += thunar_file_get_size (file);
-            }
-        }
+      /* the totals of the selection */
+      size_summary = store->selection_summary.size_summary;
+      folder_count = store->selection_summary.folder_count;
+      non_folder_count = store->selection_summary.non_folder_count;
 
      /* text for the items in the folder */
      if (non_folder_count > 0)
@@ -62,8 +62,9 @@ GList           *thunar_list_model_get_paths_for_files    (ThunarListModel  *sto
 GList           *thunar_list_model_get_paths_for_pattern  (ThunarListModel  *store,
                                                            const gchar      *pattern);
 
-gchar           *thunar_list_model_get_statusbar_text     (ThunarListModel  *store,
-                                                           GList            *selected_items);
+void             thunar_list_model_set_selected_files     (ThunarListModel  *store,
+                                                           GList            *selected_files);
+gchar           *thunar_list_model_get_statusbar_text     (ThunarListModel  *store);
 
 G_END_DECLS;
 
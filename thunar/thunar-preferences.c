@@ -91,6 +91,7 @@ enum
   PROP_MISC_TEXT_BESIDE_ICONS,
   PROP_MISC_THUMBNAIL_MODE,
   PROP_MISC_FILE_SIZE_BINARY,
+  PROP_MISC_TRANSFER_VERIFY_CHECKSUM,
   PROP_SHORTCUTS_ICON_EMBLEMS,
   PROP_SHORTCUTS_ICON_SIZE,
   PROP_TREE_ICON_EMBLEMS,
@@ -705,6 +706,21 @@ thunar_preferences_class_init (ThunarPreferencesClass *klass)
                             FALSE,
                             EXO_PARAM_READWRITE);
 
+  /**
+   * ThunarPreferences:misc-transfer-verify-checksum:
+   *
+   * Whether files that were already copied by an interrupted copy
+   * operation are compared by checksum before they are skipped when
+   * the operation is resumed, instead of only by size and
+   * modification time.
+   **/
+  preferences_props[PROP_MISC_TRANSFER_VERIFY_CHECKSUM] =
+      g_param_spec_boolean ("misc-transfer-verify-checksum",
+                            "MiscTransferVerifyChecksum",
+                            NULL,
+                            FALSE,
+                            EXO_PARAM_READWRITE);
+
   /**
    * ThunarPreferences:shortcuts-icon-emblems:
    *
@@ -41,6 +41,7 @@
 #include <thunar/thunar-chooser-button.h>
 #include <thunar/thunar-dialogs.h>
 #include <thunar/thunar-emblem-chooser.h>
+#include <thunar/thunar-filesystem-cache.h>
 #include <thunar/thunar-gio-extensions.h>
 #include <thunar/thunar-gobject-extensions.h>
 #include <thunar/thunar-gtk-extensions.h>
@@ -99,6 +100,11 @@ static void     thunar_properties_dialog_icon_button_clicked  (GtkWidget
                                                                ThunarPropertiesDialog      *dialog);
 static void     thunar_properties_dialog_update               (ThunarPropertiesDialog      *dialog);
 static void     thunar_properties_dialog_update_providers     (ThunarPropertiesDialog      *dialog);
+static void     thunar_properties_dialog_update_free_space    (ThunarPropertiesDialog      *dialog,
+                                                               ThunarFile                  *file);
+static void     thunar_properties_dialog_filesystem_changed   (ThunarFilesystemCache       *cache,
+                                                               GFile                       *root,
+                                                               ThunarPropertiesDialog      *dialog);
 static GList   *thunar_properties_dialog_get_files            (ThunarPropertiesDialog      *dialog);
 
 
@@ -125,6 +131,8 @@ struct _ThunarPropertiesDialog
   ThunarThumbnailer      *thumbnailer;
   guint                   thumbnail_request;
 
+  ThunarFilesystemCache  *filesystem_cache;
+
   GtkWidget              *notebook;
   GtkWidget              *icon_button;
   GtkWidget              *icon_image;
@@ -247,6 +255,11 @@ thunar_properties_dialog_init (ThunarPropertiesDialog *dialog)
   dialog->thumbnailer = thunar_thumbnailer_get ();
   dialog->thumbnail_request = 0;
 
+  /* refresh the free space once the cached values are updated */
+  dialog->filesystem_cache = thunar_filesystem_cache_get ();
+  g_signal_connect (G_OBJECT (dialog->filesystem_cache), "changed",
+                    G_CALLBACK (thunar_properties_dialog_filesystem_changed), dialog);
+
   dialog->provider_factory = thunarx_provider_factory_get_default ();
 
   gtk_dialog_add_buttons (GTK_DIALOG (dialog),
@@ -600,6 +613,10 @@ thunar_properties_dialog_finalize (GObject *object)
   /* release the thumbnailer */
   g_object_unref (dialog->thumbnailer);
 
+  /* release the filesystem cache */
+  g_signal_handlers_disconnect_by_func (dialog->filesystem_cache, thunar_properties_dialog_filesystem_changed, dialog);
+  g_object_unref (dialog->filesystem_cache);
+
   /* release the provider property pages */
   g_list_free_full (dialog->provider_pages, g_object_unref);
 
@@ -882,6 +899,62 @@ thunar_properties_dialog_update_providers (ThunarPropertiesDialog *dialog)
 
 
 
+static void
+thunar_properties_dialog_update_free_space (ThunarPropertiesDialog *dialog,
+                                            ThunarFile             *file)
+{
+  gchar   *fs_string = NULL;
+  guint64  fs_free;
+  guint64  fs_size;
+  gdouble  fs_fraction = 0.0;
+
+  _thunar_return_if_fail (THUNAR_IS_PROPERTIES_DIALOG (dialog));
+  _thunar_return_if_fail (THUNAR_IS_FILE (file));
+
+  if (thunar_file_is_directory (file))
+    {
+      fs_string = thunar_filesystem_cache_get_free_space_string (dialog->filesystem_cache,
+                                                                 thunar_file_get_file (file),
+                                                                 dialog->file_size_binary);
+      if (thunar_filesystem_cache_get_free_space (dialog->filesystem_cache, thunar_file_get_file (file),
+                                                  &fs_free, &fs_size)
+          && fs_size > 0)
+        {
+          /* free disk space fraction */
+          fs_fraction = ((fs_size - fs_free) * 100 / fs_size);
+        }
+    }
+
+  if (fs_string != NULL)
+    {
+      gtk_label_set_text (GTK_LABEL (dialog->freespace_label), fs_string);
+      gtk_progress_bar_set_fraction (GTK_PROGRESS_BAR (dialog->freespace_bar), fs_fraction / 100);
+      gtk_widget_show (dialog->freespace_vbox);
+      g_free (fs_string);
+    }
+  else
+    {
+      gtk_widget_hide (dialog->freespace_vbox);
+    }
+}
+
+
+
+static void
+thunar_properties_dialog_filesystem_changed (ThunarFilesystemCache  *cache,
+                                             GFile                  *root,
+                                             ThunarPropertiesDialog *dialog)
+{
+  _thunar_return_if_fail (THUNAR_IS_FILESYSTEM_CACHE (cache));
+  _thunar_return_if_fail (THUNAR_IS_PROPERTIES_DIALOG (dialog));
+
+  /* only the single file page shows the free space */
+  if (dialog->files != NULL && dialog->files->next == NULL)
+    thunar_properties_dialog_update_free_space (dialog, THUNAR_FILE (dialog->files->data));
+}
+
+
+
 static void
 thunar_properties_dialog_update_single (ThunarPropertiesDialog *dialog)
 {
@@ -896,15 +969,11 @@ thunar_properties_dialog_update_single (ThunarPropertiesDialog *dialog)
   glong              offset;
   gchar             *date;
   gchar             *display_name;
-  gchar             *fs_string;
   gchar             *str;
   gchar             *volume_name;
   ThunarFile        *file;
   ThunarFile        *parent_file;
   gboolean           show_chooser;
-  guint64            fs_free;
-  guint64            fs_size;
-  gdouble            fs_fraction = 0.0;
 
   _thunar_return_if_fail (THUNAR_IS_PROPERTIES_DIALOG (dialog));
   _thunar_return_if_fail (g_list_length (dialog->files) == 1);
@@ -1081,32 +1150,7 @@ thunar_properties_dialog_update_single (ThunarPropertiesDialog *dialog)
     }
 
   /* update the free space (only for folders) */
-  if (thunar_file_is_directory (file))
-    {
-      fs_string = thunar_g_file_get_free_space_string (thunar_file_get_file (file),
-                                                       dialog->file_size_binary);
-      if (thunar_g_file_get_free_space (thunar_file_get_file (file), &fs_free, &fs_size)
-          && fs_size > 0)
-        {
-          /* free disk space fraction */
-          fs_fraction = ((fs_size - fs_free) * 100 / fs_size);
-        }
-      if (fs_string != NULL)
-        {
-          gtk_label_set_text (GTK_LABEL (dialog->freespace_label), fs_string);
-          gtk_progress_bar_set_fraction (GTK_PROGRESS_BAR (dialog->freespace_bar), fs_fraction / 100);
-          gtk_widget_show (dialog->freespace_vbox);
-          g_free (fs_string);
-        }
-      else
-        {
-          gtk_widget_hide (dialog->freespace_vbox);
-        }
-    }
-  else
-    {
-      gtk_widget_hide (dialog->freespace_vbox);
-    }
+  thunar_properties_dialog_update_free_space (dialog, file);
 
   /* update the volume */
   volume = thunar_file_get_volume (file);
@@ -39,6 +39,12 @@
 
 #define THUNAR_RENAMER_MODEL_ITEM(item) ((ThunarRenamerModelItem *) (item))
 
+/* maximum time (in microseconds) the update idle source may run at once */
+#define UPDATE_TIME_SLICE (10 * 1000)
+
+/* number of items handed to the renamer at once */
+#define UPDATE_BATCH_SIZE (64)
+
 
 
 /* Property identifiers */
@@ -109,14 +115,23 @@ static void                    thunar_renamer_model_file_changed        (ThunarR
 static void                    thunar_renamer_model_file_destroyed      (ThunarRenamerModel      *renamer_model,
                                                                          ThunarFile              *file,
                                                                          ThunarFileMonitor       *file_monitor);
+static void                    thunar_renamer_model_name_changed        (ThunarRenamerModel      *renamer_model,
+                                                                         ThunarxFileInfo         *file,
+                                                                         ThunarxRenamer          *renamer);
 static void                    thunar_renamer_model_invalidate_all      (ThunarRenamerModel      *renamer_model);
 static void                    thunar_renamer_model_invalidate_item     (ThunarRenamerModel      *renamer_model,
-                                                                         ThunarRenamerModelItem  *item);
-static gboolean                thunar_renamer_model_conflict_item       (ThunarRenamerModel      *renamer_model,
-                                                                         ThunarRenamerModelItem  *item);
-static gchar                  *thunar_renamer_model_process_item        (ThunarRenamerModel      *renamer_model,
-                                                                         ThunarRenamerModelItem  *item,
-                                                                         guint                    idx);
+                                                                         GList                   *lp);
+static void                    thunar_renamer_model_update_indices      (ThunarRenamerModel      *renamer_model);
+static void                    thunar_renamer_model_drop_item           (ThunarRenamerModel      *renamer_model,
+                                                                         GList                   *lp);
+static gboolean                thunar_renamer_model_target_register     (ThunarRenamerModel      *renamer_model,
+                                                                         GList                   *lp);
+static void                    thunar_renamer_model_target_unregister   (ThunarRenamerModel      *renamer_model,
+                                                                         GList                   *lp);
+static void                    thunar_renamer_model_process_items       (ThunarRenamerModel      *renamer_model,
+                                                                         ThunarRenamerModelItem **items,
+                                                                         guint                    n_items,
+                                                                         gchar                  **names);
 static gboolean                thunar_renamer_model_update_idle         (gpointer                 user_data);
 static void                    thunar_renamer_model_update_idle_destroy (gpointer                 user_data);
 static ThunarRenamerModelItem *thunar_renamer_model_item_new            (ThunarFile              *file) G_GNUC_MALLOC;
@@ -154,6 +169,22 @@ struct _ThunarRenamerModel
   ThunarFileMonitor *file_monitor;
   ThunarxRenamer    *renamer;
   GList             *items;
+  GList             *items_tail;
+  guint              n_items;
+
+  /* ThunarFile -> the link of its item in items */
+  GHashTable        *links;
+
+  /* TRUE if the index of every item is up to date */
+  gboolean           indices_valid;
+
+  /* the links of the items that must be updated */
+  GQueue             dirty;
+
+  /* "directory/target name" -> GQueue of the links of the up to
+   * date items that end up with that name, more than one means
+   * that these items conflict */
+  GHashTable        *targets;
 
   /* TRUE if the model is currently frozen */
   gboolean           frozen;
@@ -166,6 +197,9 @@ struct _ThunarRenamerModelItem
 {
   ThunarFile *file;
   gchar      *name;
+  gchar      *directory;    /* URI of the parent folder */
+  gchar      *target;       /* key in the targets table, if registered */
+  guint       index;        /* position in the model, see indices_valid */
   guint64     date_changed;
   guint       changed : 1;  /* if the file changed */
   guint       conflict : 1; /* if the item conflicts with another item */
@@ -276,6 +310,11 @@ thunar_renamer_model_init (ThunarRenamerModel *renamer_model)
   renamer_model->stamp = g_random_int ();
 #endif
 
+  renamer_model->links = g_hash_table_new (g_direct_hash, g_direct_equal);
+  renamer_model->targets = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify) g_queue_free);
+  renamer_model->indices_valid = TRUE;
+  g_queue_init (&renamer_model->dirty);
+
   /* connect to the file monitor */
   renamer_model->file_monitor = thunar_file_monitor_get_default ();
   g_signal_connect_swapped (G_OBJECT (renamer_model->file_monitor), "file-changed",
@@ -296,6 +335,9 @@ thunar_renamer_model_finalize (GObject *object)
 
   /* release all items */
   g_list_free_full (renamer_model->items, thunar_renamer_model_item_free);
+  g_hash_table_destroy (renamer_model->links);
+  g_hash_table_destroy (renamer_model->targets);
+  g_queue_clear (&renamer_model->dirty);
 
   /* disconnect from the file monitor */
   g_signal_handlers_disconnect_by_func (G_OBJECT (renamer_model->file_monitor), thunar_renamer_model_file_destroyed, renamer_model);
@@ -454,7 +496,10 @@ thunar_renamer_model_get_path (GtkTreeModel *tree_model,
   _thunar_return_val_if_fail (iter->stamp == renamer_model->stamp, NULL);
 
   /* determine the idx of the item */
-  idx = g_list_position (renamer_model->items, iter->user_data);
+  if (G_LIKELY (renamer_model->indices_valid))
+    idx = THUNAR_RENAMER_MODEL_ITEM (((GList *) iter->user_data)->data)->index;
+  else
+    idx = g_list_position (renamer_model->items, iter->user_data);
   if (G_UNLIKELY (idx < 0))
     return NULL;
 
@@ -562,7 +607,7 @@ static gint
 thunar_renamer_model_iter_n_children (GtkTreeModel *tree_model,
                                       GtkTreeIter  *iter)
 {
-  return (iter == NULL) ? g_list_length (THUNAR_RENAMER_MODEL (tree_model)->items) : 0;
+  return (iter == NULL) ? THUNAR_RENAMER_MODEL (tree_model)->n_items : 0;
 }
 
 
@@ -615,41 +660,40 @@ thunar_renamer_model_file_changed (ThunarRenamerModel *renamer_model,
   _thunar_return_if_fail (renamer_model->file_monitor == file_monitor);
 
   /* check if we have that file */
-  for (lp = renamer_model->items; lp != NULL; lp = lp->next)
-    if (THUNAR_RENAMER_MODEL_ITEM (lp->data)->file == file)
-      {
-        item = THUNAR_RENAMER_MODEL_ITEM (lp->data);
-
-        /* check if the file changed on disk, this is done to prevent
-         * excessive looping when some renamers are used
-         * (thunar-media-tags-plugin is an example) */
-        date_changed = thunar_file_get_date (file, THUNAR_FILE_DATE_CHANGED);
-        if (item->date_changed == date_changed)
-          break;
+  lp = g_hash_table_lookup (renamer_model->links, file);
+  if (G_LIKELY (lp == NULL))
+    return;
 
-        /* check if we're frozen */
-        if (G_LIKELY (!renamer_model->frozen))
-          {
-            /* the file changed */
-            item->changed = TRUE;
+  item = THUNAR_RENAMER_MODEL_ITEM (lp->data);
 
-            /* set the new mtime */
-            item->date_changed = date_changed;
+  /* check if the file changed on disk, this is done to prevent
+   * excessive looping when some renamers are used
+   * (thunar-media-tags-plugin is an example) */
+  date_changed = thunar_file_get_date (file, THUNAR_FILE_DATE_CHANGED);
+  if (item->date_changed == date_changed)
+    return;
 
-            /* invalidate the item */
-            thunar_renamer_model_invalidate_item (renamer_model, item);
-            break;
-          }
+  /* check if we're frozen */
+  if (G_LIKELY (!renamer_model->frozen))
+    {
+      /* the file changed */
+      item->changed = TRUE;
 
-        /* determine the iter for the item */
-        GTK_TREE_ITER_INIT (iter, renamer_model->stamp, lp);
+      /* set the new mtime */
+      item->date_changed = date_changed;
 
-        /* emit "row-changed" to display up2date file name */
-        path = gtk_tree_model_get_path (GTK_TREE_MODEL (renamer_model), &iter);
-        gtk_tree_model_row_changed (GTK_TREE_MODEL (renamer_model), path, &iter);
-        gtk_tree_path_free (path);
-        break;
-      }
+      /* invalidate the item */
+      thunar_renamer_model_invalidate_item (renamer_model, lp);
+      return;
+    }
+
+  /* determine the iter for the item */
+  GTK_TREE_ITER_INIT (iter, renamer_model->stamp, lp);
+
+  /* emit "row-changed" to display up2date file name */
+  path = gtk_tree_model_get_path (GTK_TREE_MODEL (renamer_model), &iter);
+  gtk_tree_model_row_changed (GTK_TREE_MODEL (renamer_model), path, &iter);
+  gtk_tree_path_free (path);
 }
 
 
@@ -669,27 +713,43 @@ thunar_renamer_model_file_destroyed (ThunarRenamerModel *renamer_model,
   _thunar_return_if_fail (THUNAR_IS_FILE (file));
 
   /* check if we have that file */
-  for (lp = renamer_model->items; lp != NULL; lp = lp->next)
-    if (THUNAR_RENAMER_MODEL_ITEM (lp->data)->file == file)
-      {
-        /* determine the idx of the item */
-        idx = g_list_position (renamer_model->items, lp);
-
-        /* free the item data */
-        thunar_renamer_model_item_free (lp->data);
-
-        /* drop the item from the list */
-        renamer_model->items = g_list_delete_link (renamer_model->items, lp);
-
-        /* tell the view that the item is gone */
-        path = gtk_tree_path_new_from_indices (idx, -1);
-        gtk_tree_model_row_deleted (GTK_TREE_MODEL (renamer_model), path);
-        gtk_tree_path_free (path);
-
-        /* invalidate all other items */
-        thunar_renamer_model_invalidate_all (renamer_model);
-        break;
-      }
+  lp = g_hash_table_lookup (renamer_model->links, file);
+  if (G_LIKELY (lp == NULL))
+    return;
+
+  /* determine the idx of the item */
+  thunar_renamer_model_update_indices (renamer_model);
+  idx = THUNAR_RENAMER_MODEL_ITEM (lp->data)->index;
+
+  /* drop the item from the model */
+  thunar_renamer_model_drop_item (renamer_model, lp);
+
+  /* tell the view that the item is gone */
+  path = gtk_tree_path_new_from_indices (idx, -1);
+  gtk_tree_model_row_deleted (GTK_TREE_MODEL (renamer_model), path);
+  gtk_tree_path_free (path);
+
+  /* invalidate all other items */
+  thunar_renamer_model_invalidate_all (renamer_model);
+}
+
+
+
+static void
+thunar_renamer_model_name_changed (ThunarRenamerModel *renamer_model,
+                                   ThunarxFileInfo    *file,
+                                   ThunarxRenamer     *renamer)
+{
+  GList *lp;
+
+  _thunar_return_if_fail (THUNAR_IS_RENAMER_MODEL (renamer_model));
+  _thunar_return_if_fail (renamer_model->renamer == renamer);
+  _thunar_return_if_fail (THUNARX_IS_FILE_INFO (file));
+
+  /* only the new name of this file changed */
+  lp = g_hash_table_lookup (renamer_model->links, file);
+  if (G_LIKELY (lp != NULL))
+    thunar_renamer_model_invalidate_item (renamer_model, lp);
 }
 
 
@@ -701,17 +761,26 @@ thunar_renamer_model_invalidate_all (ThunarRenamerModel *renamer_model)
 
   /* invalidate all items in the model */
   for (lp = renamer_model->items; lp != NULL; lp = lp->next)
-    thunar_renamer_model_invalidate_item (renamer_model, lp->data);
+    thunar_renamer_model_invalidate_item (renamer_model, lp);
 }
 
 
 
 static void
-thunar_renamer_model_invalidate_item (ThunarRenamerModel     *renamer_model,
-                                      ThunarRenamerModelItem *item)
+thunar_renamer_model_invalidate_item (ThunarRenamerModel *renamer_model,
+                                      GList              *lp)
 {
+  ThunarRenamerModelItem *item = THUNAR_RENAMER_MODEL_ITEM (lp->data);
+
+  /* the target name of the item is about to change */
+  thunar_renamer_model_target_unregister (renamer_model, lp);
+
   /* mark the item as dirty */
-  item->dirty = TRUE;
+  if (G_LIKELY (!item->dirty))
+    {
+      item->dirty = TRUE;
+      g_queue_push_tail (&renamer_model->dirty, lp);
+    }
 
   /* check if the update idle source is already running and not frozen */
   if (G_UNLIKELY (renamer_model->update_idle_id == 0 && !renamer_model->frozen))
@@ -727,161 +796,265 @@ thunar_renamer_model_invalidate_item (ThunarRenamerModel     *renamer_model,
 
 
 
-static gboolean
-trm_same_directory (ThunarFile *a,
-                    ThunarFile *b)
+static void
+thunar_renamer_model_update_indices (ThunarRenamerModel *renamer_model)
 {
-  GFile    *parent_a;
-  GFile    *parent_b;
-  gboolean  result;
+  GList *lp;
+  guint  idx;
+
+  if (G_LIKELY (renamer_model->indices_valid))
+    return;
+
+  for (idx = 0, lp = renamer_model->items; lp != NULL; ++idx, lp = lp->next)
+    THUNAR_RENAMER_MODEL_ITEM (lp->data)->index = idx;
+
+  renamer_model->indices_valid = TRUE;
+}
 
-  /* determine the parent paths for both files */
-  parent_a = g_file_get_parent (thunar_file_get_file (a));
-  parent_b = g_file_get_parent (thunar_file_get_file (b));
 
-  /* check if both files have the same parent */
-  result = (parent_a != NULL && parent_b != NULL && g_file_equal (parent_a, parent_b));
 
-  if (parent_a != NULL)
-    g_object_unref (parent_a);
-  if (parent_b != NULL)
-    g_object_unref (parent_b);
+static void
+thunar_renamer_model_drop_item (ThunarRenamerModel *renamer_model,
+                                GList              *lp)
+{
+  ThunarRenamerModelItem *item = THUNAR_RENAMER_MODEL_ITEM (lp->data);
 
-  return result;
+  /* forget about the item */
+  thunar_renamer_model_target_unregister (renamer_model, lp);
+  if (G_UNLIKELY (item->dirty))
+    g_queue_remove (&renamer_model->dirty, lp);
+  g_hash_table_remove (renamer_model->links, item->file);
+
+  /* free the item data */
+  thunar_renamer_model_item_free (item);
+
+  /* drop the item from the list */
+  if (lp == renamer_model->items_tail)
+    renamer_model->items_tail = lp->prev;
+  renamer_model->items = g_list_delete_link (renamer_model->items, lp);
+  renamer_model->n_items -= 1;
+  renamer_model->indices_valid = FALSE;
 }
 
 
 
 static gboolean
-thunar_renamer_model_conflict_item (ThunarRenamerModel     *renamer_model,
-                                    ThunarRenamerModelItem *item)
+thunar_renamer_model_target_register (ThunarRenamerModel *renamer_model,
+                                      GList              *lp)
 {
+  ThunarRenamerModelItem *item = THUNAR_RENAMER_MODEL_ITEM (lp->data);
   ThunarRenamerModelItem *oitem;
   GtkTreePath            *path;
   GtkTreeIter             iter;
-  gboolean                conflict = FALSE;
-  GList                  *lp;
+  const gchar            *name;
+  GQueue                 *links;
+  GList                  *llp;
 
-  for (lp = renamer_model->items; lp != NULL; lp = lp->next)
+  _thunar_return_val_if_fail (item->target == NULL, FALSE);
+  _thunar_return_val_if_fail (renamer_model->indices_valid, FALSE);
+
+  /* items can only conflict if they end up with the same name in the same directory */
+  name = (item->name != NULL) ? item->name : thunar_file_get_display_name (item->file);
+  item->target = g_strconcat (item->directory != NULL ? item->directory : "", "/", name, NULL);
+
+  links = g_hash_table_lookup (renamer_model->targets, item->target);
+  if (G_LIKELY (links == NULL))
     {
-      /* check if this item is dirty or the item we're about to check */
-      oitem = THUNAR_RENAMER_MODEL_ITEM (lp->data);
-      if (G_UNLIKELY (oitem == item || oitem->dirty))
-        continue;
+      /* no other item uses this name */
+      links = g_queue_new ();
+      g_queue_push_tail (links, lp);
+      g_hash_table_insert (renamer_model->targets, g_strdup (item->target), links);
+      return FALSE;
+    }
 
-      /* check if this other item conflicts with the item in question (can only conflict if in same directory) */
-      if (trm_same_directory (item->file, oitem->file)
-          && ((item->name != NULL && oitem->name == NULL && strcmp (item->name, thunar_file_get_display_name (oitem->file)) == 0)
-           || (item->name == NULL && oitem->name != NULL && strcmp (thunar_file_get_display_name (item->file), oitem->name) == 0)
-           || (item->name != NULL && oitem->name != NULL && strcmp (item->name, oitem->name) == 0)))
+  /* all the other items with this name conflict as well */
+  for (llp = links->head; llp != NULL; llp = llp->next)
+    {
+      oitem = THUNAR_RENAMER_MODEL_ITEM (((GList *) llp->data)->data);
+      if (G_LIKELY (!oitem->conflict))
         {
-          /* check if the other item is already in conflict state */
-          if (G_LIKELY (!oitem->conflict))
-            {
-              /* set to conflict state */
-              oitem->conflict = TRUE;
+          /* set to conflict state */
+          oitem->conflict = TRUE;
+
+          /* emit "row-changed" for the other item */
+          GTK_TREE_ITER_INIT (iter, renamer_model->stamp, llp->data);
+          path = gtk_tree_path_new_from_indices (oitem->index, -1);
+          gtk_tree_model_row_changed (GTK_TREE_MODEL (renamer_model), path, &iter);
+          gtk_tree_path_free (path);
+        }
+    }
 
-              /* determine iter for other item */
-              GTK_TREE_ITER_INIT (iter, renamer_model->stamp, lp);
+  g_queue_push_tail (links, lp);
 
-              /* emit "row-changed" for the other item */
-              path = gtk_tree_model_get_path (GTK_TREE_MODEL (renamer_model), &iter);
-              gtk_tree_model_row_changed (GTK_TREE_MODEL (renamer_model), path, &iter);
-              gtk_tree_path_free (path);
-            }
+  /* this item conflicts */
+  return TRUE;
+}
 
-          /* this item conflicts */
-          conflict = TRUE;
-        }
+
+
+static void
+thunar_renamer_model_target_unregister (ThunarRenamerModel *renamer_model,
+                                        GList              *lp)
+{
+  ThunarRenamerModelItem *item = THUNAR_RENAMER_MODEL_ITEM (lp->data);
+  GQueue                 *links;
+  GList                  *olp;
+
+  if (item->target == NULL)
+    return;
+
+  links = g_hash_table_lookup (renamer_model->targets, item->target);
+  _thunar_assert (links != NULL);
+
+  g_queue_remove (links, lp);
+  if (links->length == 0)
+    {
+      g_hash_table_remove (renamer_model->targets, item->target);
+    }
+  else if (links->length == 1)
+    {
+      /* the remaining item might not conflict anymore, update it */
+      olp = links->head->data;
+      if (THUNAR_RENAMER_MODEL_ITEM (olp->data)->conflict)
+        thunar_renamer_model_invalidate_item (renamer_model, olp);
     }
 
-  return conflict;
+  g_free (item->target);
+  item->target = NULL;
 }
 
 
 
-static gchar*
-thunar_renamer_model_process_item (ThunarRenamerModel     *renamer_model,
-                                   ThunarRenamerModelItem *item,
-                                   guint                   idx)
+static void
+thunar_renamer_model_process_items (ThunarRenamerModel      *renamer_model,
+                                    ThunarRenamerModelItem **items,
+                                    guint                    n_items,
+                                    gchar                  **names)
 {
-  ThunarRenamerMode mode;
-  const gchar      *display_name;
-  const gchar      *dot;
-  gchar            *name = NULL;
-  gchar            *prefix;
-  gchar            *suffix;
-  gchar            *text;
+  ThunarRenamerMode *modes;
+  ThunarxFileInfo  **files;
+  const gchar      **texts;
+  const gchar      **dots;
+  const gchar       *display_name;
+  gchar            **results;
+  gchar             *prefix;
+  guint             *indices;
+  guint             *map;
+  guint              n_files = 0;
+  guint              m, n;
+
+  for (n = 0; n < n_items; ++n)
+    names[n] = NULL;
 
   /* no new name if no renamer is set */
-  if (G_UNLIKELY (renamer_model->renamer == NULL))
-    return NULL;
-
-  /* determine the current display name of the file */
-  display_name = thunar_file_get_display_name (item->file);
+  if (G_UNLIKELY (renamer_model->renamer == NULL || n_items == 0))
+    return;
 
-  /* determine the extension in the filename */
-  dot = thunar_util_str_get_extension (display_name);
+  modes = g_new (ThunarRenamerMode, n_items);
+  dots = g_new (const gchar *, n_items);
+  files = g_new (ThunarxFileInfo *, n_items);
+  texts = g_new (const gchar *, n_items);
+  indices = g_new (guint, n_items);
+  map = g_new (guint, n_items);
 
-  /* if we don't have a dot, then no "Suffix only" rename can take place */
-  if (G_LIKELY (dot != NULL || renamer_model->mode != THUNAR_RENAMER_MODE_SUFFIX))
+  /* determine the part of each name the renamer should be applied to */
+  for (n = 0; n < n_items; ++n)
     {
+      /* determine the current display name of the file */
+      display_name = thunar_file_get_display_name (items[n]->file);
+
+      /* determine the extension in the filename */
+      dots[n] = thunar_util_str_get_extension (display_name);
+
+      /* if we don't have a dot, then no "Suffix only" rename can take place */
+      if (G_UNLIKELY (dots[n] == NULL && renamer_model->mode == THUNAR_RENAMER_MODE_SUFFIX))
+        continue;
+
       /* now, for "Name only", we need a dot, otherwise treat everything as name */
-      if (renamer_model->mode == THUNAR_RENAMER_MODE_NAME && dot == NULL)
-        mode = THUNAR_RENAMER_MODE_BOTH;
+      if (renamer_model->mode == THUNAR_RENAMER_MODE_NAME && dots[n] == NULL)
+        modes[n] = THUNAR_RENAMER_MODE_BOTH;
       else
-        mode = renamer_model->mode;
+        modes[n] = renamer_model->mode;
 
-      /* determine the new name according to the mode */
-      switch (mode)
+      /* determine the text according to the mode */
+      switch (modes[n])
         {
         case THUNAR_RENAMER_MODE_NAME:
-          /* determine the name part of the display name */
-          text = g_strndup (display_name, (dot - display_name));
+          /* the name part of the display name */
+          texts[n_files] = g_strndup (display_name, (dots[n] - display_name));
+          break;
 
-          /* determine the new name */
-          prefix = thunarx_renamer_process (renamer_model->renamer, THUNARX_FILE_INFO (item->file), text, idx);
+        case THUNAR_RENAMER_MODE_SUFFIX:
+          /* the suffix without the dot */
+          texts[n_files] = dots[n] + 1;
+          break;
 
-          /* determine the new full name */
-          name = g_strconcat (prefix, dot, NULL);
+        case THUNAR_RENAMER_MODE_BOTH:
+          /* the full display name */
+          texts[n_files] = display_name;
+          break;
 
-          /* release the temporary strings */
-          g_free (prefix);
-          g_free (text);
+        default:
+          _thunar_assert_not_reached ();
           break;
+        }
 
-        case THUNAR_RENAMER_MODE_SUFFIX:
-          /* determine the new suffix */
-          suffix = thunarx_renamer_process (renamer_model->renamer, THUNARX_FILE_INFO (item->file), dot + 1, idx);
+      files[n_files] = THUNARX_FILE_INFO (items[n]->file);
+      indices[n_files] = items[n]->index;
+      map[n_files] = n;
+      ++n_files;
+    }
 
-          prefix = g_strndup (display_name, (dot - display_name) + 1);
-          name = g_strconcat (prefix, suffix, NULL);
-          g_free (prefix);
+  /* let the renamer determine all new names at once */
+  results = (n_files > 0) ? thunarx_renamer_process_batch (renamer_model->renamer, files, texts, indices, n_files) : NULL;
+
+  /* determine the new full names */
+  for (m = 0; m < n_files; ++m)
+    {
+      n = map[m];
+      display_name = thunar_file_get_display_name (items[n]->file);
 
-          /* release the suffix */
-          g_free (suffix);
+      switch (modes[n])
+        {
+        case THUNAR_RENAMER_MODE_NAME:
+          names[n] = g_strconcat (results[m], dots[n], NULL);
+          g_free ((gchar *) texts[m]);
+          g_free (results[m]);
+          break;
+
+        case THUNAR_RENAMER_MODE_SUFFIX:
+          prefix = g_strndup (display_name, (dots[n] - display_name) + 1);
+          names[n] = g_strconcat (prefix, results[m], NULL);
+          g_free (results[m]);
+          g_free (prefix);
           break;
 
         case THUNAR_RENAMER_MODE_BOTH:
-          /* determine the new full name */
-          name = thunarx_renamer_process (renamer_model->renamer, THUNARX_FILE_INFO (item->file), display_name, idx);
+          names[n] = results[m];
           break;
 
         default:
           _thunar_assert_not_reached ();
           break;
         }
-    }
 
-  /* check if the new name is equal to the old one */
-  if (exo_str_is_equal (name, display_name))
-    {
-      /* just return NULL then */
-      g_free (name);
-      name = NULL;
+      /* check if the new name is equal to the old one */
+      if (exo_str_is_equal (names[n], display_name))
+        {
+          /* just use NULL then */
+          g_free (names[n]);
+          names[n] = NULL;
+        }
     }
 
-  return name;
+  /* the strings were either released or taken above */
+  g_free (results);
+  g_free (map);
+  g_free (indices);
+  g_free (texts);
+  g_free (files);
+  g_free (dots);
+  g_free (modes);
 }
 
 
@@ -889,82 +1062,112 @@ thunar_renamer_model_process_item (ThunarRenamerModel     *renamer_model,
 static gboolean
 thunar_renamer_model_update_idle (gpointer user_data)
 {
+  ThunarRenamerModelItem *items[UPDATE_BATCH_SIZE];
   ThunarRenamerModelItem *item;
   ThunarRenamerModel     *renamer_model = THUNAR_RENAMER_MODEL (user_data);
   GtkTreePath            *path;
   GtkTreeIter             iter;
-  gboolean                changed = FALSE;
+  gboolean                changes[UPDATE_BATCH_SIZE];
+  gboolean                changed;
   gboolean                conflict;
-  guint                   idx;
-  gchar                  *name;
+  gboolean                pending = FALSE;
+  gint64                  deadline;
+  gchar                  *names[UPDATE_BATCH_SIZE];
+  GList                  *batch[UPDATE_BATCH_SIZE];
   GList                  *lp;
+  guint                   n_items;
+  guint                   n;
 
   GDK_THREADS_ENTER ();
 
   /* don't do anything if the model is frozen */
   if (G_LIKELY (!renamer_model->frozen))
     {
-      /* process the first dirty item */
-      for (idx = 0, lp = renamer_model->items; !changed && lp != NULL; ++idx, lp = lp->next)
-        {
-          /* check if this item is dirty */
-          item = THUNAR_RENAMER_MODEL_ITEM (lp->data);
-          if (G_LIKELY (!item->dirty))
-            continue;
-
-          /* check if the file changed */
-          changed = item->changed;
+      /* the renamers need the position of the items */
+      thunar_renamer_model_update_indices (renamer_model);
 
-          /* mark as valid, since we're updating right now */
-          item->changed = FALSE;
-          item->dirty = FALSE;
-
-          /* determine the new name for the item */
-          name = thunar_renamer_model_process_item (renamer_model, item, idx);
-          if (!exo_str_is_equal (item->name, name))
+      /* process dirty items in batches until the time slice is used up */
+      deadline = g_get_monotonic_time () + UPDATE_TIME_SLICE;
+      while (renamer_model->dirty.length > 0)
+        {
+          /* collect the next batch of dirty items */
+          for (n_items = 0; n_items < UPDATE_BATCH_SIZE; ++n_items)
             {
-              /* apply new name */
-              g_free (item->name);
-              item->name = name;
+              lp = g_queue_pop_head (&renamer_model->dirty);
+              if (lp == NULL)
+                break;
 
-              /* the item changed */
-              changed = TRUE;
-            }
-          else
-            {
-              /* release temporary name */
-              g_free (name);
-            }
+              batch[n_items] = lp;
+              items[n_items] = item = THUNAR_RENAMER_MODEL_ITEM (lp->data);
 
-          /* check if this item conflicts with any other item */
-          conflict = thunar_renamer_model_conflict_item (renamer_model, item);
-          if (item->conflict != conflict)
-            {
-              /* apply the new state */
-              item->conflict = conflict;
+              /* check if the file changed */
+              changes[n_items] = item->changed;
 
-              /* the item changed */
-              changed = TRUE;
+              /* mark as valid, since we're updating right now */
+              item->changed = FALSE;
+              item->dirty = FALSE;
             }
 
-          /* check if the item changed */
-          if (G_LIKELY (changed))
-            {
-              /* generate the iter for the item */
-              GTK_TREE_ITER_INIT (iter, renamer_model->stamp, lp);
+          /* determine the new names for the items */
+          thunar_renamer_model_process_items (renamer_model, items, n_items, names);
 
-              /* emit "row-changed" for this item */
-              path = gtk_tree_path_new_from_indices (idx, -1);
-              gtk_tree_model_row_changed (GTK_TREE_MODEL (renamer_model), path, &iter);
-              gtk_tree_path_free (path);
+          for (n = 0; n < n_items; ++n)
+            {
+              lp = batch[n];
+              item = items[n];
+              changed = changes[n];
+
+              if (!exo_str_is_equal (item->name, names[n]))
+                {
+                  /* apply new name */
+                  g_free (item->name);
+                  item->name = names[n];
+
+                  /* the item changed */
+                  changed = TRUE;
+                }
+              else
+                {
+                  /* release temporary name */
+                  g_free (names[n]);
+                }
+
+              /* check if this item conflicts with any other item */
+              conflict = thunar_renamer_model_target_register (renamer_model, lp);
+              if (item->conflict != conflict)
+                {
+                  /* apply the new state */
+                  item->conflict = conflict;
+
+                  /* the item changed */
+                  changed = TRUE;
+                }
+
+              /* check if the item changed */
+              if (G_LIKELY (changed))
+                {
+                  /* generate the iter for the item */
+                  GTK_TREE_ITER_INIT (iter, renamer_model->stamp, lp);
+
+                  /* emit "row-changed" for this item */
+                  path = gtk_tree_path_new_from_indices (item->index, -1);
+                  gtk_tree_model_row_changed (GTK_TREE_MODEL (renamer_model), path, &iter);
+                  gtk_tree_path_free (path);
+                }
             }
+
+          /* continue in the next iteration if we took too long */
+          if (g_get_monotonic_time () >= deadline)
+            break;
         }
+
+      pending = (renamer_model->dirty.length > 0);
     }
 
   GDK_THREADS_LEAVE ();
 
-  /* keep the idle source as long as any item changed */
-  return changed;
+  /* keep the idle source as long as any item is dirty */
+  return pending;
 }
 
 
@@ -985,11 +1188,19 @@ static ThunarRenamerModelItem*
 thunar_renamer_model_item_new (ThunarFile *file)
 {
   ThunarRenamerModelItem *item;
+  GFile                  *parent;
 
   item = g_slice_new0 (ThunarRenamerModelItem);
   item->file = g_object_ref (G_OBJECT (file));
   item->date_changed = thunar_file_get_date (file, THUNAR_FILE_DATE_CHANGED);
-  item->dirty = TRUE;
+
+  /* remember the folder of the file for the conflict checks */
+  parent = g_file_get_parent (thunar_file_get_file (file));
+  if (G_LIKELY (parent != NULL))
+    {
+      item->directory = g_file_get_uri (parent);
+      g_object_unref (parent);
+    }
 
   return item;
 }
@@ -1002,6 +1213,8 @@ thunar_renamer_model_item_free (gpointer data)
   ThunarRenamerModelItem *item = data;
 
   g_object_unref (G_OBJECT (item->file));
+  g_free (item->directory);
+  g_free (item->target);
   g_free (item->name);
   g_slice_free (ThunarRenamerModelItem, item);
 }
@@ -1259,6 +1472,7 @@ thunar_renamer_model_set_renamer (ThunarRenamerModel *renamer_model,
   if (renamer_model->renamer != NULL)
     {
       g_signal_handlers_disconnect_by_func (G_OBJECT (renamer_model->renamer), thunar_renamer_model_invalidate_all, renamer_model);
+      g_signal_handlers_disconnect_by_func (G_OBJECT (renamer_model->renamer), thunar_renamer_model_name_changed, renamer_model);
       g_object_unref (G_OBJECT (renamer_model->renamer));
     }
 
@@ -1269,6 +1483,7 @@ thunar_renamer_model_set_renamer (ThunarRenamerModel *renamer_model,
   if (G_LIKELY (renamer != NULL))
     {
       g_signal_connect_swapped (G_OBJECT (renamer), "changed", G_CALLBACK (thunar_renamer_model_invalidate_all), renamer_model);
+      g_signal_connect_swapped (G_OBJECT (renamer), "file-changed", G_CALLBACK (thunar_renamer_model_name_changed), renamer_model);
       g_object_ref (G_OBJECT (renamer));
     }
 
@@ -1297,32 +1512,58 @@ thunar_renamer_model_insert (ThunarRenamerModel *renamer_model,
   ThunarRenamerModelItem *item;
   GtkTreePath            *path;
   GtkTreeIter             iter;
+  GList                  *sibling;
   GList                  *lp;
 
   _thunar_return_if_fail (THUNAR_IS_RENAMER_MODEL (renamer_model));
   _thunar_return_if_fail (THUNAR_IS_FILE (file));
 
   /* check if we already have that file */
-  for (lp = renamer_model->items; lp != NULL; lp = lp->next)
-    if (THUNAR_RENAMER_MODEL_ITEM (lp->data)->file == file)
-      return;
+  if (g_hash_table_lookup (renamer_model->links, file) != NULL)
+    return;
 
   /* allocate a new item for the file */
   item = thunar_renamer_model_item_new (file);
 
-  /* append the item to the model */
-  renamer_model->items = g_list_insert (renamer_model->items, item, position);
+  if (position < 0 || (guint) position >= renamer_model->n_items)
+    {
+      /* append the item behind the last one, without walking the list */
+      lp = g_list_alloc ();
+      lp->data = item;
+      lp->prev = renamer_model->items_tail;
+      if (G_LIKELY (renamer_model->items_tail != NULL))
+        renamer_model->items_tail->next = lp;
+      else
+        renamer_model->items = lp;
+      renamer_model->items_tail = lp;
+
+      /* the indices of all other items stay the same */
+      position = renamer_model->n_items;
+      item->index = position;
+    }
+  else
+    {
+      /* insert the item in front of the one at position */
+      sibling = g_list_nth (renamer_model->items, position);
+      renamer_model->items = g_list_insert_before (renamer_model->items, sibling, item);
+      renamer_model->indices_valid = FALSE;
+      lp = sibling->prev;
+    }
+  renamer_model->n_items += 1;
+
+  /* remember the link for the file */
+  g_hash_table_insert (renamer_model->links, file, lp);
 
   /* determine the iterator for the new item */
-  GTK_TREE_ITER_INIT (iter, renamer_model->stamp, g_list_find (renamer_model->items, item));
+  GTK_TREE_ITER_INIT (iter, renamer_model->stamp, lp);
 
   /* emit the "row-inserted" signal */
-  path = gtk_tree_model_get_path (GTK_TREE_MODEL (renamer_model), &iter);
+  path = gtk_tree_path_new_from_indices (position, -1);
   gtk_tree_model_row_inserted (GTK_TREE_MODEL (renamer_model), path, &iter);
   gtk_tree_path_free (path);
 
   /* invalidate the newly added item */
-  thunar_renamer_model_invalidate_item (renamer_model, item);
+  thunar_renamer_model_invalidate_item (renamer_model, lp);
 }
 
 
@@ -1352,7 +1593,7 @@ thunar_renamer_model_reorder (ThunarRenamerModel *renamer_model,
   _thunar_return_if_fail (THUNAR_IS_RENAMER_MODEL (renamer_model));
 
   /* leave when there is nothing to sort */
-  n_items = g_list_length (renamer_model->items);
+  n_items = renamer_model->n_items;
   if (G_UNLIKELY (n_items <= 1))
     return;
 
@@ -1416,6 +1657,8 @@ thunar_renamer_model_reorder (ThunarRenamerModel *renamer_model,
       /* advance the offset */
       lprev = lp;
     }
+  renamer_model->items_tail = lprev;
+  renamer_model->indices_valid = FALSE;
 
   /* tell the view about the new item order */
   path = gtk_tree_path_new ();
@@ -1461,6 +1704,8 @@ thunar_renamer_model_sort (ThunarRenamerModel *renamer_model,
 void
 thunar_renamer_model_clear (ThunarRenamerModel *renamer_model)
 {
+  GtkTreePath *path;
+
   _thunar_return_if_fail (THUNAR_IS_RENAMER_MODEL (renamer_model));
 
   /* grab an additional reference on the model */
@@ -1469,13 +1714,25 @@ thunar_renamer_model_clear (ThunarRenamerModel *renamer_model)
   /* freeze notifications */
   g_object_freeze_notify (G_OBJECT (renamer_model));
 
-  /* delete all items from the model */
+  /* nothing left to update or to conflict with */
+  g_queue_clear (&renamer_model->dirty);
+  g_hash_table_remove_all (renamer_model->targets);
+  g_hash_table_remove_all (renamer_model->links);
+
+  /* delete all items from the model, front to back */
+  path = gtk_tree_path_new_first ();
   while (renamer_model->items != NULL)
     {
-      /* just use the "file-destroyed" handler here to drop the first item */
-      thunar_renamer_model_file_destroyed (renamer_model, THUNAR_RENAMER_MODEL_ITEM (renamer_model->items->data)->file,
-                                           renamer_model->file_monitor);
+      thunar_renamer_model_item_free (renamer_model->items->data);
+      renamer_model->items = g_list_delete_link (renamer_model->items, renamer_model->items);
+      renamer_model->n_items -= 1;
+
+      /* tell the view that the item is gone */
+      gtk_tree_model_row_deleted (GTK_TREE_MODEL (renamer_model), path);
     }
+  gtk_tree_path_free (path);
+  renamer_model->items_tail = NULL;
+  renamer_model->indices_valid = TRUE;
 
   /* thaw notifications */
   g_object_thaw_notify (G_OBJECT (renamer_model));
@@ -1508,11 +1765,8 @@ thunar_renamer_model_remove (ThunarRenamerModel *renamer_model,
   if (G_UNLIKELY (lp == NULL))
     return;
 
-  /* free the item data */
-  thunar_renamer_model_item_free (lp->data);
-
-  /* drop the item from the list */
-  renamer_model->items = g_list_delete_link (renamer_model->items, lp);
+  /* drop the item from the model */
+  thunar_renamer_model_drop_item (renamer_model, lp);
 
   /* tell the view that the item is gone */
   gtk_tree_model_row_deleted (GTK_TREE_MODEL (renamer_model), path);
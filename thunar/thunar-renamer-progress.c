@@ -21,24 +21,22 @@
 #include <config.h>
 #endif
 
+#include <thunar/thunar-io-jobs.h>
 #include <thunar/thunar-private.h>
 #include <thunar/thunar-renamer-progress.h>
 
 
 
-/* Signal identifiers */
-enum
-{
-  FINISHED,
-  LAST_SIGNAL,
-};
-
-
-
 static void     thunar_renamer_progress_finalize          (GObject                    *object);
 static void     thunar_renamer_progress_destroy           (GtkWidget                  *object);
-static gboolean thunar_renamer_progress_next_idle         (gpointer                    user_data);
-static void     thunar_renamer_progress_next_idle_destroy (gpointer                    user_data);
+static void     thunar_renamer_progress_percent           (ExoJob                     *job,
+                                                           gdouble                     percent,
+                                                           ThunarRenamerProgress      *renamer_progress);
+static void     thunar_renamer_progress_error             (ExoJob                     *job,
+                                                           GError                     *error,
+                                                           ThunarRenamerProgress      *renamer_progress);
+static void     thunar_renamer_progress_finished          (ExoJob                     *job,
+                                                           ThunarRenamerProgress      *renamer_progress);
 
 
 
@@ -52,15 +50,15 @@ struct _ThunarRenamerProgress
   GtkAlignment __parent__;
   GtkWidget   *bar;
 
-  GList       *pairs_done;
-  guint        n_pairs_done;
-  GList       *pairs_todo;
-  guint        n_pairs_todo;
-  gboolean     pairs_undo;  /* whether we're undoing previous changes */
+  /* the rename job and the number of files it renames */
+  ThunarJob   *job;
+  guint        n_pairs;
+
+  /* the error of the job, if any */
+  GError      *error;
 
   /* internal main loop for the _rename() method */
-  guint        next_idle_id;
-  GMainLoop   *next_idle_loop;
+  GMainLoop   *job_loop;
 };
 
 
@@ -101,13 +99,9 @@ thunar_renamer_progress_finalize (GObject *object)
 {
   ThunarRenamerProgress *renamer_progress = THUNAR_RENAMER_PROGRESS (object);
 
-  /* make sure we're not finalized while the main loop is active */
-  _thunar_assert (renamer_progress->next_idle_id == 0);
-  _thunar_assert (renamer_progress->next_idle_loop == NULL);
-
-  /* release the pairs */
-  thunar_renamer_pair_list_free (renamer_progress->pairs_done);
-  thunar_renamer_pair_list_free (renamer_progress->pairs_todo);
+  /* make sure we're not finalized while the job is running */
+  _thunar_assert (renamer_progress->job == NULL);
+  _thunar_assert (renamer_progress->job_loop == NULL);
 
   (*G_OBJECT_CLASS (thunar_renamer_progress_parent_class)->finalize) (object);
 }
@@ -119,7 +113,7 @@ thunar_renamer_progress_destroy (GtkWidget *object)
 {
   ThunarRenamerProgress *renamer_progress = THUNAR_RENAMER_PROGRESS (object);
 
-  /* exit the internal main loop on destroy */
+  /* cancel the job on destroy, this reverts all changes */
   thunar_renamer_progress_cancel (renamer_progress);
 
   (*GTK_WIDGET_CLASS (thunar_renamer_progress_parent_class)->destroy) (object);
@@ -127,156 +121,53 @@ thunar_renamer_progress_destroy (GtkWidget *object)
 
 
 
-static gboolean
-thunar_renamer_progress_next_idle (gpointer user_data)
+static void
+thunar_renamer_progress_percent (ExoJob                *job,
+                                 gdouble                percent,
+                                 ThunarRenamerProgress *renamer_progress)
 {
-  ThunarRenamerProgress *renamer_progress = THUNAR_RENAMER_PROGRESS (user_data);
-  ThunarRenamerPair     *pair;
-  GtkWindow             *toplevel;
-  GtkWidget             *message;
-  GError                *error = NULL;
-  gchar                 *oldname;
-  gchar                  text[128];
-  gint                   response;
-  guint                  n_done;
-  guint                  n_total;
-  GList                 *first;
-
-  GDK_THREADS_ENTER ();
-
-  /* check if we have still pairs to go */
-  if (G_LIKELY (renamer_progress->pairs_todo != NULL))
-    {
-      /* pop the first pair from the todo list */
-      first = g_list_first (renamer_progress->pairs_todo);
-      pair = first->data;
-      renamer_progress->pairs_todo = g_list_delete_link (renamer_progress->pairs_todo, first);
-
-      /* update item count */
-      renamer_progress->n_pairs_todo--;
-      _thunar_assert (g_list_length (renamer_progress->pairs_todo) == renamer_progress->n_pairs_todo);
-
-      /* determine the done/todo items */
-      n_done = renamer_progress->n_pairs_done + 1;
-      n_total = n_done + renamer_progress->n_pairs_todo;
-
-      /* update the progress bar text */
-      g_snprintf (text, sizeof (text), "%d/%d", n_done, n_total);
-      gtk_progress_bar_set_text (GTK_PROGRESS_BAR (renamer_progress->bar), text);
-
-      /* update the progress bar fraction */
-      gtk_progress_bar_set_fraction (GTK_PROGRESS_BAR (renamer_progress->bar), CLAMP ((gdouble) n_done / MAX (n_total, 1), 0.0, 1.0));
-
-      /* remember the old file name (for undo) */
-      oldname = g_strdup (thunar_file_get_display_name (pair->file));
-
-      /* try to rename the file */
-      if (!thunar_file_rename (pair->file, pair->name, NULL, FALSE, &error))
-        {
-          /* determine the toplevel widget */
-          toplevel = (GtkWindow *) gtk_widget_get_toplevel (GTK_WIDGET (renamer_progress));
-
-          /* tell the user that we failed */
-          message = gtk_message_dialog_new (toplevel,
-                                            GTK_DIALOG_DESTROY_WITH_PARENT
-                                            | GTK_DIALOG_MODAL,
-                                            GTK_MESSAGE_ERROR,
-                                            GTK_BUTTONS_NONE,
-                                            _("Failed to rename \"%s\" to \"%s\"."),
-                                            oldname, pair->name);
-
-          /* check if we should provide undo */
-          if (!renamer_progress->pairs_undo && renamer_progress->pairs_done != NULL)
-            {
-              gtk_message_dialog_format_secondary_text (GTK_MESSAGE_DIALOG (message),
-                                                        _("You can either choose to skip this file and continue to rename the "
-                                                          "remaining files, or revert the previously renamed files to their "
-                                                          "previous names, or cancel the operation without reverting previous "
-                                                          "changes."));
-              gtk_dialog_add_button (GTK_DIALOG (message), _("_Cancel"), GTK_RESPONSE_CANCEL);
-              gtk_dialog_add_button (GTK_DIALOG (message), _("_Revert Changes"), GTK_RESPONSE_REJECT);
-              gtk_dialog_add_button (GTK_DIALOG (message), _("_Skip This File"), GTK_RESPONSE_ACCEPT);
-              gtk_dialog_set_default_response (GTK_DIALOG (message), GTK_RESPONSE_ACCEPT);
-            }
-          else if (renamer_progress->pairs_todo != NULL)
-            {
-              gtk_message_dialog_format_secondary_text (GTK_MESSAGE_DIALOG (message),
-                                                        _("Do you want to skip this file and continue to rename the "
-                                                          "remaining files?"));
-              gtk_dialog_add_button (GTK_DIALOG (message), _("_Cancel"), GTK_RESPONSE_CANCEL);
-              gtk_dialog_add_button (GTK_DIALOG (message), _("_Skip This File"), GTK_RESPONSE_ACCEPT);
-              gtk_dialog_set_default_response (GTK_DIALOG (message), GTK_RESPONSE_ACCEPT);
-            }
-          else
-            {
-              gtk_message_dialog_format_secondary_text (GTK_MESSAGE_DIALOG (message), "%s.", error->message);
-              gtk_dialog_add_button (GTK_DIALOG (message), _("_Close"), GTK_RESPONSE_CANCEL);
-            }
-
-          /* run the dialog */
-          response = gtk_dialog_run (GTK_DIALOG (message));
-          if (response == GTK_RESPONSE_REJECT)
-            {
-              /* undo previous changes */
-              renamer_progress->pairs_undo = TRUE;
-
-              /* release the todo pairs and use the done as todo */
-              thunar_renamer_pair_list_free (renamer_progress->pairs_todo);
-              renamer_progress->pairs_todo = renamer_progress->pairs_done;
-              renamer_progress->pairs_done = NULL;
-
-              renamer_progress->n_pairs_done = 0;
-              renamer_progress->n_pairs_todo = g_list_length (renamer_progress->pairs_todo);
-            }
-          else if (response != GTK_RESPONSE_ACCEPT)
-            {
-              /* canceled, just exit the main loop */
-              g_main_loop_quit (renamer_progress->next_idle_loop);
-            }
-
-          /* release the pair */
-          thunar_renamer_pair_free (pair);
-
-          /* destroy the dialog */
-          gtk_widget_destroy (message);
-
-          /* clear the error */
-          g_clear_error (&error);
-
-          /* release old name */
-          g_free (oldname);
-        }
-      else
-        {
-          /* replace the newname with the oldname for the pair (-> undo) */
-          g_free (pair->name);
-          pair->name = oldname;
-
-          /* move the pair to the list of completed pairs */
-          renamer_progress->pairs_done = g_list_prepend (renamer_progress->pairs_done, pair);
-
-          /* update counter */
-          renamer_progress->n_pairs_done++;
-          _thunar_assert (g_list_length (renamer_progress->pairs_done) == renamer_progress->n_pairs_done);
-        }
-    }
+  gchar text[128];
+  guint n_done;
 
-  /* be sure to cancel the internal loop once we're done */
-  if (G_UNLIKELY (renamer_progress->pairs_todo == NULL))
-    g_main_loop_quit (renamer_progress->next_idle_loop);
+  _thunar_return_if_fail (THUNAR_IS_RENAMER_PROGRESS (renamer_progress));
+
+  /* the job renames some files twice to resolve cycles, so
+   * the number of files is an estimate from the percentage */
+  n_done = CLAMP (percent, 0.0, 100.0) * renamer_progress->n_pairs / 100.0;
 
-  GDK_THREADS_LEAVE ();
+  /* update the progress bar text */
+  g_snprintf (text, sizeof (text), "%u/%u", n_done, renamer_progress->n_pairs);
+  gtk_progress_bar_set_text (GTK_PROGRESS_BAR (renamer_progress->bar), text);
 
-  /* keep the idle source alive as long as we have anything to do */
-  return (renamer_progress->pairs_todo != NULL);
+  /* update the progress bar fraction */
+  gtk_progress_bar_set_fraction (GTK_PROGRESS_BAR (renamer_progress->bar), CLAMP (percent / 100.0, 0.0, 1.0));
 }
 
 
 
 static void
-thunar_renamer_progress_next_idle_destroy (gpointer user_data)
+thunar_renamer_progress_error (ExoJob                *job,
+                               GError                *error,
+                               ThunarRenamerProgress *renamer_progress)
 {
-  THUNAR_RENAMER_PROGRESS (user_data)->next_idle_id = 0;
+  _thunar_return_if_fail (THUNAR_IS_RENAMER_PROGRESS (renamer_progress));
+
+  /* remember the error, it is reported once the job is done */
+  if (renamer_progress->error == NULL)
+    renamer_progress->error = g_error_copy (error);
+}
+
+
+
+static void
+thunar_renamer_progress_finished (ExoJob                *job,
+                                  ThunarRenamerProgress *renamer_progress)
+{
+  _thunar_return_if_fail (THUNAR_IS_RENAMER_PROGRESS (renamer_progress));
+
+  /* exit the internal main loop */
+  if (G_LIKELY (renamer_progress->job_loop != NULL))
+    g_main_loop_quit (renamer_progress->job_loop);
 }
 
 
@@ -307,9 +198,9 @@ thunar_renamer_progress_cancel (ThunarRenamerProgress *renamer_progress)
 {
   _thunar_return_if_fail (THUNAR_IS_RENAMER_PROGRESS (renamer_progress));
 
-  /* exit the internal main loop (if any) */
-  if (G_UNLIKELY (renamer_progress->next_idle_loop != NULL))
-    g_main_loop_quit (renamer_progress->next_idle_loop);
+  /* cancel the job (if any), the main loop exits once it is done */
+  if (G_UNLIKELY (renamer_progress->job != NULL))
+    exo_job_cancel (EXO_JOB (renamer_progress->job));
 }
 
 
@@ -326,7 +217,7 @@ gboolean
 thunar_renamer_progress_running (ThunarRenamerProgress *renamer_progress)
 {
   _thunar_return_val_if_fail (THUNAR_IS_RENAMER_PROGRESS (renamer_progress), FALSE);
-  return (renamer_progress->next_idle_loop != NULL);
+  return (renamer_progress->job != NULL);
 }
 
 
@@ -339,6 +230,10 @@ thunar_renamer_progress_running (ThunarRenamerProgress *renamer_progress)
  * Renames all #ThunarRenamePair<!---->s in the specified @pair_list
  * using the @renamer_progress.
  *
+ * The files are renamed by a background job in a single transaction,
+ * if any of them cannot be renamed (or the operation is cancelled),
+ * all files are reverted to their previous names.
+ *
  * This method starts a new main loop, and returns only after the
  * rename operation is done (or cancelled by a "destroy" signal).
  **/
@@ -346,49 +241,89 @@ void
 thunar_renamer_progress_run (ThunarRenamerProgress *renamer_progress,
                              GList                 *pairs)
 {
+  ThunarRenamerPair *pair;
+  GtkWindow         *toplevel;
+  GtkWidget         *message;
+  GList             *file_list = NULL;
+  GList             *lp;
+  gchar            **names;
+  guint              n;
+
   _thunar_return_if_fail (THUNAR_IS_RENAMER_PROGRESS (renamer_progress));
 
   /* make sure we're not already renaming */
-  if (G_UNLIKELY (renamer_progress->next_idle_id != 0
-      || renamer_progress->next_idle_loop != NULL))
+  if (G_UNLIKELY (renamer_progress->job != NULL
+      || renamer_progress->job_loop != NULL))
+    return;
+
+  /* nothing to do */
+  if (G_UNLIKELY (pairs == NULL))
     return;
 
   /* take an additional reference on the progress */
   g_object_ref (G_OBJECT (renamer_progress));
 
-  /* make sure to release the list of completed items first */
-  thunar_renamer_pair_list_free (renamer_progress->pairs_done);
-  renamer_progress->pairs_done = NULL;
-
-  /* set the pairs on the todo list */
-  thunar_renamer_pair_list_free (renamer_progress->pairs_todo);
-  renamer_progress->pairs_todo = thunar_renamer_pair_list_copy (pairs);
-  renamer_progress->n_pairs_todo = g_list_length (renamer_progress->pairs_todo);
-
-  /* schedule the idle source */
-  renamer_progress->next_idle_id = g_idle_add_full (G_PRIORITY_LOW, thunar_renamer_progress_next_idle,
-                                                    renamer_progress, thunar_renamer_progress_next_idle_destroy);
-
-  /* run the inner main loop */
-  renamer_progress->next_idle_loop = g_main_loop_new (NULL, FALSE);
-  g_main_loop_run (renamer_progress->next_idle_loop);
-  g_main_loop_unref (renamer_progress->next_idle_loop);
-  renamer_progress->next_idle_loop = NULL;
-
-  /* be sure to cancel any pending idle source */
-  if (G_UNLIKELY (renamer_progress->next_idle_id != 0))
-    g_source_remove (renamer_progress->next_idle_id);
-
-  /* release the list of completed items */
-  thunar_renamer_pair_list_free (renamer_progress->pairs_done);
-  renamer_progress->pairs_done = NULL;
+  /* split the pairs into the files and their new names */
+  renamer_progress->n_pairs = g_list_length (pairs);
+  names = g_new (gchar *, renamer_progress->n_pairs + 1);
+  for (lp = pairs, n = 0; lp != NULL; lp = lp->next, ++n)
+    {
+      pair = lp->data;
+      file_list = g_list_prepend (file_list, thunar_file_get_file (pair->file));
+      names[n] = pair->name;
+    }
+  names[n] = NULL;
+  file_list = g_list_reverse (file_list);
+
+  /* reset the progress bar */
+  thunar_renamer_progress_percent (NULL, 0.0, renamer_progress);
+
+  /* launch the rename job */
+  renamer_progress->job = thunar_io_jobs_rename_files (file_list, names);
+  g_signal_connect (renamer_progress->job, "percent",
+                    G_CALLBACK (thunar_renamer_progress_percent), renamer_progress);
+  g_signal_connect (renamer_progress->job, "error",
+                    G_CALLBACK (thunar_renamer_progress_error), renamer_progress);
+  g_signal_connect (renamer_progress->job, "finished",
+                    G_CALLBACK (thunar_renamer_progress_finished), renamer_progress);
+
+  /* the job copied the lists */
+  g_list_free (file_list);
+  g_free (names);
+
+  /* run the inner main loop until the job is done */
+  renamer_progress->job_loop = g_main_loop_new (NULL, FALSE);
+  g_main_loop_run (renamer_progress->job_loop);
+  g_main_loop_unref (renamer_progress->job_loop);
+  renamer_progress->job_loop = NULL;
+
+  /* release the job */
+  g_signal_handlers_disconnect_matched (renamer_progress->job, G_SIGNAL_MATCH_DATA,
+                                        0, 0, NULL, NULL, renamer_progress);
+  g_object_unref (renamer_progress->job);
+  renamer_progress->job = NULL;
+
+  /* tell the user if something went wrong, unless he cancelled */
+  if (renamer_progress->error != NULL
+      && !g_error_matches (renamer_progress->error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+    {
+      /* determine the toplevel widget */
+      toplevel = (GtkWindow *) gtk_widget_get_toplevel (GTK_WIDGET (renamer_progress));
+
+      message = gtk_message_dialog_new (toplevel,
+                                        GTK_DIALOG_DESTROY_WITH_PARENT
+                                        | GTK_DIALOG_MODAL,
+                                        GTK_MESSAGE_ERROR,
+                                        GTK_BUTTONS_CLOSE,
+                                        _("Failed to rename the files."));
+      gtk_message_dialog_format_secondary_text (GTK_MESSAGE_DIALOG (message),
+                                                "%s.", renamer_progress->error->message);
+      gtk_dialog_run (GTK_DIALOG (message));
+      gtk_widget_destroy (message);
+    }
 
-  /* release the list of todo items */
-  thunar_renamer_pair_list_free (renamer_progress->pairs_todo);
-  renamer_progress->pairs_todo = NULL;
+  g_clear_error (&renamer_progress->error);
 
   /* release the additional reference on the progress */
   g_object_unref (G_OBJECT (renamer_progress));
 }
-
-
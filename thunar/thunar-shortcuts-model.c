@@ -42,6 +42,7 @@
 #include <thunar/thunar-file.h>
 #include <thunar/thunar-shortcuts-model.h>
 #include <thunar/thunar-device-monitor.h>
+#include <thunar/thunar-filesystem-cache.h>
 #include <thunar/thunar-preferences.h>
 #include <thunar/thunar-util.h>
 #include <thunar/thunar-private.h>
@@ -49,13 +50,18 @@
 #define SPINNER_CYCLE_DURATION 1000
 #define SPINNER_NUM_STEPS      12
 
+/* seconds to wait for the file of a bookmark, before it
+ * is kept as a location like a remote bookmark */
+#define BOOKMARK_RESOLVE_TIMEOUT 5
+
 
 
 #define THUNAR_SHORTCUT(obj) ((ThunarShortcut *) (obj))
 
 
 
-typedef struct _ThunarShortcut ThunarShortcut;
+typedef struct _ThunarShortcut        ThunarShortcut;
+typedef struct _ThunarShortcutResolve ThunarShortcutResolve;
 
 
 
@@ -125,6 +131,17 @@ static void               thunar_shortcuts_model_add_shortcut       (ThunarShort
                                                                      ThunarShortcut            *shortcut);
 static void               thunar_shortcuts_model_remove_shortcut    (ThunarShortcutsModel      *model,
                                                                      ThunarShortcut            *shortcut);
+static gboolean           thunar_shortcuts_model_drop_shortcut      (ThunarShortcutsModel      *model,
+                                                                     ThunarShortcut            *shortcut);
+static void               thunar_shortcuts_model_watch_file         (ThunarShortcutsModel      *model,
+                                                                     ThunarShortcut            *shortcut);
+static void               thunar_shortcuts_model_resolve            (ThunarShortcutsModel      *model,
+                                                                     ThunarShortcut            *shortcut);
+static void               thunar_shortcuts_model_resolve_ready      (GFile                     *location,
+                                                                     ThunarFile                *file,
+                                                                     GError                    *error,
+                                                                     gpointer                   user_data);
+static gboolean           thunar_shortcuts_model_resolve_timeout    (gpointer                   user_data);
 static gboolean           thunar_shortcuts_model_load               (gpointer                   data);
 static void               thunar_shortcuts_model_save               (ThunarShortcutsModel      *model);
 static void               thunar_shortcuts_model_monitor            (GFileMonitor              *monitor,
@@ -148,6 +165,7 @@ static void               thunar_shortcuts_model_device_changed     (ThunarDevic
 
 static void               thunar_shortcut_free                      (ThunarShortcut            *shortcut,
                                                                      ThunarShortcutsModel      *model);
+static void               thunar_shortcut_cancel_resolve            (ThunarShortcut            *shortcut);
 
 
 
@@ -176,6 +194,8 @@ struct _ThunarShortcutsModel
 
   ThunarDeviceMonitor  *device_monitor;
 
+  ThunarFilesystemCache *filesystem_cache;
+
   gint64                bookmarks_time;
   GFile                *bookmarks_file;
   GFileMonitor         *bookmarks_monitor;
@@ -200,9 +220,20 @@ struct _ThunarShortcut
   ThunarFile          *file;
   ThunarDevice        *device;
 
+  /* pending lookup of the file for a bookmark */
+  GCancellable        *resolve_cancellable;
+  guint                resolve_timeout_id;
+
   guint                hidden : 1;
 };
 
+struct _ThunarShortcutResolve
+{
+  ThunarShortcutsModel *model;
+  ThunarShortcut       *shortcut;
+  GCancellable         *cancellable;
+};
+
 
 
 G_DEFINE_TYPE_WITH_CODE (ThunarShortcutsModel, thunar_shortcuts_model, G_TYPE_OBJECT,
@@ -290,6 +321,9 @@ thunar_shortcuts_model_init (ThunarShortcutsModel *model)
   exo_binding_new (G_OBJECT (model->preferences), "misc-file-size-binary",
                    G_OBJECT (model), "file-size-binary");
 
+  /* free space for the device tooltips */
+  model->filesystem_cache = thunar_filesystem_cache_get ();
+
   /* load volumes */
   thunar_shortcuts_model_shortcut_devices (model);
 
@@ -341,6 +375,8 @@ thunar_shortcuts_model_finalize (GObject *object)
   g_signal_handlers_disconnect_matched (model->device_monitor, G_SIGNAL_MATCH_DATA, 0, 0, NULL, NULL, model);
   g_object_unref (model->device_monitor);
 
+  g_object_unref (model->filesystem_cache);
+
   (*G_OBJECT_CLASS (thunar_shortcuts_model_parent_class)->finalize) (object);
 }
 
@@ -615,7 +651,8 @@ thunar_shortcuts_model_get_value (GtkTreeModel *tree_model,
           if (file != NULL)
             {
               file_size_binary = THUNAR_SHORTCUTS_MODEL (tree_model)->file_size_binary;
-              disk_usage = thunar_g_file_get_free_space_string (file, file_size_binary);
+              disk_usage = thunar_filesystem_cache_get_free_space_string (THUNAR_SHORTCUTS_MODEL (tree_model)->filesystem_cache,
+                                                                          file, file_size_binary);
               g_object_unref (file);
               g_value_take_string (value, disk_usage);
             }
@@ -1131,16 +1168,7 @@ thunar_shortcuts_model_add_shortcut_with_path (ThunarShortcutsModel *model,
 
   /* we want to stay informed about changes to the file */
   if (G_LIKELY (shortcut->file != NULL))
-    {
-      /* watch the file for changes */
-      thunar_file_watch (shortcut->file);
-
-      /* connect appropriate signals */
-      g_signal_connect (G_OBJECT (shortcut->file), "changed",
-                        G_CALLBACK (thunar_shortcuts_model_file_changed), model);
-      g_signal_connect (G_OBJECT (shortcut->file), "destroy",
-                        G_CALLBACK (thunar_shortcuts_model_file_destroy), model);
-    }
+    thunar_shortcuts_model_watch_file (model, shortcut);
 
   if (path == NULL)
     {
@@ -1164,6 +1192,24 @@ thunar_shortcuts_model_add_shortcut_with_path (ThunarShortcutsModel *model,
 
 
 
+static void
+thunar_shortcuts_model_watch_file (ThunarShortcutsModel *model,
+                                   ThunarShortcut       *shortcut)
+{
+  _thunar_return_if_fail (THUNAR_IS_FILE (shortcut->file));
+
+  /* watch the file for changes */
+  thunar_file_watch (shortcut->file);
+
+  /* connect appropriate signals */
+  g_signal_connect (G_OBJECT (shortcut->file), "changed",
+                    G_CALLBACK (thunar_shortcuts_model_file_changed), model);
+  g_signal_connect (G_OBJECT (shortcut->file), "destroy",
+                    G_CALLBACK (thunar_shortcuts_model_file_destroy), model);
+}
+
+
+
 static void
 thunar_shortcuts_model_add_shortcut (ThunarShortcutsModel *model,
                                      ThunarShortcut       *shortcut)
@@ -1179,36 +1225,46 @@ thunar_shortcuts_model_add_shortcut (ThunarShortcutsModel *model,
 static void
 thunar_shortcuts_model_remove_shortcut (ThunarShortcutsModel *model,
                                         ThunarShortcut       *shortcut)
+{
+  gboolean needs_save;
+
+  /* check if we need to save */
+  needs_save = (shortcut->group == THUNAR_SHORTCUT_GROUP_PLACES_BOOKMARKS);
+
+  /* the shortcuts list was changed, so write the gtk bookmarks file */
+  if (thunar_shortcuts_model_drop_shortcut (model, shortcut) && needs_save)
+    thunar_shortcuts_model_save (model);
+}
+
+
+
+static gboolean
+thunar_shortcuts_model_drop_shortcut (ThunarShortcutsModel *model,
+                                      ThunarShortcut       *shortcut)
 {
   GtkTreePath *path;
   gint         idx;
-  gboolean     needs_save;
 
   /* determine the index of the shortcut */
   idx = g_list_index (model->shortcuts, shortcut);
-  if (G_LIKELY (idx >= 0))
-    {
-      /* unlink the shortcut from the model */
-      model->shortcuts = g_list_remove (model->shortcuts, shortcut);
+  if (G_UNLIKELY (idx < 0))
+    return FALSE;
 
-      /* tell everybody that we have lost a shortcut */
-      path = gtk_tree_path_new_from_indices (idx, -1);
-      gtk_tree_model_row_deleted (GTK_TREE_MODEL (model), path);
-      gtk_tree_path_free (path);
+  /* unlink the shortcut from the model */
+  model->shortcuts = g_list_remove (model->shortcuts, shortcut);
 
-      /* check if we need to save */
-      needs_save = (shortcut->group == THUNAR_SHORTCUT_GROUP_PLACES_BOOKMARKS);
+  /* tell everybody that we have lost a shortcut */
+  path = gtk_tree_path_new_from_indices (idx, -1);
+  gtk_tree_model_row_deleted (GTK_TREE_MODEL (model), path);
+  gtk_tree_path_free (path);
 
-      /* actually free the shortcut */
-      thunar_shortcut_free (shortcut, model);
+  /* actually free the shortcut */
+  thunar_shortcut_free (shortcut, model);
 
-      /* the shortcuts list was changed, so write the gtk bookmarks file */
-      if (needs_save)
-        thunar_shortcuts_model_save (model);
+  /* update header visibility */
+  thunar_shortcuts_model_header_visibility (model);
 
-      /* update header visibility */
-      thunar_shortcuts_model_header_visibility (model);
-    }
+  return TRUE;
 }
 
 
@@ -1237,7 +1293,6 @@ thunar_shortcuts_model_load_line (GFile       *file_path,
 {
   ThunarShortcutsModel *model = THUNAR_SHORTCUTS_MODEL (user_data);
   ThunarShortcut       *shortcut;
-  ThunarFile           *file;
 
   _thunar_return_if_fail (G_IS_FILE (file_path));
   _thunar_return_if_fail (THUNAR_IS_SHORTCUTS_MODEL (model));
@@ -1246,29 +1301,22 @@ thunar_shortcuts_model_load_line (GFile       *file_path,
   /* handle local and remove files differently */
   if (thunar_shortcuts_model_local_file (file_path))
     {
-      /* try to open the file corresponding to the uri */
-      file = thunar_file_get (file_path, NULL);
-      if (G_UNLIKELY (file == NULL))
-        return;
+      /* create a placeholder entry for the location, the file is
+       * looked up in the background so an unreachable mount
+       * point does not block the side pane */
+      shortcut = g_slice_new0 (ThunarShortcut);
+      shortcut->group = THUNAR_SHORTCUT_GROUP_PLACES_BOOKMARKS;
+      shortcut->gicon = g_themed_icon_new ("folder");
+      shortcut->location = g_object_ref (file_path);
+      shortcut->sort_id = row_num;
+      shortcut->hidden = thunar_shortcuts_model_get_hidden (model, shortcut);
+      shortcut->name = g_strdup (name);
 
-      /* make sure the file refers to a directory */
-      if (G_UNLIKELY (thunar_file_is_directory (file)))
-        {
-          /* create the shortcut entry */
-          shortcut = g_slice_new0 (ThunarShortcut);
-          shortcut->group = THUNAR_SHORTCUT_GROUP_PLACES_BOOKMARKS;
-          shortcut->file = file;
-          shortcut->sort_id = row_num;
-          shortcut->hidden = thunar_shortcuts_model_get_hidden (model, shortcut);
-          shortcut->name = g_strdup (name);
+      /* append the shortcut to the list */
+      thunar_shortcuts_model_add_shortcut (model, shortcut);
 
-          /* append the shortcut to the list */
-          thunar_shortcuts_model_add_shortcut (model, shortcut);
-        }
-      else
-        {
-          g_object_unref (file);
-        }
+      /* replace the location with the file once it is known */
+      thunar_shortcuts_model_resolve (model, shortcut);
     }
   else
     {
@@ -1288,6 +1336,106 @@ thunar_shortcuts_model_load_line (GFile       *file_path,
 
 
 
+static void
+thunar_shortcuts_model_resolve (ThunarShortcutsModel *model,
+                                ThunarShortcut       *shortcut)
+{
+  ThunarShortcutResolve *resolve;
+
+  _thunar_return_if_fail (G_IS_FILE (shortcut->location));
+  _thunar_return_if_fail (shortcut->resolve_cancellable == NULL);
+
+  resolve = g_slice_new0 (ThunarShortcutResolve);
+  resolve->model = model;
+  resolve->shortcut = shortcut;
+  resolve->cancellable = g_cancellable_new ();
+
+  /* keep the location if the lookup takes too long */
+  shortcut->resolve_cancellable = g_object_ref (resolve->cancellable);
+  shortcut->resolve_timeout_id = g_timeout_add_seconds (BOOKMARK_RESOLVE_TIMEOUT,
+                                                        thunar_shortcuts_model_resolve_timeout,
+                                                        shortcut);
+
+  /* this calls thunar_shortcuts_model_resolve_ready() right
+   * away if the file is already in the cache */
+  thunar_file_get_async (shortcut->location, resolve->cancellable,
+                         thunar_shortcuts_model_resolve_ready, resolve);
+}
+
+
+
+static void
+thunar_shortcuts_model_resolve_ready (GFile      *location,
+                                      ThunarFile *file,
+                                      GError     *error,
+                                      gpointer    user_data)
+{
+  ThunarShortcutResolve *resolve = user_data;
+  ThunarShortcutsModel  *model = resolve->model;
+  ThunarShortcut        *shortcut = resolve->shortcut;
+  GtkTreePath           *path;
+  GtkTreeIter            iter;
+  GList                 *lp;
+
+  /* the shortcut was released or the lookup timed out, in both
+   * cases the model must not be touched anymore */
+  if (g_cancellable_is_cancelled (resolve->cancellable))
+    goto out;
+
+  /* the lookup finished */
+  thunar_shortcut_cancel_resolve (shortcut);
+
+  /* drop the bookmark if it does not refer to a directory, just
+   * like the file was never found, without saving the bookmarks */
+  if (error != NULL || file == NULL || !thunar_file_is_directory (file))
+    {
+      thunar_shortcuts_model_drop_shortcut (model, shortcut);
+      goto out;
+    }
+
+  /* switch from the placeholder to the file */
+  shortcut->file = g_object_ref (file);
+  g_object_unref (shortcut->location);
+  shortcut->location = NULL;
+  g_object_unref (shortcut->gicon);
+  shortcut->gicon = NULL;
+  thunar_shortcuts_model_watch_file (model, shortcut);
+
+  /* tell the view the row has a proper name and icon now */
+  lp = g_list_find (model->shortcuts, shortcut);
+  if (G_LIKELY (lp != NULL))
+    {
+      GTK_TREE_ITER_INIT (iter, model->stamp, lp);
+
+      path = gtk_tree_path_new_from_indices (g_list_position (model->shortcuts, lp), -1);
+      gtk_tree_model_row_changed (GTK_TREE_MODEL (model), path, &iter);
+      gtk_tree_path_free (path);
+    }
+
+out:
+  g_object_unref (resolve->cancellable);
+  g_slice_free (ThunarShortcutResolve, resolve);
+}
+
+
+
+static gboolean
+thunar_shortcuts_model_resolve_timeout (gpointer user_data)
+{
+  ThunarShortcut *shortcut = user_data;
+
+  /* the source is destroyed when returning */
+  shortcut->resolve_timeout_id = 0;
+
+  /* give up, the shortcut keeps working with its
+   * location like a remote bookmark */
+  thunar_shortcut_cancel_resolve (shortcut);
+
+  return FALSE;
+}
+
+
+
 static gboolean
 thunar_shortcuts_model_load (gpointer data)
 {
@@ -1654,6 +1802,9 @@ static void
 thunar_shortcut_free (ThunarShortcut       *shortcut,
                       ThunarShortcutsModel *model)
 {
+  /* stop looking up the file */
+  thunar_shortcut_cancel_resolve (shortcut);
+
   if (G_LIKELY (shortcut->file != NULL))
     {
       /* drop the file watch */
@@ -1684,6 +1835,26 @@ thunar_shortcut_free (ThunarShortcut       *shortcut,
 
 
 
+static void
+thunar_shortcut_cancel_resolve (ThunarShortcut *shortcut)
+{
+  if (shortcut->resolve_timeout_id != 0)
+    {
+      g_source_remove (shortcut->resolve_timeout_id);
+      shortcut->resolve_timeout_id = 0;
+    }
+
+  if (shortcut->resolve_cancellable != NULL)
+    {
+      /* a lookup that is still running ignores its result now */
+      g_cancellable_cancel (shortcut->resolve_cancellable);
+      g_object_unref (shortcut->resolve_cancellable);
+      shortcut->resolve_cancellable = NULL;
+    }
+}
+
+
+
 static gboolean
 thunar_shortcuts_model_busy_timeout (gpointer data)
 {
@@ -37,6 +37,8 @@
 #include <thunar/thunar-dialogs.h>
 #include <thunar/thunar-dnd.h>
 #include <thunar/thunar-enum-types.h>
+#include <thunar/thunar-file-monitor.h>
+#include <thunar/thunar-filesystem-cache.h>
 #include <thunar/thunar-gio-extensions.h>
 #include <thunar/thunar-gobject-extensions.h>
 #include <thunar/thunar-gtk-extensions.h>
@@ -51,6 +53,7 @@
 #include <thunar/thunar-standard-view-ui.h>
 #include <thunar/thunar-templates-action.h>
 #include <thunar/thunar-history.h>
+#include <thunar/thunar-image-probe.h>
 #include <thunar/thunar-thumbnailer.h>
 #include <thunar/thunar-util.h>
 
@@ -161,6 +164,14 @@ static ThunarFile          *thunar_standard_view_get_drop_file              (Thu
                                                                              gint                      x,
                                                                              gint                      y,
                                                                              GtkTreePath             **path_return);
+static void                 thunar_standard_view_custom_actions_invalidate  (ThunarStandardView       *standard_view);
+static void                 thunar_standard_view_custom_actions_changed     (ThunarStandardView       *standard_view,
+                                                                             ThunarFile               *file);
+static gboolean             thunar_standard_view_custom_actions_cached      (ThunarStandardView       *standard_view,
+                                                                             GtkWidget                *window,
+                                                                             GList                    *providers,
+                                                                             GList                    *files,
+                                                                             gboolean                  folder);
 static void                 thunar_standard_view_merge_custom_actions       (ThunarStandardView       *standard_view,
                                                                              GList                    *selected_items);
 static void                 thunar_standard_view_update_statusbar_text      (ThunarStandardView       *standard_view);
@@ -345,6 +356,17 @@ struct _ThunarStandardViewPrivate
   GtkActionGroup         *custom_actions;
   gint                    custom_merge_id;
 
+  /* the merged custom actions are reused as long as the
+   * files, the window and the provider stamps stay the same.
+   */
+  ThunarFileMonitor      *file_monitor;
+  GList                  *custom_actions_files;
+  GHashTable             *custom_actions_file_set;
+  GList                  *custom_actions_providers;
+  GArray                 *custom_actions_stamps;
+  GtkWidget              *custom_actions_window;
+  guint                   custom_actions_folder : 1;
+
   /* right-click drag/popup support */
   GList                  *drag_g_file_list;
   guint                   drag_scroll_timer_id;
@@ -388,6 +410,10 @@ struct _ThunarStandardViewPrivate
   guint                   thumbnail_source_id;
   gboolean                thumbnailing_scheduled;
 
+  /* refresh the free space and image size in the statusbar */
+  ThunarFilesystemCache  *filesystem_cache;
+  ThunarImageProbe       *image_probe;
+
   /* file insert signal */
   gulong                  row_changed_id;
 
@@ -648,11 +674,30 @@ thunar_standard_view_init (ThunarStandardView *standard_view)
   /* grab a reference on the provider factory */
   standard_view->priv->provider_factory = thunarx_provider_factory_get_default ();
 
+  /* drop the cached custom actions whenever one of their files changes */
+  standard_view->priv->custom_actions_file_set = g_hash_table_new (g_direct_hash, g_direct_equal);
+  standard_view->priv->custom_actions_stamps = g_array_new (FALSE, FALSE, sizeof (guint));
+  standard_view->priv->file_monitor = thunar_file_monitor_get_default ();
+  g_signal_connect_swapped (G_OBJECT (standard_view->priv->file_monitor), "file-changed",
+                            G_CALLBACK (thunar_standard_view_custom_actions_changed), standard_view);
+  g_signal_connect_swapped (G_OBJECT (standard_view->priv->file_monitor), "file-destroyed",
+                            G_CALLBACK (thunar_standard_view_custom_actions_changed), standard_view);
+
   /* create a thumbnailer */
   standard_view->priv->thumbnailer = thunar_thumbnailer_get ();
   g_signal_connect (G_OBJECT (standard_view->priv->thumbnailer), "request-finished", G_CALLBACK (thunar_standard_view_finished_thumbnailing), standard_view);
   standard_view->priv->thumbnailing_scheduled = FALSE;
 
+  /* update the statusbar when free space values arrive */
+  standard_view->priv->filesystem_cache = thunar_filesystem_cache_get ();
+  g_signal_connect_swapped (G_OBJECT (standard_view->priv->filesystem_cache), "changed",
+                            G_CALLBACK (thunar_standard_view_update_statusbar_text), standard_view);
+
+  /* update the statusbar when image dimensions are probed */
+  standard_view->priv->image_probe = thunar_image_probe_get ();
+  g_signal_connect_swapped (G_OBJECT (standard_view->priv->image_probe), "ready",
+                            G_CALLBACK (thunar_standard_view_update_statusbar_text), standard_view);
+
   /* initialize the scrolled window */
   gtk_scrolled_window_set_policy (GTK_SCROLLED_WINDOW (standard_view),
                                   GTK_POLICY_AUTOMATIC,
@@ -884,6 +929,14 @@ thunar_standard_view_finalize (GObject *object)
   g_signal_handlers_disconnect_by_func (standard_view->priv->thumbnailer, thunar_standard_view_finished_thumbnailing, standard_view);
   g_object_unref (standard_view->priv->thumbnailer);
 
+  /* release the filesystem cache */
+  g_signal_handlers_disconnect_by_func (standard_view->priv->filesystem_cache, thunar_standard_view_update_statusbar_text, standard_view);
+  g_object_unref (standard_view->priv->filesystem_cache);
+
+  /* release the image probe */
+  g_signal_handlers_disconnect_by_func (standard_view->priv->image_probe, thunar_standard_view_update_statusbar_text, standard_view);
+  g_object_unref (standard_view->priv->image_probe);
+
   /* release the scroll_to_file reference (if any) */
   if (G_UNLIKELY (standard_view->priv->scroll_to_file != NULL))
     g_object_unref (G_OBJECT (standard_view->priv->scroll_to_file));
@@ -894,6 +947,13 @@ thunar_standard_view_finalize (GObject *object)
   /* release our reference on the provider factory */
   g_object_unref (G_OBJECT (standard_view->priv->provider_factory));
 
+  /* release the custom actions cache */
+  thunar_standard_view_custom_actions_invalidate (standard_view);
+  g_hash_table_destroy (standard_view->priv->custom_actions_file_set);
+  g_array_free (standard_view->priv->custom_actions_stamps, TRUE);
+  g_signal_handlers_disconnect_by_func (standard_view->priv->file_monitor, thunar_standard_view_custom_actions_changed, standard_view);
+  g_object_unref (standard_view->priv->file_monitor);
+
   /* release the drag path list (just in case the drag-end wasn't fired before) */
   thunar_g_file_list_free (standard_view->priv->drag_g_file_list);
 
@@ -1238,6 +1298,9 @@ thunar_standard_view_set_ui_manager (ThunarComponent *component,
   /* disconnect from the previous UI manager */
   if (G_LIKELY (standard_view->ui_manager != NULL))
     {
+      /* the cached custom actions are merged into the previous UI manager */
+      thunar_standard_view_custom_actions_invalidate (standard_view);
+
       /* remove any registered custom menu actions */
       if (G_LIKELY (standard_view->priv->custom_merge_id != 0))
         {
@@ -1651,17 +1714,19 @@ thunar_standard_view_get_statusbar_text (ThunarView *view)
   /* generate the statusbar text on-demand */
   if (standard_view->priv->statusbar_text == NULL)
     {
-      /* query the selected items (actually a list of GtkTreePath's) */
-      items = THUNAR_STANDARD_VIEW_GET_CLASS (standard_view)->get_selected_items (standard_view);
-
       /* we display a loading text if no items are
        * selected and the view is loading
        */
-      if (items == NULL && standard_view->loading)
-        return _("Loading folder contents...");
+      if (standard_view->loading)
+        {
+          items = THUNAR_STANDARD_VIEW_GET_CLASS (standard_view)->get_selected_items (standard_view);
+          g_list_free_full (items, (GDestroyNotify) gtk_tree_path_free);
+          if (items == NULL)
+            return _("Loading folder contents...");
+        }
 
-      standard_view->priv->statusbar_text = thunar_list_model_get_statusbar_text (standard_view->model, items);
-      g_list_free_full (items, (GDestroyNotify) gtk_tree_path_free);
+      /* the model knows the selection from thunar_standard_view_selection_changed() */
+      standard_view->priv->statusbar_text = thunar_list_model_get_statusbar_text (standard_view->model);
     }
 
   return standard_view->priv->statusbar_text;
@@ -1999,6 +2064,82 @@ thunar_standard_view_get_drop_file (ThunarStandardView *standard_view,
 
 
 
+static void
+thunar_standard_view_custom_actions_invalidate (ThunarStandardView *standard_view)
+{
+  /* forget the files, the window and the providers the actions were determined for */
+  if (standard_view->priv->custom_actions_files != NULL)
+    {
+      g_hash_table_remove_all (standard_view->priv->custom_actions_file_set);
+      thunar_g_file_list_free (standard_view->priv->custom_actions_files);
+      standard_view->priv->custom_actions_files = NULL;
+    }
+
+  g_list_free_full (standard_view->priv->custom_actions_providers, g_object_unref);
+  standard_view->priv->custom_actions_providers = NULL;
+
+  g_array_set_size (standard_view->priv->custom_actions_stamps, 0);
+  standard_view->priv->custom_actions_window = NULL;
+}
+
+
+
+static void
+thunar_standard_view_custom_actions_changed (ThunarStandardView *standard_view,
+                                             ThunarFile         *file)
+{
+  _thunar_return_if_fail (THUNAR_IS_STANDARD_VIEW (standard_view));
+  _thunar_return_if_fail (THUNAR_IS_FILE (file));
+
+  /* the cached actions were determined for the old state of the file */
+  if (G_UNLIKELY (g_hash_table_lookup (standard_view->priv->custom_actions_file_set, file) != NULL))
+    thunar_standard_view_custom_actions_invalidate (standard_view);
+}
+
+
+
+static gboolean
+thunar_standard_view_custom_actions_cached (ThunarStandardView *standard_view,
+                                            GtkWidget          *window,
+                                            GList              *providers,
+                                            GList              *files,
+                                            gboolean            folder)
+{
+  GList *lp, *lq;
+  guint  n;
+
+  /* check whether the actions are cached at all */
+  if (standard_view->priv->custom_actions_files == NULL
+      || standard_view->priv->custom_actions_window != window
+      || standard_view->priv->custom_actions_folder != folder)
+    return FALSE;
+
+  /* the same providers must still have the same stamps */
+  for (lp = providers, lq = standard_view->priv->custom_actions_providers, n = 0;
+       lp != NULL && lq != NULL;
+       lp = lp->next, lq = lq->next, ++n)
+    {
+      if (lp->data != lq->data
+          || thunarx_menu_provider_get_cache_stamp (lp->data) != g_array_index (standard_view->priv->custom_actions_stamps, guint, n))
+        return FALSE;
+    }
+  if (lp != NULL || lq != NULL)
+    return FALSE;
+
+  /* the actions must have been determined for exactly these files */
+  for (lp = files, lq = standard_view->priv->custom_actions_files;
+       lp != NULL && lq != NULL;
+       lp = lp->next, lq = lq->next)
+    {
+      if (lp->data != lq->data)
+        return FALSE;
+    }
+
+  return (lp == NULL && lq == NULL);
+}
+
+
+
 static void
 thunar_standard_view_merge_custom_actions (ThunarStandardView *standard_view,
                                            GList              *selected_items)
@@ -2006,11 +2147,14 @@ thunar_standard_view_merge_custom_actions (ThunarStandardView *standard_view,
   GtkTreeIter iter;
   ThunarFile *file = NULL;
   GtkWidget  *window;
+  gboolean    cacheable = TRUE;
+  GArray     *stamps;
   GList      *providers;
   GList      *actions = NULL;
   GList      *files = NULL;
   GList      *tmp;
   GList      *lp;
+  guint       stamp;
 
   /* we cannot add anything if we aren't connected to any UI manager */
   if (G_UNLIKELY (standard_view->ui_manager == NULL))
@@ -2038,25 +2182,63 @@ thunar_standard_view_merge_custom_actions (ThunarStandardView *standard_view,
         {
           /* grab a reference to the current directory of the view */
           file = thunar_navigator_get_current_directory (THUNAR_NAVIGATOR (standard_view));
+          if (G_LIKELY (file != NULL))
+            files = g_list_prepend (NULL, g_object_ref (G_OBJECT (file)));
+        }
+
+      /* reuse the previously merged actions if nothing changed since then */
+      if (thunar_standard_view_custom_actions_cached (standard_view, window, providers, files, selected_items == NULL))
+        {
+          g_list_free_full (providers, g_object_unref);
+          thunar_g_file_list_free (files);
+          return;
         }
 
       /* load the actions offered by the menu providers */
+      stamps = g_array_sized_new (FALSE, FALSE, sizeof (guint), g_list_length (providers));
       for (lp = providers; lp != NULL; lp = lp->next)
         {
-          if (G_LIKELY (files != NULL))
+          /* query the stamp first, so a change during the query invalidates the cache */
+          stamp = thunarx_menu_provider_get_cache_stamp (lp->data);
+          if (stamp == 0)
+            cacheable = FALSE;
+          g_array_append_val (stamps, stamp);
+
+          if (G_LIKELY (selected_items != NULL))
             tmp = thunarx_menu_provider_get_file_actions (lp->data, window, files);
           else if (G_LIKELY (file != NULL))
             tmp = thunarx_menu_provider_get_folder_actions (lp->data, window, THUNARX_FILE_INFO (file));
           else
             tmp = NULL;
           actions = g_list_concat (actions, tmp);
-          g_object_unref (G_OBJECT (lp->data));
         }
-      g_list_free (providers);
 
-      /* cleanup the selected files list (if any) */
-      if (G_LIKELY (files != NULL))
-        thunar_g_file_list_free (files);
+      /* forget about the previously cached actions */
+      thunar_standard_view_custom_actions_invalidate (standard_view);
+
+      /* remember what the actions were determined for, if all providers allow it */
+      if (cacheable && files != NULL)
+        {
+          for (lp = files; lp != NULL; lp = lp->next)
+            g_hash_table_insert (standard_view->priv->custom_actions_file_set, lp->data, lp->data);
+          standard_view->priv->custom_actions_files = files;
+          standard_view->priv->custom_actions_providers = providers;
+          standard_view->priv->custom_actions_window = window;
+          standard_view->priv->custom_actions_folder = (selected_items == NULL);
+          g_array_append_vals (standard_view->priv->custom_actions_stamps, stamps->data, stamps->len);
+        }
+      else
+        {
+          g_list_free_full (providers, g_object_unref);
+          thunar_g_file_list_free (files);
+        }
+
+      g_array_free (stamps, TRUE);
+    }
+  else
+    {
+      /* no providers, nothing to cache */
+      thunar_standard_view_custom_actions_invalidate (standard_view);
     }
 
   /* remove the previously determined menu actions from the UI manager */
@@ -4412,6 +4594,9 @@ thunar_standard_view_selection_changed (ThunarStandardView *standard_view)
   /* and setup the new selected files list */
   standard_view->priv->selected_files = selected_files;
 
+  /* let the model update the totals of the selection */
+  thunar_list_model_set_selected_files (standard_view->model, selected_files);
+
   /* check whether the folder displayed by the view is writable/in the trash */
   current_directory = thunar_navigator_get_current_directory (THUNAR_NAVIGATOR (standard_view));
   writable = (current_directory != NULL && thunar_file_is_writable (current_directory));
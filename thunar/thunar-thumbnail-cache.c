@@ -578,6 +578,69 @@ thunar_thumbnail_cache_move_file (ThunarThumbnailCache *cache,
 
 
 
+/**
+ * thunar_thumbnail_cache_move_files:
+ * @cache        : a #ThunarThumbnailCache.
+ * @source_files : a #GList of #GFile<!---->s that were moved.
+ * @target_files : a #GList of the matching destination #GFile<!---->s.
+ *
+ * Same as thunar_thumbnail_cache_move_file(), but queues all pairs
+ * at once, so large batches of moves only take the cache lock and
+ * reschedule the queue timeout a single time.
+ **/
+void
+thunar_thumbnail_cache_move_files (ThunarThumbnailCache *cache,
+                                   GList                *source_files,
+                                   GList                *target_files)
+{
+  GList *sp;
+  GList *tp;
+
+  _thunar_return_if_fail (THUNAR_IS_THUMBNAIL_CACHE (cache));
+  _thunar_return_if_fail (g_list_length (source_files) == g_list_length (target_files));
+
+  if (G_UNLIKELY (source_files == NULL))
+    return;
+
+  /* acquire a cache lock */
+  _thumbnail_cache_lock (cache);
+
+  /* check if we have a valid proxy for the cache service */
+  if (cache->proxy_state != THUNAR_THUMBNAIL_CACHE_PROXY_FAILED)
+    {
+      /* add the files to the move queue */
+      for (sp = source_files, tp = target_files;
+           sp != NULL && tp != NULL;
+           sp = sp->next, tp = tp->next)
+        {
+          cache->move_source_queue = g_list_prepend (cache->move_source_queue,
+                                                     g_object_ref (sp->data));
+          cache->move_target_queue = g_list_prepend (cache->move_target_queue,
+                                                     g_object_ref (tp->data));
+        }
+    }
+
+  if (cache->proxy_state == THUNAR_THUMBNAIL_CACHE_PROXY_AVAILABLE)
+    {
+      /* cancel any pending timeout to process the move queue */
+      if (cache->move_queue_idle_id > 0)
+        {
+          g_source_remove (cache->move_queue_idle_id);
+          cache->move_queue_idle_id = 0;
+        }
+
+      /* process the move queue in a 250ms timeout */
+      cache->move_queue_idle_id =
+        g_timeout_add_full (G_PRIORITY_DEFAULT_IDLE, 250, thunar_thumbnail_cache_process_move_queue,
+                            cache, thunar_thumbnail_cache_process_move_queue_destroy);
+    }
+
+  /* release the cache lock */
+  _thumbnail_cache_unlock (cache);
+}
+
+
+
 void
 thunar_thumbnail_cache_copy_file (ThunarThumbnailCache *cache,
                                   GFile                *source_file,
@@ -659,6 +722,49 @@ thunar_thumbnail_cache_delete_file (ThunarThumbnailCache *cache,
 
 
 
+void
+thunar_thumbnail_cache_delete_files (ThunarThumbnailCache *cache,
+                                     GList                *files)
+{
+  GList *lp;
+
+  _thunar_return_if_fail (THUNAR_IS_THUMBNAIL_CACHE (cache));
+
+  if (G_UNLIKELY (files == NULL))
+    return;
+
+  /* acquire a cache lock */
+  _thumbnail_cache_lock (cache);
+
+  /* check if we have a valid proxy for the cache service */
+  if (cache->proxy_state != THUNAR_THUMBNAIL_CACHE_PROXY_FAILED)
+    {
+      /* add the files to the delete queue */
+      for (lp = files; lp != NULL; lp = lp->next)
+        cache->delete_queue = g_list_prepend (cache->delete_queue, g_object_ref (lp->data));
+    }
+
+  if (cache->proxy_state == THUNAR_THUMBNAIL_CACHE_PROXY_AVAILABLE)
+    {
+      /* cancel any pending timeout to process the delete queue */
+      if (cache->delete_queue_idle_id > 0)
+        {
+          g_source_remove (cache->delete_queue_idle_id);
+          cache->delete_queue_idle_id = 0;
+        }
+
+      /* process the delete queue in a 500ms timeout */
+      cache->delete_queue_idle_id =
+        g_timeout_add (500, (GSourceFunc) thunar_thumbnail_cache_process_delete_queue,
+                       cache);
+    }
+
+  /* release the cache lock */
+  _thumbnail_cache_unlock (cache);
+}
+
+
+
 void
 thunar_thumbnail_cache_cleanup_file (ThunarThumbnailCache *cache,
                                      GFile                *file)
@@ -43,11 +43,16 @@ ThunarThumbnailCache *thunar_thumbnail_cache_new          (void) G_GNUC_MALLOC G
 void                  thunar_thumbnail_cache_move_file    (ThunarThumbnailCache *cache,
                                                            GFile                *source_file,
                                                            GFile                *target_file);
+void                  thunar_thumbnail_cache_move_files   (ThunarThumbnailCache *cache,
+                                                           GList                *source_files,
+                                                           GList                *target_files);
 void                  thunar_thumbnail_cache_copy_file    (ThunarThumbnailCache *cache,
                                                            GFile                *source_file,
                                                            GFile                *target_file);
 void                  thunar_thumbnail_cache_delete_file  (ThunarThumbnailCache *cache,
                                                            GFile                *file);
+void                  thunar_thumbnail_cache_delete_files (ThunarThumbnailCache *cache,
+                                                           GList                *files);
 void                  thunar_thumbnail_cache_cleanup_file (ThunarThumbnailCache *cache,
                                                            GFile                *file);
 
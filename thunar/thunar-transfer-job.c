@@ -23,6 +23,17 @@
 #include <config.h>
 #endif
 
+#ifdef HAVE_ERRNO_H
+#include <errno.h>
+#endif
+#ifdef HAVE_FCNTL_H
+#include <fcntl.h>
+#endif
+#include <stdio.h>
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+
 #include <gio/gio.h>
 
 #include <thunar/thunar-application.h>
@@ -34,12 +45,22 @@
 #include <thunar/thunar-private.h>
 #include <thunar/thunar-thumbnail-cache.h>
 #include <thunar/thunar-transfer-job.h>
+#include <thunar/thunar-transfer-journal.h>
 
 
 
 /* seconds before we show the transfer rate + remaining time */
 #define MINIMUM_TRANSFER_TIME (10 * G_USEC_PER_SEC) /* 10 seconds */
 
+/* number of files renamed between progress updates in the fast move path */
+#define FAST_MOVE_PROGRESS_INTERVAL (500)
+
+/* number of bytes copied between two journal updates of a file */
+#define JOURNAL_PARTIAL_INTERVAL (64 * 1024 * 1024)
+
+/* size of the buffer used to continue partially copied files */
+#define RESUME_BUFFER_SIZE (1024 * 1024)
+
 
 
 /* Property identifiers */
@@ -96,6 +117,16 @@ struct _ThunarTransferJob
 
   ThunarPreferences    *preferences;
   gboolean              file_size_binary;
+
+  /* journal of the copy, loaded from an interrupted job if resuming */
+  ThunarTransferJournal *journal;
+  gboolean               resuming;
+  gboolean               verify_checksum;
+
+  /* file currently being copied and its last journaled offset */
+  GFile                 *journal_file;
+  guint64                journal_mtime;
+  guint64                journal_offset;
 };
 
 struct _ThunarTransferNode
@@ -158,6 +189,9 @@ thunar_transfer_job_init (ThunarTransferJob *job)
   job->last_total_progress = 0;
   job->transfer_rate = 0;
   job->start_time = 0;
+  job->journal = NULL;
+  job->resuming = FALSE;
+  job->journal_file = NULL;
 }
 
 
@@ -171,6 +205,8 @@ thunar_transfer_job_finalize (GObject *object)
 
   thunar_g_file_list_free (job->target_file_list);
 
+  thunar_transfer_journal_free (job->journal);
+
   g_object_unref (job->preferences);
 
   (*G_OBJECT_CLASS (thunar_transfer_job_parent_class)->finalize) (object);
@@ -270,6 +306,15 @@ thunar_transfer_job_progress (goffset  current_num_bytes,
           job->last_total_progress = job->total_progress;
         }
     }
+
+  /* remember how far we got with large files, so we can continue there */
+  if (job->journal_file != NULL
+      && (guint64) current_num_bytes >= job->journal_offset + JOURNAL_PARTIAL_INTERVAL)
+    {
+      thunar_transfer_journal_mark_partial (job->journal, job->journal_file,
+                                            current_num_bytes, job->journal_mtime);
+      job->journal_offset = current_num_bytes;
+    }
 }
 
 
@@ -570,6 +615,10 @@ thunar_transfer_job_copy_file (ThunarTransferJob *job,
           if (response == THUNAR_JOB_RESPONSE_YES)
             {
               copy_flags |= G_FILE_COPY_OVERWRITE;
+
+              /* the old contents of the target cannot be told apart from
+               * copied data on resume, so only journal the finished file */
+              job->journal_file = NULL;
               continue;
             }
 
@@ -588,6 +637,248 @@ thunar_transfer_job_copy_file (ThunarTransferJob *job,
 
 
 
+static gchar *
+ttj_file_checksum (GFile        *file,
+                   GCancellable *cancellable)
+{
+  GFileInputStream *stream;
+  GChecksum        *checksum;
+  gssize            n_read;
+  gchar            *buffer;
+  gchar            *result = NULL;
+
+  stream = g_file_read (file, cancellable, NULL);
+  if (G_UNLIKELY (stream == NULL))
+    return NULL;
+
+  checksum = g_checksum_new (G_CHECKSUM_SHA256);
+  buffer = g_malloc (RESUME_BUFFER_SIZE);
+
+  do
+    {
+      n_read = g_input_stream_read (G_INPUT_STREAM (stream), buffer, RESUME_BUFFER_SIZE,
+                                    cancellable, NULL);
+      if (n_read > 0)
+        g_checksum_update (checksum, (const guchar *) buffer, n_read);
+    }
+  while (n_read > 0);
+
+  /* only return a checksum if we read the whole file */
+  if (n_read == 0)
+    result = g_strdup (g_checksum_get_string (checksum));
+
+  g_free (buffer);
+  g_checksum_free (checksum);
+  g_object_unref (stream);
+
+  return result;
+}
+
+
+
+static gboolean
+ttj_resume_copy (ThunarTransferJob *job,
+                 GFile             *source_file,
+                 GFile             *target_file,
+                 goffset            offset,
+                 goffset            size,
+                 GError           **error)
+{
+  GFileInputStream *input;
+  GOutputStream    *output;
+  GFileIOStream    *iostream;
+  GCancellable     *cancellable;
+  gboolean          succeed = FALSE;
+  gssize            n_read;
+  gchar            *buffer;
+
+  _thunar_return_val_if_fail (THUNAR_IS_TRANSFER_JOB (job), FALSE);
+  _thunar_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+  cancellable = exo_job_get_cancellable (EXO_JOB (job));
+
+  input = g_file_read (source_file, cancellable, error);
+  if (G_UNLIKELY (input == NULL))
+    return FALSE;
+
+  iostream = g_file_open_readwrite (target_file, cancellable, error);
+  if (G_UNLIKELY (iostream == NULL))
+    {
+      g_object_unref (input);
+      return FALSE;
+    }
+
+  /* drop everything after the last journaled offset, it might be garbage */
+  if (g_seekable_seek (G_SEEKABLE (input), offset, G_SEEK_SET, cancellable, error)
+      && g_seekable_truncate (G_SEEKABLE (iostream), offset, cancellable, error)
+      && g_seekable_seek (G_SEEKABLE (iostream), offset, G_SEEK_SET, cancellable, error))
+    {
+      /* account for the part we already have */
+      thunar_transfer_job_progress (offset, size, job);
+
+      output = g_io_stream_get_output_stream (G_IO_STREAM (iostream));
+      buffer = g_malloc (RESUME_BUFFER_SIZE);
+
+      for (;;)
+        {
+          n_read = g_input_stream_read (G_INPUT_STREAM (input), buffer, RESUME_BUFFER_SIZE,
+                                        cancellable, error);
+          if (n_read <= 0)
+            {
+              succeed = (n_read == 0);
+              break;
+            }
+
+          if (!g_output_stream_write_all (output, buffer, n_read, NULL, cancellable, error))
+            break;
+
+          offset += n_read;
+          thunar_transfer_job_progress (offset, size, job);
+        }
+
+      g_free (buffer);
+    }
+
+  /* close the streams, but only report the first error */
+  g_input_stream_close (G_INPUT_STREAM (input), NULL, NULL);
+  if (!g_io_stream_close (G_IO_STREAM (iostream), cancellable, succeed ? error : NULL))
+    succeed = FALSE;
+
+  g_object_unref (input);
+  g_object_unref (iostream);
+
+  /* copy the default attributes (i.e. the modification time) like g_file_copy() */
+  if (succeed)
+    {
+      g_file_copy_attributes (source_file, target_file, G_FILE_COPY_NOFOLLOW_SYMLINKS,
+                              cancellable, NULL);
+    }
+
+  return succeed;
+}
+
+
+
+/**
+ * thunar_transfer_job_resume_file:
+ * @job         : a resuming #ThunarTransferJob.
+ * @source_file : the source #GFile to copy.
+ * @target_file : the destination #GFile to copy to.
+ * @error       : return location for errors or %NULL.
+ *
+ * Checks the journal of the interrupted job for @target_file. Files that
+ * were copied completely are skipped if their size and modification time
+ * still match the source (and optionally their checksum), partially copied
+ * files are continued at their last journaled offset.
+ *
+ * Return value: @target_file if the file was skipped or continued, %NULL
+ *               if the file has to be copied the regular way or on error.
+ **/
+static GFile *
+thunar_transfer_job_resume_file (ThunarTransferJob *job,
+                                 GFile             *source_file,
+                                 GFile             *target_file,
+                                 GError           **error)
+{
+  ThunarTransferJournalState state;
+  GCancellable              *cancellable;
+  GFileInfo                 *source_info;
+  GFileInfo                 *target_info;
+  gboolean                   resumed = FALSE;
+  guint64                    source_mtime = 0;
+  guint64                    offset = 0;
+  goffset                    source_size;
+  goffset                    target_size;
+  gchar                     *source_checksum;
+  gchar                     *target_checksum;
+  GError                    *err = NULL;
+
+  _thunar_return_val_if_fail (THUNAR_IS_TRANSFER_JOB (job), NULL);
+  _thunar_return_val_if_fail (job->journal != NULL, NULL);
+  _thunar_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+  state = thunar_transfer_journal_lookup (job->journal, target_file, &offset, &source_mtime);
+  if (state == THUNAR_TRANSFER_JOURNAL_NONE || g_file_equal (source_file, target_file))
+    return NULL;
+
+  cancellable = exo_job_get_cancellable (EXO_JOB (job));
+
+  source_info = g_file_query_info (source_file,
+                                   G_FILE_ATTRIBUTE_STANDARD_SIZE ","
+                                   G_FILE_ATTRIBUTE_STANDARD_TYPE ","
+                                   G_FILE_ATTRIBUTE_TIME_MODIFIED,
+                                   G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS,
+                                   cancellable, NULL);
+  target_info = g_file_query_info (target_file,
+                                   G_FILE_ATTRIBUTE_STANDARD_SIZE ","
+                                   G_FILE_ATTRIBUTE_STANDARD_TYPE ","
+                                   G_FILE_ATTRIBUTE_TIME_MODIFIED,
+                                   G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS,
+                                   cancellable, NULL);
+
+  if (source_info != NULL && target_info != NULL
+      && g_file_info_get_file_type (source_info) == G_FILE_TYPE_REGULAR
+      && g_file_info_get_file_type (target_info) == G_FILE_TYPE_REGULAR)
+    {
+      source_size = g_file_info_get_size (source_info);
+      target_size = g_file_info_get_size (target_info);
+
+      /* reset the file progress */
+      job->file_progress = 0;
+
+      if (state == THUNAR_TRANSFER_JOURNAL_DONE)
+        {
+          /* the copy kept the modification time of the source */
+          resumed = (source_size == target_size
+                     && g_file_info_get_attribute_uint64 (source_info, G_FILE_ATTRIBUTE_TIME_MODIFIED)
+                        == g_file_info_get_attribute_uint64 (target_info, G_FILE_ATTRIBUTE_TIME_MODIFIED));
+
+          if (resumed && job->verify_checksum)
+            {
+              source_checksum = ttj_file_checksum (source_file, cancellable);
+              target_checksum = ttj_file_checksum (target_file, cancellable);
+              resumed = (source_checksum != NULL && g_strcmp0 (source_checksum, target_checksum) == 0);
+              g_free (source_checksum);
+              g_free (target_checksum);
+            }
+
+          /* account for the skipped file */
+          if (resumed)
+            thunar_transfer_job_progress (source_size, source_size, job);
+        }
+      else if (g_file_info_get_attribute_uint64 (source_info, G_FILE_ATTRIBUTE_TIME_MODIFIED) == source_mtime
+               && (guint64) source_size >= offset
+               && (guint64) target_size >= offset)
+        {
+          resumed = ttj_resume_copy (job, source_file, target_file, offset, source_size, &err);
+          if (!resumed)
+            {
+              /* forget about the progress of the failed attempt */
+              job->total_progress -= job->file_progress;
+              job->file_progress = 0;
+            }
+        }
+    }
+
+  if (source_info != NULL)
+    g_object_unref (source_info);
+  if (target_info != NULL)
+    g_object_unref (target_info);
+
+  if (G_UNLIKELY (err != NULL))
+    {
+      /* fall back to a regular copy, unless the user cancelled */
+      if (exo_job_is_cancelled (EXO_JOB (job)))
+        g_propagate_error (error, err);
+      else
+        g_error_free (err);
+    }
+
+  return resumed ? g_object_ref (target_file) : NULL;
+}
+
+
+
 static void
 thunar_transfer_job_copy_node (ThunarTransferJob  *job,
                                ThunarTransferNode *node,
@@ -634,7 +925,8 @@ thunar_transfer_job_copy_node (ThunarTransferJob  *job,
 
       /* query file info */
       info = g_file_query_info (node->source_file,
-                                G_FILE_ATTRIBUTE_STANDARD_DISPLAY_NAME,
+                                G_FILE_ATTRIBUTE_STANDARD_DISPLAY_NAME ","
+                                G_FILE_ATTRIBUTE_TIME_MODIFIED,
                                 G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS,
                                 exo_job_get_cancellable (EXO_JOB (job)),
                                 &err);
@@ -650,9 +942,32 @@ thunar_transfer_job_copy_node (ThunarTransferJob  *job,
       exo_job_info_message (EXO_JOB (job), "%s", g_file_info_get_display_name (info));
 
 retry_copy:
-      /* copy the item specified by this node (not recursively) */
-      real_target_file = thunar_transfer_job_copy_file (job, node->source_file,
-                                                        target_file, &err);
+      real_target_file = NULL;
+
+      /* check if an interrupted job already copied (parts of) the file */
+      if (G_UNLIKELY (job->resuming))
+        {
+          real_target_file = thunar_transfer_job_resume_file (job, node->source_file,
+                                                              target_file, &err);
+        }
+
+      if (real_target_file == NULL && err == NULL)
+        {
+          /* journal the progress of the file while copying */
+          if (job->journal != NULL && !g_file_equal (node->source_file, target_file))
+            {
+              job->journal_file = target_file;
+              job->journal_mtime = g_file_info_get_attribute_uint64 (info, G_FILE_ATTRIBUTE_TIME_MODIFIED);
+              job->journal_offset = 0;
+            }
+
+          /* copy the item specified by this node (not recursively) */
+          real_target_file = thunar_transfer_job_copy_file (job, node->source_file,
+                                                            target_file, &err);
+
+          job->journal_file = NULL;
+        }
+
       if (G_LIKELY (real_target_file != NULL))
         {
           /* node->source_file == real_target_file means to skip the file */
@@ -683,6 +998,10 @@ retry_copy:
                   break;
                 }
 
+              /* directories are merged on resume, so only files need an entry */
+              if (job->journal != NULL && node->children == NULL)
+                thunar_transfer_journal_mark_done (job->journal, real_target_file);
+
               /* add the real target file to the return list */
               if (G_LIKELY (target_file_list_return != NULL))
                 {
@@ -846,6 +1165,198 @@ thunar_transfer_job_verify_destination (ThunarTransferJob  *transfer_job,
 
 
 
+#ifdef HAVE_RENAMEAT2
+static void
+ttj_fast_move_close_fd (gpointer data)
+{
+  gint fd = GPOINTER_TO_INT (data);
+
+  if (fd >= 0)
+    close (fd);
+}
+
+
+
+static gint
+ttj_fast_move_lookup_fd (GHashTable *dir_fds,
+                         GFile      *directory)
+{
+  gpointer fd_ptr;
+  gchar   *path;
+  gint     fd = -1;
+
+  /* check if we already opened this directory */
+  if (g_hash_table_lookup_extended (dir_fds, directory, NULL, &fd_ptr))
+    return GPOINTER_TO_INT (fd_ptr);
+
+  path = g_file_get_path (directory);
+  if (G_LIKELY (path != NULL))
+    fd = open (path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  g_free (path);
+
+  /* failures are cached as well, so we don't retry them for every file */
+  g_hash_table_insert (dir_fds, g_object_ref (directory), GINT_TO_POINTER (fd));
+
+  return fd;
+}
+
+
+
+/* returns 0 if the file was renamed, the errno of the failure otherwise */
+static gint
+ttj_fast_move_file (GHashTable *dir_fds,
+                    GFile      *source_file,
+                    GFile      *target_file)
+{
+  GFile    *source_parent;
+  GFile    *target_parent;
+  gchar    *source_name;
+  gchar    *target_name;
+  gint      saved_errno = EXDEV;
+  gint      source_fd = -1;
+  gint      target_fd = -1;
+
+  source_parent = g_file_get_parent (source_file);
+  target_parent = g_file_get_parent (target_file);
+
+  if (G_LIKELY (source_parent != NULL && target_parent != NULL))
+    {
+      source_fd = ttj_fast_move_lookup_fd (dir_fds, source_parent);
+      target_fd = ttj_fast_move_lookup_fd (dir_fds, target_parent);
+    }
+
+  if (G_LIKELY (source_fd >= 0 && target_fd >= 0))
+    {
+      source_name = g_file_get_basename (source_file);
+      target_name = g_file_get_basename (target_file);
+
+      /* never replace an existing target, conflicts are resolved by the
+       * regular move path which asks the user what to do */
+      if (renameat2 (source_fd, source_name, target_fd, target_name, RENAME_NOREPLACE) == 0)
+        saved_errno = 0;
+      else
+        saved_errno = errno;
+
+      g_free (source_name);
+      g_free (target_name);
+    }
+
+  if (source_parent != NULL)
+    g_object_unref (source_parent);
+  if (target_parent != NULL)
+    g_object_unref (target_parent);
+
+  return saved_errno;
+}
+#endif
+
+
+
+/**
+ * thunar_transfer_job_fast_move:
+ * @job                    : a #ThunarTransferJob.
+ * @new_files_list_return  : return location for the moved target files.
+ *
+ * Tries to move all native source files of @job with a plain rename
+ * against cached directory descriptors. No file info is queried for
+ * the files and the thumbnail cache is notified once for the whole
+ * batch. Every file that was moved is dropped from the source and
+ * target lists of @job and prepended to @new_files_list_return; the
+ * remaining files (other devices, conflicts, non-native files, ...)
+ * are left to the regular move path.
+ **/
+static void
+thunar_transfer_job_fast_move (ThunarTransferJob *job,
+                               GList            **new_files_list_return)
+{
+#ifdef HAVE_RENAMEAT2
+  ThunarThumbnailCache *thumbnail_cache;
+  ThunarTransferNode   *node;
+  ThunarApplication    *application;
+  GHashTable           *dir_fds;
+  GList                *moved_sources = NULL;
+  GList                *moved_targets = NULL;
+  GList                *snext;
+  GList                *sp;
+  GList                *tnext;
+  GList                *tp;
+  guint                 n_files;
+  guint                 n_moved = 0;
+  gint                  move_errno;
+
+  _thunar_return_if_fail (THUNAR_IS_TRANSFER_JOB (job));
+  _thunar_return_if_fail (job->type == THUNAR_TRANSFER_JOB_MOVE);
+
+  n_files = g_list_length (job->source_node_list);
+
+  /* directory descriptors, shared by all files with the same parent */
+  dir_fds = g_hash_table_new_full (g_file_hash, (GEqualFunc) g_file_equal,
+                                   g_object_unref, ttj_fast_move_close_fd);
+
+  for (sp = job->source_node_list, tp = job->target_file_list;
+       sp != NULL && tp != NULL;
+       sp = snext, tp = tnext)
+    {
+      /* determine the next list items */
+      snext = sp->next;
+      tnext = tp->next;
+
+      if (exo_job_is_cancelled (EXO_JOB (job)))
+        break;
+
+      node = sp->data;
+
+      /* only local files can be renamed directly */
+      if (!g_file_is_native (node->source_file) || !g_file_is_native (tp->data))
+        continue;
+
+      move_errno = ttj_fast_move_file (dir_fds, node->source_file, tp->data);
+      if (move_errno == 0)
+        {
+          /* remember the pair for the thumbnail cache, this takes
+           * over the reference of the target list item */
+          moved_sources = g_list_prepend (moved_sources, g_object_ref (node->source_file));
+          moved_targets = g_list_prepend (moved_targets, tp->data);
+
+          /* add the target file to the new files list */
+          *new_files_list_return = thunar_g_file_list_prepend (*new_files_list_return, tp->data);
+
+          /* release the source node and drop the matching list items */
+          thunar_transfer_node_free (node);
+          job->source_node_list = g_list_delete_link (job->source_node_list, sp);
+          job->target_file_list = g_list_delete_link (job->target_file_list, tp);
+
+          /* update the progress every now and then */
+          if (++n_moved % FAST_MOVE_PROGRESS_INTERVAL == 0)
+            exo_job_percent (EXO_JOB (job), (n_moved * 100.0) / n_files);
+        }
+      else if (move_errno == ENOSYS)
+        {
+          /* the kernel does not know renameat2, no point in trying the others */
+          break;
+        }
+    }
+
+  g_hash_table_destroy (dir_fds);
+
+  if (moved_sources != NULL)
+    {
+      /* notify the thumbnail cache of all move operations at once */
+      application = thunar_application_get ();
+      thumbnail_cache = thunar_application_get_thumbnail_cache (application);
+      g_object_unref (application);
+
+      thunar_thumbnail_cache_move_files (thumbnail_cache, moved_sources, moved_targets);
+      g_object_unref (thumbnail_cache);
+
+      g_list_free_full (moved_sources, g_object_unref);
+      g_list_free_full (moved_targets, g_object_unref);
+    }
+#endif
+}
+
+
+
 static gboolean
 thunar_transfer_job_execute (ExoJob  *job,
                              GError **error)
@@ -859,6 +1370,7 @@ thunar_transfer_job_execute (ExoJob  *job,
   gboolean              parent_exists;
   GError               *err = NULL;
   GList                *new_files_list = NULL;
+  GList                *source_file_list = NULL;
   GList                *snext;
   GList                *sp;
   GList                *tnext;
@@ -873,6 +1385,14 @@ thunar_transfer_job_execute (ExoJob  *job,
   if (exo_job_set_error_if_cancelled (job, error))
     return FALSE;
 
+  /* rename files on the same file system in one go, before
+   * we start to query information for every single file */
+  if (transfer_job->type == THUNAR_TRANSFER_JOB_MOVE)
+    {
+      exo_job_info_message (job, _("Moving files..."));
+      thunar_transfer_job_fast_move (transfer_job, &new_files_list);
+    }
+
   exo_job_info_message (job, _("Collecting files..."));
 
   /* take a reference on the thumbnail cache */
@@ -1035,8 +1555,9 @@ thunar_transfer_job_execute (ExoJob  *job,
   /* continue if there were no errors yet */
   if (G_LIKELY (err == NULL))
     {
-      /* check destination */
-      if (!thunar_transfer_job_verify_destination (transfer_job, &err))
+      /* check destination, unless it already holds parts of the data */
+      if (!transfer_job->resuming
+          && !thunar_transfer_job_verify_destination (transfer_job, &err))
         {
           if (err != NULL)
             {
@@ -1050,6 +1571,22 @@ thunar_transfer_job_execute (ExoJob  *job,
             }
         }
 
+      /* journal copies, so they can be resumed if we are interrupted */
+      if (transfer_job->type == THUNAR_TRANSFER_JOB_COPY
+          && transfer_job->journal == NULL
+          && transfer_job->source_node_list != NULL)
+        {
+          for (sp = g_list_last (transfer_job->source_node_list); sp != NULL; sp = sp->prev)
+            {
+              node = sp->data;
+              source_file_list = g_list_prepend (source_file_list, node->source_file);
+            }
+
+          transfer_job->journal = thunar_transfer_journal_new (source_file_list,
+                                                               transfer_job->target_file_list);
+          g_list_free (source_file_list);
+        }
+
       /* transfer starts now */
       transfer_job->start_time = g_get_real_time ();
 
@@ -1061,6 +1598,10 @@ thunar_transfer_job_execute (ExoJob  *job,
           thunar_transfer_job_copy_node (transfer_job, sp->data, tp->data, NULL,
                                          &new_files_list, &err);
         }
+
+      /* the job is over (finished, failed or cancelled), no need to resume it */
+      if (transfer_job->journal != NULL)
+        thunar_transfer_journal_remove (transfer_job->journal);
     }
 
   /* check if we failed */
@@ -1154,6 +1695,36 @@ thunar_transfer_job_new (GList                *source_node_list,
 
 
 
+/**
+ * thunar_transfer_job_new_resume:
+ * @journal : a #ThunarTransferJournal of an interrupted copy.
+ *
+ * Allocates a new copy job that continues the job recorded in
+ * @journal. The job takes over the ownership of @journal.
+ *
+ * Return value: the newly allocated #ThunarTransferJob.
+ **/
+ThunarJob *
+thunar_transfer_job_new_resume (ThunarTransferJournal *journal)
+{
+  ThunarTransferJob *job;
+
+  _thunar_return_val_if_fail (journal != NULL, NULL);
+
+  job = THUNAR_TRANSFER_JOB (thunar_transfer_job_new (thunar_transfer_journal_get_source_files (journal),
+                                                      thunar_transfer_journal_get_target_files (journal),
+                                                      THUNAR_TRANSFER_JOB_COPY));
+  job->journal = journal;
+  job->resuming = TRUE;
+
+  /* the preferences are not meant to be accessed from the job thread */
+  g_object_get (G_OBJECT (job->preferences), "misc-transfer-verify-checksum", &job->verify_checksum, NULL);
+
+  return THUNAR_JOB (job);
+}
+
+
+
 gchar *
 thunar_transfer_job_get_status (ThunarTransferJob *job)
 {
@@ -1218,3 +1789,27 @@ thunar_transfer_job_get_status (ThunarTransferJob *job)
   return g_string_free (status, FALSE);
 }
 
+
+
+
+/**
+ * thunar_transfer_job_get_progress:
+ * @job            : a #ThunarTransferJob.
+ * @total_progress : return location for the number of bytes transferred.
+ * @total_size     : return location for the number of bytes to transfer.
+ *
+ * Returns the transfer progress of @job in bytes, for callers that
+ * report the progress without thunar_transfer_job_get_status().
+ **/
+void
+thunar_transfer_job_get_progress (ThunarTransferJob *job,
+                                  guint64           *total_progress,
+                                  guint64           *total_size)
+{
+  _thunar_return_if_fail (THUNAR_IS_TRANSFER_JOB (job));
+
+  if (total_progress != NULL)
+    *total_progress = job->total_progress;
+  if (total_size != NULL)
+    *total_size = job->total_size;
+}
@@ -23,6 +23,8 @@
 
 #include <glib-object.h>
 
+#include <thunar/thunar-transfer-journal.h>
+
 G_BEGIN_DECLS
 
 /**
@@ -51,11 +53,16 @@ typedef struct _ThunarTransferJob        ThunarTransferJob;
 
 GType      thunar_transfer_job_get_type (void) G_GNUC_CONST;
 
-ThunarJob *thunar_transfer_job_new        (GList                *source_file_list,
-                                           GList                *target_file_list,
-                                           ThunarTransferJobType type) G_GNUC_MALLOC G_GNUC_WARN_UNUSED_RESULT;
+ThunarJob *thunar_transfer_job_new          (GList                *source_file_list,
+                                             GList                *target_file_list,
+                                             ThunarTransferJobType type) G_GNUC_MALLOC G_GNUC_WARN_UNUSED_RESULT;
+ThunarJob *thunar_transfer_job_new_resume   (ThunarTransferJournal *journal) G_GNUC_MALLOC G_GNUC_WARN_UNUSED_RESULT;
+
+gchar     *thunar_transfer_job_get_status   (ThunarTransferJob    *job);
 
-gchar     *thunar_transfer_job_get_status (ThunarTransferJob    *job);
+void       thunar_transfer_job_get_progress (ThunarTransferJob    *job,
+                                             guint64              *total_progress,
+                                             guint64              *total_size);
 
 G_END_DECLS
 
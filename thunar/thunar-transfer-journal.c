@@ -0,0 +1,595 @@
+/* vi:set et ai sw=2 sts=2 ts=2: */
+/*-
+ * Copyright (c) 2015 Xfce Development Team <xfce4-dev@xfce.org>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the Free
+ * Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* The journal is a plain text file in $XDG_CACHE_HOME/Thunar/transfers/,
+ * which is only ever appended to while the job is running:
+ *
+ *   version 1
+ *   pid <pid of the owning process>
+ *   copy <source uri> <target uri>
+ *   done <target uri>
+ *   partial <target uri> <offset> <source mtime>
+ *
+ * One "copy" line is written for every toplevel pair of the job, "done"
+ * and "partial" lines are written while the job is running. Later lines
+ * replace earlier lines for the same target. URIs are always escaped,
+ * so they never contain whitespace. The file is removed once the job
+ * finishes, so every journal that is left behind by a process that is
+ * no longer running belongs to an interrupted job.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#ifdef HAVE_ERRNO_H
+#include <errno.h>
+#endif
+#ifdef HAVE_SIGNAL_H
+#include <signal.h>
+#endif
+#ifdef HAVE_STDARG_H
+#include <stdarg.h>
+#endif
+#include <stdio.h>
+#ifdef HAVE_STDLIB_H
+#include <stdlib.h>
+#endif
+#ifdef HAVE_STRING_H
+#include <string.h>
+#endif
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+
+#include <glib/gstdio.h>
+
+#include <libxfce4util/libxfce4util.h>
+
+#include <thunar/thunar-gio-extensions.h>
+#include <thunar/thunar-private.h>
+#include <thunar/thunar-transfer-journal.h>
+
+
+
+/* relative location of the journals in the cache directory */
+#define JOURNAL_DIRECTORY "Thunar/transfers/"
+
+/* current version of the journal format */
+#define JOURNAL_VERSION (1)
+
+
+
+typedef struct _ThunarTransferJournalEntry ThunarTransferJournalEntry;
+
+
+
+struct _ThunarTransferJournal
+{
+  gchar      *path;
+  FILE       *stream;
+
+  GList      *source_file_list;
+  GList      *target_file_list;
+
+  /* target uri -> ThunarTransferJournalEntry */
+  GHashTable *entries;
+};
+
+struct _ThunarTransferJournalEntry
+{
+  ThunarTransferJournalState state;
+  guint64                    offset;
+  guint64                    source_mtime;
+};
+
+
+
+static ThunarTransferJournal *
+thunar_transfer_journal_alloc (void)
+{
+  ThunarTransferJournal *journal;
+
+  journal = g_slice_new0 (ThunarTransferJournal);
+  journal->entries = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+
+  return journal;
+}
+
+
+
+static void
+thunar_transfer_journal_write (ThunarTransferJournal *journal,
+                               const gchar           *format,
+                               ...)
+{
+  va_list args;
+
+  if (G_UNLIKELY (journal->stream == NULL))
+    return;
+
+  va_start (args, format);
+  vfprintf (journal->stream, format, args);
+  va_end (args);
+
+  /* hand the line to the kernel, so it survives if we crash right after;
+   * this is no fsync(), but the copied data is not synced either */
+  fflush (journal->stream);
+}
+
+
+
+static void
+thunar_transfer_journal_set_entry (ThunarTransferJournal      *journal,
+                                   const gchar                *uri,
+                                   ThunarTransferJournalState  state,
+                                   guint64                     offset,
+                                   guint64                     source_mtime)
+{
+  ThunarTransferJournalEntry *entry;
+
+  entry = g_hash_table_lookup (journal->entries, uri);
+  if (entry == NULL)
+    {
+      entry = g_new0 (ThunarTransferJournalEntry, 1);
+      g_hash_table_insert (journal->entries, g_strdup (uri), entry);
+    }
+
+  entry->state = state;
+  entry->offset = offset;
+  entry->source_mtime = source_mtime;
+}
+
+
+
+/**
+ * thunar_transfer_journal_new:
+ * @source_file_list : the toplevel source #GFile<!---->s of the job.
+ * @target_file_list : the matching target #GFile<!---->s.
+ *
+ * Creates a new journal file for a transfer job and records the
+ * toplevel pairs of the job in it. If the journal file cannot be
+ * created, the returned journal silently records nothing.
+ *
+ * Return value: the newly allocated #ThunarTransferJournal, which must
+ *               be released with thunar_transfer_journal_free().
+ **/
+ThunarTransferJournal *
+thunar_transfer_journal_new (GList *source_file_list,
+                             GList *target_file_list)
+{
+  ThunarTransferJournal *journal;
+  GList                 *sp;
+  GList                 *tp;
+  gchar                 *directory;
+  gchar                 *source_uri;
+  gchar                 *target_uri;
+  gint                   fd = -1;
+
+  _thunar_return_val_if_fail (g_list_length (source_file_list) == g_list_length (target_file_list), NULL);
+
+  journal = thunar_transfer_journal_alloc ();
+  journal->source_file_list = thunar_g_file_list_copy (source_file_list);
+  journal->target_file_list = thunar_g_file_list_copy (target_file_list);
+
+  /* create a unique journal file in the cache directory */
+  directory = xfce_resource_save_location (XFCE_RESOURCE_CACHE, JOURNAL_DIRECTORY, TRUE);
+  if (G_LIKELY (directory != NULL))
+    {
+      journal->path = g_build_filename (directory, "transfer-XXXXXX", NULL);
+      fd = g_mkstemp (journal->path);
+      g_free (directory);
+    }
+
+  if (G_LIKELY (fd >= 0))
+    journal->stream = fdopen (fd, "a");
+
+  if (G_UNLIKELY (journal->stream == NULL))
+    {
+      g_warning ("Failed to create transfer journal: %s", g_strerror (errno));
+
+      if (fd >= 0)
+        {
+          close (fd);
+          g_unlink (journal->path);
+        }
+
+      g_free (journal->path);
+      journal->path = NULL;
+
+      return journal;
+    }
+
+  thunar_transfer_journal_write (journal, "version %d\npid %d\n",
+                                 JOURNAL_VERSION, (gint) getpid ());
+
+  for (sp = source_file_list, tp = target_file_list;
+       sp != NULL && tp != NULL;
+       sp = sp->next, tp = tp->next)
+    {
+      source_uri = g_file_get_uri (sp->data);
+      target_uri = g_file_get_uri (tp->data);
+      thunar_transfer_journal_write (journal, "copy %s %s\n", source_uri, target_uri);
+      g_free (source_uri);
+      g_free (target_uri);
+    }
+
+  return journal;
+}
+
+
+
+/**
+ * thunar_transfer_journal_load:
+ * @path  : the path to a journal file.
+ * @error : return location for errors or %NULL.
+ *
+ * Loads the journal at @path, usually returned from
+ * thunar_transfer_journal_find_interrupted(), and takes over
+ * ownership of the file for the current process, so the resumed
+ * job keeps appending to it.
+ *
+ * Return value: the #ThunarTransferJournal or %NULL on error.
+ **/
+ThunarTransferJournal *
+thunar_transfer_journal_load (const gchar *path,
+                              GError     **error)
+{
+  ThunarTransferJournal *journal;
+  GFile                 *file;
+  gchar                **lines;
+  gchar                **fields;
+  gchar                 *contents;
+  guint                  n;
+
+  _thunar_return_val_if_fail (path != NULL, NULL);
+  _thunar_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+  if (!g_file_get_contents (path, &contents, NULL, error))
+    return NULL;
+
+  journal = thunar_transfer_journal_alloc ();
+  journal->path = g_strdup (path);
+
+  lines = g_strsplit (contents, "\n", -1);
+  g_free (contents);
+
+  for (n = 0; lines[n] != NULL; ++n)
+    {
+      fields = g_strsplit (lines[n], " ", 4);
+
+      if (g_strv_length (fields) == 3 && strcmp (fields[0], "copy") == 0)
+        {
+          file = g_file_new_for_uri (fields[1]);
+          journal->source_file_list = g_list_prepend (journal->source_file_list, file);
+          file = g_file_new_for_uri (fields[2]);
+          journal->target_file_list = g_list_prepend (journal->target_file_list, file);
+        }
+      else if (g_strv_length (fields) == 2 && strcmp (fields[0], "done") == 0)
+        {
+          thunar_transfer_journal_set_entry (journal, fields[1],
+                                             THUNAR_TRANSFER_JOURNAL_DONE, 0, 0);
+        }
+      else if (g_strv_length (fields) == 4 && strcmp (fields[0], "partial") == 0)
+        {
+          thunar_transfer_journal_set_entry (journal, fields[1],
+                                             THUNAR_TRANSFER_JOURNAL_PARTIAL,
+                                             g_ascii_strtoull (fields[2], NULL, 10),
+                                             g_ascii_strtoull (fields[3], NULL, 10));
+        }
+
+      g_strfreev (fields);
+    }
+
+  g_strfreev (lines);
+
+  journal->source_file_list = g_list_reverse (journal->source_file_list);
+  journal->target_file_list = g_list_reverse (journal->target_file_list);
+
+  if (G_UNLIKELY (journal->source_file_list == NULL))
+    {
+      g_set_error (error, G_FILE_ERROR, G_FILE_ERROR_INVAL,
+                   _("The transfer journal \"%s\" is invalid"), path);
+      thunar_transfer_journal_free (journal);
+      return NULL;
+    }
+
+  /* take over the journal */
+  journal->stream = g_fopen (path, "a");
+  thunar_transfer_journal_write (journal, "pid %d\n", (gint) getpid ());
+
+  return journal;
+}
+
+
+
+/**
+ * thunar_transfer_journal_free:
+ * @journal : a #ThunarTransferJournal.
+ *
+ * Releases the memory of @journal. The journal file itself is
+ * kept, use thunar_transfer_journal_remove() to delete it.
+ **/
+void
+thunar_transfer_journal_free (ThunarTransferJournal *journal)
+{
+  if (journal == NULL)
+    return;
+
+  if (journal->stream != NULL)
+    fclose (journal->stream);
+
+  thunar_g_file_list_free (journal->source_file_list);
+  thunar_g_file_list_free (journal->target_file_list);
+  g_hash_table_destroy (journal->entries);
+  g_free (journal->path);
+
+  g_slice_free (ThunarTransferJournal, journal);
+}
+
+
+
+/**
+ * thunar_transfer_journal_remove:
+ * @journal : a #ThunarTransferJournal.
+ *
+ * Deletes the journal file of @journal. This is done once the
+ * job finished, or the user decided not to resume it.
+ **/
+void
+thunar_transfer_journal_remove (ThunarTransferJournal *journal)
+{
+  _thunar_return_if_fail (journal != NULL);
+
+  if (journal->stream != NULL)
+    {
+      fclose (journal->stream);
+      journal->stream = NULL;
+    }
+
+  if (journal->path != NULL)
+    g_unlink (journal->path);
+}
+
+
+
+/**
+ * thunar_transfer_journal_get_source_files:
+ * @journal : a #ThunarTransferJournal.
+ *
+ * Return value: the toplevel source #GFile<!---->s of the job. The
+ *               list is owned by @journal.
+ **/
+GList *
+thunar_transfer_journal_get_source_files (const ThunarTransferJournal *journal)
+{
+  _thunar_return_val_if_fail (journal != NULL, NULL);
+  return journal->source_file_list;
+}
+
+
+
+/**
+ * thunar_transfer_journal_get_target_files:
+ * @journal : a #ThunarTransferJournal.
+ *
+ * Return value: the toplevel target #GFile<!---->s of the job. The
+ *               list is owned by @journal.
+ **/
+GList *
+thunar_transfer_journal_get_target_files (const ThunarTransferJournal *journal)
+{
+  _thunar_return_val_if_fail (journal != NULL, NULL);
+  return journal->target_file_list;
+}
+
+
+
+/**
+ * thunar_transfer_journal_mark_done:
+ * @journal     : a #ThunarTransferJournal.
+ * @target_file : the #GFile that was copied completely.
+ *
+ * Records that the copy to @target_file finished.
+ **/
+void
+thunar_transfer_journal_mark_done (ThunarTransferJournal *journal,
+                                   GFile                 *target_file)
+{
+  gchar *uri;
+
+  _thunar_return_if_fail (journal != NULL);
+  _thunar_return_if_fail (G_IS_FILE (target_file));
+
+  uri = g_file_get_uri (target_file);
+  thunar_transfer_journal_write (journal, "done %s\n", uri);
+  g_free (uri);
+}
+
+
+
+/**
+ * thunar_transfer_journal_mark_partial:
+ * @journal      : a #ThunarTransferJournal.
+ * @target_file  : the #GFile that is being copied.
+ * @offset       : number of bytes written to @target_file so far.
+ * @source_mtime : modification time of the source file, used to detect
+ *                 changes of the source before resuming.
+ *
+ * Records the progress of the copy to @target_file.
+ **/
+void
+thunar_transfer_journal_mark_partial (ThunarTransferJournal *journal,
+                                      GFile                 *target_file,
+                                      guint64                offset,
+                                      guint64                source_mtime)
+{
+  gchar *uri;
+
+  _thunar_return_if_fail (journal != NULL);
+  _thunar_return_if_fail (G_IS_FILE (target_file));
+
+  uri = g_file_get_uri (target_file);
+  thunar_transfer_journal_write (journal, "partial %s %" G_GUINT64_FORMAT " %" G_GUINT64_FORMAT "\n",
+                                 uri, offset, source_mtime);
+  g_free (uri);
+}
+
+
+
+/**
+ * thunar_transfer_journal_lookup:
+ * @journal             : a #ThunarTransferJournal.
+ * @target_file         : a target #GFile of the job.
+ * @offset_return       : return location for the partial offset or %NULL.
+ * @source_mtime_return : return location for the source mtime of a
+ *                        partial copy or %NULL.
+ *
+ * Looks up the state of @target_file as recorded by the interrupted
+ * job the journal was loaded from.
+ *
+ * Return value: the #ThunarTransferJournalState of @target_file.
+ **/
+ThunarTransferJournalState
+thunar_transfer_journal_lookup (ThunarTransferJournal *journal,
+                                GFile                 *target_file,
+                                guint64               *offset_return,
+                                guint64               *source_mtime_return)
+{
+  ThunarTransferJournalEntry *entry;
+  gchar                      *uri;
+
+  _thunar_return_val_if_fail (journal != NULL, THUNAR_TRANSFER_JOURNAL_NONE);
+  _thunar_return_val_if_fail (G_IS_FILE (target_file), THUNAR_TRANSFER_JOURNAL_NONE);
+
+  /* nothing to look up in a journal we wrote ourselves */
+  if (g_hash_table_size (journal->entries) == 0)
+    return THUNAR_TRANSFER_JOURNAL_NONE;
+
+  uri = g_file_get_uri (target_file);
+  entry = g_hash_table_lookup (journal->entries, uri);
+  g_free (uri);
+
+  if (entry == NULL)
+    return THUNAR_TRANSFER_JOURNAL_NONE;
+
+  if (offset_return != NULL)
+    *offset_return = entry->offset;
+  if (source_mtime_return != NULL)
+    *source_mtime_return = entry->source_mtime;
+
+  return entry->state;
+}
+
+
+
+static gboolean
+thunar_transfer_journal_is_orphaned (const gchar *path)
+{
+  gboolean orphaned = FALSE;
+  gchar  **lines;
+  gchar   *contents;
+  gint     pid = 0;
+  guint    n;
+
+  if (!g_file_get_contents (path, &contents, NULL, NULL))
+    return FALSE;
+
+  /* the last pid line names the current owner */
+  lines = g_strsplit (contents, "\n", -1);
+  for (n = 0; lines[n] != NULL; ++n)
+    if (strncmp (lines[n], "pid ", 4) == 0)
+      pid = atoi (lines[n] + 4);
+  g_strfreev (lines);
+  g_free (contents);
+
+  if (pid == getpid ())
+    {
+      /* a stale journal of an earlier process with our pid */
+      orphaned = TRUE;
+    }
+  else if (pid > 0)
+    {
+      /* check if the owner is still running */
+      orphaned = (kill (pid, 0) < 0 && errno == ESRCH);
+    }
+
+  return orphaned;
+}
+
+
+
+/**
+ * thunar_transfer_journal_find_interrupted:
+ *
+ * Looks for journals of transfer jobs that were interrupted because
+ * the process running them terminated unexpectedly. This should only
+ * be called on startup, before any job was launched.
+ *
+ * Return value: a %NULL-terminated array of journal paths, to be
+ *               released with g_strfreev(), or %NULL if there are
+ *               no interrupted jobs.
+ **/
+gchar **
+thunar_transfer_journal_find_interrupted (void)
+{
+  const gchar *name;
+  GPtrArray   *paths;
+  gchar       *directory;
+  gchar       *path;
+  GDir        *dir;
+
+  directory = xfce_resource_save_location (XFCE_RESOURCE_CACHE, JOURNAL_DIRECTORY, FALSE);
+  if (G_UNLIKELY (directory == NULL))
+    return NULL;
+
+  dir = g_dir_open (directory, 0, NULL);
+  if (dir == NULL)
+    {
+      g_free (directory);
+      return NULL;
+    }
+
+  paths = g_ptr_array_new ();
+
+  while ((name = g_dir_read_name (dir)) != NULL)
+    {
+      if (!g_str_has_prefix (name, "transfer-"))
+        continue;
+
+      path = g_build_filename (directory, name, NULL);
+      if (thunar_transfer_journal_is_orphaned (path))
+        g_ptr_array_add (paths, path);
+      else
+        g_free (path);
+    }
+
+  g_dir_close (dir);
+  g_free (directory);
+
+  if (paths->len == 0)
+    {
+      g_ptr_array_free (paths, TRUE);
+      return NULL;
+    }
+
+  g_ptr_array_add (paths, NULL);
+  return (gchar **) g_ptr_array_free (paths, FALSE);
+}
@@ -0,0 +1,70 @@
+/* vi:set et ai sw=2 sts=2 ts=2: */
+/*-
+ * Copyright (c) 2015 Xfce Development Team <xfce4-dev@xfce.org>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the Free
+ * Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __THUNAR_TRANSFER_JOURNAL_H__
+#define __THUNAR_TRANSFER_JOURNAL_H__
+
+#include <gio/gio.h>
+
+G_BEGIN_DECLS
+
+/**
+ * ThunarTransferJournalState:
+ * @THUNAR_TRANSFER_JOURNAL_NONE    : nothing is known about the file.
+ * @THUNAR_TRANSFER_JOURNAL_PARTIAL : the file was partially copied.
+ * @THUNAR_TRANSFER_JOURNAL_DONE    : the file was copied completely.
+ *
+ * State of a target file as recorded in a #ThunarTransferJournal.
+ **/
+typedef enum
+{
+  THUNAR_TRANSFER_JOURNAL_NONE,
+  THUNAR_TRANSFER_JOURNAL_PARTIAL,
+  THUNAR_TRANSFER_JOURNAL_DONE,
+} ThunarTransferJournalState;
+
+typedef struct _ThunarTransferJournal ThunarTransferJournal;
+
+ThunarTransferJournal     *thunar_transfer_journal_new              (GList                  *source_file_list,
+                                                                     GList                  *target_file_list) G_GNUC_MALLOC;
+ThunarTransferJournal     *thunar_transfer_journal_load             (const gchar            *path,
+                                                                     GError                **error) G_GNUC_MALLOC;
+void                       thunar_transfer_journal_free             (ThunarTransferJournal  *journal);
+void                       thunar_transfer_journal_remove           (ThunarTransferJournal  *journal);
+
+GList                     *thunar_transfer_journal_get_source_files (const ThunarTransferJournal *journal);
+GList                     *thunar_transfer_journal_get_target_files (const ThunarTransferJournal *journal);
+
+void                       thunar_transfer_journal_mark_done        (ThunarTransferJournal  *journal,
+                                                                     GFile                  *target_file);
+void                       thunar_transfer_journal_mark_partial     (ThunarTransferJournal  *journal,
+                                                                     GFile                  *target_file,
+                                                                     guint64                 offset,
+                                                                     guint64                 source_mtime);
+ThunarTransferJournalState thunar_transfer_journal_lookup           (ThunarTransferJournal  *journal,
+                                                                     GFile                  *target_file,
+                                                                     guint64                *offset_return,
+                                                                     guint64                *source_mtime_return);
+
+gchar                    **thunar_transfer_journal_find_interrupted (void) G_GNUC_MALLOC;
+
+G_END_DECLS
+
+#endif /* !__THUNAR_TRANSFER_JOURNAL_H__ */
@@ -49,6 +49,14 @@
 
 
 
+/* maximum number of folders prefetched per current directory */
+#define PREFETCH_BUDGET (16)
+
+/* number of recently expanded folders remembered for prefetching */
+#define PREFETCH_N_RECENT (8)
+
+
+
 /* Property identifiers */
 enum
 {
@@ -135,6 +143,9 @@ static ThunarTreeModelItem *thunar_tree_model_item_new_with_device    (ThunarTre
 static void                 thunar_tree_model_item_free               (ThunarTreeModelItem    *item);
 static void                 thunar_tree_model_item_reset              (ThunarTreeModelItem    *item);
 static void                 thunar_tree_model_item_load_folder        (ThunarTreeModelItem    *item);
+static void                 thunar_tree_model_item_remember_expanded  (ThunarTreeModelItem    *item);
+static void                 thunar_tree_model_item_add_invisible      (ThunarTreeModelItem    *item,
+                                                                       ThunarFile             *file);
 static void                 thunar_tree_model_item_files_added        (ThunarTreeModelItem    *item,
                                                                        GList                  *files,
                                                                        ThunarFolder           *folder);
@@ -146,6 +157,22 @@ static void                 thunar_tree_model_item_load_idle_destroy  (gpointer
 static void                 thunar_tree_model_item_notify_loading     (ThunarTreeModelItem    *item,
                                                                        GParamSpec             *pspec,
                                                                        ThunarFolder           *folder);
+static GNode               *thunar_tree_model_node_append             (ThunarTreeModel        *model,
+                                                                       GNode                  *parent,
+                                                                       ThunarTreeModelItem    *item);
+static void                 thunar_tree_model_node_destroy            (ThunarTreeModel        *model,
+                                                                       GNode                  *node);
+static guint                thunar_tree_model_node_children_changed   (ThunarTreeModel        *model,
+                                                                       GNode                  *node);
+static gint                 thunar_tree_model_node_get_index          (ThunarTreeModel        *model,
+                                                                       GNode                  *node);
+static void                 thunar_tree_model_node_track_hidden       (ThunarTreeModel        *model,
+                                                                       GNode                  *node);
+static void                 thunar_tree_model_node_hide_children      (ThunarTreeModel        *model,
+                                                                       GNode                  *node,
+                                                                       GSList                 *children);
+static void                 thunar_tree_model_node_show_children      (ThunarTreeModel        *model,
+                                                                       GNode                  *node);
 static void                 thunar_tree_model_node_insert_dummy       (GNode                  *parent,
                                                                        ThunarTreeModel        *model);
 static void                 thunar_tree_model_node_drop_dummy         (GNode                  *node,
@@ -160,8 +187,10 @@ static gboolean             thunar_tree_model_node_traverse_sort      (GNode
                                                                        gpointer                user_data);
 static gboolean             thunar_tree_model_node_traverse_free      (GNode                  *node,
                                                                        gpointer                user_data);
-static gboolean             thunar_tree_model_node_traverse_visible   (GNode                  *node,
-                                                                       gpointer                user_data);
+static void                 thunar_tree_model_node_prefetch           (ThunarTreeModel        *model,
+                                                                       GNode                  *node);
+static gboolean             thunar_tree_model_prefetch_idle           (gpointer                user_data);
+static void                 thunar_tree_model_prefetch_idle_destroy   (gpointer                user_data);
 static gboolean             thunar_tree_model_get_case_sensitive      (ThunarTreeModel        *model);
 static void                 thunar_tree_model_set_case_sensitive      (ThunarTreeModel        *model,
                                                                        gboolean                case_sensitive);
@@ -197,7 +226,25 @@ struct _ThunarTreeModel
 
   GNode                      *root;
 
+  /* bumped whenever the order of the root's children changes */
+  guint                       root_children_stamp;
+
+  /* nodes whose visibility can change when refiltering: visible
+   * nodes of hidden files and nodes with invisible children */
+  GHashTable                 *hidden_nodes;
+  GHashTable                 *filtered_nodes;
+
   guint                       cleanup_idle_id;
+
+  /* background loading of the folders the user is likely to
+   * expand next, see thunar_tree_model_prefetch() */
+  GList                      *prefetch_queue;
+  guint                       prefetch_idle_id;
+  guint                       prefetch_budget;
+  guint                       prefetch_serial;
+
+  /* recently expanded items, most recent first */
+  GList                      *recent_items;
 };
 
 struct _ThunarTreeModelItem
@@ -209,9 +256,22 @@ struct _ThunarTreeModelItem
   ThunarDevice    *device;
   ThunarTreeModel *model;
 
-  /* list of children of this node that are
+  /* the node of this item in the tree */
+  GNode           *node;
+
+  /* cached position of the node among its siblings, valid
+   * while index_stamp matches the parent's children_stamp */
+  gint             index;
+  guint            index_stamp;
+  guint            children_stamp;
+
+  /* the prefetch run this item was last considered in, the
+   * cleanup keeps folders of the latest run loaded */
+  guint            prefetch_serial;
+
+  /* set of children of this node that are
    * not visible in the treeview */
-  GSList          *invisible_children;
+  GHashTable      *invisible_children;
 };
 
 typedef struct
@@ -297,6 +357,8 @@ thunar_tree_model_init (ThunarTreeModel *model)
   model->visible_func = (ThunarTreeModelVisibleFunc) exo_noop_true;
   model->visible_data = NULL;
   model->cleanup_idle_id = 0;
+  model->hidden_nodes = g_hash_table_new (NULL, NULL);
+  model->filtered_nodes = g_hash_table_new (NULL, NULL);
 
   /* connect to the file monitor */
   model->file_monitor = thunar_file_monitor_get_default ();
@@ -347,11 +409,11 @@ thunar_tree_model_init (ThunarTreeModel *model)
 
           /* create and append the new node */
           item = thunar_tree_model_item_new_with_file (model, file);
-          node = g_node_append_data (model->root, item);
+          node = thunar_tree_model_node_append (model, model->root, item);
           g_object_unref (G_OBJECT (file));
 
           /* add the dummy node */
-          g_node_append_data (node, NULL);
+          thunar_tree_model_node_append (model, node, NULL);
         }
 
       /* release the system defined path */
@@ -382,6 +444,14 @@ thunar_tree_model_finalize (GObject *object)
   if (model->cleanup_idle_id != 0)
     g_source_remove (model->cleanup_idle_id);
 
+  /* stop prefetching */
+  if (model->prefetch_idle_id != 0)
+    g_source_remove (model->prefetch_idle_id);
+  g_list_free (model->prefetch_queue);
+  model->prefetch_queue = NULL;
+  g_list_free (model->recent_items);
+  model->recent_items = NULL;
+
   /* disconnect from the file monitor */
   g_signal_handlers_disconnect_by_func (model->file_monitor, thunar_tree_model_file_changed, model);
   g_object_unref (model->file_monitor);
@@ -390,6 +460,10 @@ thunar_tree_model_finalize (GObject *object)
   g_node_traverse (model->root, G_POST_ORDER, G_TRAVERSE_ALL, -1, thunar_tree_model_node_traverse_free, NULL);
   g_node_destroy (model->root);
 
+  /* release the refilter candidates */
+  g_hash_table_destroy (model->hidden_nodes);
+  g_hash_table_destroy (model->filtered_nodes);
+
   /* disconnect from the volume monitor */
   g_signal_handlers_disconnect_matched (model->device_monitor, G_SIGNAL_MATCH_DATA, 0, 0, NULL, NULL, model);
   g_object_unref (model->device_monitor);
@@ -527,57 +601,25 @@ thunar_tree_model_get_path (GtkTreeModel *tree_model,
 {
   ThunarTreeModel *model = THUNAR_TREE_MODEL (tree_model);
   GtkTreePath     *path;
-  GtkTreeIter      tmp_iter;
-  GNode           *tmp_node;
   GNode           *node;
-  gint             n;
 
   _thunar_return_val_if_fail (iter->user_data != NULL, NULL);
   _thunar_return_val_if_fail (iter->stamp == model->stamp, NULL);
 
-  /* determine the node for the iterator */
-  node = iter->user_data;
+  path = gtk_tree_path_new ();
 
-  /* check if the iter refers to the "virtual root node" */
-  if (node->parent == NULL && node == model->root)
-    return gtk_tree_path_new ();
-  else if (G_UNLIKELY (node->parent == NULL))
-    return NULL;
-
-  if (node->parent == model->root)
-    {
-      path = gtk_tree_path_new ();
-      tmp_node = g_node_first_child (model->root);
-    }
-  else
-    {
-      /* determine the iterator for the parent node */
-      GTK_TREE_ITER_INIT (tmp_iter, model->stamp, node->parent);
-
-      /* determine the path for the parent node */
-      path = gtk_tree_model_get_path (tree_model, &tmp_iter);
-
-      /* and the node for the parent's children */
-      tmp_node = g_node_first_child (node->parent);
-    }
-
-  /* check if we have a valid path */
-  if (G_LIKELY (path != NULL))
+  /* walk up to the "virtual root node", using the cached
+   * child indices instead of searching the sibling lists */
+  for (node = iter->user_data; node != model->root; node = node->parent)
     {
-      /* lookup our index in the child list */
-      for (n = 0; tmp_node != NULL; ++n, tmp_node = tmp_node->next)
-        if (tmp_node == node)
-          break;
-
-      /* check if we have found the node */
-      if (G_UNLIKELY (tmp_node == NULL))
+      /* check if the node was removed from the tree */
+      if (G_UNLIKELY (node->parent == NULL))
         {
           gtk_tree_path_free (path);
           return NULL;
         }
 
-      /* append the index to the parent path */
-      gtk_tree_path_append_index (path, n);
+      gtk_tree_path_prepend_index (path, thunar_tree_model_node_get_index (model, node));
     }
 
   return path;
@@ -786,6 +828,9 @@ thunar_tree_model_ref_node (GtkTreeModel *tree_model,
     {
       /* tell the parent to load the folder */
       thunar_tree_model_item_load_folder (node->parent->data);
+
+      /* the folder was expanded, remember it for prefetching */
+      thunar_tree_model_item_remember_expanded (node->parent->data);
     }
   else
     {
@@ -847,13 +892,15 @@ static void
 thunar_tree_model_sort (ThunarTreeModel *model,
                         GNode           *node)
 {
-  GtkTreePath *path;
-  GtkTreeIter  iter;
-  SortTuple   *sort_array;
-  GNode       *child_node;
-  guint        n_children;
-  gint        *new_order;
-  guint        n;
+  ThunarTreeModelItem *item;
+  GtkTreePath         *path;
+  GtkTreeIter          iter;
+  SortTuple           *sort_array;
+  GNode               *child_node;
+  guint                n_children;
+  gint                *new_order;
+  guint                stamp;
+  guint                n;
 
   _thunar_return_if_fail (THUNAR_IS_TREE_MODEL (model));
 
@@ -884,6 +931,9 @@ thunar_tree_model_sort (ThunarTreeModel *model,
   /* start out with an empty child list */
   node->children = NULL;
 
+  /* the cached child indices are outdated now */
+  stamp = thunar_tree_model_node_children_changed (model, node);
+
   /* update our internals and generate the new order */
   new_order = g_newa (gint, n_children);
   for (n = 0; n < n_children; ++n)
@@ -896,6 +946,11 @@ thunar_tree_model_sort (ThunarTreeModel *model,
       sort_array[n].node->prev = NULL;
       sort_array[n].node->parent = NULL;
       g_node_append (node, sort_array[n].node);
+
+      /* remember the new position of the child */
+      item = sort_array[n].node->data;
+      item->index = n;
+      item->index_stamp = stamp;
     }
 
   /* determine the iterator for the parent node */
@@ -1080,6 +1135,10 @@ thunar_tree_model_device_added (ThunarDeviceMonitor *device_monitor,
   /* insert before the last child of the root (the "File System" node) */
   node = g_node_last_child (model->root);
   node = g_node_insert_data_before (model->root, node, item);
+  item->node = node;
+
+  /* the "File System" node moved down */
+  thunar_tree_model_node_children_changed (model, model->root);
 
   /* determine the iterator for the new node */
   GTK_TREE_ITER_INIT (iter, model->stamp, node);
@@ -1131,6 +1190,7 @@ thunar_tree_model_item_new_with_file (ThunarTreeModel *model,
   item = g_slice_new0 (ThunarTreeModelItem);
   item->file = g_object_ref (G_OBJECT (file));
   item->model = model;
+  item->index = -1;
 
   return item;
 }
@@ -1147,6 +1207,7 @@ thunar_tree_model_item_new_with_device (ThunarTreeModel *model,
   item = g_slice_new0 (ThunarTreeModelItem);
   item->device = g_object_ref (G_OBJECT (device));
   item->model = model;
+  item->index = -1;
 
   /* check if the volume is mounted */
   if (thunar_device_is_mounted (device))
@@ -1168,6 +1229,13 @@ thunar_tree_model_item_new_with_device (ThunarTreeModel *model,
 static void
 thunar_tree_model_item_free (ThunarTreeModelItem *item)
 {
+  /* drop the item from the prefetch queue */
+  if (G_UNLIKELY (item->model->prefetch_queue != NULL))
+    item->model->prefetch_queue = g_list_remove (item->model->prefetch_queue, item);
+
+  /* forget the item if it was expanded recently */
+  item->model->recent_items = g_list_remove (item->model->recent_items, item);
+
   /* disconnect from the volume */
   if (G_UNLIKELY (item->device != NULL))
     g_object_unref (item->device);
@@ -1199,7 +1267,8 @@ thunar_tree_model_item_reset (ThunarTreeModelItem *item)
   /* free all the invisible children */
   if (item->invisible_children != NULL)
     {
-      g_slist_free_full (item->invisible_children, g_object_unref);
+      g_hash_table_remove (item->model->filtered_nodes, item->node);
+      g_hash_table_destroy (item->invisible_children);
       item->invisible_children = NULL;
     }
 
@@ -1233,6 +1302,53 @@ thunar_tree_model_item_load_folder (ThunarTreeModelItem *item)
 
 
 
+static void
+thunar_tree_model_item_remember_expanded (ThunarTreeModelItem *item)
+{
+  ThunarTreeModel *model = item->model;
+  GList           *lp;
+
+  /* check if the folder is already the most recent one */
+  if (model->recent_items != NULL && model->recent_items->data == item)
+    return;
+
+  lp = g_list_find (model->recent_items, item);
+  if (lp != NULL)
+    {
+      /* move the folder to the front of the list */
+      model->recent_items = g_list_delete_link (model->recent_items, lp);
+      model->recent_items = g_list_prepend (model->recent_items, item);
+    }
+  else
+    {
+      model->recent_items = g_list_prepend (model->recent_items, item);
+
+      /* forget the oldest folder */
+      if (g_list_length (model->recent_items) > PREFETCH_N_RECENT)
+        model->recent_items = g_list_delete_link (model->recent_items, g_list_last (model->recent_items));
+    }
+}
+
+
+
+static void
+thunar_tree_model_item_add_invisible (ThunarTreeModelItem *item,
+                                      ThunarFile          *file)
+{
+  if (item->invisible_children == NULL)
+    {
+      /* allocate the set, it owns a reference on each file */
+      item->invisible_children = g_hash_table_new_full (g_direct_hash, g_direct_equal, g_object_unref, NULL);
+
+      /* the node needs to be checked when refiltering */
+      g_hash_table_insert (item->model->filtered_nodes, item->node, item->node);
+    }
+
+  g_hash_table_insert (item->invisible_children, g_object_ref (G_OBJECT (file)), file);
+}
+
+
+
 static void
 thunar_tree_model_item_files_added (ThunarTreeModelItem *item,
                                     GList               *files,
@@ -1262,15 +1378,13 @@ thunar_tree_model_item_files_added (ThunarTreeModelItem *item,
       /* if this file should be visible */
       if (!model->visible_func (model, file, model->visible_data))
         {
-          /* file is invisible, insert it in the invisible list and continue */
-          item->invisible_children = g_slist_prepend (item->invisible_children,
-                                                      g_object_ref (G_OBJECT (file)));
+          /* file is invisible, insert it in the invisible set and continue */
+          thunar_tree_model_item_add_invisible (item, file);
           continue;
         }
 
-      /* lookup the node for the item (on-demand) */
-      if (G_UNLIKELY (node == NULL))
-        node = g_node_find (model->root, G_POST_ORDER, G_TRAVERSE_ALL, item);
+      /* the node of the item, remembered to sort it later */
+      node = item->node;
       _thunar_return_if_fail (node != NULL);
 
       /* allocate a new item for the file */
@@ -1282,6 +1396,8 @@ thunar_tree_model_item_files_added (ThunarTreeModelItem *item,
           /* replace the dummy node with the new node */
           child_node = g_node_first_child (node);
           child_node->data = child_item;
+          child_item->node = child_node;
+          thunar_tree_model_node_track_hidden (model, child_node);
 
           /* determine the tree iter for the child */
           GTK_TREE_ITER_INIT (child_iter, model->stamp, child_node);
@@ -1294,7 +1410,7 @@ thunar_tree_model_item_files_added (ThunarTreeModelItem *item,
       else
         {
           /* insert a new item for the child */
-          child_node = g_node_append_data (node, child_item);
+          child_node = thunar_tree_model_node_append (model, node, child_item);
 
           /* determine the tree iter for the child */
           GTK_TREE_ITER_INIT (child_iter, model->stamp, child_node);
@@ -1327,13 +1443,12 @@ thunar_tree_model_item_files_removed (ThunarTreeModelItem *item,
   GNode           *child_node;
   GNode           *node;
   GList           *lp;
-  GSList          *inv_link;
 
   _thunar_return_if_fail (THUNAR_IS_FOLDER (folder));
   _thunar_return_if_fail (item->folder == folder);
 
   /* determine the node for the folder */
-  node = g_node_find (model->root, G_POST_ORDER, G_TRAVERSE_ALL, item);
+  node = item->node;
   _thunar_return_if_fail (node != NULL);
 
   /* check if the node has any visible children */
@@ -1368,18 +1483,16 @@ thunar_tree_model_item_files_removed (ThunarTreeModelItem *item,
   /* we also need to release all the invisible folders */
   if (item->invisible_children != NULL)
     {
+      /* drop the files from the set, this releases them */
       for (lp = files; lp != NULL; lp = lp->next)
-        {
-          /* find the file in the hidden list */
-          inv_link = g_slist_find (item->invisible_children, lp->data);
-          if (inv_link != NULL)
-            {
-              /* release the file */
-              g_object_unref (G_OBJECT (lp->data));
+        g_hash_table_remove (item->invisible_children, lp->data);
 
-              /* remove from the list */
-              item->invisible_children = g_slist_delete_link (item->invisible_children, inv_link);
-            }
+      /* nothing left to refilter for this node */
+      if (g_hash_table_size (item->invisible_children) == 0)
+        {
+          g_hash_table_remove (model->filtered_nodes, node);
+          g_hash_table_destroy (item->invisible_children);
+          item->invisible_children = NULL;
         }
     }
 }
@@ -1401,7 +1514,7 @@ thunar_tree_model_item_notify_loading (ThunarTreeModelItem *item,
   if (G_LIKELY (!thunar_folder_get_loading (folder)))
     {
       /* lookup the node for the item... */
-      node = g_node_find (item->model->root, G_POST_ORDER, G_TRAVERSE_ALL, item);
+      node = item->node;
       _thunar_return_if_fail (node != NULL);
 
       /* ...and drop the dummy for the node */
@@ -1426,7 +1539,7 @@ thunar_tree_model_item_load_idle (gpointer user_data)
 
 #ifndef NDEBUG
       /* find the node in the tree */
-      node = g_node_find (item->model->root, G_POST_ORDER, G_TRAVERSE_ALL, item);
+      node = item->node;
 
       /* debug check to make sure the node is empty or contains a dummy node.
        * if this is not true, the node already contains sub folders which means
@@ -1451,8 +1564,8 @@ thunar_tree_model_item_load_idle (gpointer user_data)
   /* verify that we have a file */
   if (G_LIKELY (item->file != NULL))
     {
-      /* open the folder for the item */
-      item->folder = thunar_folder_get_for_file (item->file);
+      /* open the folder for the item, we only need its subdirectories */
+      item->folder = thunar_folder_get_directories_for_file (item->file);
       if (G_LIKELY (item->folder != NULL))
         {
           /* connect signals */
@@ -1486,6 +1599,246 @@ thunar_tree_model_item_load_idle_destroy (gpointer user_data)
 
 
 
+static guint *
+thunar_tree_model_node_get_children_stamp (ThunarTreeModel *model,
+                                           GNode           *node)
+{
+  /* dummy nodes never have children */
+  if (node == model->root)
+    return &model->root_children_stamp;
+  else
+    return &THUNAR_TREE_MODEL_ITEM (node->data)->children_stamp;
+}
+
+
+
+static guint
+thunar_tree_model_node_children_changed (ThunarTreeModel *model,
+                                         GNode           *node)
+{
+  guint *stamp;
+
+  /* invalidate the cached indices of all children */
+  stamp = thunar_tree_model_node_get_children_stamp (model, node);
+  return ++(*stamp);
+}
+
+
+
+static GNode *
+thunar_tree_model_node_append (ThunarTreeModel     *model,
+                               GNode               *parent,
+                               ThunarTreeModelItem *item)
+{
+  ThunarTreeModelItem *prev_item;
+  GNode               *node;
+  guint                stamp;
+
+  node = g_node_append_data (parent, item);
+
+  if (G_LIKELY (item != NULL))
+    {
+      item->node = node;
+      thunar_tree_model_node_track_hidden (model, node);
+
+      /* appending does not move any siblings, so the index of the new
+       * node follows from its predecessor if that one is known */
+      stamp = *thunar_tree_model_node_get_children_stamp (model, parent);
+      if (node->prev == NULL)
+        {
+          item->index = 0;
+          item->index_stamp = stamp;
+        }
+      else if (node->prev->data != NULL)
+        {
+          prev_item = node->prev->data;
+          if (prev_item->index >= 0 && prev_item->index_stamp == stamp)
+            {
+              item->index = prev_item->index + 1;
+              item->index_stamp = stamp;
+            }
+        }
+    }
+
+  return node;
+}
+
+
+
+static void
+thunar_tree_model_node_destroy (ThunarTreeModel *model,
+                                GNode           *node)
+{
+  GNode    *parent = node->parent;
+  gboolean  last = (node->next == NULL);
+
+  /* forget the node in the refilter candidates */
+  g_hash_table_remove (model->hidden_nodes, node);
+  g_hash_table_remove (model->filtered_nodes, node);
+
+  g_node_destroy (node);
+
+  /* removing anything but the last child moves its siblings */
+  if (!last && parent != NULL)
+    thunar_tree_model_node_children_changed (model, parent);
+}
+
+
+
+static gint
+thunar_tree_model_node_get_index (ThunarTreeModel *model,
+                                  GNode           *node)
+{
+  ThunarTreeModelItem *item = node->data;
+  GNode               *child;
+  guint                stamp;
+  gint                 n;
+
+  /* the dummy node is always the only child */
+  if (G_UNLIKELY (item == NULL))
+    return g_node_child_position (node->parent, node);
+
+  stamp = *thunar_tree_model_node_get_children_stamp (model, node->parent);
+  if (item->index < 0 || item->index_stamp != stamp)
+    {
+      /* refresh the indices of all siblings in one go */
+      for (child = node->parent->children, n = 0; child != NULL; child = child->next, ++n)
+        if (G_LIKELY (child->data != NULL))
+          {
+            THUNAR_TREE_MODEL_ITEM (child->data)->index = n;
+            THUNAR_TREE_MODEL_ITEM (child->data)->index_stamp = stamp;
+          }
+    }
+
+  return item->index;
+}
+
+
+
+static void
+thunar_tree_model_node_track_hidden (ThunarTreeModel *model,
+                                     GNode           *node)
+{
+  ThunarTreeModelItem *item = node->data;
+
+  /* only hidden files can change their visibility when refiltering */
+  if (item != NULL && item->file != NULL && thunar_file_is_hidden (item->file))
+    g_hash_table_insert (model->hidden_nodes, node, node);
+  else
+    g_hash_table_remove (model->hidden_nodes, node);
+}
+
+
+
+static void
+thunar_tree_model_node_hide_children (ThunarTreeModel *model,
+                                      GNode           *node,
+                                      GSList          *children)
+{
+  ThunarTreeModelItem *parent = node->data;
+  ThunarTreeModelItem *item;
+  GtkTreePath         *path;
+  GtkTreeIter          iter;
+  GNode               *child_node;
+  GSList              *lp;
+
+  /* the children are sorted last to first, so removing
+   * one does not move the ones that are still to go */
+  for (lp = children; lp != NULL; lp = lp->next)
+    {
+      child_node = lp->data;
+      item = child_node->data;
+
+      _thunar_return_if_fail (child_node->parent == node);
+      _thunar_return_if_fail (THUNAR_IS_FILE (item->file));
+
+      /* delete all the children of the node */
+      while (child_node->children)
+        g_node_traverse (child_node->children, G_POST_ORDER, G_TRAVERSE_ALL, -1,
+                         thunar_tree_model_node_traverse_remove, model);
+
+      /* generate an iterator for the item */
+      GTK_TREE_ITER_INIT (iter, model->stamp, child_node);
+
+      /* remove this item from the tree */
+      path = gtk_tree_model_get_path (GTK_TREE_MODEL (model), &iter);
+      gtk_tree_model_row_deleted (GTK_TREE_MODEL (model), path);
+      gtk_tree_path_free (path);
+
+      /* insert the file in the invisible set of the parent */
+      if (G_LIKELY (parent != NULL))
+        thunar_tree_model_item_add_invisible (parent, item->file);
+
+      /* free the item and destroy the node */
+      thunar_tree_model_item_free (item);
+      thunar_tree_model_node_destroy (model, child_node);
+    }
+}
+
+
+
+static void
+thunar_tree_model_node_show_children (ThunarTreeModel *model,
+                                      GNode           *node)
+{
+  ThunarTreeModelItem *item = node->data;
+  ThunarTreeModelItem *child;
+  GHashTableIter       iter;
+  GtkTreePath         *path;
+  GtkTreeIter          child_iter;
+  ThunarFile          *file;
+  GNode               *child_node = NULL;
+  gpointer             key;
+
+  /* nothing to do until the folder has been loaded */
+  if (item == NULL || item->invisible_children == NULL || G_NODE_HAS_DUMMY (node))
+    return;
+
+  /* check which invisible files should be visible now */
+  g_hash_table_iter_init (&iter, item->invisible_children);
+  while (g_hash_table_iter_next (&iter, &key, NULL))
+    {
+      file = THUNAR_FILE (key);
+
+      if (!model->visible_func (model, file, model->visible_data))
+        continue;
+
+      /* allocate a new item for the file */
+      child = thunar_tree_model_item_new_with_file (model, file);
+
+      /* insert a new node for the child */
+      child_node = thunar_tree_model_node_append (model, node, child);
+
+      /* determine the tree iter for the child */
+      GTK_TREE_ITER_INIT (child_iter, model->stamp, child_node);
+
+      /* emit a "row-inserted" for the new node */
+      path = gtk_tree_model_get_path (GTK_TREE_MODEL (model), &child_iter);
+      gtk_tree_model_row_inserted (GTK_TREE_MODEL (model), path, &child_iter);
+      gtk_tree_path_free (path);
+
+      /* drop the file from the invisible set, this releases it */
+      g_hash_table_iter_remove (&iter);
+
+      /* insert dummy */
+      thunar_tree_model_node_insert_dummy (child_node, model);
+    }
+
+  /* check if all the children are visible again */
+  if (g_hash_table_size (item->invisible_children) == 0)
+    {
+      g_hash_table_remove (model->filtered_nodes, node);
+      g_hash_table_destroy (item->invisible_children);
+      item->invisible_children = NULL;
+    }
+
+  /* sort the node once for all the new children */
+  if (child_node != NULL)
+    thunar_tree_model_sort (model, node);
+}
+
+
+
 static void
 thunar_tree_model_node_insert_dummy (GNode           *parent,
                                      ThunarTreeModel *model)
@@ -1498,7 +1851,7 @@ thunar_tree_model_node_insert_dummy (GNode           *parent,
   _thunar_return_if_fail (g_node_n_children (parent) == 0);
 
   /* add the dummy node */
-  node = g_node_append_data (parent, NULL);
+  node = thunar_tree_model_node_append (model, parent, NULL);
 
   /* determine the iterator for the dummy node */
   GTK_TREE_ITER_INIT (iter, model->stamp, node);
@@ -1532,7 +1885,7 @@ thunar_tree_model_node_drop_dummy (GNode           *node,
       gtk_tree_model_row_deleted (GTK_TREE_MODEL (model), path);
 
       /* drop the dummy from the model */
-      g_node_destroy (node->children);
+      thunar_tree_model_node_destroy (model, node->children);
 
       /* determine the iter to the parent node */
       GTK_TREE_ITER_INIT (iter, model->stamp, node);
@@ -1557,7 +1910,10 @@ thunar_tree_model_node_traverse_cleanup (GNode    *node,
   ThunarTreeModelItem *item = node->data;
   ThunarTreeModel     *model = THUNAR_TREE_MODEL (user_data);
 
-  if (item && item->folder != NULL && item->ref_count == 0)
+  /* folders prefetched for the current directory are kept
+   * until the user navigates elsewhere */
+  if (item && item->folder != NULL && item->ref_count == 0
+      && (item->prefetch_serial == 0 || item->prefetch_serial != model->prefetch_serial))
     {
       /* disconnect from the folder */
       g_signal_handlers_disconnect_matched (G_OBJECT (item->folder), G_SIGNAL_MATCH_DATA, 0, 0, NULL, NULL, item);
@@ -1594,6 +1950,9 @@ thunar_tree_model_node_traverse_changed (GNode   *node,
       /* determine the tree model from the item */
       model = THUNAR_TREE_MODEL_ITEM (node->data)->model;
 
+      /* a renamed folder could have become hidden or visible */
+      thunar_tree_model_node_track_hidden (model, node);
+
       /* determine the iterator for the node */
       GTK_TREE_ITER_INIT (iter, model->stamp, node);
 
@@ -1647,7 +2006,7 @@ thunar_tree_model_node_traverse_remove (GNode   *node,
       thunar_tree_model_node_traverse_free (node, user_data);
 
       /* remove the node from the tree */
-      g_node_destroy (node);
+      thunar_tree_model_node_destroy (model, node);
 
       /* release the path */
       gtk_tree_path_free (path);
@@ -1684,95 +2043,63 @@ thunar_tree_model_node_traverse_free (GNode   *node,
 
 
 
-static gboolean
-thunar_tree_model_node_traverse_visible (GNode    *node,
-                                         gpointer  user_data)
+static void
+thunar_tree_model_node_prefetch (ThunarTreeModel *model,
+                                 GNode           *node)
 {
   ThunarTreeModelItem *item = node->data;
-  ThunarTreeModel     *model = THUNAR_TREE_MODEL (user_data);
-  GtkTreePath         *path;
-  GtkTreeIter          iter;
-  GNode               *child_node;
-  GSList              *lp, *lnext;
-  ThunarTreeModelItem *parent, *child;
-  ThunarFile          *file;
 
-  _thunar_return_val_if_fail (model->visible_func != NULL, FALSE);
-  _thunar_return_val_if_fail (item == NULL || item->file == NULL || THUNAR_IS_FILE (item->file), FALSE);
+  /* skip dummy nodes and items without a file */
+  if (item == NULL || item->file == NULL)
+    return;
 
-  if (G_LIKELY (item != NULL && item->file != NULL))
-    {
-      /* check if this file should be visibily in the treeview */
-      if (!model->visible_func (model, item->file, model->visible_data))
-        {
-          /* delete all the children of the node */
-          while (node->children)
-            g_node_traverse (node->children, G_POST_ORDER, G_TRAVERSE_ALL, -1,
-                             thunar_tree_model_node_traverse_remove, model);
+  /* check if the item was already handled in this run */
+  if (item->prefetch_serial == model->prefetch_serial)
+    return;
 
-          /* generate an iterator for the item */
-          GTK_TREE_ITER_INIT (iter, model->stamp, node);
+  /* keep the folder, even if it is already loaded */
+  item->prefetch_serial = model->prefetch_serial;
 
-          /* remove this item from the tree */
-          path = gtk_tree_model_get_path (GTK_TREE_MODEL (model), &iter);
-          gtk_tree_model_row_deleted (GTK_TREE_MODEL (model), path);
-          gtk_tree_path_free (path);
-
-          /* insert the file in the invisible list of the parent */
-          parent = node->parent->data;
-          if (G_LIKELY (parent))
-            parent->invisible_children = g_slist_prepend (parent->invisible_children,
-                                                          g_object_ref (G_OBJECT (item->file)));
+  /* nothing to do if the folder is loaded or about to be loaded */
+  if (item->folder != NULL
+      || item->load_idle_id != 0
+      || model->prefetch_budget == 0)
+    return;
 
-          /* free the item and destroy the node */
-          thunar_tree_model_item_free (item);
-          g_node_destroy (node);
-        }
-      else if (!G_NODE_HAS_DUMMY (node))
-        {
-          /* this node should be visible. check if the node has invisible
-           * files that should be visible too */
-          for (lp = item->invisible_children, child_node = NULL; lp != NULL; lp = lnext)
-            {
-              lnext = lp->next;
-              file = THUNAR_FILE (lp->data);
+  /* queue the item for the prefetch idle */
+  model->prefetch_queue = g_list_append (model->prefetch_queue, item);
+  model->prefetch_budget -= 1;
+}
 
-              _thunar_return_val_if_fail (THUNAR_IS_FILE (file), FALSE);
 
-              if (model->visible_func (model, file, model->visible_data))
-                {
-                  /* allocate a new item for the file */
-                  child = thunar_tree_model_item_new_with_file (model, file);
 
-                  /* insert a new node for the child */
-                  child_node = g_node_append_data (node, child);
+static gboolean
+thunar_tree_model_prefetch_idle (gpointer user_data)
+{
+  ThunarTreeModel     *model = THUNAR_TREE_MODEL (user_data);
+  ThunarTreeModelItem *item;
 
-                  /* determine the tree iter for the child */
-                  GTK_TREE_ITER_INIT (iter, model->stamp, child_node);
+  if (G_UNLIKELY (model->prefetch_queue == NULL))
+    return FALSE;
 
-                  /* emit a "row-inserted" for the new node */
-                  path = gtk_tree_model_get_path (GTK_TREE_MODEL (model), &iter);
-                  gtk_tree_model_row_inserted (GTK_TREE_MODEL (model), path, &iter);
-                  gtk_tree_path_free (path);
+  /* take the next item from the queue */
+  item = model->prefetch_queue->data;
+  model->prefetch_queue = g_list_delete_link (model->prefetch_queue, model->prefetch_queue);
 
-                  /* release the reference on the file hold by the invisible list */
-                  g_object_unref (G_OBJECT (file));
+  /* load the folder, unless the view requested it in the meantime */
+  if (item->folder == NULL && item->load_idle_id == 0 && item->file != NULL)
+    thunar_tree_model_item_load_idle (item);
 
-                  /* delete the file in the list */
-                  item->invisible_children = g_slist_delete_link (item->invisible_children, lp);
+  /* load one folder per iteration */
+  return (model->prefetch_queue != NULL);
+}
 
-                  /* insert dummy */
-                  thunar_tree_model_node_insert_dummy (child_node, model);
-                }
-            }
 
-          /* sort this node if one of new children have been added */
-          if (child_node != NULL)
-            thunar_tree_model_sort (model, node);
-        }
-    }
 
-  return FALSE;
+static void
+thunar_tree_model_prefetch_idle_destroy (gpointer user_data)
+{
+  THUNAR_TREE_MODEL (user_data)->prefetch_idle_id = 0;
 }
 
 
@@ -1874,7 +2201,9 @@ thunar_tree_model_set_case_sensitive (ThunarTreeModel *model,
  *
  * Sets the visible function used when filtering the #ThunarTreeModel.
  * The function should return %TRUE if the given row should be visible
- * and %FALSE otherwise.
+ * and %FALSE otherwise. Only hidden files, as reported by
+ * thunar_file_is_hidden(), may be filtered out; the model relies on
+ * that to refilter only the nodes whose visibility can change.
  **/
 void
 thunar_tree_model_set_visible_func (ThunarTreeModel            *model,
@@ -1895,17 +2224,78 @@ thunar_tree_model_set_visible_func (ThunarTreeModel            *model,
  * thunar_tree_model_refilter:
  * @model : a #ThunarTreeModel.
  *
- * Walks all the folders in the #ThunarTreeModel and updates their
- * visibility.
+ * Updates the visibility of the folders in the #ThunarTreeModel. Only
+ * the nodes of hidden folders and the folders hidden before are
+ * checked, see thunar_tree_model_set_visible_func(). The rows are
+ * removed and inserted one parent at a time.
  **/
 void
 thunar_tree_model_refilter (ThunarTreeModel *model)
 {
+  GHashTableIter  iter;
+  GHashTable     *hide_nodes;
+  GHashTable     *parents;
+  ThunarFile     *file;
+  gpointer        key;
+  GSList         *children;
+  GList          *nodes;
+  GList          *lp;
+  GNode          *ancestor;
+  GNode          *child;
+  GNode          *node;
+
   _thunar_return_if_fail (THUNAR_IS_TREE_MODEL (model));
+  _thunar_return_if_fail (model->visible_func != NULL);
 
-  /* traverse all nodes to update their visibility */
-  g_node_traverse (model->root, G_PRE_ORDER, G_TRAVERSE_ALL, -1,
-                   thunar_tree_model_node_traverse_visible, model);
+  /* check which of the visible hidden folders should disappear */
+  hide_nodes = g_hash_table_new (NULL, NULL);
+  g_hash_table_iter_init (&iter, model->hidden_nodes);
+  while (g_hash_table_iter_next (&iter, &key, NULL))
+    {
+      node = key;
+      file = THUNAR_TREE_MODEL_ITEM (node->data)->file;
+      if (file != NULL && !model->visible_func (model, file, model->visible_data))
+        g_hash_table_insert (hide_nodes, node, node);
+    }
+
+  /* group them by parent, nodes below another node
+   * that disappears are removed together with it */
+  parents = g_hash_table_new (NULL, NULL);
+  g_hash_table_iter_init (&iter, hide_nodes);
+  while (g_hash_table_iter_next (&iter, &key, NULL))
+    {
+      node = key;
+      for (ancestor = node->parent; ancestor != NULL; ancestor = ancestor->parent)
+        if (g_hash_table_lookup (hide_nodes, ancestor) != NULL)
+          break;
+
+      if (G_LIKELY (ancestor == NULL))
+        g_hash_table_insert (parents, node->parent, node->parent);
+    }
+
+  /* remove the rows of each parent, last child first */
+  nodes = g_hash_table_get_keys (parents);
+  for (lp = nodes; lp != NULL; lp = lp->next)
+    {
+      node = lp->data;
+
+      for (child = node->children, children = NULL; child != NULL; child = child->next)
+        if (g_hash_table_lookup (hide_nodes, child) != NULL)
+          children = g_slist_prepend (children, child);
+
+      thunar_tree_model_node_hide_children (model, node, children);
+      g_slist_free (children);
+    }
+  g_list_free (nodes);
+
+  g_hash_table_destroy (parents);
+  g_hash_table_destroy (hide_nodes);
+
+  /* insert the invisible folders that should be visible now */
+  nodes = g_hash_table_get_keys (model->filtered_nodes);
+  for (lp = nodes; lp != NULL; lp = lp->next)
+    thunar_tree_model_node_show_children (model, lp->data);
+  g_list_free (nodes);
 }
 
 
@@ -1930,3 +2320,66 @@ thunar_tree_model_cleanup (ThunarTreeModel *model)
     }
 }
 
+
+
+/**
+ * thunar_tree_model_prefetch:
+ * @model : a #ThunarTreeModel.
+ * @iter  : the #GtkTreeIter of the current directory of the view.
+ *
+ * Loads the subfolders of the folders the user is likely to expand
+ * next in the background: @iter, its subfolders, the siblings of
+ * @iter and its ancestors and the recently expanded folders. At
+ * most %PREFETCH_BUDGET folders are loaded, one per low priority idle
+ * iteration.
+ *
+ * Folders prefetched for a previous directory are released by the
+ * next cleanup if the view doesn't use them.
+ **/
+void
+thunar_tree_model_prefetch (ThunarTreeModel *model,
+                            GtkTreeIter     *iter)
+{
+  GNode *node;
+  GNode *child;
+  GList *lp;
+
+  _thunar_return_if_fail (THUNAR_IS_TREE_MODEL (model));
+  _thunar_return_if_fail (iter != NULL && iter->stamp == model->stamp);
+
+  /* start a new run, this drops whatever is still queued */
+  if (G_UNLIKELY (++model->prefetch_serial == 0))
+    model->prefetch_serial = 1;
+  model->prefetch_budget = PREFETCH_BUDGET;
+  g_list_free (model->prefetch_queue);
+  model->prefetch_queue = NULL;
+
+  /* the directory and its subfolders */
+  node = iter->user_data;
+  thunar_tree_model_node_prefetch (model, node);
+  for (child = node->children; child != NULL; child = child->next)
+    thunar_tree_model_node_prefetch (model, child);
+
+  /* the siblings of the directory and its ancestors, nearest first. the
+   * toplevel items (trash, network, devices) are not prefetched */
+  for (; node->parent != NULL && node->parent != model->root; node = node->parent)
+    {
+      thunar_tree_model_node_prefetch (model, node->parent);
+      for (child = node->parent->children; child != NULL; child = child->next)
+        thunar_tree_model_node_prefetch (model, child);
+    }
+
+  /* the recently expanded folders */
+  for (lp = model->recent_items; lp != NULL; lp = lp->next)
+    thunar_tree_model_node_prefetch (model, THUNAR_TREE_MODEL_ITEM (lp->data)->node);
+
+  /* schedule the prefetch idle */
+  if (model->prefetch_queue != NULL && model->prefetch_idle_id == 0)
+    {
+      model->prefetch_idle_id = g_idle_add_full (G_PRIORITY_LOW, thunar_tree_model_prefetch_idle,
+                                                 model, thunar_tree_model_prefetch_idle_destroy);
+    }
+
+  /* release the folders prefetched for the previous directory */
+  thunar_tree_model_cleanup (model);
+}
@@ -68,6 +68,9 @@ void             thunar_tree_model_refilter           (ThunarTreeModel
 
 void             thunar_tree_model_cleanup            (ThunarTreeModel            *model);
 
+void             thunar_tree_model_prefetch           (ThunarTreeModel            *model,
+                                                       GtkTreeIter                *iter);
+
 G_END_DECLS;
 
 #endif /* !__THUNAR_TREE_MODEL_H__ */
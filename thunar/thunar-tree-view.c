@@ -2608,6 +2608,10 @@ thunar_tree_view_cursor_idle (gpointer user_data)
               /* place cursor on the ancestor */
               gtk_tree_view_set_cursor (GTK_TREE_VIEW (view), ancestor, NULL, FALSE);
 
+              /* load the folders the user is likely to expand next */
+              if (done && gtk_tree_model_get_iter (GTK_TREE_MODEL (view->model), &iter, ancestor))
+                thunar_tree_model_prefetch (view->model, &iter);
+
               /* release the ancestor path */
               gtk_tree_path_free (ancestor);
 
@@ -62,6 +62,22 @@
 
 
 
+typedef struct
+{
+  const gchar *phase;
+  gint64       time;
+} ThunarProfileMark;
+
+
+
+/* startup profile, only recorded if THUNAR_PROFILE_STARTUP is set */
+static GArray *thunar_util_profile_marks = NULL;
+static gint64  thunar_util_profile_start = 0;
+static gint64  thunar_util_profile_last = 0;
+static gint    thunar_util_profile_state = -1;
+
+
+
 /**
  * thunar_util_strrchr_offset:
  * @str:    haystack
@@ -609,3 +625,86 @@ thunar_setup_display_cb (gpointer data)
 {
   g_setenv ("DISPLAY", (char *) data, TRUE);
 }
+
+
+
+/**
+ * thunar_util_profile_enabled:
+ *
+ * Checks whether Thunar was started with the THUNAR_PROFILE_STARTUP
+ * environment variable set. The first call also starts the clock of
+ * the startup profile.
+ *
+ * Return value: %TRUE if the startup profile is recorded.
+ **/
+gboolean
+thunar_util_profile_enabled (void)
+{
+  /* check once whether profiling is enabled */
+  if (G_UNLIKELY (thunar_util_profile_state < 0))
+    {
+      thunar_util_profile_state = (g_getenv ("THUNAR_PROFILE_STARTUP") != NULL);
+      thunar_util_profile_start = thunar_util_profile_last = g_get_monotonic_time ();
+    }
+
+  return thunar_util_profile_state;
+}
+
+
+
+/**
+ * thunar_util_profile_mark:
+ * @phase : static string naming the phase that just finished.
+ *
+ * Records the time at which @phase finished, if Thunar was started
+ * with the THUNAR_PROFILE_STARTUP environment variable set. The
+ * recorded phases are printed by thunar_util_profile_dump().
+ **/
+void
+thunar_util_profile_mark (const gchar *phase)
+{
+  ThunarProfileMark mark;
+
+  _thunar_return_if_fail (phase != NULL);
+
+  if (G_LIKELY (!thunar_util_profile_enabled ()))
+    return;
+
+  if (thunar_util_profile_marks == NULL)
+    thunar_util_profile_marks = g_array_new (FALSE, FALSE, sizeof (ThunarProfileMark));
+
+  mark.phase = phase;
+  mark.time = g_get_monotonic_time ();
+  g_array_append_val (thunar_util_profile_marks, mark);
+}
+
+
+
+/**
+ * thunar_util_profile_dump:
+ *
+ * Prints the phases recorded by thunar_util_profile_mark() since the
+ * last dump, with the time spent in each phase and the time elapsed
+ * since the first mark.
+ **/
+void
+thunar_util_profile_dump (void)
+{
+  ThunarProfileMark *mark;
+  guint              n;
+
+  if (thunar_util_profile_marks == NULL || thunar_util_profile_marks->len == 0)
+    return;
+
+  g_print ("Thunar startup profile:\n");
+  for (n = 0; n < thunar_util_profile_marks->len; ++n)
+    {
+      mark = &g_array_index (thunar_util_profile_marks, ThunarProfileMark, n);
+      g_print ("  %-28s %9.2f ms %9.2f ms\n", mark->phase,
+               (mark->time - thunar_util_profile_last) / 1000.0,
+               (mark->time - thunar_util_profile_start) / 1000.0);
+      thunar_util_profile_last = mark->time;
+    }
+
+  g_array_set_size (thunar_util_profile_marks, 0);
+}
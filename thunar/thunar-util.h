@@ -55,6 +55,10 @@ gchar     *thunar_util_change_working_directory (const gchar    *new_directory)
 
 void       thunar_setup_display_cb              (gpointer data);
 
+gboolean   thunar_util_profile_enabled          (void);
+void       thunar_util_profile_mark             (const gchar    *phase);
+void       thunar_util_profile_dump             (void);
+
 G_END_DECLS;
 
 #endif /* !__THUNAR_UTIL_H__ */
@@ -225,3 +225,36 @@ thunarx_menu_provider_get_dnd_actions (ThunarxMenuProvider *provider,
 
   return actions;
 }
+
+
+
+/**
+ * thunarx_menu_provider_get_cache_stamp:
+ * @provider : a #ThunarxMenuProvider.
+ *
+ * Tells the file manager whether the actions returned from @provider
+ * may be cached. A provider that returns a non-zero stamp promises
+ * that its thunarx_menu_provider_get_file_actions() and
+ * thunarx_menu_provider_get_folder_actions() results depend only on
+ * the files and the window passed to them, so the file manager may
+ * reuse the previously returned actions as long as neither the files
+ * nor the stamp changed. The provider should return a different stamp
+ * whenever its configuration changes.
+ *
+ * Providers that don't implement this method are never cached.
+ *
+ * Return value: a non-zero stamp if the actions of @provider may be
+ *               cached, %0 otherwise.
+ *
+ * Since: 1.7.0
+ **/
+guint
+thunarx_menu_provider_get_cache_stamp (ThunarxMenuProvider *provider)
+{
+  g_return_val_if_fail (THUNARX_IS_MENU_PROVIDER (provider), 0);
+
+  if (THUNARX_MENU_PROVIDER_GET_IFACE (provider)->get_cache_stamp != NULL)
+    return (*THUNARX_MENU_PROVIDER_GET_IFACE (provider)->get_cache_stamp) (provider);
+
+  return 0;
+}
@@ -58,8 +58,9 @@ struct _ThunarxMenuProviderIface
                                  ThunarxFileInfo     *folder,
                                  GList               *files);
 
+  guint  (*get_cache_stamp)     (ThunarxMenuProvider *provider);
+
   /*< private >*/
-  void (*reserved1) (void);
   void (*reserved2) (void);
   void (*reserved3) (void);
 };
@@ -79,6 +80,8 @@ GList *thunarx_menu_provider_get_dnd_actions    (ThunarxMenuProvider *provider,
                                                  ThunarxFileInfo     *folder,
                                                  GList               *files) G_GNUC_MALLOC G_GNUC_WARN_UNUSED_RESULT;
 
+guint  thunarx_menu_provider_get_cache_stamp    (ThunarxMenuProvider *provider);
+
 G_END_DECLS;
 
 #endif /* !__THUNARX_MENU_PROVIDER_H__ */
@@ -22,6 +22,8 @@
 #include <config.h>
 #endif
 
+#include <glib/gstdio.h>
+
 #include <gdk/gdk.h>
 
 #include <thunarx/thunarx-private.h>
@@ -39,7 +41,12 @@
 static void     thunarx_provider_factory_finalize       (GObject                     *object);
 static void     thunarx_provider_factory_add            (ThunarxProviderFactory      *factory,
                                                          ThunarxProviderModule       *module);
-static GList   *thunarx_provider_factory_load_modules   (ThunarxProviderFactory      *factory);
+static void     thunarx_provider_factory_load_manifest  (ThunarxProviderFactory      *factory);
+static gboolean thunarx_provider_factory_needs_module   (ThunarxProviderFactory      *factory,
+                                                         const gchar                 *name,
+                                                         GType                        type);
+static GList   *thunarx_provider_factory_load_modules   (ThunarxProviderFactory      *factory,
+                                                         GType                        type);
 static gboolean thunarx_provider_factory_timer          (gpointer                     user_data);
 static void     thunarx_provider_factory_timer_destroy  (gpointer                     user_data);
 
@@ -63,6 +70,11 @@ struct _ThunarxProviderFactory
   ThunarxProviderInfo *infos;     /* provider types and cached provider references */
   gint                 n_infos;   /* number of items in the infos array */
 
+  gchar              **names;     /* file names of the available modules */
+  GHashTable          *manifest;  /* module name -> interfaces implemented by the module */
+  GHashTable          *loaded;    /* names of the modules whose types were added */
+  GSList              *queried;   /* provider types for which the modules were loaded */
+
   guint                timer_id;  /* GSource timer to cleanup cached providers */
 };
 
@@ -110,6 +122,14 @@ thunarx_provider_factory_finalize (GObject *object)
       g_object_unref (factory->infos[n].provider);
   g_free (factory->infos);
 
+  /* release the module information */
+  if (factory->manifest != NULL)
+    g_hash_table_destroy (factory->manifest);
+  if (factory->loaded != NULL)
+    g_hash_table_destroy (factory->loaded);
+  g_slist_free (factory->queried);
+  g_strfreev (factory->names);
+
   (*G_OBJECT_CLASS (thunarx_provider_factory_parent_class)->finalize) (object);
 }
 
@@ -137,60 +157,156 @@ thunarx_provider_factory_add (ThunarxProviderFactory *factory,
 
 
 
+static void
+thunarx_provider_factory_load_manifest (ThunarxProviderFactory *factory)
+{
+  GPtrArray   *names;
+  GStatBuf     manifest_stat;
+  GStatBuf     module_stat;
+  const gchar *name;
+  GKeyFile    *key_file;
+  gchar      **groups;
+  gchar      **interfaces;
+  gchar       *path;
+  GDir        *dp;
+  guint        n;
+
+  factory->manifest = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify) g_strfreev);
+  factory->loaded = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+
+  /* determine the file names of all existing plugins */
+  names = g_ptr_array_new ();
+  dp = g_dir_open (THUNARX_DIRECTORY, 0, NULL);
+  if (G_LIKELY (dp != NULL))
+    {
+      while ((name = g_dir_read_name (dp)) != NULL)
+        if (g_str_has_suffix (name, "." G_MODULE_SUFFIX))
+          g_ptr_array_add (names, g_strdup (name));
+      g_dir_close (dp);
+    }
+  g_ptr_array_add (names, NULL);
+  factory->names = (gchar **) g_ptr_array_free (names, FALSE);
+
+  /* load the manifest written by thunarx-query-modules (if any) */
+  path = g_build_filename (THUNARX_DIRECTORY, THUNARX_PROVIDER_MODULE_MANIFEST, NULL);
+  key_file = g_key_file_new ();
+  if (g_stat (path, &manifest_stat) == 0
+      && g_key_file_load_from_file (key_file, path, G_KEY_FILE_NONE, NULL))
+    {
+      groups = g_key_file_get_groups (key_file, NULL);
+      for (n = 0; groups[n] != NULL; ++n)
+        {
+          /* ignore modules that were updated after the manifest was written */
+          g_free (path);
+          path = g_build_filename (THUNARX_DIRECTORY, groups[n], NULL);
+          if (g_stat (path, &module_stat) != 0 || module_stat.st_mtime > manifest_stat.st_mtime)
+            continue;
+
+          interfaces = g_key_file_get_string_list (key_file, groups[n], THUNARX_PROVIDER_MODULE_MANIFEST_INTERFACES, NULL, NULL);
+          if (G_LIKELY (interfaces != NULL))
+            g_hash_table_insert (factory->manifest, g_strdup (groups[n]), interfaces);
+        }
+      g_strfreev (groups);
+    }
+  g_key_file_free (key_file);
+  g_free (path);
+}
+
+
+
+static gboolean
+thunarx_provider_factory_needs_module (ThunarxProviderFactory *factory,
+                                       const gchar            *name,
+                                       GType                   type)
+{
+  gchar **interfaces;
+  guint   n;
+
+  /* the manifest only knows about interfaces */
+  if (!G_TYPE_IS_INTERFACE (type))
+    return TRUE;
+
+  /* modules missing from the manifest must be loaded to find out */
+  interfaces = g_hash_table_lookup (factory->manifest, name);
+  if (interfaces == NULL)
+    return TRUE;
+
+  for (n = 0; interfaces[n] != NULL; ++n)
+    if (g_str_equal (interfaces[n], g_type_name (type)))
+      return TRUE;
+
+  return FALSE;
+}
+
+
+
 static GList*
-thunarx_provider_factory_load_modules (ThunarxProviderFactory *factory)
+thunarx_provider_factory_load_modules (ThunarxProviderFactory *factory,
+                                       GType                   type)
 {
   ThunarxProviderModule *module;
   const gchar           *name;
   GList                 *modules = NULL;
   GList                 *lp;
-  GDir                  *dp;
+  guint                  n;
+#ifndef NDEBUG
+  gint64                 start;
+#endif
 
-  dp = g_dir_open (THUNARX_DIRECTORY, 0, NULL);
-  if (G_LIKELY (dp != NULL))
+  /* nothing to do if the modules for this type were loaded before */
+  if (g_slist_find (factory->queried, GSIZE_TO_POINTER (type)) != NULL)
+    return NULL;
+  factory->queried = g_slist_prepend (factory->queried, GSIZE_TO_POINTER (type));
+
+  /* determine the types for the plugins that may provide the type */
+  for (n = 0; factory->names[n] != NULL; ++n)
     {
-      /* determine the types for all existing plugins */
-      for (;;)
+      name = factory->names[n];
+
+      /* skip modules that were loaded before or that don't implement the type */
+      if (g_hash_table_lookup (factory->loaded, name) != NULL
+          || !thunarx_provider_factory_needs_module (factory, name, type))
+        continue;
+
+      /* check if we already have that module */
+      for (lp = thunarx_provider_modules; lp != NULL; lp = lp->next)
+        if (g_str_equal (G_TYPE_MODULE (lp->data)->name, name))
+          break;
+
+      /* use or allocate a new module for the file */
+      if (G_UNLIKELY (lp != NULL))
         {
-          /* read the next entry from the directory */
-          name = g_dir_read_name (dp);
-          if (G_UNLIKELY (name == NULL))
-            break;
-
-          /* check if this is a valid plugin file */
-          if (g_str_has_suffix (name, "." G_MODULE_SUFFIX))
-            {
-              /* check if we already have that module */
-              for (lp = thunarx_provider_modules; lp != NULL; lp = lp->next)
-                if (g_str_equal (G_TYPE_MODULE (lp->data)->name, name))
-                  break;
-
-              /* use or allocate a new module for the file */
-              if (G_UNLIKELY (lp != NULL))
-                {
-                  /* just use the existing module */
-                  module = THUNARX_PROVIDER_MODULE (lp->data);
-                }
-              else
-                {
-                  /* allocate the new module and add it to our list */
-                  module = thunarx_provider_module_new (name);
-                  thunarx_provider_modules = g_list_prepend (thunarx_provider_modules, module);
-                }
-
-              /* try to load the module */
-              if (g_type_module_use (G_TYPE_MODULE (module)))
-                {
-                  /* add the types provided by the module */
-                  thunarx_provider_factory_add (factory, module);
-
-                  /* add the module to our list */
-                  modules = g_list_prepend (modules, module);
-                }
-            }
+          /* just use the existing module */
+          module = THUNARX_PROVIDER_MODULE (lp->data);
+        }
+      else
+        {
+          /* allocate the new module and add it to our list */
+          module = thunarx_provider_module_new (name);
+          thunarx_provider_modules = g_list_prepend (thunarx_provider_modules, module);
         }
 
-      g_dir_close (dp);
+#ifndef NDEBUG
+      start = g_get_monotonic_time ();
+#endif
+
+      /* try to load the module */
+      if (g_type_module_use (G_TYPE_MODULE (module)))
+        {
+          /* add the types provided by the module */
+          thunarx_provider_factory_add (factory, module);
+
+          /* add the module to our list */
+          modules = g_list_prepend (modules, module);
+        }
+
+      /* never try to load the module again */
+      g_hash_table_insert (factory->loaded, g_strdup (name), GUINT_TO_POINTER (TRUE));
+
+#ifndef NDEBUG
+      g_debug ("loaded module %s for %s in %.3f ms", name, g_type_name (type),
+               (g_get_monotonic_time () - start) / 1000.0);
+#endif
     }
 
   return modules;
@@ -295,8 +411,8 @@ thunarx_provider_factory_list_providers (ThunarxProviderFactory *factory,
   /* check if the cleanup timer is running (and thereby the factory is initialized) */
   if (G_UNLIKELY (factory->timer_id == 0))
     {
-      /* load all available modules (and thereby initialize the factory) */
-      modules = thunarx_provider_factory_load_modules (factory);
+      /* determine the available modules and the interfaces they implement */
+      thunarx_provider_factory_load_manifest (factory);
 
       /* start the "provider cache" cleanup timer */
       factory->timer_id = g_timeout_add_seconds_full (G_PRIORITY_LOW, THUNARX_PROVIDER_FACTORY_INTERVAL,
@@ -304,6 +420,9 @@ thunarx_provider_factory_list_providers (ThunarxProviderFactory *factory,
                                                       thunarx_provider_factory_timer_destroy);
     }
 
+  /* load the modules that may provide the type, unless done before */
+  modules = thunarx_provider_factory_load_modules (factory, type);
+
   /* determine all available providers for the type */
   for (info = factory->infos, n = factory->n_infos; --n >= 0; ++info)
     if (G_LIKELY (g_type_is_a (info->type, type)))
@@ -323,7 +442,7 @@ thunarx_provider_factory_list_providers (ThunarxProviderFactory *factory,
         providers = g_list_append (providers, info->provider);
       }
 
-  /* check if we were initialized by this method invocation */
+  /* check if modules were loaded by this method invocation */
   if (G_UNLIKELY (modules != NULL))
     {
       /* unload all non-persistent modules */
@@ -298,3 +298,85 @@ thunarx_provider_module_list_types (const ThunarxProviderModule *module,
 
   (*module->list_types) (types, n_types);
 }
+
+
+
+/**
+ * thunarx_provider_module_write_manifest:
+ * @error : return location for errors or %NULL.
+ *
+ * Loads every module in the extensions directory and writes the manifest
+ * used by the #ThunarxProviderFactory to load only the modules implementing
+ * a requested provider interface. Modules that fail to load are left out,
+ * so the factory will always try them.
+ *
+ * This is private API, only exported for thunarx-query-modules.
+ *
+ * Return value: %TRUE if the manifest was written, %FALSE on error.
+ **/
+gboolean
+thunarx_provider_module_write_manifest (GError **error)
+{
+  ThunarxProviderModule *module;
+  const GType           *types;
+  const gchar           *name;
+  GPtrArray             *names;
+  GKeyFile              *key_file;
+  gboolean               succeed;
+  GType                 *interfaces;
+  gchar                 *contents;
+  gchar                 *path;
+  GDir                  *dp;
+  guint                  n_interfaces;
+  guint                  n;
+  gint                   n_types;
+  gint                   i;
+  gsize                  length;
+
+  g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+  dp = g_dir_open (THUNARX_DIRECTORY, 0, error);
+  if (G_UNLIKELY (dp == NULL))
+    return FALSE;
+
+  key_file = g_key_file_new ();
+  names = g_ptr_array_new ();
+
+  while ((name = g_dir_read_name (dp)) != NULL)
+    {
+      if (!g_str_has_suffix (name, "." G_MODULE_SUFFIX))
+        continue;
+
+      /* load the module to register its types */
+      module = thunarx_provider_module_new (name);
+      if (g_type_module_use (G_TYPE_MODULE (module)))
+        {
+          /* collect the interfaces implemented by the provider types */
+          thunarx_provider_module_list_types (module, &types, &n_types);
+          for (i = 0; i < n_types; ++i)
+            {
+              interfaces = g_type_interfaces (types[i], &n_interfaces);
+              for (n = 0; n < n_interfaces; ++n)
+                g_ptr_array_add (names, (gpointer) g_type_name (interfaces[n]));
+              g_free (interfaces);
+            }
+
+          g_key_file_set_string_list (key_file, name, THUNARX_PROVIDER_MODULE_MANIFEST_INTERFACES,
+                                      (const gchar * const *) names->pdata, names->len);
+          g_ptr_array_set_size (names, 0);
+        }
+    }
+
+  g_ptr_array_free (names, TRUE);
+  g_dir_close (dp);
+
+  /* write the manifest next to the modules */
+  contents = g_key_file_to_data (key_file, &length, NULL);
+  path = g_build_filename (THUNARX_DIRECTORY, THUNARX_PROVIDER_MODULE_MANIFEST, NULL);
+  succeed = g_file_set_contents (path, contents, length, error);
+  g_key_file_free (key_file);
+  g_free (contents);
+  g_free (path);
+
+  return succeed;
+}
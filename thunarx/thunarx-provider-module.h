@@ -37,6 +37,10 @@ typedef struct _ThunarxProviderModule      ThunarxProviderModule;
 #define THUNARX_IS_PROVIDER_MODULE_CLASS(klass) (G_TYPE_CHECK_CLASS_TYPE ((klass), THUNARX_TYPE_PROVIDER_MODULE))
 #define THUNARX_PROVIDER_MODULE_GET_CLASS(obj)  (G_TYPE_INSTANCE_GET_CLASS ((obj), THUNARX_TYPE_PROVIDER_MODULE, ThunarxProviderModuleClass))
 
+/* manifest in THUNARX_DIRECTORY listing the interfaces implemented by each module */
+#define THUNARX_PROVIDER_MODULE_MANIFEST            "thunarx-modules.manifest"
+#define THUNARX_PROVIDER_MODULE_MANIFEST_INTERFACES "Interfaces"
+
 G_GNUC_INTERNAL
 GType                  thunarx_provider_module_get_type   (void) G_GNUC_CONST;
 
@@ -48,4 +52,7 @@ void                   thunarx_provider_module_list_types (const ThunarxProvider
                                                            const GType                **types,
                                                            gint                        *n_types);
 
+/* exported for thunarx-query-modules only */
+gboolean               thunarx_provider_module_write_manifest (GError                    **error);
+
 #endif /* !__THUNARX_PROVIDER_MODULE_H__ */
@@ -0,0 +1,56 @@
+/* vi:set et ai sw=2 sts=2 ts=2: */
+/*-
+ * Copyright (c) 2015 Xfce Development Team <xfce4-dev@xfce.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#ifdef HAVE_STDLIB_H
+#include <stdlib.h>
+#endif
+
+#include <glib.h>
+
+#include <thunarx/thunarx-private.h>
+#include <thunarx/thunarx-provider-module.h>
+
+
+
+/* Writes the manifest used by the ThunarxProviderFactory to load only the
+ * modules implementing a requested provider interface.
+ */
+int
+main (int argc, char **argv)
+{
+  GError *error = NULL;
+
+#if !GLIB_CHECK_VERSION (2, 36, 0)
+  g_type_init ();
+#endif
+
+  if (!thunarx_provider_module_write_manifest (&error))
+    {
+      g_printerr ("%s: %s\n", g_get_prgname (), error->message);
+      g_error_free (error);
+      return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
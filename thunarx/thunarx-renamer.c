@@ -45,34 +45,40 @@ enum
 enum
 {
   CHANGED,
+  FILE_CHANGED,
   LAST_SIGNAL,
 };
 
 
 
-static void     thunarx_renamer_finalize          (GObject                *object);
-static GObject *thunarx_renamer_constructor       (GType                   type,
-                                                   guint                   n_construct_properties,
-                                                   GObjectConstructParam  *construct_properties);
-static void     thunarx_renamer_get_property      (GObject                *object,
-                                                   guint                   prop_id,
-                                                   GValue                 *value,
-                                                   GParamSpec             *pspec);
-static void     thunarx_renamer_set_property      (GObject                *object,
-                                                   guint                   prop_id,
-                                                   const GValue           *value,
-                                                   GParamSpec             *pspec);
-static gchar   *thunarx_renamer_real_process      (ThunarxRenamer         *renamer,
-                                                   ThunarxFileInfo        *file,
-                                                   const gchar            *text,
-                                                   guint                   num);
-static void     thunarx_renamer_real_load         (ThunarxRenamer         *renamer,
-                                                   GHashTable             *settings);
-static void     thunarx_renamer_real_save         (ThunarxRenamer         *renamer,
-                                                   GHashTable             *settings);
-static GList   *thunarx_renamer_real_get_actions  (ThunarxRenamer         *renamer,
-                                                   GtkWindow              *window,
-                                                   GList                  *files);
+static void     thunarx_renamer_finalize            (GObject                *object);
+static GObject *thunarx_renamer_constructor         (GType                   type,
+                                                     guint                   n_construct_properties,
+                                                     GObjectConstructParam  *construct_properties);
+static void     thunarx_renamer_get_property        (GObject                *object,
+                                                     guint                   prop_id,
+                                                     GValue                 *value,
+                                                     GParamSpec             *pspec);
+static void     thunarx_renamer_set_property        (GObject                *object,
+                                                     guint                   prop_id,
+                                                     const GValue           *value,
+                                                     GParamSpec             *pspec);
+static gchar   *thunarx_renamer_real_process        (ThunarxRenamer         *renamer,
+                                                     ThunarxFileInfo        *file,
+                                                     const gchar            *text,
+                                                     guint                   num);
+static void     thunarx_renamer_real_load           (ThunarxRenamer         *renamer,
+                                                     GHashTable             *settings);
+static void     thunarx_renamer_real_save           (ThunarxRenamer         *renamer,
+                                                     GHashTable             *settings);
+static gchar  **thunarx_renamer_real_process_batch  (ThunarxRenamer         *renamer,
+                                                     ThunarxFileInfo       **files,
+                                                     const gchar           **texts,
+                                                     const guint            *indices,
+                                                     guint                   n_files);
+static GList   *thunarx_renamer_real_get_actions    (ThunarxRenamer         *renamer,
+                                                     GtkWindow              *window,
+                                                     GList                  *files);
 
 
 
@@ -110,6 +116,7 @@ thunarx_renamer_class_init (ThunarxRenamerClass *klass)
   klass->load = thunarx_renamer_real_load;
   klass->save = thunarx_renamer_real_save;
   klass->get_actions = thunarx_renamer_real_get_actions;
+  klass->process_batch = thunarx_renamer_real_process_batch;
 
   /**
    * ThunarxRenamer:help-url:
@@ -166,6 +173,29 @@ thunarx_renamer_class_init (ThunarxRenamerClass *klass)
                   NULL, NULL,
                   g_cclosure_marshal_VOID__VOID,
                   G_TYPE_NONE, 0);
+
+  /**
+   * ThunarxRenamer::file-changed:
+   * @renamer : a #ThunarxRenamer.
+   * @file    : the #ThunarxFileInfo whose new name changed.
+   *
+   * Derived classes should emit this signal using the
+   * thunarx_renamer_file_changed() method whenever the
+   * new name of a single @file changed without a change
+   * of the settings, for example because information
+   * the @renamer loaded in the background became available.
+   *
+   * The file manager will then invoke thunarx_renamer_process()
+   * only for @file and update its row in the preview.
+   **/
+  renamer_signals[FILE_CHANGED] =
+    g_signal_new (I_("file-changed"),
+                  G_TYPE_FROM_CLASS (klass),
+                  G_SIGNAL_RUN_FIRST,
+                  G_STRUCT_OFFSET (ThunarxRenamerClass, file_changed),
+                  NULL, NULL,
+                  g_cclosure_marshal_VOID__OBJECT,
+                  G_TYPE_NONE, 1, THUNARX_TYPE_FILE_INFO);
 }
 
 
@@ -281,6 +311,27 @@ thunarx_renamer_real_process (ThunarxRenamer  *renamer,
 
 
 
+static gchar**
+thunarx_renamer_real_process_batch (ThunarxRenamer   *renamer,
+                                    ThunarxFileInfo **files,
+                                    const gchar     **texts,
+                                    const guint      *indices,
+                                    guint             n_files)
+{
+  gchar **names;
+  guint   n;
+
+  /* the fallback method processes the files one by one */
+  names = g_new (gchar *, n_files + 1);
+  for (n = 0; n < n_files; ++n)
+    names[n] = (*THUNARX_RENAMER_GET_CLASS (renamer)->process) (renamer, files[n], texts[n], indices[n]);
+  names[n] = NULL;
+
+  return names;
+}
+
+
+
 static void
 thunarx_renamer_real_load (ThunarxRenamer *renamer,
                            GHashTable     *settings)
@@ -521,6 +572,49 @@ thunarx_renamer_process (ThunarxRenamer  *renamer,
 
 
 
+/**
+ * thunarx_renamer_process_batch:
+ * @renamer : a #ThunarxRenamer.
+ * @files   : an array of @n_files #ThunarxFileInfo<!---->s whose
+ *            new names - according to @renamer - should be
+ *            determined.
+ * @texts   : the parts of the filenames to which the @renamer
+ *            should be applied, one for every file in @files.
+ * @indices : the indices of the @files in the list, used for
+ *            renamers that work on numbering.
+ * @n_files : the number of items in @files, @texts and @indices.
+ *
+ * Determines the replacements for all @texts at once. The result
+ * is the same as calling thunarx_renamer_process() for every file,
+ * but renamers may override this method to share expensive work,
+ * such as compiling a pattern or querying metadata, between the
+ * files of a batch. The default implementation simply invokes the
+ * <literal>process</literal> method for every file.
+ *
+ * The caller is responsible to free the returned array using
+ * g_strfreev() when no longer needed.
+ *
+ * Return value: a %NULL-terminated array of @n_files strings with
+ *               which to replace the @texts.
+ *
+ * Since: 1.7.0
+ **/
+gchar**
+thunarx_renamer_process_batch (ThunarxRenamer   *renamer,
+                               ThunarxFileInfo **files,
+                               const gchar     **texts,
+                               const guint      *indices,
+                               guint             n_files)
+{
+  g_return_val_if_fail (THUNARX_IS_RENAMER (renamer), NULL);
+  g_return_val_if_fail (files != NULL || n_files == 0, NULL);
+  g_return_val_if_fail (texts != NULL || n_files == 0, NULL);
+  g_return_val_if_fail (indices != NULL || n_files == 0, NULL);
+  return (*THUNARX_RENAMER_GET_CLASS (renamer)->process_batch) (renamer, files, texts, indices, n_files);
+}
+
+
+
 /**
  * thunarx_renamer_load:
  * @renamer  : a #ThunarxRenamer.
@@ -704,3 +798,24 @@ thunarx_renamer_changed (ThunarxRenamer *renamer)
   g_return_if_fail (THUNARX_IS_RENAMER (renamer));
   g_signal_emit (G_OBJECT (renamer), renamer_signals[CHANGED], 0);
 }
+
+
+
+/**
+ * thunarx_renamer_file_changed:
+ * @renamer : a #ThunarxRenamer.
+ * @file    : a #ThunarxFileInfo.
+ *
+ * This method should be used by derived classes
+ * to emit the "file-changed" signal for @renamer
+ * and @file. See the documentation of the
+ * "file-changed" signal for details.
+ **/
+void
+thunarx_renamer_file_changed (ThunarxRenamer  *renamer,
+                              ThunarxFileInfo *file)
+{
+  g_return_if_fail (THUNARX_IS_RENAMER (renamer));
+  g_return_if_fail (THUNARX_IS_FILE_INFO (file));
+  g_signal_emit (G_OBJECT (renamer), renamer_signals[FILE_CHANGED], 0, file);
+}
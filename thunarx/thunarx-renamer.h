@@ -64,8 +64,13 @@ struct _ThunarxRenamerClass
                          GtkWindow       *window,
                          GList           *files);
 
+  gchar **(*process_batch) (ThunarxRenamer   *renamer,
+                            ThunarxFileInfo **files,
+                            const gchar     **texts,
+                            const guint      *indices,
+                            guint             n_files);
+
   /*< private >*/
-  void (*reserved0) (void);
   void (*reserved1) (void);
   void (*reserved2) (void);
   void (*reserved3) (void);
@@ -74,10 +79,11 @@ struct _ThunarxRenamerClass
   /*< public >*/
 
   /* signals */
-  void (*changed) (ThunarxRenamer *renamer);
+  void (*changed)      (ThunarxRenamer  *renamer);
+  void (*file_changed) (ThunarxRenamer  *renamer,
+                        ThunarxFileInfo *file);
 
   /*< private >*/
-  void (*reserved6) (void);
   void (*reserved7) (void);
   void (*reserved8) (void);
   void (*reserved9) (void);
@@ -90,31 +96,38 @@ struct _ThunarxRenamer
   ThunarxRenamerPrivate *priv;
 };
 
-GType        thunarx_renamer_get_type     (void) G_GNUC_CONST;
-
-const gchar *thunarx_renamer_get_help_url (ThunarxRenamer   *renamer);
-void         thunarx_renamer_set_help_url (ThunarxRenamer   *renamer,
-                                           const gchar      *help_url);
-
-const gchar *thunarx_renamer_get_name     (ThunarxRenamer   *renamer);
-void         thunarx_renamer_set_name     (ThunarxRenamer   *renamer,
-                                           const gchar      *name);
-
-gchar       *thunarx_renamer_process      (ThunarxRenamer   *renamer,
-                                           ThunarxFileInfo  *file,
-                                           const gchar      *text,
-                                           guint             index) G_GNUC_MALLOC;
-
-void         thunarx_renamer_load         (ThunarxRenamer   *renamer,
-                                           GHashTable       *settings);
-void         thunarx_renamer_save         (ThunarxRenamer   *renamer,
-                                           GHashTable       *settings);
-
-GList       *thunarx_renamer_get_actions  (ThunarxRenamer   *renamer,
-                                           GtkWindow        *window,
-                                           GList            *files) G_GNUC_MALLOC;
-
-void         thunarx_renamer_changed      (ThunarxRenamer   *renamer);
+GType        thunarx_renamer_get_type      (void) G_GNUC_CONST;
+
+const gchar *thunarx_renamer_get_help_url  (ThunarxRenamer   *renamer);
+void         thunarx_renamer_set_help_url  (ThunarxRenamer   *renamer,
+                                            const gchar      *help_url);
+
+const gchar *thunarx_renamer_get_name      (ThunarxRenamer   *renamer);
+void         thunarx_renamer_set_name      (ThunarxRenamer   *renamer,
+                                            const gchar      *name);
+
+gchar       *thunarx_renamer_process       (ThunarxRenamer   *renamer,
+                                            ThunarxFileInfo  *file,
+                                            const gchar      *text,
+                                            guint             index) G_GNUC_MALLOC;
+gchar      **thunarx_renamer_process_batch (ThunarxRenamer   *renamer,
+                                            ThunarxFileInfo **files,
+                                            const gchar     **texts,
+                                            const guint      *indices,
+                                            guint             n_files) G_GNUC_MALLOC;
+
+void         thunarx_renamer_load          (ThunarxRenamer   *renamer,
+                                            GHashTable       *settings);
+void         thunarx_renamer_save          (ThunarxRenamer   *renamer,
+                                            GHashTable       *settings);
+
+GList       *thunarx_renamer_get_actions   (ThunarxRenamer   *renamer,
+                                            GtkWindow        *window,
+                                            GList            *files) G_GNUC_MALLOC;
+
+void         thunarx_renamer_changed       (ThunarxRenamer   *renamer);
+void         thunarx_renamer_file_changed  (ThunarxRenamer   *renamer,
+                                            ThunarxFileInfo  *file);
 
 G_END_DECLS;
 